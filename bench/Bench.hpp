@@ -0,0 +1,280 @@
+#pragma once
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <format>
+#include <unistd.h>
+
+// Minimal microbenchmark harness for the bench/ programs.
+//
+// Each benchmark body runs `iterations` times per call. The runner first
+// grows the batch size until one batch takes about a millisecond, then
+// repeats batches until --min-time has passed and reports per-operation
+// statistics over the batches. The median is the number to track: it is
+// the least sensitive to scheduler noise.
+//
+// Output is a table on stdout; --json[=path] writes the results in Google
+// Benchmark's JSON layout ("context" + "benchmarks" with real_time in ns),
+// so existing comparison tools can diff two runs.
+namespace bench {
+
+// Keep the optimizer from discarding a computed value
+template <typename T>
+inline void do_not_optimize(T const& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+inline void clobber_memory() {
+    asm volatile("" : : : "memory");
+}
+
+struct Result {
+    std::string name;
+    uint64_t iterations = 0;  // Total operations timed
+    double mean_ns = 0;       // Per operation
+    double median_ns = 0;
+    double min_ns = 0;
+    double stddev_ns = 0;
+    double p90_ns = 0;        // Only for record()ed latencies
+    double p99_ns = 0;
+    double bytes_per_op = 0;  // 0 when the benchmark has no byte count
+    double items_per_op = 0;
+};
+
+class Runner {
+public:
+    // Body: void(uint64_t iterations); it must do `iterations` operations
+    using Body = std::function<void(uint64_t)>;
+
+    // Program-specific options go to `extra_option`, which returns false for
+    // ones it does not know
+    using OptionHandler = std::function<bool(std::string_view)>;
+
+    Runner(int argc, char* argv[], const OptionHandler& extra_option = {}, std::string_view extra_usage = "")
+        : executable_(argc > 0 ? argv[0] : "") {
+        for (int i = 1; i < argc; ++i) {
+            std::string_view arg = argv[i];
+            if (extra_option && extra_option(arg)) {
+                continue;
+            } else if (arg == "--json") {
+                json_path_ = "-";
+            } else if (arg.starts_with("--json=")) {
+                json_path_ = arg.substr(7);
+            } else if (arg.starts_with("--filter=")) {
+                filter_ = arg.substr(9);
+            } else if (arg.starts_with("--min-time=")) {
+                min_time_ = std::stod(std::string(arg.substr(11)));
+            } else if (arg == "--list") {
+                list_only_ = true;
+            } else {
+                std::cout << "Usage: " << argv[0] << " [--filter=substring] [--min-time=seconds] [--json[=path]] [--list]\n"
+                          << "  --json without a path prints JSON to stdout instead of the table\n"
+                          << extra_usage;
+                std::exit(arg == "-h" || arg == "--help" ? 0 : 2);
+            }
+        }
+    }
+
+    bool selected(std::string_view name) const {
+        return filter_.empty() || name.find(filter_) != std::string_view::npos;
+    }
+
+    // Register and immediately run one benchmark (if it passes the filter).
+    // bytes_per_op / items_per_op feed the throughput columns.
+    void run(const std::string& name, const Body& body, double bytes_per_op = 0, double items_per_op = 0) {
+        if (!selected(name)) return;
+        if (list_only_) {
+            std::cout << name << '\n';
+            return;
+        }
+        using clock = std::chrono::steady_clock;
+        auto time_batch = [&](uint64_t n) {
+            auto start = clock::now();
+            body(n);
+            return std::chrono::duration<double, std::nano>(clock::now() - start).count();
+        };
+
+        uint64_t batch = 1;
+        double elapsed = time_batch(batch); // Also warms caches and lazy state
+        while (elapsed < 1e6 && batch < (uint64_t{1} << 40)) {
+            batch *= elapsed < 1e5 ? 10 : 2;
+            elapsed = time_batch(batch);
+        }
+
+        std::vector<double> samples;
+        double total = 0;
+        while (total < min_time_ * 1e9 || samples.size() < 5) {
+            double ns = time_batch(batch);
+            total += ns;
+            samples.push_back(ns / static_cast<double>(batch));
+        }
+
+        Result r;
+        r.name = name;
+        r.iterations = batch * samples.size();
+        r.bytes_per_op = bytes_per_op;
+        r.items_per_op = items_per_op;
+        r.mean_ns = total / static_cast<double>(r.iterations);
+        std::sort(samples.begin(), samples.end());
+        size_t mid = samples.size() / 2;
+        r.median_ns = samples.size() % 2 ? samples[mid] : (samples[mid - 1] + samples[mid]) / 2;
+        r.min_ns = samples.front();
+        double variance = 0;
+        for (double s : samples) variance += (s - r.mean_ns) * (s - r.mean_ns);
+        r.stddev_ns = std::sqrt(variance / static_cast<double>(samples.size()));
+        results_.push_back(r);
+
+        if (json_path_ != "-") print_row(r);
+    }
+
+    // Report latencies the caller timed itself, one sample per operation,
+    // e.g. per request against a server. Adds p90/p99 to the statistics.
+    void record(const std::string& name, std::vector<double> samples_ns, double items_per_op = 0,
+                double bytes_per_op = 0) {
+        if (!selected(name)) return;
+        if (list_only_) {
+            std::cout << name << '\n';
+            return;
+        }
+        if (samples_ns.empty()) return;
+        Result r;
+        r.name = name;
+        r.iterations = samples_ns.size();
+        r.bytes_per_op = bytes_per_op;
+        r.items_per_op = items_per_op;
+        std::sort(samples_ns.begin(), samples_ns.end());
+        double total = 0;
+        for (double s : samples_ns) total += s;
+        r.mean_ns = total / static_cast<double>(samples_ns.size());
+        r.median_ns = percentile(samples_ns, 0.5);
+        r.p90_ns = percentile(samples_ns, 0.9);
+        r.p99_ns = percentile(samples_ns, 0.99);
+        r.min_ns = samples_ns.front();
+        double variance = 0;
+        for (double s : samples_ns) variance += (s - r.mean_ns) * (s - r.mean_ns);
+        r.stddev_ns = std::sqrt(variance / static_cast<double>(samples_ns.size()));
+        results_.push_back(r);
+
+        if (json_path_ != "-") print_row(r);
+    }
+
+    // Linear interpolation between closest ranks; `sorted` must be ascending
+    static double percentile(const std::vector<double>& sorted, double q) {
+        if (sorted.empty()) return 0;
+        double rank = q * static_cast<double>(sorted.size() - 1);
+        size_t lo = static_cast<size_t>(rank);
+        size_t hi = std::min(lo + 1, sorted.size() - 1);
+        return sorted[lo] + (sorted[hi] - sorted[lo]) * (rank - static_cast<double>(lo));
+    }
+
+    // Write the JSON report if requested; returns the process exit code
+    int finish() const {
+        if (list_only_ || json_path_.empty()) return 0;
+        std::string report = to_json().dump(2);
+        if (json_path_ == "-") {
+            std::cout << report << std::endl;
+            return 0;
+        }
+        std::ofstream out(json_path_);
+        out << report << '\n';
+        if (!out) {
+            std::cerr << "Cannot write " << json_path_ << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    nlohmann::json to_json() const {
+        char date[32];
+        std::time_t now = std::time(nullptr);
+        std::tm local{};
+        localtime_r(&now, &local);
+        std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z", &local);
+        char host[256] = "";
+        gethostname(host, sizeof(host) - 1);
+
+        nlohmann::json benchmarks = nlohmann::json::array();
+        for (const auto& r : results_) {
+            auto add = [&](const std::string& suffix, const std::string& aggregate, double ns) {
+                nlohmann::json b = {
+                    {"name", r.name + suffix},
+                    {"run_name", r.name},
+                    {"run_type", "aggregate"},
+                    {"aggregate_name", aggregate},
+                    {"iterations", r.iterations},
+                    {"real_time", ns},
+                    {"cpu_time", ns},
+                    {"time_unit", "ns"}
+                };
+                if (aggregate == "stddev") ns = 0; // Throughput of a spread is meaningless
+                if (r.bytes_per_op > 0 && ns > 0) b["bytes_per_second"] = r.bytes_per_op * 1e9 / ns;
+                if (r.items_per_op > 0 && ns > 0) b["items_per_second"] = r.items_per_op * 1e9 / ns;
+                benchmarks.push_back(std::move(b));
+            };
+            add("_mean", "mean", r.mean_ns);
+            add("_median", "median", r.median_ns);
+            add("_stddev", "stddev", r.stddev_ns);
+            add("_min", "min", r.min_ns);
+            if (r.p99_ns > 0) {
+                add("_p90", "p90", r.p90_ns);
+                add("_p99", "p99", r.p99_ns);
+            }
+        }
+        return {
+            {"context", {
+                {"date", date},
+                {"host_name", host},
+                {"executable", executable_},
+                {"num_cpus", std::thread::hardware_concurrency()},
+#ifdef NDEBUG
+                {"library_build_type", "release"},
+#else
+                {"library_build_type", "debug"},
+#endif
+                {"min_time_s", min_time_}
+            }},
+            {"benchmarks", std::move(benchmarks)}
+        };
+    }
+
+    const std::vector<Result>& results() const { return results_; }
+
+private:
+    std::string executable_;
+    std::string json_path_; // "" = none, "-" = stdout
+    std::string filter_;
+    double min_time_ = 0.5;
+    bool list_only_ = false;
+    std::vector<Result> results_;
+    mutable bool header_printed_ = false;
+
+    void print_row(const Result& r) const {
+        if (!header_printed_) {
+            std::cout << std::format("{:<44} {:>12} {:>12} {:>8} {:>14}\n", "benchmark", "median ns", "min ns", "cv %",
+                                     "throughput");
+            header_printed_ = true;
+        }
+        std::string throughput;
+        if (r.bytes_per_op > 0) {
+            throughput = std::format("{:.1f} MB/s", r.bytes_per_op * 1e3 / r.median_ns);
+        } else if (r.items_per_op > 0) {
+            throughput = std::format("{:.2f} M/s", r.items_per_op * 1e3 / r.median_ns);
+        }
+        double cv = r.mean_ns > 0 ? 100.0 * r.stddev_ns / r.mean_ns : 0;
+        std::cout << std::format("{:<44} {:>12.1f} {:>12.1f} {:>8.1f} {:>14}\n", r.name, r.median_ns, r.min_ns, cv,
+                                 throughput)
+                  << std::flush;
+    }
+};
+
+} // namespace bench
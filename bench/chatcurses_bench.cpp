@@ -0,0 +1,329 @@
+// chatcurses_bench: microbenchmarks for the hot paths of the chat client -
+// wrapping and measuring text, painting the chat window, building provider
+// requests, framing/parsing MCP traffic and trace spans. Nothing here touches the
+// network or needs API keys; the UI draws into a headless terminal.
+//
+// Usage: chatcurses_bench [--filter=substring] [--min-time=seconds] [--json[=path]] [--list]
+#include "Bench.hpp"
+#include "utf8_utils.hpp"
+#include "NCursesUI.hpp"
+#include "XAIClient.hpp"
+#include "ClaudeAIClient.hpp"
+#include "OpenAIClient.hpp"
+#include "GeminiAIClient.hpp"
+#include "MCPMessage.hpp"
+#include "MCPStdioFramer.hpp"
+#include "Trace.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+    // Deterministic text: prose with some long words, or the same with CJK,
+    // combining marks and emoji sprinkled in
+    std::string make_text(size_t bytes, bool unicode) {
+        static const char* ascii_words[] = {"the", "quick", "brown", "fox", "jumps", "over", "lazy", "dogs",
+                                            "streaming", "response", "configuration", "internationalization"};
+        static const char* unicode_words[] = {"你好", "café", "été", "\U0001F44D",
+                                              "\U0001F468‍\U0001F469‍\U0001F467", "한국어",
+                                              "\U0001F1EF\U0001F1F5", "naïve"};
+        std::string text;
+        uint32_t seed = 12345;
+        size_t word = 0;
+        while (text.size() < bytes) {
+            seed = seed * 1103515245 + 12345;
+            bool pick_unicode = unicode && (seed >> 16) % 4 == 0;
+            text += pick_unicode ? unicode_words[(seed >> 8) % std::size(unicode_words)]
+                                 : ascii_words[(seed >> 8) % std::size(ascii_words)];
+            text += ++word % 40 == 0 ? '\n' : ' ';
+        }
+        return text;
+    }
+
+    template <typename Client>
+    void fill_history(Client& client, int turns, size_t message_bytes) {
+        client.set_system_prompt("You are a helpful assistant running in a terminal.");
+        std::string user = make_text(message_bytes / 4, false);
+        std::string assistant = make_text(message_bytes, true);
+        for (int i = 0; i < turns; ++i) {
+            client.push_user_message(user);
+            client.push_assistant_message(assistant);
+        }
+    }
+
+    // A tools/list result the size of a typical multi-server setup
+    std::string make_tools_list_response(int tools) {
+        nlohmann::json list = nlohmann::json::array();
+        for (int i = 0; i < tools; ++i) {
+            list.push_back({
+                {"name", "tool_" + std::to_string(i)},
+                {"description", "Fetches and summarizes data for tool number " + std::to_string(i)},
+                {"inputSchema", {
+                    {"type", "object"},
+                    {"properties", {
+                        {"url", {{"type", "string"}, {"description", "Address to fetch"}}},
+                        {"max_results", {{"type", "integer"}, {"minimum", 1}, {"maximum", 50}}}
+                    }},
+                    {"required", {"url"}}
+                }}
+            });
+        }
+        return nlohmann::json{{"jsonrpc", "2.0"}, {"id", 42}, {"result", {{"tools", list}}}}.dump();
+    }
+
+    std::string make_tool_call_response(size_t payload_bytes) {
+        nlohmann::json content = nlohmann::json::array({{{"type", "text"}, {"text", make_text(payload_bytes, true)}}});
+        return nlohmann::json{{"jsonrpc", "2.0"}, {"id", "req-7"}, {"result", {{"content", content}}}}.dump();
+    }
+
+    void bench_text(bench::Runner& runner) {
+        for (bool unicode : {false, true}) {
+            std::string kind = unicode ? "mixed" : "ascii";
+            std::string text = make_text(4096, unicode);
+            runner.run("utf8_word_wrap/" + kind + "/4KB/80", [&](uint64_t n) {
+                for (uint64_t i = 0; i < n; ++i) bench::do_not_optimize(utf8_word_wrap(text, 80, 2));
+            }, static_cast<double>(text.size()));
+
+            std::vector<WrapSpan> spans;
+            runner.run("utf8_wrap_spans/" + kind + "/4KB/80", [&](uint64_t n) {
+                for (uint64_t i = 0; i < n; ++i) {
+                    utf8_wrap_spans(text, 80, 2, spans);
+                    bench::do_not_optimize(spans.data());
+                }
+            }, static_cast<double>(text.size()));
+
+            runner.run("utf8_display_width/" + kind + "/4KB", [&](uint64_t n) {
+                for (uint64_t i = 0; i < n; ++i) bench::do_not_optimize(utf8_display_width(text));
+            }, static_cast<double>(text.size()));
+
+            std::string line = make_text(80, unicode);
+            runner.run("utf8_display_width/" + kind + "/line", [&](uint64_t n) {
+                for (uint64_t i = 0; i < n; ++i) bench::do_not_optimize(utf8_display_width(line));
+            }, static_cast<double>(line.size()));
+        }
+    }
+
+    void bench_render(bench::Runner& runner) {
+        bool wanted = false;
+        for (const char* kind : {"ascii", "mixed"}) {
+            for (const char* scenario : {"scroll", "tail", "full_repaint"}) {
+                wanted |= runner.selected(std::format("draw_chat_window/{}/{}", kind, scenario));
+            }
+        }
+        if (!wanted) return;
+        // Headless terminal: a fixed size, output thrown away
+        setenv("TERM", "xterm-256color", 0);
+        setenv("LINES", "50", 1);
+        setenv("COLUMNS", "160", 1);
+        FILE* out = std::fopen("/dev/null", "w");
+        FILE* in = std::fopen("/dev/null", "r");
+        if (!out || !in) {
+            std::fprintf(stderr, "Cannot open /dev/null; skipping draw_chat_window\n");
+            return;
+        }
+        {
+            std::unique_ptr<NCursesUI> ui;
+            try {
+                ui = std::make_unique<NCursesUI>(out, in);
+            } catch (const std::exception& e) {
+                std::fprintf(stderr, "%s (TERM=%s); skipping draw_chat_window\n", e.what(), std::getenv("TERM"));
+            }
+            if (ui) {
+                for (bool unicode : {false, true}) {
+                    std::string kind = unicode ? "mixed" : "ascii";
+                    auto rows = utf8_word_wrap(make_text(64 * 1024, unicode), ui->chat_text_width(), 2);
+                    size_t visible = static_cast<size_t>(ui->chat_text_rows());
+                    std::vector<std::string_view> frame(visible);
+
+                    // Streaming: the window scrolls by one row per frame
+                    size_t top = 0;
+                    runner.run("draw_chat_window/" + kind + "/scroll", [&](uint64_t n) {
+                        for (uint64_t i = 0; i < n; ++i) {
+                            top = (top + 1) % (rows.size() - visible);
+                            for (size_t r = 0; r < visible; ++r) frame[r] = rows[top + r];
+                            ui->draw_chat_window(frame);
+                            ui->refresh_all();
+                        }
+                    });
+
+                    // Streaming into the last row only: everything else is unchanged
+                    for (size_t r = 0; r < visible; ++r) frame[r] = rows[r];
+                    size_t tail = 0;
+                    runner.run("draw_chat_window/" + kind + "/tail", [&](uint64_t n) {
+                        for (uint64_t i = 0; i < n; ++i) {
+                            const std::string& last = rows[visible + tail % 64];
+                            frame.back() = std::string_view(last).substr(0, (tail * 7) % (last.size() + 1));
+                            ++tail;
+                            ui->draw_chat_window(frame);
+                            ui->refresh_all();
+                        }
+                    });
+
+                    // Resize, theme change or settings panel: repaint everything
+                    runner.run("draw_chat_window/" + kind + "/full_repaint", [&](uint64_t n) {
+                        for (uint64_t i = 0; i < n; ++i) {
+                            ui->invalidate();
+                            ui->draw_chat_window(frame);
+                            ui->refresh_all();
+                        }
+                    });
+                }
+            }
+        }
+        std::fclose(in);
+        std::fclose(out);
+    }
+
+    void bench_requests(bench::Runner& runner) {
+        const std::string latest = "Summarize the discussion so far in three bullet points.";
+        for (int turns : {10, 100}) {
+            std::string suffix = "/" + std::to_string(turns) + "_turns";
+
+            XAIClient xai;
+            fill_history(xai, turns, 600);
+            ClaudeAIClient claude;
+            fill_history(claude, turns, 600);
+            OpenAIClient openai;
+            fill_history(openai, turns, 600);
+            GeminiAIClient gemini;
+            fill_history(gemini, turns, 600);
+
+            runner.run("build_message_history/xai" + suffix, [&](uint64_t n) {
+                for (uint64_t i = 0; i < n; ++i) bench::do_not_optimize(xai.build_message_history(latest));
+            });
+            runner.run("build_message_history/claude" + suffix, [&](uint64_t n) {
+                for (uint64_t i = 0; i < n; ++i) bench::do_not_optimize(claude.build_message_history(latest));
+            });
+            runner.run("build_message_history/gemini" + suffix, [&](uint64_t n) {
+                for (uint64_t i = 0; i < n; ++i) bench::do_not_optimize(gemini.build_message_history(latest));
+            });
+
+            // Body construction plus dump(): what send_message does before curl
+            const std::string system = "You are a helpful assistant running in a terminal.";
+            auto xai_messages = xai.build_message_history(latest);
+            double xai_bytes = static_cast<double>(xai.build_request_body(xai_messages, "grok-3-beta", system).dump().size());
+            runner.run("request_body/xai" + suffix, [&](uint64_t n) {
+                for (uint64_t i = 0; i < n; ++i) {
+                    bench::do_not_optimize(xai.build_request_body(xai_messages, "grok-3-beta", system).dump());
+                }
+            }, xai_bytes);
+            auto claude_messages = claude.build_message_history(latest);
+            double claude_bytes = static_cast<double>(claude.build_request_body(claude_messages, "claude", system).dump().size());
+            runner.run("request_body/claude" + suffix, [&](uint64_t n) {
+                for (uint64_t i = 0; i < n; ++i) {
+                    bench::do_not_optimize(claude.build_request_body(claude_messages, "claude", system).dump());
+                }
+            }, claude_bytes);
+            auto openai_messages = openai.build_message_history(latest);
+            double openai_bytes = static_cast<double>(openai.build_request_body(openai_messages, "gpt-4o").dump().size());
+            runner.run("request_body/openai" + suffix, [&](uint64_t n) {
+                for (uint64_t i = 0; i < n; ++i) {
+                    bench::do_not_optimize(openai.build_request_body(openai_messages, "gpt-4o").dump());
+                }
+            }, openai_bytes);
+            auto gemini_messages = gemini.build_message_history(latest);
+            double gemini_bytes = static_cast<double>(gemini.build_request_body(gemini_messages).dump().size());
+            runner.run("request_body/gemini" + suffix, [&](uint64_t n) {
+                for (uint64_t i = 0; i < n; ++i) bench::do_not_optimize(gemini.build_request_body(gemini_messages).dump());
+            }, gemini_bytes);
+        }
+    }
+
+    void bench_mcp(bench::Runner& runner) {
+        struct Sample {
+            std::string name;
+            std::string text;
+        };
+        std::vector<Sample> samples = {
+            {"notification", nlohmann::json{{"jsonrpc", "2.0"}, {"method", "notifications/progress"},
+                                            {"params", {{"progressToken", "t1"}, {"progress", 50}, {"total", 100}}}}.dump()},
+            {"tools_list_32", make_tools_list_response(32)},
+            {"tool_result_64KB", make_tool_call_response(64 * 1024)},
+        };
+        for (const auto& sample : samples) {
+            auto json = nlohmann::json::parse(sample.text);
+            runner.run("parse_mcp_message/" + sample.name, [&](uint64_t n) {
+                for (uint64_t i = 0; i < n; ++i) bench::do_not_optimize(parse_mcp_message(json));
+            });
+            // What the client does per received line: text -> json -> message
+            runner.run("parse_mcp_message/" + sample.name + "/from_text", [&](uint64_t n) {
+                for (uint64_t i = 0; i < n; ++i) {
+                    bench::do_not_optimize(parse_mcp_message(nlohmann::json::parse(sample.text)));
+                }
+            }, static_cast<double>(sample.text.size()));
+        }
+
+        // Outgoing: serialize a tools/call request and frame it
+        MCPRequest request(MCPMessageId{std::string("req-7")}, "tools/call",
+                           nlohmann::json{{"name", "scrape_url"}, {"arguments", {{"url", "https://example.com/page"}}}});
+        std::string frame;
+        runner.run("stdio_framing/send/tools_call", [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) {
+                frame.clear();
+                MCPStdioFramer::append_frame(frame, request.to_json().dump());
+                bench::do_not_optimize(frame.data());
+            }
+        });
+
+        // Incoming: pipe reads of 64KB carrying many small messages, and one
+        // large result split over many reads
+        auto feed_stream = [&](const std::string& name, const std::string& message, size_t copies) {
+            std::string stream;
+            for (size_t i = 0; i < copies; ++i) MCPStdioFramer::append_frame(stream, message);
+            runner.run("stdio_framing/receive/" + name, [&](uint64_t n) {
+                MCPStdioFramer framer;
+                size_t lines = 0;
+                for (uint64_t i = 0; i < n; ++i) {
+                    for (size_t at = 0; at < stream.size(); at += 65536) {
+                        framer.feed(std::string_view(stream).substr(at, 65536), [&](std::string_view line) {
+                            lines += line.size();
+                        });
+                    }
+                }
+                bench::do_not_optimize(lines);
+            }, static_cast<double>(stream.size()), static_cast<double>(copies));
+        };
+        feed_stream("small_x1000", samples[0].text, 1000);
+        feed_stream("1MB_x1", make_tool_call_response(1024 * 1024), 1);
+    }
+
+    // What a span costs on a hot path, with tracing off and on
+    void bench_trace(bench::Runner& runner) {
+        auto& tracer = Tracer::instance();
+        runner.run("trace_span/disabled", [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) {
+                TraceSpan span("bench", "bench");
+                bench::do_not_optimize(span.active());
+            }
+        });
+        tracer.start(""); // Record without writing a file
+        runner.run("trace_span/enabled", [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) {
+                TraceSpan span("bench", "bench");
+                if ((i & 0xFFFF) == 0xFFFF) tracer.clear(); // Stay below the per-thread cap
+            }
+        });
+        runner.run("trace_span/enabled_with_arg", [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) {
+                TraceSpan span("bench", "bench");
+                span.arg("tool", "scrape_url");
+                if ((i & 0xFFFF) == 0xFFFF) tracer.clear();
+            }
+        });
+        tracer.stop();
+        tracer.clear();
+    }
+}
+
+int main(int argc, char* argv[]) {
+    bench::Runner runner(argc, argv);
+    bench_text(runner);
+    bench_render(runner);
+    bench_requests(runner);
+    bench_mcp(runner);
+    bench_trace(runner);
+    return runner.finish();
+}
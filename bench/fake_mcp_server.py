@@ -0,0 +1,450 @@
+#!/usr/bin/env python3
+"""Scriptable fake MCP server over stdio or WebSocket, for benchmarks and tests.
+
+Speaks enough of MCP 2024-11-05 for MCPClient: initialize, ping, shutdown,
+tools/list, tools/call, resources/list, resources/read,
+resources/subscribe, resources/unsubscribe, prompts/list, prompts/get and
+notifications/cancelled. Tool calls run concurrently, so latency scripted
+on one call does not hold up the others.
+
+    python3 bench/fake_mcp_server.py                  # stdio
+    python3 bench/fake_mcp_server.py --ws 9400        # WebSocket on ws://127.0.0.1:9400
+    python3 bench/fake_mcp_server.py --script tools.json
+
+A script is a JSON list of tools. Every field but "name" is optional:
+
+    [{"name": "slow_search", "latency_ms": 40, "jitter_ms": 10, "payload_bytes": 2048,
+      "failure_rate": 0.05, "failure": "rpc_error", "progress_steps": 3}]
+
+failure is one of rpc_error (JSON-RPC error response), tool_error (result
+with isError), hang (never answers unless cancelled), malformed (a line
+that is not JSON) and disconnect (the server exits). A call may override
+latency_ms, payload_bytes and fail (bool, forces the failure mode) through
+its arguments; ignore_cancel (bool) answers even after
+notifications/cancelled, like a reply that crossed the cancellation. A
+tool's "input_schema" replaces the default inputSchema. Without --script
+the built-in tools below are served.
+
+tools/list returns every tool on one page until fake/set_tools_page_size
+{"size": n} splits it into pages of n; nextCursor is the offset of the
+next page.
+
+The server holds two text resources, fake://notes and fake://status. The
+non-MCP request fake/update_resource {"uri": ..., "text": ...} replaces or
+adds one and, if the client subscribed to it, sends
+notifications/resources/updated before the reply. fake/update_after_read
+takes the same parameters and applies the update right after the next
+resources/read of that uri has been answered.
+
+Prompts are Python format strings over their arguments; missing required
+arguments are an invalid-params error. {<argument>_length} expands to an
+argument's length, which makes a prompt that is not a plain substitution.
+A prompt's "when" {"argument": ..., "equals": ..., "template": ...} swaps in
+another template for one argument value, like a conditional in a real
+template language. The "broken" prompt fails every prompts/get.
+fake/set_prompt {"name": ..., "template": ..., "arguments": [...]} replaces
+or adds a prompt and sends notifications/prompts/list_changed before the reply. fake/stats returns
+{"prompts_get": n, "cancelled": [...]}: the number of prompts/get requests
+and the ids named by notifications/cancelled so far.
+"""
+import argparse
+import base64
+import hashlib
+import json
+import os
+import random
+import socket
+import socketserver
+import struct
+import sys
+import threading
+import time
+
+PROTOCOL_VERSION = "2024-11-05"
+
+INPUT_SCHEMA = {
+    "type": "object",
+    "properties": {
+        "text": {"type": "string"},
+        "latency_ms": {"type": "number", "minimum": 0},
+        "payload_bytes": {"type": "integer", "minimum": 0},
+        "fail": {"type": "boolean"},
+    },
+}
+
+DEFAULT_TOOLS = [
+    {"name": "echo", "description": "Returns its arguments"},
+    {"name": "fixed_latency", "description": "Answers after 10 ms", "latency_ms": 10},
+    {"name": "payload", "description": "Returns payload_bytes of text", "payload_bytes": 65536},
+    {"name": "flaky", "description": "Fails 10% of calls with a JSON-RPC error", "failure_rate": 0.1,
+     "failure": "rpc_error"},
+    {"name": "tool_error", "description": "Always reports a tool-level error", "failure_rate": 1.0,
+     "failure": "tool_error"},
+    {"name": "hang", "description": "Never answers; use with a timeout or cancellation", "failure_rate": 1.0,
+     "failure": "hang"},
+    {"name": "progress", "description": "Reports progress while it works", "latency_ms": 50, "progress_steps": 5},
+    {"name": "tagged", "description": "Returns its arguments; accepts any tag_* argument",
+     "input_schema": dict(INPUT_SCHEMA, patternProperties={"^tag_": {"type": "string"}}, additionalProperties=False)},
+]
+
+DEFAULT_RESOURCES = {
+    "fake://notes": "first version of the notes",
+    "fake://status": "idle",
+}
+
+DEFAULT_PROMPTS = {
+    "greeting": {"description": "Greets someone", "template": "Hello, {name}! Welcome to {place}.",
+                 "arguments": [{"name": "name", "required": True}, {"name": "place", "required": True}]},
+    "review": {"description": "Asks for a code review", "template": "Review this {language} code:\n{code}",
+               "arguments": [{"name": "code", "required": True}, {"name": "language"}]},
+    "length_aware": {"description": "Not a plain substitution", "template": "{topic} ({topic_length} characters)",
+                     "arguments": [{"name": "topic", "required": True}]},
+    "access": {"description": "Wording depends on an argument's value", "template": "{name} has {level} access",
+               "when": {"argument": "level", "equals": "admin", "template": "{name} has full access"},
+               "arguments": [{"name": "name", "required": True}, {"name": "level", "required": True}]},
+    "broken": {"description": "Fails every prompts/get", "template": "", "arguments": []},
+}
+
+
+def make_payload(size):
+    """Printable, JSON-safe filler of exactly size bytes."""
+    line = "The quick brown fox jumps over the lazy dog. 0123456789\n"
+    return (line * (size // len(line) + 1))[:size]
+
+
+class Server:
+    def __init__(self, tools, seed, send):
+        self.tools = {t["name"]: t for t in tools}
+        self.resources = dict(DEFAULT_RESOURCES)
+        self.subscriptions = set()
+        self.updates_after_read = {}
+        self.prompts = {name: dict(prompt) for name, prompt in DEFAULT_PROMPTS.items()}
+        self.prompts_get = 0
+        self.tools_page_size = None
+        self.rng = random.Random(seed)
+        self.rng_lock = threading.Lock()
+        self.cancelled = set()
+        self.cancelled_lock = threading.Lock()
+        self.send = send  # Callable taking one serialized line; must be thread-safe
+
+    def reply(self, msg_id, result=None, error=None):
+        message = {"jsonrpc": "2.0", "id": msg_id}
+        if error is not None:
+            message["error"] = error
+        else:
+            message["result"] = result
+        self.send(json.dumps(message))
+
+    def handle_line(self, line):
+        try:
+            message = json.loads(line)
+        except json.JSONDecodeError:
+            self.send(json.dumps({"jsonrpc": "2.0", "id": None,
+                                  "error": {"code": -32700, "message": "Parse error"}}))
+            return True
+        method = message.get("method")
+        msg_id = message.get("id")
+        params = message.get("params") or {}
+        if method is None:
+            return True  # A response to something we never send
+        if msg_id is None:
+            if method == "notifications/cancelled":
+                with self.cancelled_lock:
+                    self.cancelled.add(json.dumps(params.get("requestId")))
+            return True
+        if method == "initialize":
+            self.reply(msg_id, {
+                "protocolVersion": PROTOCOL_VERSION,
+                "capabilities": {"tools": {"listChanged": False}, "resources": {"subscribe": True},
+                                 "prompts": {"listChanged": True}},
+                "serverInfo": {"name": "fake-mcp-server", "version": "1.0.0"},
+            })
+        elif method == "ping":
+            self.reply(msg_id, {})
+        elif method == "shutdown":
+            self.reply(msg_id, {})
+            return False
+        elif method == "tools/list":
+            tools = [{"name": t["name"], "description": t.get("description", ""),
+                      "inputSchema": t.get("input_schema", INPUT_SCHEMA)} for t in self.tools.values()]
+            start = int(params.get("cursor") or 0)
+            end = start + self.tools_page_size if self.tools_page_size else len(tools)
+            result = {"tools": tools[start:end]}
+            if end < len(tools):
+                result["nextCursor"] = str(end)
+            self.reply(msg_id, result)
+        elif method == "fake/set_tools_page_size":
+            self.tools_page_size = params.get("size") or None
+            self.reply(msg_id, {})
+        elif method == "resources/list":
+            self.reply(msg_id, {"resources": [{"uri": uri, "name": uri.split("://")[1], "mimeType": "text/plain"}
+                                              for uri in self.resources]})
+        elif method == "resources/read":
+            uri = params.get("uri")
+            if uri not in self.resources:
+                self.reply(msg_id, error={"code": -32002, "message": f"Resource not found: {uri}"})
+            else:
+                self.reply(msg_id, {"contents": [{"uri": uri, "mimeType": "text/plain", "text": self.resources[uri]}]})
+                if uri in self.updates_after_read:
+                    self.update_resource(uri, self.updates_after_read.pop(uri))
+        elif method == "resources/subscribe":
+            self.subscriptions.add(params.get("uri"))
+            self.reply(msg_id, {})
+        elif method == "resources/unsubscribe":
+            self.subscriptions.discard(params.get("uri"))
+            self.reply(msg_id, {})
+        elif method == "fake/update_resource":
+            self.update_resource(params.get("uri"), params.get("text", ""))
+            self.reply(msg_id, {})
+        elif method == "fake/update_after_read":
+            self.updates_after_read[params.get("uri")] = params.get("text", "")
+            self.reply(msg_id, {})
+        elif method == "prompts/list":
+            self.reply(msg_id, {"prompts": [{"name": name, "description": prompt.get("description", ""),
+                                             "arguments": prompt.get("arguments", [])}
+                                            for name, prompt in self.prompts.items()]})
+        elif method == "prompts/get":
+            self.prompts_get += 1
+            self.get_prompt(msg_id, params)
+        elif method == "fake/set_prompt":
+            self.prompts[params.get("name")] = {"template": params.get("template", ""),
+                                                "arguments": params.get("arguments", [])}
+            self.send(json.dumps({"jsonrpc": "2.0", "method": "notifications/prompts/list_changed"}))
+            self.reply(msg_id, {})
+        elif method == "fake/stats":
+            with self.cancelled_lock:
+                cancelled = [json.loads(request_id) for request_id in sorted(self.cancelled)]
+            self.reply(msg_id, {"prompts_get": self.prompts_get, "cancelled": cancelled})
+        elif method == "tools/call":
+            threading.Thread(target=self.call_tool, args=(msg_id, params), daemon=True).start()
+        else:
+            self.reply(msg_id, error={"code": -32601, "message": f"Method not found: {method}"})
+        return True
+
+    def update_resource(self, uri, text):
+        self.resources[uri] = text
+        if uri in self.subscriptions:
+            self.send(json.dumps({"jsonrpc": "2.0", "method": "notifications/resources/updated",
+                                  "params": {"uri": uri}}))
+
+    def get_prompt(self, msg_id, params):
+        name = params.get("name")
+        prompt = self.prompts.get(name)
+        if prompt is None or name == "broken":
+            self.reply(msg_id, error={"code": -32602, "message": f"Unknown prompt: {name}"})
+            return
+        args = params.get("arguments") or {}
+        values = {}
+        for argument in prompt.get("arguments", []):
+            value = args.get(argument["name"])
+            if value is None and argument.get("required"):
+                self.reply(msg_id, error={"code": -32602, "message": f"Missing required argument: {argument['name']}"})
+                return
+            values[argument["name"]] = value or ""
+            values[argument["name"] + "_length"] = len(value or "")
+        template = prompt["template"]
+        when = prompt.get("when")
+        if when and args.get(when["argument"]) == when["equals"]:
+            template = when["template"]
+        self.reply(msg_id, {"description": prompt.get("description", ""), "messages": [
+            {"role": "user", "content": {"type": "text", "text": template.format(**values)}}]})
+
+    def is_cancelled(self, msg_id):
+        with self.cancelled_lock:
+            return json.dumps(msg_id) in self.cancelled
+
+    def call_tool(self, msg_id, params):
+        name = params.get("name")
+        args = params.get("arguments") or {}
+        tool = self.tools.get(name)
+        if tool is None:
+            self.reply(msg_id, error={"code": -32602, "message": f"Unknown tool: {name}"})
+            return
+        latency = args.get("latency_ms", tool.get("latency_ms", 0)) / 1000.0
+        jitter = tool.get("jitter_ms", 0) / 1000.0
+        with self.rng_lock:
+            if jitter:
+                latency = max(0.0, latency + self.rng.uniform(-jitter, jitter))
+            fail = args.get("fail", self.rng.random() < tool.get("failure_rate", 0.0))
+        failure = tool.get("failure", "rpc_error")
+
+        token = (params.get("_meta") or {}).get("progressToken")
+        steps = tool.get("progress_steps", 0) if token is not None else 0
+        for step in range(steps):
+            time.sleep(latency / steps)
+            if self.is_cancelled(msg_id):
+                return
+            self.send(json.dumps({"jsonrpc": "2.0", "method": "notifications/progress",
+                                  "params": {"progressToken": token, "progress": step + 1, "total": steps}}))
+        if not steps and latency:
+            time.sleep(latency)
+        if self.is_cancelled(msg_id) and not args.get("ignore_cancel"):
+            return  # MCP: no response to a cancelled request
+
+        if fail:
+            if failure == "hang":
+                return
+            if failure == "disconnect":
+                os._exit(1)
+            if failure == "malformed":
+                self.send('{"jsonrpc": "2.0", "id": ' + json.dumps(msg_id) + ', "result": ')
+                return
+            if failure == "tool_error":
+                self.reply(msg_id, {"isError": True,
+                                    "content": [{"type": "text", "text": f"{name} failed (scripted)"}]})
+                return
+            self.reply(msg_id, error={"code": -32603, "message": f"{name} failed (scripted)"})
+            return
+
+        size = args.get("payload_bytes", tool.get("payload_bytes", 0))
+        text = make_payload(size) if size else json.dumps(args)
+        self.reply(msg_id, {"content": [{"type": "text", "text": text}]})
+
+
+def serve_stdio(tools, seed):
+    lock = threading.Lock()
+    out = sys.stdout.buffer
+
+    def send(line):
+        with lock:
+            out.write(line.encode() + b"\n")
+            out.flush()
+
+    server = Server(tools, seed, send)
+    for raw in sys.stdin.buffer:
+        line = raw.decode().strip()
+        if line and not server.handle_line(line):
+            break
+
+
+# Minimal RFC 6455 server: text frames, ping/pong and close; no extensions
+WS_GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+
+
+def ws_send_frame(sock, opcode, payload):
+    header = bytes([0x80 | opcode])
+    length = len(payload)
+    if length < 126:
+        header += bytes([length])
+    elif length < 1 << 16:
+        header += bytes([126]) + struct.pack("!H", length)
+    else:
+        header += bytes([127]) + struct.pack("!Q", length)
+    sock.sendall(header + payload)
+
+
+def ws_read_exact(sock, n):
+    data = bytearray()
+    while len(data) < n:
+        chunk = sock.recv(n - len(data))
+        if not chunk:
+            raise ConnectionError("closed")
+        data += chunk
+    return bytes(data)
+
+
+def ws_read_message(sock):
+    """Returns (opcode, payload) of the next complete message, joining fragments."""
+    message, message_opcode = bytearray(), None
+    while True:
+        b0, b1 = ws_read_exact(sock, 2)
+        fin, opcode = b0 & 0x80, b0 & 0x0F
+        length = b1 & 0x7F
+        if length == 126:
+            length = struct.unpack("!H", ws_read_exact(sock, 2))[0]
+        elif length == 127:
+            length = struct.unpack("!Q", ws_read_exact(sock, 8))[0]
+        mask = ws_read_exact(sock, 4) if b1 & 0x80 else None
+        payload = ws_read_exact(sock, length)
+        if mask:
+            payload = bytes(b ^ mask[i % 4] for i, b in enumerate(payload))
+        if opcode >= 0x8:
+            return opcode, payload  # Control frames are never fragmented
+        if opcode:
+            message_opcode = opcode
+        message += payload
+        if fin:
+            return message_opcode, bytes(message)
+
+
+class WebSocketHandler(socketserver.BaseRequestHandler):
+    tools = None
+    seed = 1
+
+    def handle(self):
+        sock = self.request
+        sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        request = b""
+        while b"\r\n\r\n" not in request:
+            chunk = sock.recv(4096)
+            if not chunk:
+                return
+            request += chunk
+        headers = {}
+        for line in request.split(b"\r\n")[1:]:
+            key, _, value = line.decode("latin-1").partition(":")
+            headers[key.strip().lower()] = value.strip()
+        key = headers.get("sec-websocket-key")
+        if not key:
+            sock.sendall(b"HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\n\r\n")
+            return
+        accept = base64.b64encode(hashlib.sha1((key + WS_GUID).encode()).digest()).decode()
+        sock.sendall(("HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                      f"Sec-WebSocket-Accept: {accept}\r\n\r\n").encode())
+
+        lock = threading.Lock()
+
+        def send(line):
+            with lock:
+                ws_send_frame(sock, 0x1, line.encode())
+
+        server = Server(self.tools, self.seed, send)
+        try:
+            while True:
+                opcode, payload = ws_read_message(sock)
+                if opcode == 0x8:
+                    with lock:
+                        ws_send_frame(sock, 0x8, payload[:2])
+                    return
+                if opcode == 0x9:
+                    with lock:
+                        ws_send_frame(sock, 0xA, payload)
+                elif opcode == 0x1 and not server.handle_line(payload.decode()):
+                    return
+        except (ConnectionError, OSError):
+            return
+
+
+class ThreadingTCPServer(socketserver.ThreadingTCPServer):
+    allow_reuse_address = True
+    daemon_threads = True
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--ws", type=int, metavar="PORT", help="serve WebSocket on PORT instead of stdio")
+    parser.add_argument("--host", default="127.0.0.1")
+    parser.add_argument("--script", help="JSON file with the tool list")
+    parser.add_argument("--seed", type=int, default=1)
+    args = parser.parse_args()
+
+    tools = DEFAULT_TOOLS
+    if args.script:
+        with open(args.script) as f:
+            tools = json.load(f)
+
+    if args.ws is None:
+        serve_stdio(tools, args.seed)
+        return
+    WebSocketHandler.tools = tools
+    WebSocketHandler.seed = args.seed
+    with ThreadingTCPServer((args.host, args.ws), WebSocketHandler) as server:
+        print(f"Fake MCP server on ws://{args.host}:{server.server_address[1]}", file=sys.stderr, flush=True)
+        try:
+            server.serve_forever()
+        except KeyboardInterrupt:
+            pass
+
+
+if __name__ == "__main__":
+    main()
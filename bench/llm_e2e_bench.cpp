@@ -0,0 +1,233 @@
+// chatcurses_e2e_bench: whole chat turns through the real provider clients
+// against a local endpoint, normally bench/mock_llm_server.py. Reports time
+// to first token, inter-token latency, turn latency and turns/s per provider.
+//
+// The clients currently deliver a reply as one chunk, so their TTFT equals
+// the turn latency and they have no inter-token samples. The wire/ rows read
+// the mock's SSE stream directly with curl and show what a streaming client
+// could achieve against the same server.
+//
+// Usage: chatcurses_e2e_bench [--base-url=http://127.0.0.1:8089] [--providers=xai,claude,openai,gemini]
+//                             [--turns=20] [--grow-history] [--trace=path] [--json[=path]]
+#include "Bench.hpp"
+#include "XAIClient.hpp"
+#include "ClaudeAIClient.hpp"
+#include "OpenAIClient.hpp"
+#include "GeminiAIClient.hpp"
+#include "ProviderConfig.hpp"
+#include "Trace.hpp"
+#include <curl/curl.h>
+#include <chrono>
+#include <cstdio>
+#include <future>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    double ns_between(Clock::time_point from, Clock::time_point to) {
+        return std::chrono::duration<double, std::nano>(to - from).count();
+    }
+
+    std::unique_ptr<AIClientInterface> make_client(const std::string& provider) {
+        if (provider == "xai") return std::make_unique<XAIClient>();
+        if (provider == "claude") return std::make_unique<ClaudeAIClient>();
+        if (provider == "openai") return std::make_unique<OpenAIClient>();
+        if (provider == "gemini") return std::make_unique<GeminiAIClient>();
+        return nullptr;
+    }
+
+    struct Options {
+        std::string base_url = "http://127.0.0.1:8089";
+        std::vector<std::string> providers = {"xai", "claude", "openai", "gemini"};
+        int turns = 20;
+        bool grow_history = false; // Keep each exchange, as the app does
+        std::string trace_path;    // Chrome trace of every turn
+    };
+
+    // One turn through send_message_stream, timing every chunk
+    struct TurnResult {
+        Clock::time_point start;
+        std::vector<Clock::time_point> chunks;
+        Clock::time_point end;
+        std::string text;
+        std::optional<ApiErrorInfo> error;
+    };
+
+    TurnResult run_turn(AIClientInterface& client, const std::string& prompt) {
+        // Shared with the client's detached thread, which may still be
+        // unwinding its callback after the wait below returns
+        struct State {
+            TurnResult turn;
+            std::promise<void> done;
+        };
+        auto state = std::make_shared<State>();
+        auto finished = state->done.get_future();
+        state->turn.start = Clock::now();
+        client.send_message_stream(prompt, "",
+            [state](const std::string& chunk, bool) {
+                state->turn.chunks.push_back(Clock::now());
+                state->turn.text += chunk;
+            },
+            [state]() {
+                state->turn.end = Clock::now();
+                state->done.set_value();
+            },
+            [state](const ApiErrorInfo& error) {
+                state->turn.end = Clock::now();
+                state->turn.error = error;
+                state->done.set_value();
+            });
+        finished.wait();
+        return state->turn;
+    }
+
+    void bench_provider(bench::Runner& runner, const Options& options, const std::string& provider) {
+        auto client = make_client(provider);
+        if (!client) {
+            std::fprintf(stderr, "Unknown provider '%s'\n", provider.c_str());
+            return;
+        }
+        client->set_api_key("mock-key");
+        client->set_base_url(options.base_url);
+        client->set_model(ProviderRegistry::instance().default_model(provider));
+        client->set_system_prompt("You are a helpful assistant running in a terminal.");
+
+        std::vector<double> ttft, turn_ns, inter_token;
+        int errors = 0;
+        size_t chunks = 0;
+        std::string last_error;
+        const std::string prompt = "Summarize the discussion so far in three bullet points.";
+        auto wall_start = Clock::now();
+        for (int i = 0; i < options.turns; ++i) {
+            TurnResult turn = run_turn(*client, prompt);
+            if (turn.error || turn.chunks.empty()) {
+                ++errors;
+                if (turn.error) last_error = turn.error->message;
+                continue;
+            }
+            ttft.push_back(ns_between(turn.start, turn.chunks.front()));
+            turn_ns.push_back(ns_between(turn.start, turn.end));
+            for (size_t c = 1; c < turn.chunks.size(); ++c) {
+                inter_token.push_back(ns_between(turn.chunks[c - 1], turn.chunks[c]));
+            }
+            chunks += turn.chunks.size();
+            if (options.grow_history) {
+                client->push_user_message(prompt);
+                client->push_assistant_message(turn.text);
+            }
+        }
+        double wall_s = ns_between(wall_start, Clock::now()) / 1e9;
+
+        runner.record("e2e/" + provider + "/ttft", ttft);
+        runner.record("e2e/" + provider + "/inter_token", inter_token);
+        runner.record("e2e/" + provider + "/turn", turn_ns, 1);
+        size_t ok = turn_ns.size();
+        std::fprintf(stderr, "%s: %zu/%d turns ok, %.2f turns/s, %.1f chunks/turn\n", provider.c_str(), ok,
+                     options.turns, wall_s > 0 ? static_cast<double>(ok) / wall_s : 0.0,
+                     ok ? static_cast<double>(chunks) / static_cast<double>(ok) : 0.0);
+        if (errors > 0) std::fprintf(stderr, "  %d failed, last error: %s\n", errors, last_error.c_str());
+    }
+
+    // Raw SSE read of /v1/chat/completions: one timestamp per data event
+    struct WireStream {
+        std::string pending;
+        std::vector<Clock::time_point> tokens;
+    };
+
+    size_t wire_write(char* data, size_t size, size_t nmemb, void* userp) {
+        auto* stream = static_cast<WireStream*>(userp);
+        auto now = Clock::now();
+        stream->pending.append(data, size * nmemb);
+        size_t end;
+        while ((end = stream->pending.find("\n\n")) != std::string::npos) {
+            std::string_view event(stream->pending.data(), end);
+            if (event.starts_with("data: ") && event != "data: [DONE]") stream->tokens.push_back(now);
+            stream->pending.erase(0, end + 2);
+        }
+        return size * nmemb;
+    }
+
+    void bench_wire(bench::Runner& runner, const Options& options) {
+        std::string url = options.base_url + "/v1/chat/completions";
+        std::string body = nlohmann::json{
+            {"model", "mock"}, {"stream", true},
+            {"messages", {{{"role", "user"}, {"content", "Summarize the discussion so far."}}}}
+        }.dump();
+        std::vector<double> ttft, inter_token, turn_ns;
+        for (int i = 0; i < options.turns; ++i) {
+            CURL* curl = curl_easy_init();
+            if (!curl) return;
+            WireStream stream;
+            struct curl_slist* headers = curl_slist_append(nullptr, "Content-Type: application/json");
+            curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+            curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body.c_str());
+            curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, wire_write);
+            curl_easy_setopt(curl, CURLOPT_WRITEDATA, &stream);
+            auto start = Clock::now();
+            CURLcode res = curl_easy_perform(curl);
+            auto end = Clock::now();
+            long status = 0;
+            curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
+            curl_slist_free_all(headers);
+            curl_easy_cleanup(curl);
+            if (res != CURLE_OK || status != 200 || stream.tokens.empty()) continue;
+            ttft.push_back(ns_between(start, stream.tokens.front()));
+            for (size_t t = 1; t < stream.tokens.size(); ++t) {
+                inter_token.push_back(ns_between(stream.tokens[t - 1], stream.tokens[t]));
+            }
+            turn_ns.push_back(ns_between(start, end));
+        }
+        runner.record("wire/chat_completions_sse/ttft", ttft);
+        runner.record("wire/chat_completions_sse/inter_token", inter_token);
+        runner.record("wire/chat_completions_sse/turn", turn_ns, 1);
+    }
+
+    std::vector<std::string> split_list(std::string_view list) {
+        std::vector<std::string> items;
+        while (!list.empty()) {
+            size_t comma = list.find(',');
+            if (comma != 0) items.emplace_back(list.substr(0, comma));
+            if (comma == std::string_view::npos) break;
+            list.remove_prefix(comma + 1);
+        }
+        return items;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    bench::Runner runner(argc, argv, [&](std::string_view arg) {
+        if (arg.starts_with("--base-url=")) {
+            options.base_url = arg.substr(11);
+            while (options.base_url.ends_with('/')) options.base_url.pop_back();
+        } else if (arg.starts_with("--providers=")) {
+            options.providers = split_list(arg.substr(12));
+        } else if (arg.starts_with("--turns=")) {
+            options.turns = std::max(1, std::stoi(std::string(arg.substr(8))));
+        } else if (arg == "--grow-history") {
+            options.grow_history = true;
+        } else if (arg.starts_with("--trace=")) {
+            options.trace_path = arg.substr(8);
+        } else {
+            return false;
+        }
+        return true;
+    }, "  --base-url=URL      server to talk to (default http://127.0.0.1:8089, see bench/mock_llm_server.py)\n"
+       "  --providers=a,b     subset of xai,claude,openai,gemini\n"
+       "  --turns=N           chat turns per provider (default 20)\n"
+       "  --grow-history      keep every exchange in the conversation, as the app does\n"
+       "  --trace=PATH        write a Chrome trace of the client turns to PATH\n");
+
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    if (!options.trace_path.empty()) Tracer::instance().start(options.trace_path);
+    for (const auto& provider : options.providers) bench_provider(runner, options, provider);
+    Tracer::instance().stop(); // The wire/ rows bypass the clients and have no spans
+    bench_wire(runner, options);
+    curl_global_cleanup();
+    return runner.finish();
+}
@@ -0,0 +1,299 @@
+// chatcurses_mcp_bench: MCPClient round trips against bench/fake_mcp_server.py
+// over stdio and WebSocket. Measures request latency percentiles, throughput
+// with concurrent tool calls, the cost of framing large results, and the
+// error and timeout paths. The server is spawned locally; no network needed.
+//
+// Usage: chatcurses_mcp_bench [--server=bench/fake_mcp_server.py] [--python=python3]
+//                             [--transports=stdio,ws] [--calls=200] [--json[=path]]
+#include "Bench.hpp"
+#include "MCPClient.hpp"
+#include "MCPProtocol.hpp"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    double ns_since(Clock::time_point start) {
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    }
+
+    struct Options {
+        std::string server = "bench/fake_mcp_server.py";
+        std::string python = "python3";
+        std::vector<std::string> transports = {"stdio", "ws"};
+        int calls = 200;
+    };
+
+    // The fake server process; stdio pipes are only set for the stdio transport
+    struct ServerProcess {
+        pid_t pid = -1;
+        int stdin_fd = -1;  // Our write end
+        int stdout_fd = -1; // Our read end
+
+        ~ServerProcess() {
+            if (stdin_fd >= 0) close(stdin_fd);
+            if (stdout_fd >= 0) close(stdout_fd);
+            if (pid > 0) {
+                kill(pid, SIGTERM);
+                waitpid(pid, nullptr, 0);
+            }
+        }
+    };
+
+    std::unique_ptr<ServerProcess> spawn_server(const Options& options, bool stdio, int ws_port) {
+        int in_pipe[2] = {-1, -1};
+        int out_pipe[2] = {-1, -1};
+        if (stdio && (pipe(in_pipe) == -1 || pipe(out_pipe) == -1)) {
+            std::perror("pipe");
+            return nullptr;
+        }
+        std::string port = std::to_string(ws_port);
+        pid_t pid = fork();
+        if (pid == -1) {
+            std::perror("fork");
+            return nullptr;
+        }
+        if (pid == 0) {
+            if (stdio) {
+                dup2(in_pipe[0], STDIN_FILENO);
+                dup2(out_pipe[1], STDOUT_FILENO);
+                close(in_pipe[0]);
+                close(in_pipe[1]);
+                close(out_pipe[0]);
+                close(out_pipe[1]);
+            } else {
+                int null_fd = open("/dev/null", O_RDONLY);
+                dup2(null_fd, STDIN_FILENO);
+            }
+            std::vector<char*> argv = {const_cast<char*>(options.python.c_str()), const_cast<char*>(options.server.c_str())};
+            if (!stdio) {
+                argv.push_back(const_cast<char*>("--ws"));
+                argv.push_back(port.data());
+            }
+            argv.push_back(nullptr);
+            execvp(argv[0], argv.data());
+            std::perror("execvp");
+            _exit(EXIT_FAILURE);
+        }
+        auto process = std::make_unique<ServerProcess>();
+        process->pid = pid;
+        if (stdio) {
+            close(in_pipe[0]);
+            close(out_pipe[1]);
+            process->stdin_fd = in_pipe[1];
+            process->stdout_fd = out_pipe[0];
+        }
+        return process;
+    }
+
+    int free_tcp_port() {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t len = sizeof(addr);
+        int port = 0;
+        if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0 &&
+            getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len) == 0) {
+            port = ntohs(addr.sin_port);
+        }
+        close(fd);
+        return port;
+    }
+
+    bool wait_for_port(int port, std::chrono::milliseconds limit) {
+        auto deadline = Clock::now() + limit;
+        while (Clock::now() < deadline) {
+            int fd = socket(AF_INET, SOCK_STREAM, 0);
+            sockaddr_in addr{};
+            addr.sin_family = AF_INET;
+            addr.sin_port = htons(static_cast<uint16_t>(port));
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            bool up = connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+            close(fd);
+            if (up) return true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+        return false;
+    }
+
+    bool call_ok(const nlohmann::json& result) {
+        return result.is_object() && result.contains("content") && !result.value("isError", false);
+    }
+
+    // Sequential calls of one tool; failed calls are counted, not timed
+    std::vector<double> time_calls(MCPToolManager& tools, const std::string& tool, const nlohmann::json& args,
+                                   int calls, int& failures) {
+        std::vector<double> samples;
+        samples.reserve(static_cast<size_t>(calls));
+        for (int i = 0; i < calls; ++i) {
+            auto start = Clock::now();
+            auto result = tools.call_tool(tool, args);
+            double ns = ns_since(start);
+            if (call_ok(result)) {
+                samples.push_back(ns);
+            } else {
+                ++failures;
+            }
+        }
+        return samples;
+    }
+
+    void bench_transport(bench::Runner& runner, const Options& options, const std::string& transport) {
+        bool stdio = transport == "stdio";
+        int port = stdio ? 0 : free_tcp_port();
+        auto server = spawn_server(options, stdio, port);
+        if (!server) return;
+        std::unique_ptr<MCPClient> client;
+        if (stdio) {
+            client = std::make_unique<MCPClient>(server->stdin_fd, server->stdout_fd);
+        } else {
+            if (!wait_for_port(port, std::chrono::seconds(5))) {
+                std::fprintf(stderr, "%s: fake MCP server did not start on port %d\n", transport.c_str(), port);
+                return;
+            }
+            client = std::make_unique<MCPClient>(std::format("ws://127.0.0.1:{}", port));
+        }
+        auto connected = client->connect().get();
+        if (!connected) {
+            std::fprintf(stderr, "%s: connect failed: %s\n", transport.c_str(), connected.error().message.c_str());
+            server.reset(); // Closing the pipes ends the client's stdio reader
+            return;
+        }
+        MCPToolManager& tools = *client->tool_manager();
+        if (tools.list_tools().empty()) {
+            std::fprintf(stderr, "%s: tools/list returned nothing\n", transport.c_str());
+            server.reset();
+            return;
+        }
+        const std::string prefix = "mcp/" + transport + "/";
+        int failures = 0;
+
+        // Bare request/response: ping has no tool-manager work on either side
+        std::vector<double> ping;
+        for (int i = 0; i < options.calls; ++i) {
+            auto start = Clock::now();
+            auto response = client->send_request_for_manager(MCPProtocolMessages::create_ping_request()).get();
+            if (response && !response->is_error()) {
+                ping.push_back(ns_since(start));
+            } else {
+                ++failures;
+            }
+        }
+        runner.record(prefix + "ping", ping);
+        runner.record(prefix + "tools_call/echo",
+                      time_calls(tools, "echo", {{"text", "hello"}}, options.calls, failures));
+
+        // Concurrent callers against a tool that takes 5 ms server-side
+        for (int concurrency : {1, 8, 32}) {
+            int per_thread = std::max(1, options.calls / concurrency);
+            std::vector<double> latencies, batches;
+            for (int round = 0; round < 3; ++round) {
+                std::vector<std::vector<double>> per_caller(static_cast<size_t>(concurrency));
+                std::vector<int> caller_failures(static_cast<size_t>(concurrency), 0);
+                std::vector<std::thread> callers;
+                auto start = Clock::now();
+                for (int c = 0; c < concurrency; ++c) {
+                    callers.emplace_back([&, c] {
+                        per_caller[c] = time_calls(tools, "fixed_latency", {{"latency_ms", 5}}, per_thread,
+                                                   caller_failures[c]);
+                    });
+                }
+                for (auto& caller : callers) caller.join();
+                batches.push_back(ns_since(start));
+                for (int c = 0; c < concurrency; ++c) {
+                    latencies.insert(latencies.end(), per_caller[c].begin(), per_caller[c].end());
+                    failures += caller_failures[c];
+                }
+            }
+            std::string name = prefix + "concurrent_" + std::to_string(concurrency);
+            runner.record(name + "/call", latencies);
+            // items_per_second of the batch rows is the calls/s throughput
+            runner.record(name + "/batch", batches, static_cast<double>(per_thread * concurrency));
+        }
+
+        // Large results: one JSON line per result, framed and parsed on receipt
+        for (int kb : {64, 1024, 8192}) {
+            int calls = std::max(5, options.calls / (kb >= 1024 ? 40 : 4));
+            runner.record(prefix + "payload/" + std::to_string(kb) + "KB",
+                          time_calls(tools, "payload", {{"payload_bytes", kb * 1024}}, calls, failures),
+                          0, kb * 1024.0);
+        }
+
+        // Failure paths: an RPC error, and a timeout that sends notifications/cancelled
+        int expected_failures = 0;
+        std::vector<double> rpc_error;
+        for (int i = 0; i < options.calls / 4; ++i) {
+            auto start = Clock::now();
+            auto result = tools.call_tool("flaky", nlohmann::json{{"fail", true}});
+            rpc_error.push_back(ns_since(start));
+            if (result.is_null()) ++expected_failures;
+        }
+        runner.record(prefix + "rpc_error", rpc_error);
+        std::vector<double> timeout_overhead;
+        for (int i = 0; i < 10; ++i) {
+            auto request = MCPProtocolMessages::create_tools_call_request("hang", nlohmann::json::object());
+            auto start = Clock::now();
+            auto response = client->send_request_for_manager(request, std::chrono::milliseconds(20)).get();
+            double ns = ns_since(start);
+            if (!response && response.error().code == ApiError::Timeout) {
+                timeout_overhead.push_back(ns - 20e6); // Time past the deadline
+            } else {
+                ++failures;
+            }
+        }
+        runner.record(prefix + "timeout_overshoot", timeout_overhead);
+
+        std::fprintf(stderr, "%s: %d unexpected failures, %d/%d scripted errors seen\n", transport.c_str(), failures,
+                     expected_failures, options.calls / 4);
+        client.reset(); // Sends shutdown; the server exits before its process is reaped
+    }
+
+    std::vector<std::string> split_list(std::string_view list) {
+        std::vector<std::string> items;
+        while (!list.empty()) {
+            size_t comma = list.find(',');
+            if (comma != 0) items.emplace_back(list.substr(0, comma));
+            if (comma == std::string_view::npos) break;
+            list.remove_prefix(comma + 1);
+        }
+        return items;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    bench::Runner runner(argc, argv, [&](std::string_view arg) {
+        if (arg.starts_with("--server=")) {
+            options.server = arg.substr(9);
+        } else if (arg.starts_with("--python=")) {
+            options.python = arg.substr(9);
+        } else if (arg.starts_with("--transports=")) {
+            options.transports = split_list(arg.substr(13));
+        } else if (arg.starts_with("--calls=")) {
+            options.calls = std::max(4, std::stoi(std::string(arg.substr(8))));
+        } else {
+            return false;
+        }
+        return true;
+    }, "  --server=PATH       fake MCP server script (default bench/fake_mcp_server.py)\n"
+       "  --python=EXE        interpreter for it (default python3)\n"
+       "  --transports=a,b    subset of stdio,ws\n"
+       "  --calls=N           calls per latency benchmark (default 200)\n");
+
+    signal(SIGPIPE, SIG_IGN); // A dying server must not take the harness with it
+    for (const auto& transport : options.transports) bench_transport(runner, options, transport);
+    return runner.finish();
+}
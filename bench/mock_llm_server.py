@@ -0,0 +1,218 @@
+#!/usr/bin/env python3
+"""Local mock of the xAI, OpenAI, Anthropic and Gemini chat APIs.
+
+Serves the request paths the clients call, in each provider's response
+format, both as a single JSON body and as server-sent events. Timing and
+size are configurable, so chatcurses_e2e_bench can measure the client side
+without a network or API keys:
+
+    python3 bench/mock_llm_server.py --port 8089 --ttft-ms 300 --tokens-per-sec 60
+
+Point the app at it with "base_urls" in chatbot_config.json, e.g.
+{"base_urls": {"xai": "http://127.0.0.1:8089"}}.
+
+Routes:
+    POST /v1/chat/completions                       xAI and OpenAI ("stream": true for SSE)
+    POST /v1/messages                               Anthropic ("stream": true for SSE)
+    POST /<version>/models/<model>:generateContent  Gemini
+    POST /<version>/models/<model>:streamGenerateContent?alt=sse
+    GET  /health
+"""
+import argparse
+import json
+import random
+import re
+import threading
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+WORDS = ["the", "quick", "brown", "fox", "jumps", "over", "lazy", "dog", "stream", "token"]
+GEMINI_PATH = re.compile(r"^/[^/]+/models/([^/:]+):(generateContent|streamGenerateContent)$")
+
+
+def make_tokens(count, token_bytes, seed):
+    """Deterministic tokens of exactly token_bytes bytes each (a word plus padding)."""
+    rng = random.Random(seed)
+    tokens = []
+    for _ in range(count):
+        word = " " + rng.choice(WORDS)
+        tokens.append((word * (token_bytes // len(word) + 1))[:token_bytes])
+    return tokens
+
+
+class Config:
+    def __init__(self, args):
+        self.ttft = args.ttft_ms / 1000.0
+        self.token_interval = 1.0 / args.tokens_per_sec if args.tokens_per_sec > 0 else 0.0
+        self.tokens = make_tokens(args.tokens, args.token_bytes, args.seed)
+        self.error_rate = args.error_rate
+        self.error_status = args.error_status
+        self.rng = random.Random(args.seed)
+        self.rng_lock = threading.Lock()
+        self.quiet = args.quiet
+
+    def should_fail(self):
+        with self.rng_lock:
+            return self.rng.random() < self.error_rate
+
+
+class Handler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+    config = None  # Set by main()
+
+    def log_message(self, fmt, *args):
+        if not self.config.quiet:
+            super().log_message(fmt, *args)
+
+    def do_GET(self):
+        if self.path == "/health":
+            self.send_json(200, {"status": "ok"})
+        else:
+            self.send_json(404, {"error": {"message": "not found"}})
+
+    def do_POST(self):
+        length = int(self.headers.get("Content-Length", 0))
+        try:
+            body = json.loads(self.rfile.read(length) or b"{}")
+        except json.JSONDecodeError as e:
+            self.send_json(400, {"error": {"message": f"invalid JSON: {e}"}})
+            return
+
+        path, _, query = self.path.partition("?")
+        gemini = GEMINI_PATH.match(path)
+        if path == "/v1/chat/completions":
+            provider, model, stream = "openai", body.get("model", "mock"), bool(body.get("stream"))
+        elif path == "/v1/messages":
+            provider, model, stream = "anthropic", body.get("model", "mock"), bool(body.get("stream"))
+        elif gemini:
+            provider, model = "gemini", gemini.group(1)
+            stream = gemini.group(2) == "streamGenerateContent"
+        else:
+            self.send_json(404, {"error": {"message": f"unknown path {path}"}})
+            return
+
+        if self.config.should_fail():
+            time.sleep(self.config.ttft)
+            self.send_error_body(provider)
+            return
+        if stream:
+            try:
+                self.stream(provider, model, sse=provider != "gemini" or "alt=sse" in query)
+            except (BrokenPipeError, ConnectionResetError):
+                pass  # The client aborted the stream
+        else:
+            # A non-streaming API answers once the whole completion exists
+            tokens = self.config.tokens
+            time.sleep(self.config.ttft + self.config.token_interval * max(len(tokens) - 1, 0))
+            self.send_json(200, self.full_response(provider, model, "".join(tokens)))
+
+    def full_response(self, provider, model, text):
+        usage_out = len(self.config.tokens)
+        if provider == "openai":
+            return {
+                "id": "chatcmpl-mock", "object": "chat.completion", "created": int(time.time()), "model": model,
+                "choices": [{"index": 0, "message": {"role": "assistant", "content": text}, "finish_reason": "stop"}],
+                "usage": {"prompt_tokens": 1, "completion_tokens": usage_out, "total_tokens": usage_out + 1},
+            }
+        if provider == "anthropic":
+            return {
+                "id": "msg_mock", "type": "message", "role": "assistant", "model": model,
+                "content": [{"type": "text", "text": text}], "stop_reason": "end_turn",
+                "usage": {"input_tokens": 1, "output_tokens": usage_out},
+            }
+        return {
+            "candidates": [{"content": {"role": "model", "parts": [{"text": text}]}, "finishReason": "STOP"}],
+            "usageMetadata": {"promptTokenCount": 1, "candidatesTokenCount": usage_out},
+        }
+
+    def stream(self, provider, model, sse):
+        self.send_response(200)
+        self.send_header("Content-Type", "text/event-stream" if sse else "application/json")
+        self.send_header("Cache-Control", "no-cache")
+        self.send_header("Connection", "close")  # The stream ends when the connection does
+        self.end_headers()
+        self.close_connection = True
+
+        def event(data, name=None):
+            prefix = f"event: {name}\n" if name else ""
+            self.wfile.write(f"{prefix}data: {json.dumps(data)}\n\n".encode())
+            self.wfile.flush()
+
+        time.sleep(self.config.ttft)
+        if provider == "anthropic":
+            event({"type": "message_start", "message": {"id": "msg_mock", "type": "message", "role": "assistant",
+                                                        "model": model, "content": []}}, "message_start")
+            event({"type": "content_block_start", "index": 0, "content_block": {"type": "text", "text": ""}},
+                  "content_block_start")
+        chunks = []
+        for i, token in enumerate(self.config.tokens):
+            if i > 0:
+                time.sleep(self.config.token_interval)
+            if provider == "openai":
+                event({"id": "chatcmpl-mock", "object": "chat.completion.chunk", "model": model,
+                       "choices": [{"index": 0, "delta": {"content": token}, "finish_reason": None}]})
+            elif provider == "anthropic":
+                event({"type": "content_block_delta", "index": 0, "delta": {"type": "text_delta", "text": token}},
+                      "content_block_delta")
+            elif sse:
+                event({"candidates": [{"content": {"role": "model", "parts": [{"text": token}]}}]})
+            else:
+                chunks.append({"candidates": [{"content": {"role": "model", "parts": [{"text": token}]}}]})
+        if provider == "openai":
+            self.wfile.write(b"data: [DONE]\n\n")
+        elif provider == "anthropic":
+            event({"type": "content_block_stop", "index": 0}, "content_block_stop")
+            event({"type": "message_delta", "delta": {"stop_reason": "end_turn"}}, "message_delta")
+            event({"type": "message_stop"}, "message_stop")
+        elif not sse:
+            # Without alt=sse Gemini streams a JSON array of partial responses
+            self.wfile.write(json.dumps(chunks).encode())
+        self.wfile.flush()
+
+    def send_error_body(self, provider):
+        status = self.config.error_status
+        message = "mock server injected failure"
+        if provider == "anthropic":
+            body = {"type": "error", "error": {"type": "overloaded_error" if status == 529 else "api_error",
+                                               "message": message}}
+        elif provider == "gemini":
+            body = {"error": {"code": status, "message": message, "status": "UNAVAILABLE"}}
+        else:
+            body = {"error": {"message": message, "type": "server_error", "code": status}}
+        self.send_json(status, body)
+
+    def send_json(self, status, body):
+        data = json.dumps(body).encode()
+        self.send_response(status)
+        self.send_header("Content-Type", "application/json")
+        self.send_header("Content-Length", str(len(data)))
+        self.end_headers()
+        self.wfile.write(data)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--host", default="127.0.0.1")
+    parser.add_argument("--port", type=int, default=8089)
+    parser.add_argument("--ttft-ms", type=float, default=200.0, help="delay before the first token")
+    parser.add_argument("--tokens-per-sec", type=float, default=50.0, help="token rate after the first; 0 = no delay")
+    parser.add_argument("--tokens", type=int, default=200, help="tokens per completion")
+    parser.add_argument("--token-bytes", type=int, default=4, help="bytes per token (payload = tokens * token-bytes)")
+    parser.add_argument("--error-rate", type=float, default=0.0, help="fraction of requests that fail (0..1)")
+    parser.add_argument("--error-status", type=int, default=500, help="HTTP status of injected failures")
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--quiet", action="store_true", help="do not log each request")
+    args = parser.parse_args()
+
+    Handler.config = Config(args)
+    server = ThreadingHTTPServer((args.host, args.port), Handler)
+    server.daemon_threads = True
+    print(f"Mock LLM server on http://{args.host}:{server.server_port}", flush=True)
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,227 @@
+#!/usr/bin/env python3
+"""Generate include/unicode_width_table.hpp.
+
+Builds a two-level lookup table giving, for every code point, its terminal
+display width (0, 1 or 2) and its grapheme-cluster break class (the subset
+of UAX #29 properties that need a table; Hangul, regional indicators, ZWJ
+and CR/LF are recognised arithmetically in utf8_utils.cpp).
+
+Usage:
+    gen_unicode_width.py [--ucd DIR] [-o include/unicode_width_table.hpp]
+
+With --ucd, DIR must contain the Unicode data files UnicodeData.txt,
+EastAsianWidth.txt, GraphemeBreakProperty.txt (auxiliary/) and
+emoji-data.txt (emoji/), flattened into one directory. Without it the
+tables are derived from Python's unicodedata module; Extended_Pictographic
+then falls back to the emoji blocks listed below.
+"""
+
+import argparse
+import os
+import sys
+import unicodedata
+
+MAX_CP = 0x110000
+BLOCK_SHIFT = 7
+BLOCK_SIZE = 1 << BLOCK_SHIFT
+
+# Grapheme break classes stored in the table (must match utf8_utils.cpp)
+GB_OTHER, GB_CONTROL, GB_EXTEND, GB_SPACING_MARK, GB_PREPEND, GB_EXT_PICT = range(6)
+
+# Used only without --ucd: blocks whose assigned symbols are all
+# Extended_Pictographic in current Unicode
+FALLBACK_PICTOGRAPHIC = [
+    (0x00A9, 0x00A9), (0x00AE, 0x00AE), (0x203C, 0x203C), (0x2049, 0x2049),
+    (0x2122, 0x2122), (0x2139, 0x2139), (0x2194, 0x2199), (0x21A9, 0x21AA),
+    (0x231A, 0x231B), (0x2328, 0x2328), (0x23CF, 0x23CF), (0x23E9, 0x23F3),
+    (0x23F8, 0x23FA), (0x24C2, 0x24C2), (0x25AA, 0x25AB), (0x25B6, 0x25B6),
+    (0x25C0, 0x25C0), (0x25FB, 0x25FE), (0x2600, 0x27BF), (0x2934, 0x2935),
+    (0x2B05, 0x2B07), (0x2B1B, 0x2B1C), (0x2B50, 0x2B50), (0x2B55, 0x2B55),
+    (0x3030, 0x3030), (0x303D, 0x303D), (0x3297, 0x3297), (0x3299, 0x3299),
+    (0x1F000, 0x1F0FF), (0x1F10D, 0x1F10F), (0x1F12F, 0x1F12F),
+    (0x1F16C, 0x1F171), (0x1F17E, 0x1F17F), (0x1F18E, 0x1F18E),
+    (0x1F191, 0x1F19A), (0x1F1AD, 0x1F1E5), (0x1F201, 0x1F20F),
+    (0x1F21A, 0x1F21A), (0x1F22F, 0x1F22F), (0x1F232, 0x1F23A),
+    (0x1F23C, 0x1F23F), (0x1F249, 0x1F3FA), (0x1F400, 0x1F53D),
+    (0x1F546, 0x1F64F), (0x1F680, 0x1F6FF), (0x1F774, 0x1F77F),
+    (0x1F7D5, 0x1F7FF), (0x1F80C, 0x1F80F), (0x1F848, 0x1F84F),
+    (0x1F85A, 0x1F85F), (0x1F888, 0x1F88F), (0x1F8AE, 0x1F8FF),
+    (0x1F90C, 0x1F93A), (0x1F93C, 0x1F945), (0x1F947, 0x1FAFF),
+    (0x1FC00, 0x1FFFD),
+]
+
+
+def parse_ranges(path, wanted_field=None):
+    """Yield (first, last, value) from a UCD 'XXXX..YYYY ; Value' file."""
+    with open(path, encoding="utf-8") as f:
+        for line in f:
+            line = line.split("#", 1)[0].strip()
+            if not line:
+                continue
+            fields = [x.strip() for x in line.split(";")]
+            cps = fields[0].split("..")
+            first = int(cps[0], 16)
+            last = int(cps[-1], 16)
+            value = fields[1]
+            if wanted_field is None or value == wanted_field:
+                yield first, last, value
+
+
+def load_from_ucd(directory):
+    category = ["Cn"] * MAX_CP
+    with open(os.path.join(directory, "UnicodeData.txt"), encoding="utf-8") as f:
+        range_start = None
+        for line in f:
+            fields = line.split(";")
+            cp = int(fields[0], 16)
+            if fields[1].endswith(", First>"):
+                range_start = cp
+                continue
+            first = range_start if fields[1].endswith(", Last>") else cp
+            range_start = None
+            for c in range(first, cp + 1):
+                category[c] = fields[2]
+
+    # Unlisted code points default to N, except the ranges the file's header
+    # assigns to W
+    eaw = ["N"] * MAX_CP
+    for first, last in [(0x3400, 0x4DBF), (0x4E00, 0x9FFF), (0xF900, 0xFAFF),
+                        (0x20000, 0x2FFFD), (0x30000, 0x3FFFD)]:
+        for c in range(first, last + 1):
+            eaw[c] = "W"
+    for first, last, value in parse_ranges(os.path.join(directory, "EastAsianWidth.txt")):
+        for c in range(first, last + 1):
+            eaw[c] = value
+
+    grapheme = {}
+    for first, last, value in parse_ranges(os.path.join(directory, "GraphemeBreakProperty.txt")):
+        for c in range(first, last + 1):
+            grapheme[c] = value
+    pictographic = set()
+    for first, last, _ in parse_ranges(os.path.join(directory, "emoji-data.txt"), "Extended_Pictographic"):
+        pictographic.update(range(first, last + 1))
+    return category, eaw, grapheme, pictographic
+
+
+def load_from_python():
+    category = [unicodedata.category(chr(c)) for c in range(MAX_CP)]
+    eaw = [unicodedata.east_asian_width(chr(c)) for c in range(MAX_CP)]
+    for first, last in [(0x20000, 0x2FFFD), (0x30000, 0x3FFFD)]:
+        for c in range(first, last + 1):
+            eaw[c] = "W"
+    grapheme = {}
+    for c in range(MAX_CP):
+        cat = category[c]
+        if cat in ("Mn", "Me") or c == 0x200C or 0x1F3FB <= c <= 0x1F3FF or 0xE0020 <= c <= 0xE007F:
+            grapheme[c] = "Extend"
+        elif cat == "Mc":
+            grapheme[c] = "SpacingMark"
+        elif cat in ("Cc", "Zl", "Zp") or (cat == "Cf" and c not in (0x200C, 0x200D)):
+            grapheme[c] = "Control"
+    for c in (0x0600, 0x0601, 0x0602, 0x0603, 0x0604, 0x0605, 0x06DD, 0x070F, 0x0890, 0x0891, 0x08E2, 0x110BD, 0x110CD):
+        grapheme[c] = "Prepend"
+    pictographic = set()
+    for first, last in FALLBACK_PICTOGRAPHIC:
+        for c in range(first, last + 1):
+            if category[c] != "Cn" or c >= 0x1F000:
+                pictographic.add(c)
+    return category, eaw, grapheme, pictographic
+
+
+def width_of(cp, category, eaw):
+    cat = category[cp]
+    if cp == 0x00AD:
+        return 1  # Soft hyphen is shown by terminals
+    if cat in ("Mn", "Me", "Cf", "Cc", "Zl", "Zp"):
+        return 0
+    if 0x1160 <= cp <= 0x11FF or 0xD7B0 <= cp <= 0xD7FF:
+        return 0  # Hangul medial vowels and final consonants join the syllable
+    if eaw[cp] in ("W", "F"):
+        return 2
+    return 1
+
+
+def grapheme_class(cp, grapheme, pictographic):
+    value = grapheme.get(cp)
+    if value == "Control" or value in ("CR", "LF"):
+        return GB_CONTROL
+    if value == "Extend":
+        return GB_EXTEND
+    if value == "SpacingMark":
+        return GB_SPACING_MARK
+    if value == "Prepend":
+        return GB_PREPEND
+    if cp in pictographic:
+        return GB_EXT_PICT
+    return GB_OTHER
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--ucd", help="directory holding the Unicode data files")
+    parser.add_argument("-o", "--output", default=os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                                                               "include", "unicode_width_table.hpp"))
+    args = parser.parse_args()
+
+    if args.ucd:
+        category, eaw, grapheme, pictographic = load_from_ucd(args.ucd)
+        source = f"Unicode data files in {os.path.basename(os.path.normpath(args.ucd))}"
+    else:
+        category, eaw, grapheme, pictographic = load_from_python()
+        source = f"Python unicodedata {unicodedata.unidata_version} (fallback pictographic ranges)"
+
+    # One byte per code point: width in bits 0-1, grapheme class in bits 2-4
+    values = [width_of(cp, category, eaw) | (grapheme_class(cp, grapheme, pictographic) << 2)
+              for cp in range(MAX_CP)]
+
+    blocks = []
+    block_ids = {}
+    stage1 = []
+    for start in range(0, MAX_CP, BLOCK_SIZE):
+        block = tuple(values[start:start + BLOCK_SIZE])
+        if block not in block_ids:
+            block_ids[block] = len(blocks)
+            blocks.append(block)
+        stage1.append(block_ids[block])
+    if len(blocks) > 0xFFFF:
+        sys.exit("too many distinct blocks")
+    index_type = "uint8_t" if len(blocks) <= 0x100 else "uint16_t"
+
+    out = []
+    out.append("#pragma once")
+    out.append("// Generated by gen_unicode_width.py from " + source + ". Do not edit.")
+    out.append("#include <cstdint>")
+    out.append("")
+    out.append("namespace unicode_table {")
+    out.append("")
+    out.append("// Per code point: display width in bits 0-1, grapheme break class in bits 2-4")
+    out.append(f"inline constexpr unsigned kBlockShift = {BLOCK_SHIFT};")
+    out.append(f"inline constexpr uint32_t kCodePointLimit = 0x{MAX_CP:X};")
+    out.append("")
+    out.append(f"inline constexpr {index_type} kStage1[{len(stage1)}] = {{")
+    for i in range(0, len(stage1), 24):
+        out.append("    " + ", ".join(str(x) for x in stage1[i:i + 24]) + ",")
+    out.append("};")
+    out.append("")
+    out.append(f"inline constexpr uint8_t kStage2[{len(blocks)}][{BLOCK_SIZE}] = {{")
+    for block in blocks:
+        out.append("    {")
+        for i in range(0, BLOCK_SIZE, 32):
+            out.append("        " + ", ".join(str(x) for x in block[i:i + 32]) + ",")
+        out.append("    },")
+    out.append("};")
+    out.append("")
+    out.append("constexpr uint8_t lookup(uint32_t cp) {")
+    out.append("    return cp < kCodePointLimit ? kStage2[kStage1[cp >> kBlockShift]][cp & ((1u << kBlockShift) - 1)] : 1;")
+    out.append("}")
+    out.append("")
+    out.append("} // namespace unicode_table")
+    out.append("")
+
+    with open(args.output, "w", encoding="utf-8") as f:
+        f.write("\n".join(out))
+    print(f"{args.output}: {len(blocks)} blocks, {len(stage1) * (1 if index_type == 'uint8_t' else 2) + len(blocks) * BLOCK_SIZE} bytes")
+
+
+if __name__ == "__main__":
+    main()
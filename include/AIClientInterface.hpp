@@ -15,6 +15,8 @@ public:
     virtual void set_api_key(const std::string& key) = 0;
     virtual void set_system_prompt(const std::string& prompt) = 0;
     virtual void set_model(const std::string& model) = 0;
+    // Scheme and host the provider's API paths are appended to
+    virtual void set_base_url(const std::string& url) = 0;
     
     // Conversation history management
     virtual void clear_history() = 0;
@@ -21,7 +21,8 @@ enum class ApiError {
     InvalidResponse,
     InvalidState,
     ConnectionError,
-    Timeout
+    Timeout,
+    Cancelled
 };
 
 struct ApiErrorInfo {
@@ -1,6 +1,10 @@
 #pragma once
 #include "AIClientInterface.hpp"
 #include "MCPService.hpp"
+#include "ProviderConfig.hpp"
+#include "Metrics.hpp"
+#include "Trace.hpp"
+#include <curl/curl.h>
 #include <regex>
 
 class BaseAIClient : public AIClientInterface {
@@ -20,6 +24,12 @@ public:
         model_ = model;
     }
     
+    void set_base_url(const std::string& url) override {
+        std::lock_guard lock(mutex_);
+        base_url_ = url;
+        while (base_url_.ends_with('/')) base_url_.pop_back();
+    }
+    
     void clear_history() override {
         std::lock_guard lock(mutex_);
         conversation_history_.clear();
@@ -39,9 +49,54 @@ protected:
     std::string api_key_;
     std::string system_prompt_;
     std::string model_;
+    std::string base_url_;
     mutable std::mutex mutex_;
     std::vector<nlohmann::json> conversation_history_;
 
+    // Metrics for one finished curl_easy_perform; status 0 when there was no response
+    static void record_request_metrics(std::string_view provider, std::string_view model, CURL* curl, CURLcode res) {
+        long status = 0;
+        curl_off_t ttft_us = 0, total_us = 0;
+        if (res == CURLE_OK) curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
+        curl_easy_getinfo(curl, CURLINFO_STARTTRANSFER_TIME_T, &ttft_us);
+        curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME_T, &total_us);
+        record_provider_request(provider, model, status, std::chrono::microseconds(ttft_us),
+                                std::chrono::microseconds(total_us));
+    }
+
+    // Child spans of `http` for the phases curl timed: DNS, connect, TLS,
+    // waiting for the first byte (upload and server time) and download
+    static void trace_curl_phases(const TraceSpan& http, CURL* curl) {
+        if (!http.active()) return;
+        curl_off_t dns = 0, connect = 0, tls = 0, pretransfer = 0, first_byte = 0, total = 0;
+        curl_easy_getinfo(curl, CURLINFO_NAMELOOKUP_TIME_T, &dns);
+        curl_easy_getinfo(curl, CURLINFO_CONNECT_TIME_T, &connect);
+        curl_easy_getinfo(curl, CURLINFO_APPCONNECT_TIME_T, &tls);
+        curl_easy_getinfo(curl, CURLINFO_PRETRANSFER_TIME_T, &pretransfer);
+        curl_easy_getinfo(curl, CURLINFO_STARTTRANSFER_TIME_T, &first_byte);
+        curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME_T, &total);
+        auto& tracer = Tracer::instance();
+        auto phase = [&](const char* name, curl_off_t from_us, curl_off_t to_us) {
+            if (to_us > from_us) tracer.complete(name, "http", http.start_ns() + from_us * 1000, (to_us - from_us) * 1000);
+        };
+        phase("dns", 0, dns);
+        phase("connect", dns, connect);
+        phase("tls", connect, tls); // Zero for plain HTTP and reused connections
+        phase("wait_first_byte", pretransfer, first_byte);
+        phase("download", first_byte, total);
+    }
+
+    // Token counts from a response's usage object, e.g. usage.prompt_tokens
+    static void record_usage_metrics(std::string_view provider, std::string_view model, const nlohmann::json& usage,
+                                     const char* in_key, const char* out_key) {
+        if (!usage.is_object()) return;
+        auto count = [&](const char* key) -> int64_t {
+            auto it = usage.find(key);
+            return it != usage.end() && it->is_number_integer() ? it->get<int64_t>() : 0;
+        };
+        record_provider_tokens(provider, model, count(in_key), count(out_key));
+    }
+
     // MCP integration helpers
     std::string enhance_system_prompt_with_tools(const std::string& base_prompt) const {
         auto& mcp = MCPService::instance();
@@ -62,6 +117,8 @@ protected:
     }
 
     std::string process_with_mcp_tools(const std::string& user_message) const {
+        TraceSpan span("process_with_mcp_tools", "mcp");
+        TraceSpan heuristics("tool_heuristics", "mcp"); // Ends when the first tool is called
         try {
             auto& mcp = MCPService::instance();
             
@@ -83,6 +140,7 @@ protected:
             if (std::regex_search(url, youtube_pattern)) {
                 // Try to use get_transcript tool for YouTube URLs
                 nlohmann::json transcript_args = {{"url", url}};
+                heuristics.end();
                 auto result = mcp.call_tool("get_transcript", transcript_args);
                 if (result) {
                     tool_results += "YouTube transcript from " + url + ":\n";
@@ -103,6 +161,7 @@ protected:
             } else {
                 // Try to use scraping tool for other URLs
                 nlohmann::json scrape_args = {{"url", url}};
+                heuristics.end();
                 auto result = mcp.call_tool("scrape_url", scrape_args);
                 if (result) {
                     tool_results += "Scraped content from " + url + ":\n";
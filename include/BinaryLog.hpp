@@ -0,0 +1,289 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <variant>
+#include <format>
+#include <expected>
+#include <cstdint>
+#include <cstring>
+#include <charconv>
+#include <exception>
+#include <type_traits>
+
+// Compact binary log format written by RichLogger in LogFormat::Binary and
+// read back by chatbot_log_decode. Instead of formatted text, each entry
+// holds the id of its call site's format string plus the raw arguments;
+// the format string, file, line and function of an id are written once,
+// the first time that id is used.
+//
+//   file    := "CCBLOG01" record*
+//   record  := 'S' "CCBLOG01"                        session start: ids restart
+//            | 'F' u32 id, u8 level, u32 line, str file, str function, str format
+//            | 'E' u32 id, i64 time_ns, u8 argc, arg*
+//            | 'M' u8 level, i64 time_ns, u32 line, str file, str function, str message
+//   arg     := 'i' i64 | 'u' u64 | 'd' f64 | 'b' u8 | 'c' u8 | 's' str
+//   str     := u32 length, bytes
+//
+// Integers are little-endian (host order on the platforms we build for).
+// A session record repeats the magic so a reader can find it again after a
+// record cut short by a crash.
+namespace binlog {
+
+inline constexpr std::string_view kMagic = "CCBLOG01";
+
+enum class Record : char { Session = 'S', Format = 'F', Entry = 'E', Message = 'M' };
+
+// A whole session record, which is also what decode() resynchronizes on
+inline constexpr std::string_view kSessionMarker = "SCCBLOG01";
+static_assert(kSessionMarker.substr(1) == kMagic);
+
+inline void put_bytes(std::string& out, const void* data, size_t size) {
+    out.append(static_cast<const char*>(data), size);
+}
+
+template <typename T>
+void put(std::string& out, T value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    put_bytes(out, &value, sizeof(value));
+}
+
+inline void put_str(std::string& out, std::string_view s) {
+    put(out, static_cast<uint32_t>(s.size()));
+    out.append(s);
+}
+
+// Encode one argument; types without a binary form are stored as their
+// formatted text
+template <typename T>
+void put_arg(std::string& out, const T& value) {
+    if constexpr (std::is_same_v<T, bool>) {
+        out += 'b';
+        put(out, static_cast<uint8_t>(value));
+    } else if constexpr (std::is_same_v<T, char>) {
+        out += 'c';
+        put(out, value);
+    } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+        out += 'i';
+        put(out, static_cast<int64_t>(value));
+    } else if constexpr (std::is_integral_v<T>) {
+        out += 'u';
+        put(out, static_cast<uint64_t>(value));
+    } else if constexpr (std::is_floating_point_v<T>) {
+        out += 'd';
+        put(out, static_cast<double>(value));
+    } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+        out += 's';
+        put_str(out, std::string_view(value));
+    } else {
+        out += 's';
+        put_str(out, std::format("{}", value));
+    }
+}
+
+using Arg = std::variant<int64_t, uint64_t, double, bool, char, std::string>;
+
+struct Entry {
+    uint8_t level = 0;
+    int64_t time_ns = 0;
+    uint32_t line = 0;
+    std::string_view file;
+    std::string_view function;
+    std::string message;
+};
+
+// Substitute args into a std::format-style string one replacement field at
+// a time, so the argument list can be built at run time. Nested fields in a
+// spec ({:>{}}, {:.{}f}) take their width or precision from an integer arg.
+inline std::string render(std::string_view format, const std::vector<Arg>& args) {
+    std::string out;
+    size_t next_arg = 0;
+    // Index of an argument field: explicit, or the next one in order
+    auto arg_index = [&](std::string_view index) {
+        if (index.empty()) return next_arg++;
+        size_t value = 0;
+        std::from_chars(index.data(), index.data() + index.size(), value);
+        return value;
+    };
+    for (size_t i = 0; i < format.size(); ++i) {
+        char c = format[i];
+        if ((c == '{' || c == '}') && i + 1 < format.size() && format[i + 1] == c) {
+            out += c;
+            ++i;
+            continue;
+        }
+        if (c != '{') {
+            out += c;
+            continue;
+        }
+        // The closing brace that matches this one, past any nested fields
+        size_t close = i + 1;
+        for (int depth = 1; close < format.size(); ++close) {
+            if (format[close] == '{') ++depth;
+            if (format[close] == '}' && --depth == 0) break;
+        }
+        if (close >= format.size()) {
+            out.append(format.substr(i));
+            break;
+        }
+        std::string_view field = format.substr(i + 1, close - i - 1);
+        size_t colon = field.find(':');
+        size_t arg = arg_index(field.substr(0, colon));
+        std::string spec = "{";
+        bool spec_ok = true;
+        if (colon != std::string_view::npos) {
+            std::string_view rest = field.substr(colon);
+            for (size_t open = rest.find('{'); open != std::string_view::npos; open = rest.find('{')) {
+                size_t end = rest.find('}', open);
+                if (end == std::string_view::npos) break;
+                spec.append(rest.substr(0, open));
+                size_t nested = arg_index(rest.substr(open + 1, end - open - 1));
+                const int64_t* signed_value = nested < args.size() ? std::get_if<int64_t>(&args[nested]) : nullptr;
+                const uint64_t* unsigned_value = nested < args.size() ? std::get_if<uint64_t>(&args[nested]) : nullptr;
+                if (signed_value && *signed_value >= 0) {
+                    spec += std::to_string(*signed_value);
+                } else if (unsigned_value) {
+                    spec += std::to_string(*unsigned_value);
+                } else {
+                    spec_ok = false;
+                }
+                rest.remove_prefix(end + 1);
+            }
+            spec.append(rest);
+        }
+        spec += '}';
+        if (arg < args.size()) {
+            try {
+                if (!spec_ok) throw std::format_error("nested field is not a non-negative integer");
+                std::visit([&](const auto& v) { out += std::vformat(spec, std::make_format_args(v)); }, args[arg]);
+            } catch (const std::exception&) {
+                out.append(format.substr(i, close - i + 1)); // Spec that doesn't suit the stored type
+            }
+        } else {
+            out += "<missing>";
+        }
+        i = close;
+    }
+    return out;
+}
+
+// Parse a whole binary log, calling f(const Entry&) for every entry in order.
+// A damaged record (a crash mid-write, a bad id or tag) is skipped up to
+// the next session record, and decoding goes on from there; the error then
+// lists what was skipped, after every readable entry has been delivered.
+template <typename F>
+std::expected<void, std::string> decode(std::string_view data, F&& f) {
+    if (data.substr(0, kMagic.size()) != kMagic) return std::unexpected("not a binary chatbot log");
+    size_t pos = kMagic.size();
+    auto need = [&](size_t n) { return pos + n <= data.size(); };
+    auto get = [&]<typename T>(T& value) {
+        if (!need(sizeof(T))) return false;
+        std::memcpy(&value, data.data() + pos, sizeof(T));
+        pos += sizeof(T);
+        return true;
+    };
+    auto get_str = [&](std::string_view& s) {
+        uint32_t length = 0;
+        if (!get(length) || !need(length)) return false;
+        s = data.substr(pos, length);
+        pos += length;
+        return true;
+    };
+
+    struct Site {
+        uint8_t level = 0;
+        uint32_t line = 0;
+        std::string_view file, function, format;
+    };
+    std::vector<Site> sites;
+    std::vector<Arg> args;
+    // A record cut short is followed by the next session's bytes, which its
+    // length fields then swallow; a record must not run into a session marker
+    size_t next_session = data.find(kSessionMarker, pos);
+    auto read_record = [&](size_t record_start) -> std::expected<void, std::string> {
+        auto truncated = [&] {
+            return std::unexpected(std::format("truncated record at offset {}", record_start));
+        };
+        if (next_session < record_start) next_session = data.find(kSessionMarker, record_start);
+        auto whole = [&] { return record_start >= next_session || pos <= next_session; };
+        char type = data[pos++];
+        switch (static_cast<Record>(type)) {
+            case Record::Session:
+                // Files from before the marker carried the magic have a bare 'S'
+                if (data.substr(pos, kMagic.size()) == kMagic) pos += kMagic.size();
+                sites.clear();
+                return {};
+            case Record::Format: {
+                uint32_t id = 0;
+                Site site;
+                if (!get(id) || !get(site.level) || !get(site.line) || !get_str(site.file) ||
+                    !get_str(site.function) || !get_str(site.format) || !whole()) {
+                    return truncated();
+                }
+                if (id >= sites.size()) sites.resize(id + 1);
+                sites[id] = site;
+                return {};
+            }
+            case Record::Entry: {
+                uint32_t id = 0;
+                Entry entry;
+                uint8_t argc = 0;
+                if (!get(id) || !get(entry.time_ns) || !get(argc)) return truncated();
+                if (id >= sites.size()) return std::unexpected(std::format("unknown format id {} at offset {}", id, record_start));
+                args.clear();
+                for (uint8_t a = 0; a < argc; ++a) {
+                    if (!need(1)) return truncated();
+                    char tag = data[pos++];
+                    bool ok = true;
+                    switch (tag) {
+                        case 'i': { int64_t v = 0; ok = get(v); args.emplace_back(std::in_place_type<int64_t>, v); break; }
+                        case 'u': { uint64_t v = 0; ok = get(v); args.emplace_back(std::in_place_type<uint64_t>, v); break; }
+                        case 'd': { double v = 0; ok = get(v); args.emplace_back(std::in_place_type<double>, v); break; }
+                        case 'b': { uint8_t v = 0; ok = get(v); args.emplace_back(std::in_place_type<bool>, v != 0); break; }
+                        case 'c': { char v = 0; ok = get(v); args.emplace_back(std::in_place_type<char>, v); break; }
+                        case 's': { std::string_view v; ok = get_str(v); args.emplace_back(std::in_place_type<std::string>, v); break; }
+                        default: return std::unexpected(std::format("bad argument tag at offset {}", pos - 1));
+                    }
+                    if (!ok) return truncated();
+                }
+                if (!whole()) return truncated();
+                const Site& site = sites[id];
+                entry.level = site.level;
+                entry.line = site.line;
+                entry.file = site.file;
+                entry.function = site.function;
+                entry.message = render(site.format, args);
+                f(static_cast<const Entry&>(entry));
+                return {};
+            }
+            case Record::Message: {
+                Entry entry;
+                std::string_view message;
+                if (!get(entry.level) || !get(entry.time_ns) || !get(entry.line) || !get_str(entry.file) ||
+                    !get_str(entry.function) || !get_str(message) || !whole()) {
+                    return truncated();
+                }
+                entry.message = std::string(message);
+                f(static_cast<const Entry&>(entry));
+                return {};
+            }
+        }
+        return std::unexpected(std::format("unknown record type at offset {}", record_start));
+    };
+
+    std::string skipped;
+    while (pos < data.size()) {
+        size_t record_start = pos;
+        auto record = read_record(record_start);
+        if (record) continue;
+        // Ids restart with each session, so nothing before the next one is needed
+        size_t next = data.find(kSessionMarker, record_start + 1);
+        pos = next == std::string_view::npos ? data.size() : next;
+        if (!skipped.empty()) skipped += "; ";
+        skipped += std::format("{}, skipped {} bytes", record.error(), pos - record_start);
+    }
+    if (!skipped.empty()) return std::unexpected(skipped);
+    return {};
+}
+
+} // namespace binlog
@@ -0,0 +1,68 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <optional>
+#include <functional>
+#include <unordered_map>
+#include "MessageHandler.hpp"
+#include "LineOffsetIndex.hpp"
+
+// Per-message cache of word-wrapped chat lines.
+// Each entry is keyed by (message id, content version) for the current
+// width; only new or changed messages are re-wrapped on sync() (for a
+// streaming message, only its last paragraph), and a width or prefix
+// change invalidates everything. Older messages prepended to the store
+// (paged-in history) are wrapped on their own without touching the
+// entries already cached. A LineOffsetIndex over
+// the per-message line counts lets visible_lines() jump straight to the
+// first message on screen, so drawing costs O(log n + rows).
+class ChatWrapCache {
+public:
+    // Text width available inside the chat window borders
+    void set_width(int width);
+    void set_user_prefix(const std::string& prefix);
+
+    // Bring the cache up to date with the message store
+    void sync(const MessageHandler& messages);
+
+    // Wrapped lines for the viewport, oldest first. scroll_offset counts
+    // lines up from the bottom of the transcript; blank separator lines
+    // are returned as empty views.
+    std::vector<std::string_view> visible_lines(int scroll_offset, int rows) const;
+
+    size_t total_lines() const { return line_index_.total(); }
+    size_t message_count() const { return entries_.size(); }
+    bool contains(uint64_t id) const { return index_of_.contains(id); }
+
+    // Global line number of the first line of message `id` for which
+    // match(text) is true, where text omits the sender prefix. Falls back to
+    // the message's first line; nullopt if the message is not cached.
+    std::optional<size_t> find_line(uint64_t id, const std::function<bool(std::string_view)>& match) const;
+
+private:
+    struct Entry {
+        uint64_t id = 0;
+        uint64_t version = 0;
+        std::vector<std::string> lines; // Excludes the blank separator
+        size_t size = 0;        // Content bytes wrapped so far
+        size_t tail_offset = 0; // Where the last (still growing) paragraph starts
+        size_t tail_line = 0;   // Its first line in `lines`
+        size_t prefix_size = 0; // Sender prefix bytes at the start of the first line
+    };
+
+    std::vector<Entry> entries_;
+    LineOffsetIndex line_index_;
+    std::unordered_map<uint64_t, size_t> index_of_; // Message id -> entry
+    int width_ = 0;
+    std::string user_prefix_ = "User: ";
+    uint64_t prepended_seen_ = 0;
+
+    static constexpr const char* kAIPrefix = "AI: ";
+
+    void invalidate();
+    void sync_prepended(const MessageHandler& messages, size_t added);
+    void wrap(Entry& entry, const ChatMessage& msg) const;
+    static size_t line_count(const Entry& entry) { return entry.lines.size() + 1; }
+};
@@ -3,9 +3,13 @@
 
 class ClaudeAIClient : public BaseAIClient {
 public:
-    ClaudeAIClient() { model_ = "claude"; }
+    ClaudeAIClient() {
+        model_ = "claude";
+        base_url_ = ProviderRegistry::instance().base_url("claude");
+    }
     
     nlohmann::json build_message_history(const std::string& latest_user_msg = "") const override {
+        TraceSpan span("build_history", "client");
         std::lock_guard lock(mutex_);
         nlohmann::json messages = nlohmann::json::array();
         for (const auto& msg : conversation_history_) {
@@ -21,4 +25,8 @@ public:
     std::future<std::expected<std::string, ApiErrorInfo>> send_message(
         const nlohmann::json& messages, 
         const std::string& model = "") override;
+    
+    // The /v1/messages body for `messages`; no network access or locking
+    nlohmann::json build_request_body(const nlohmann::json& messages, const std::string& model,
+                                      const std::string& system_prompt, const std::string& tool_results = "") const;
 };
\ No newline at end of file
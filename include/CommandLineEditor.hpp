@@ -1,11 +1,32 @@
 #pragma once
 #include <string>
+#include <string_view>
 #include <vector>
+#include <cstdint>
+#include "GapBuffer.hpp"
+#include "LineOffsetIndex.hpp"
 
+// Multi-line prompt editor over a gap buffer. The text is UTF-8: bytes
+// >= 0x80 from getch() are inserted as-is, and cursor movement and
+// deletion step over whole grapheme clusters (an emoji ZWJ sequence, a
+// letter with its combining marks), so they never split what the user
+// sees as one character. cursor_pos() is a byte offset.
+//
+// The editor keeps a line index (length and soft-wrapped rows of each
+// logical line plus the cursor's line and its start) and a prefix sum of
+// the per-line row counts. An edit rewraps only the line it touches, so a
+// keystroke costs O(length of the edited line) plus O(log lines) to update
+// and query the row counts, independent of how much text the prompt holds.
+// Splitting or joining lines also shifts the line index, O(lines).
 class CommandLineEditor {
 public:
     CommandLineEditor();
     void handle_input(int ch);
+    // Insert a block of text (a paste) in one operation. CRLF and CR become
+    // line breaks, tabs become spaces and other control characters are dropped.
+    void insert(std::string_view text);
+    void insert_newline();
+    // The whole prompt, all lines
     std::string current_line() const;
     void clear();
     void add_history(const std::string& line);
@@ -14,11 +35,49 @@ public:
     const std::vector<std::string>& history() const;
 public:
     // New for richer editing
-    int cursor_pos() const { return cursor_pos_; }
-    void set_cursor_pos(int pos) { cursor_pos_ = std::max(0, std::min((int)buffer_.size(), pos)); }
+    int cursor_pos() const { return static_cast<int>(buffer_.cursor()); }
+    void set_cursor_pos(int pos) { move_to(static_cast<size_t>(std::max(0, pos))); }
+    // Display columns before the cursor on its soft-wrapped row
+    int cursor_column() const;
+
+    size_t line_count() const { return lines_.size(); }
+    // Move to the same column of the previous (-1) or next (+1) logical
+    // line; false when there is no such line
+    bool move_line(int direction);
+
+    // Soft wrapping; rows hold at most `columns` display columns
+    void set_wrap_width(int columns);
+    size_t row_count() const;
+    size_t cursor_row() const;
+    // Soft-wrapped rows [first, first + count)
+    std::vector<std::string> rows(size_t first, size_t count) const;
+
 private:
-    std::string buffer_;
+    struct Line {
+        size_t length = 0; // Bytes, excluding the '\n'
+        // Byte offsets where each soft-wrapped row starts
+        std::vector<uint32_t> row_starts{0};
+    };
+
+    GapBuffer buffer_;
+    std::vector<Line> lines_{Line{}};
+    LineOffsetIndex row_index_; // Row count of each line
+    size_t cursor_line_ = 0;
+    size_t cursor_line_start_ = 0; // Byte offset of the cursor line
+    int wrap_width_ = 80;
     std::vector<std::string> history_;
     int history_index_ = -1;
-    int cursor_pos_ = 0;
+
+    size_t previous_grapheme_start() const;
+    size_t next_grapheme_end() const;
+    void move_to(size_t pos);
+    void erase_before(size_t n);
+    void erase_after(size_t n);
+    void assign(std::string_view text);
+    size_t line_start(size_t line) const;
+    std::string line_text(size_t line) const;
+    // Rewrap `line`, which starts at byte `start`, and update its row count
+    void rewrap(size_t line, size_t start);
+    // Soft row of the cursor within its line, and its start offset
+    std::pair<size_t, size_t> cursor_row_in_line() const;
 };
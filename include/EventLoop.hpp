@@ -0,0 +1,35 @@
+#pragma once
+
+// epoll-based wait for the UI thread: wakes on keyboard input (stdin),
+// terminal resize (SIGWINCH via signalfd) or an explicit wake() from
+// any other thread (eventfd). Nothing wakes the process while idle.
+//
+// The constructor blocks SIGWINCH for the calling thread; construct the
+// loop before starting any other thread so they inherit the mask and the
+// signal is only ever consumed through the signalfd.
+class EventLoop {
+public:
+    struct Events {
+        bool input = false;
+        bool resize = false;
+        bool wakeup = false;
+    };
+
+    EventLoop();
+    ~EventLoop();
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    // Block until something happens. timeout_ms < 0 waits indefinitely;
+    // on timeout or EINTR all flags are false.
+    Events wait(int timeout_ms = -1);
+
+    // Thread-safe and async-signal-safe
+    void wake();
+
+private:
+    int epoll_fd_ = -1;
+    int wake_fd_ = -1;
+    int signal_fd_ = -1;
+    bool stdin_always_ready_ = false;
+};
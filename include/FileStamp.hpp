@@ -0,0 +1,64 @@
+#pragma once
+#include <string>
+#include <optional>
+#include <cerrno>
+#include <ctime>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Identity of a regular file at one moment: size, inode and nanosecond
+// mtime. A copy of the file taken at that moment is current while the
+// stamp still matches (a rewrite within the same second still counts).
+class FileStamp {
+    size_t size_ = 0;
+    timespec mtime_{};
+    ino_t inode_ = 0;
+public:
+    // nullopt if `path` is not a regular file
+    static std::optional<FileStamp> take(const std::string& path) {
+        struct stat st{};
+        if (stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) return std::nullopt;
+        FileStamp stamp;
+        stamp.size_ = static_cast<size_t>(st.st_size);
+        stamp.mtime_ = st.st_mtim;
+        stamp.inode_ = st.st_ino;
+        return stamp;
+    }
+
+    bool is_stale(const std::string& path) const {
+        struct stat st{};
+        if (stat(path.c_str(), &st) != 0) return true;
+        return !matches(st);
+    }
+
+    // Copies the file if it still matches the stamp, else nullopt. A file
+    // truncated or rewritten during the read comes up short or mismatched.
+    std::optional<std::string> read_if_current(const std::string& path) const {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return std::nullopt;
+        std::optional<std::string> content;
+        struct stat st{};
+        if (fstat(fd, &st) == 0 && matches(st)) {
+            std::string buffer(size_, '\0');
+            size_t done = 0;
+            while (done < size_) {
+                ssize_t n = ::read(fd, buffer.data() + done, size_ - done);
+                if (n < 0 && errno == EINTR) continue;
+                if (n <= 0) break;
+                done += static_cast<size_t>(n);
+            }
+            if (done == size_) content = std::move(buffer);
+        }
+        ::close(fd);
+        return content;
+    }
+
+    size_t size() const { return size_; }
+
+private:
+    bool matches(const struct stat& st) const {
+        return static_cast<size_t>(st.st_size) == size_ && st.st_ino == inode_ &&
+               st.st_mtim.tv_sec == mtime_.tv_sec && st.st_mtim.tv_nsec == mtime_.tv_nsec;
+    }
+};
@@ -0,0 +1,103 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+
+// Byte buffer with a movable gap at the edit point. Inserting or erasing
+// at the cursor is O(1) amortized (O(n) per insert for a plain string);
+// moving the cursor costs the distance moved.
+class GapBuffer {
+public:
+    size_t size() const { return data_.size() - gap_size(); }
+    bool empty() const { return size() == 0; }
+    size_t cursor() const { return gap_begin_; }
+
+    char at(size_t pos) const {
+        return pos < gap_begin_ ? data_[pos] : data_[pos + gap_size()];
+    }
+
+    // Text on each side of the cursor
+    std::string_view before() const { return {data_.data(), gap_begin_}; }
+    std::string_view after() const { return {data_.data() + gap_end_, data_.size() - gap_end_}; }
+
+    // Bytes [pos, pos + len), which may straddle the gap
+    std::string substr(size_t pos, size_t len) const {
+        pos = std::min(pos, size());
+        len = std::min(len, size() - pos);
+        std::string out;
+        out.reserve(len);
+        if (pos < gap_begin_) {
+            size_t head = std::min(len, gap_begin_ - pos);
+            out.append(data_.data() + pos, head);
+            pos += head;
+            len -= head;
+        }
+        out.append(data_.data() + pos + gap_size(), len);
+        return out;
+    }
+
+    std::string str() const {
+        std::string out;
+        out.reserve(size());
+        out.append(before());
+        out.append(after());
+        return out;
+    }
+
+    void move_to(size_t pos) {
+        pos = std::min(pos, size());
+        if (pos < gap_begin_) {
+            size_t count = gap_begin_ - pos;
+            std::memmove(data_.data() + gap_end_ - count, data_.data() + pos, count);
+            gap_begin_ = pos;
+            gap_end_ -= count;
+        } else if (pos > gap_begin_) {
+            size_t count = pos - gap_begin_;
+            std::memmove(data_.data() + gap_begin_, data_.data() + gap_end_, count);
+            gap_begin_ += count;
+            gap_end_ += count;
+        }
+    }
+
+    void insert(std::string_view text) {
+        reserve_gap(text.size());
+        std::memcpy(data_.data() + gap_begin_, text.data(), text.size());
+        gap_begin_ += text.size();
+    }
+
+    void insert(char c) { insert(std::string_view(&c, 1)); }
+
+    // Erase up to n bytes before / after the cursor
+    void erase_before(size_t n) { gap_begin_ -= std::min(n, gap_begin_); }
+    void erase_after(size_t n) { gap_end_ += std::min(n, data_.size() - gap_end_); }
+
+    void assign(std::string_view text) {
+        clear();
+        insert(text);
+    }
+
+    void clear() {
+        gap_begin_ = 0;
+        gap_end_ = data_.size();
+    }
+
+private:
+    std::vector<char> data_;
+    size_t gap_begin_ = 0;
+    size_t gap_end_ = 0;
+
+    size_t gap_size() const { return gap_end_ - gap_begin_; }
+
+    void reserve_gap(size_t needed) {
+        if (gap_size() >= needed) return;
+        // Grow geometrically and move the text after the gap to the new end
+        size_t tail = data_.size() - gap_end_;
+        size_t capacity = std::max(data_.size() * 2, size() + needed + 64);
+        data_.resize(capacity);
+        size_t new_gap_end = capacity - tail;
+        std::memmove(data_.data() + new_gap_end, data_.data() + gap_end_, tail);
+        gap_end_ = new_gap_end;
+    }
+};
@@ -24,12 +24,14 @@ public:
         std::function<void()> on_done_cb,
         std::function<void(const ApiErrorInfo& error)> on_error_cb) override;
 
+    // The generateContent body for `messages`; no network access or locking
+    nlohmann::json build_request_body(const nlohmann::json& messages) const;
+
 private:
-    static const std::string BASE_URL;
     static const std::string API_VERSION;
     
-    std::string build_request_url(const std::string& model) const;
-    nlohmann::json build_request_body(const nlohmann::json& messages) const;
-    std::expected<std::string, ApiErrorInfo> parse_response(const std::string& response) const;
-    std::expected<std::string, ApiErrorInfo> make_api_request(const std::string& url, const nlohmann::json& request_body) const;
+    std::string build_request_url(const std::string& base_url, const std::string& model) const;
+    std::expected<std::string, ApiErrorInfo> parse_response(const std::string& response, const std::string& model) const;
+    std::expected<std::string, ApiErrorInfo> make_api_request(const std::string& url, const nlohmann::json& request_body,
+                                                              const std::string& model) const;
 };
\ No newline at end of file
@@ -1,8 +1,39 @@
 #pragma once
 #include "RichLogger.hpp"
 
+// Lowest level the LOG_* macros compile in (0 = Debug ... 4 = Critical);
+// set with the CHATBOT_MIN_LOG_LEVEL CMake option
+#ifndef CHATBOT_MIN_LOG_LEVEL
+#define CHATBOT_MIN_LOG_LEVEL 0
+#endif
+
 // Global singleton logger instance
 inline RichLogger& get_logger() {
+#if CHATBOT_BINARY_LOG
+    static RichLogger logger{"chatbot.blog", LogFormat::Binary};
+#else
     static RichLogger logger{"chatbot.log"};
+#endif
     return logger;
 }
+
+// Level-checked logging with std::format syntax. The arguments are only
+// evaluated when the level is enabled, and formatting is left to the
+// logger's writer thread. Calls below CHATBOT_MIN_LOG_LEVEL are still
+// type-checked but generate no code. LOG_TO names the logger.
+#define LOG_TO(logger, level, ...)                                                           \
+    do {                                                                                     \
+        if constexpr (static_cast<int>(level) >= CHATBOT_MIN_LOG_LEVEL) {                    \
+            RichLogger& log_target_ = (logger);                                              \
+            if (log_target_.enabled(level))                                                  \
+                log_target_.logf((level), std::source_location::current(), __VA_ARGS__);     \
+        }                                                                                    \
+    } while (0)
+
+#define LOG_AT(level, ...) LOG_TO(get_logger(), level, __VA_ARGS__)
+
+#define LOG_DEBUG(...) LOG_AT(LogLevel::Debug, __VA_ARGS__)
+#define LOG_INFO(...) LOG_AT(LogLevel::Info, __VA_ARGS__)
+#define LOG_WARN(...) LOG_AT(LogLevel::Warning, __VA_ARGS__)
+#define LOG_ERROR(...) LOG_AT(LogLevel::Error, __VA_ARGS__)
+#define LOG_CRITICAL(...) LOG_AT(LogLevel::Critical, __VA_ARGS__)
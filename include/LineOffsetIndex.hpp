@@ -0,0 +1,98 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <utility>
+
+// Fenwick (binary indexed) tree over per-message wrapped-line counts.
+// Maps a global line number to (message index, line within message) and
+// back in O(log n); appending or resizing one message is also O(log n).
+// Inserting or erasing in the middle rebuilds the tree in O(n).
+class LineOffsetIndex {
+public:
+    void clear() {
+        tree_.clear();
+        counts_.clear();
+        total_ = 0;
+    }
+
+    size_t size() const { return counts_.size(); }
+    size_t count(size_t index) const { return counts_[index]; }
+
+    void push_back(size_t count) {
+        // New node i covers (i - lowbit(i), i]: this count plus the tail of what's already here
+        size_t i = counts_.size() + 1;
+        size_t node = count + prefix(i - 1) - prefix(i - lowbit(i));
+        counts_.push_back(count);
+        tree_.push_back(node);
+        total_ += count;
+    }
+
+    // Insert entries before `index`
+    void insert(size_t index, const std::vector<size_t>& counts) {
+        counts_.insert(counts_.begin() + static_cast<std::ptrdiff_t>(index), counts.begin(), counts.end());
+        rebuild();
+    }
+
+    // Erase entries [index, index + n)
+    void erase(size_t index, size_t n = 1) {
+        auto first = counts_.begin() + static_cast<std::ptrdiff_t>(index);
+        counts_.erase(first, first + static_cast<std::ptrdiff_t>(n));
+        rebuild();
+    }
+
+    void set(size_t index, size_t count) {
+        size_t old = counts_[index];
+        if (old == count) return;
+        counts_[index] = count;
+        for (size_t i = index + 1; i <= tree_.size(); i += lowbit(i)) {
+            tree_[i - 1] = tree_[i - 1] - old + count;
+        }
+        total_ = total_ - old + count;
+    }
+
+    // Lines in messages [0, index)
+    size_t prefix(size_t index) const {
+        size_t sum = 0;
+        for (size_t i = index; i > 0; i -= lowbit(i)) {
+            sum += tree_[i - 1];
+        }
+        return sum;
+    }
+
+    size_t total() const { return total_; }
+
+    // Message containing global line `line` and the line's offset within it.
+    // Returns {size(), 0} when line is past the end.
+    std::pair<size_t, size_t> find(size_t line) const {
+        size_t pos = 0;
+        size_t remaining = line;
+        size_t step = 1;
+        while (step * 2 <= tree_.size()) step *= 2;
+        for (; step > 0; step /= 2) {
+            if (pos + step <= tree_.size() && tree_[pos + step - 1] <= remaining) {
+                pos += step;
+                remaining -= tree_[pos - 1];
+            }
+        }
+        if (pos >= counts_.size()) return {counts_.size(), 0};
+        return {pos, remaining};
+    }
+
+private:
+    static size_t lowbit(size_t i) { return i & (~i + 1); }
+
+    // Linear-time build: each node passes its sum up to its parent
+    void rebuild() {
+        tree_ = counts_;
+        total_ = 0;
+        for (size_t i = 1; i <= tree_.size(); ++i) {
+            total_ += counts_[i - 1];
+            size_t parent = i + lowbit(i);
+            if (parent <= tree_.size()) tree_[parent - 1] += tree_[i - 1];
+        }
+    }
+
+    std::vector<size_t> tree_;   // 1-based Fenwick nodes stored at [i - 1]
+    std::vector<size_t> counts_;
+    size_t total_ = 0;
+};
@@ -0,0 +1,55 @@
+#pragma once
+#include <string>
+#include <memory>
+#include <mutex>
+#include <functional>
+
+// Handle for aborting an in-flight MCP request from another thread.
+// Pass one to a manager call and call cancel() to abandon it: the waiting
+// call returns immediately and the server is sent notifications/cancelled.
+// Copies share state. One handle can cover several sequential requests;
+// once cancelled, later requests made with it fail immediately.
+class MCPCancelHandle {
+public:
+    using Canceller = std::function<void(const std::string& reason)>;
+
+    MCPCancelHandle() : state_(std::make_shared<State>()) {}
+
+    void cancel(const std::string& reason = "Cancelled by user") const {
+        Canceller canceller;
+        {
+            std::lock_guard lock(state_->mutex);
+            state_->cancelled = true;
+            canceller = std::move(state_->canceller);
+            state_->canceller = nullptr;
+        }
+        if (canceller) canceller(reason);
+    }
+
+    bool is_cancelled() const {
+        std::lock_guard lock(state_->mutex);
+        return state_->cancelled;
+    }
+
+    // Used by MCPClient: attach the request currently in flight.
+    // Returns false if the handle was cancelled before the request was sent.
+    bool bind(Canceller canceller) const {
+        std::lock_guard lock(state_->mutex);
+        if (state_->cancelled) return false;
+        state_->canceller = std::move(canceller);
+        return true;
+    }
+
+    void unbind() const {
+        std::lock_guard lock(state_->mutex);
+        state_->canceller = nullptr;
+    }
+
+private:
+    struct State {
+        std::mutex mutex;
+        bool cancelled = false;
+        Canceller canceller;
+    };
+    std::shared_ptr<State> state_;
+};
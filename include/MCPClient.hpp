@@ -2,6 +2,7 @@
 #include "AIClientInterface.hpp"
 #include "MCPMessage.hpp"
 #include "MCPProtocol.hpp"
+#include "MCPCancelHandle.hpp"
 #include <ixwebsocket/IXWebSocket.h>
 #include <nlohmann/json.hpp>
 #include <future>
@@ -10,6 +11,8 @@
 #include <atomic>
 #include <thread>
 #include <unordered_map>
+#include <unordered_set>
+#include <deque>
 #include <condition_variable>
 #include <chrono>
 #include "MCPResourceManager.hpp"
@@ -28,6 +31,7 @@ public:
     void set_api_key(const std::string& key) override;
     void set_system_prompt(const std::string& prompt) override;
     void set_model(const std::string& model) override;
+    void set_base_url(const std::string& url) override; // The server URL; takes effect on the next connect()
     void clear_history() override;
     void push_user_message(const std::string& content) override;
     void push_assistant_message(const std::string& content) override;
@@ -57,21 +61,31 @@ public:
     // Get server capabilities after successful connection
     std::optional<MCPCapabilities> get_server_capabilities() const;
 
+    // Name from the server's initialize reply, else its URL or "stdio"; used as a metrics label
+    std::string server_label() const;
+
     MCPResourceManager* resource_manager() { return resource_manager_.get(); }
     MCPToolManager* tool_manager() { return tool_manager_.get(); }
     MCPPromptManager* prompt_manager() { return prompt_manager_.get(); }
 
     // Allow managers to send requests
     std::future<std::expected<MCPResponse, ApiErrorInfo>> send_request_for_manager(const MCPRequest& request, 
-                                                                                   std::chrono::milliseconds timeout = std::chrono::milliseconds(30000)) {
-        return send_request(request, timeout);
+                                                                                   std::chrono::milliseconds timeout = std::chrono::milliseconds(30000),
+                                                                                   MCPCancelHandle cancel = {}) {
+        return send_request(request, timeout, std::move(cancel));
     }
 
+    // Abandon an in-flight request: its caller gets ApiError::Cancelled,
+    // the server is sent notifications/cancelled and any late reply is dropped
+    bool cancel_request(const MCPMessageId& id, const std::string& reason);
+    void cancel_all_requests(const std::string& reason);
+
 private:
     // Core MCP protocol methods
     std::future<std::expected<void, ApiErrorInfo>> initialize_connection();
     std::future<std::expected<MCPResponse, ApiErrorInfo>> send_request(const MCPRequest& request, 
-                                                                       std::chrono::milliseconds timeout = std::chrono::milliseconds(30000));
+                                                                       std::chrono::milliseconds timeout = std::chrono::milliseconds(30000),
+                                                                       MCPCancelHandle cancel = {});
     void send_notification(const MCPNotification& notification);
     
     // Message handling
@@ -83,6 +97,7 @@ private:
     // WebSocket management
     void setup_websocket();
     void setup_stdio_connection();
+    void send_stdio(std::string_view message); // Framed, complete write to the server's stdin
     void cleanup_connection();
     
     // State management
@@ -93,6 +108,7 @@ private:
     bool is_stdio_connection_{false};
     std::thread stdio_read_thread_;
     std::atomic<bool> stdio_read_thread_running_{false};
+    std::mutex stdio_write_mutex_;
     std::string api_key_;
     std::string system_prompt_;
     std::string model_;
@@ -109,6 +125,15 @@ private:
     std::unordered_map<std::string, std::promise<MCPResponse>> pending_responses_;
     std::mutex pending_requests_mutex_;
     
+    // Ids of requests we gave up on; their late responses are discarded unparsed.
+    // Bounded FIFO, guarded by pending_requests_mutex_.
+    static constexpr size_t kMaxAbandonedRequests = 256;
+    std::unordered_set<std::string> abandoned_requests_;
+    std::deque<std::string> abandoned_order_;
+    void mark_abandoned(const std::string& request_id);
+    bool has_abandoned();
+    bool take_abandoned(const std::string& request_id);
+    
     // Bridge process management
     std::thread bridge_thread_;
     std::atomic<bool> bridge_running_{false};
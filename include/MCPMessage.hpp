@@ -20,7 +20,10 @@ enum class MCPErrorCode {
     InvalidServerState = -32002,
     ResourceNotFound = -32003,
     ToolNotFound = -32004,
-    PromptNotFound = -32005
+    PromptNotFound = -32005,
+    
+    // Local only: the request was abandoned (timeout or user abort)
+    RequestCancelled = -32800
 };
 
 // MCP Error structure
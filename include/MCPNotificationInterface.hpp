@@ -1,6 +1,7 @@
 #pragma once
 #include <string>
 #include <functional>
+#include <optional>
 #include <nlohmann/json.hpp>
 
 // Interface for receiving MCP tool call notifications
@@ -17,6 +18,11 @@ public:
     // Called when a tool call fails
     virtual void on_tool_call_error(const std::string& tool_name, const std::string& error_message) = 0;
     
+    // Called for each notifications/progress the server sends for a running tool call.
+    // Runs on the MCP reader thread, so implementations should only record state.
+    virtual void on_tool_call_progress(const std::string& tool_name, double progress,
+                                       std::optional<double> total, const std::string& message) {}
+    
     // Called when any MCP operation occurs (general notification)
     virtual void on_mcp_activity(const std::string& activity_description) = 0;
 };
@@ -27,6 +33,7 @@ public:
     using ToolCallStartCallback = std::function<void(const std::string&, const nlohmann::json&)>;
     using ToolCallSuccessCallback = std::function<void(const std::string&, const nlohmann::json&)>;
     using ToolCallErrorCallback = std::function<void(const std::string&, const std::string&)>;
+    using ToolCallProgressCallback = std::function<void(const std::string&, double, std::optional<double>, const std::string&)>;
     using ActivityCallback = std::function<void(const std::string&)>;
     
     void set_tool_call_start_callback(ToolCallStartCallback callback) {
@@ -41,6 +48,10 @@ public:
         tool_call_error_callback_ = std::move(callback);
     }
     
+    void set_tool_call_progress_callback(ToolCallProgressCallback callback) {
+        tool_call_progress_callback_ = std::move(callback);
+    }
+    
     void set_activity_callback(ActivityCallback callback) {
         activity_callback_ = std::move(callback);
     }
@@ -63,6 +74,13 @@ public:
         }
     }
     
+    void on_tool_call_progress(const std::string& tool_name, double progress,
+                               std::optional<double> total, const std::string& message) override {
+        if (tool_call_progress_callback_) {
+            tool_call_progress_callback_(tool_name, progress, total, message);
+        }
+    }
+    
     void on_mcp_activity(const std::string& activity_description) override {
         if (activity_callback_) {
             activity_callback_(activity_description);
@@ -73,5 +91,6 @@ private:
     ToolCallStartCallback tool_call_start_callback_;
     ToolCallSuccessCallback tool_call_success_callback_;
     ToolCallErrorCallback tool_call_error_callback_;
+    ToolCallProgressCallback tool_call_progress_callback_;
     ActivityCallback activity_callback_;
 };
\ No newline at end of file
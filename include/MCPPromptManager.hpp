@@ -1,11 +1,51 @@
 #pragma once
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 #include <optional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <deque>
 #include <nlohmann/json.hpp>
+#include "MCPCancelHandle.hpp"
 
 class MCPClient;
 
+// A prompt template compiled once into literal and {{argument}} slot ops.
+// Rendering sizes the output up front and writes it in a single pass.
+class PromptTemplate {
+public:
+    // Compile a template; every {{name}} placeholder becomes a slot
+    static PromptTemplate compile(std::string source);
+    // Split text the server rendered with each argument set to a unique
+    // marker: every occurrence of a marker becomes that argument's slot
+    static PromptTemplate from_rendered(std::string text,
+                                        const std::vector<std::pair<std::string, std::string>>& markers);
+
+    std::string render(const nlohmann::json& arguments) const;
+
+    const std::vector<std::string>& slot_names() const { return slots_; }
+    bool has_slot(const std::string& name) const;
+
+private:
+    struct Op {
+        enum class Kind { Literal, Slot };
+        Kind kind;
+        size_t offset = 0; // Literal: byte range in source_
+        size_t length = 0;
+        size_t slot = 0;   // Slot: index into slots_
+    };
+    std::string source_;
+    std::vector<Op> ops_;
+    std::vector<std::string> slots_;
+    size_t literal_bytes_ = 0;
+
+    void add_literal(size_t offset, size_t length);
+    void add_slot(std::string_view name);
+};
+
 class MCPPromptManager {
 public:
     explicit MCPPromptManager(MCPClient* client);
@@ -14,8 +54,15 @@ public:
     // List prompts (optionally paginated)
     std::vector<nlohmann::json> list_prompts(std::optional<std::string> cursor = std::nullopt);
 
-    // Get a prompt by name with arguments
-    std::optional<std::string> get_prompt(const std::string& name, std::optional<nlohmann::json> arguments = std::nullopt);
+    // Get a prompt by name with arguments. The first use fetches the prompt
+    // with marker arguments and compiles it, then checks the template against
+    // the server's own renders of real arguments. A template renders locally
+    // only after it matched two renders whose arguments differ in every
+    // value, and then only when every argument it declares is a non-empty
+    // string; anything else, and any prompt that ever mismatched, goes to
+    // the server.
+    std::optional<std::string> get_prompt(const std::string& name, std::optional<nlohmann::json> arguments = std::nullopt,
+                                          const MCPCancelHandle& cancel = {});
 
     // Render a prompt template
     std::string render_template(const std::string& template_str, const nlohmann::json& arguments);
@@ -27,6 +74,30 @@ private:
     MCPClient* client_;
     std::vector<nlohmann::json> prompt_cache_;
     std::string last_cursor_;
-    // Add more as needed
+
+    struct CompiledPrompt {
+        std::shared_ptr<const PromptTemplate> tmpl; // nullptr: the server renders every call
+        nlohmann::json verified_args; // Arguments of the first matching server render, or null
+        bool trusted = false; // Also matched a render with every argument changed
+    };
+
+    // Bound on each compiled cache; the oldest entry goes first
+    static constexpr size_t kMaxCompiled = 64;
+
+    mutable std::mutex cache_mutex_;
+    std::unordered_map<std::string, CompiledPrompt> compiled_prompts_;
+    std::deque<std::string> compiled_prompt_order_;
+    std::unordered_map<std::string, std::shared_ptr<const PromptTemplate>> compiled_templates_;
+    std::deque<std::string> compiled_template_order_;
+
     void clear_cache();
-}; 
\ No newline at end of file
+    std::optional<std::string> fetch_prompt_text(const std::string& name, std::optional<nlohmann::json> arguments,
+                                                 const MCPCancelHandle& cancel = {});
+    std::optional<std::vector<std::string>> prompt_argument_names(const std::string& name);
+    CompiledPrompt compile_prompt(const std::string& name, const MCPCancelHandle& cancel);
+    void store_compiled(const std::string& name, const std::shared_ptr<const PromptTemplate>& expected,
+                        CompiledPrompt compiled);
+    void remember_compiled(const std::string& name, CompiledPrompt compiled);
+    static bool renders_locally(const PromptTemplate& tmpl, const nlohmann::json& arguments);
+    static bool differs_everywhere(const nlohmann::json& a, const nlohmann::json& b);
+};
@@ -122,14 +122,25 @@ public:
     // Create resources/read request
     static MCPRequest create_resources_read_request(const std::string& uri);
     
-    // Create tools/call request
+    // Create resources/subscribe request
+    static MCPRequest create_resources_subscribe_request(const std::string& uri);
+    
+    // Create resources/unsubscribe request
+    static MCPRequest create_resources_unsubscribe_request(const std::string& uri);
+    
+    // Create tools/call request (progress_token is sent as _meta.progressToken)
     static MCPRequest create_tools_call_request(const std::string& name, 
-                                               std::optional<nlohmann::json> arguments = std::nullopt);
+                                               std::optional<nlohmann::json> arguments = std::nullopt,
+                                               std::optional<nlohmann::json> progress_token = std::nullopt);
     
     // Create prompts/get request
     static MCPRequest create_prompts_get_request(const std::string& name,
                                                 std::optional<nlohmann::json> arguments = std::nullopt);
     
+    // Create notifications/cancelled notification
+    static MCPNotification create_cancelled_notification(const MCPMessageId& request_id,
+                                                         const std::string& reason);
+    
     // Create sampling/create_message request
     static MCPRequest create_sampling_create_message_request(const nlohmann::json& messages,
                                                            std::optional<nlohmann::json> model_preferences = std::nullopt,
@@ -162,16 +173,20 @@ namespace MCPMethods {
     constexpr const char* PING = "ping";
     constexpr const char* RESOURCES_LIST = "resources/list";
     constexpr const char* RESOURCES_READ = "resources/read";
-    constexpr const char* RESOURCES_UPDATED = "resources/updated";
-    constexpr const char* RESOURCES_LIST_CHANGED = "resources/list_changed";
+    constexpr const char* RESOURCES_SUBSCRIBE = "resources/subscribe";
+    constexpr const char* RESOURCES_UNSUBSCRIBE = "resources/unsubscribe";
+    constexpr const char* RESOURCES_UPDATED = "notifications/resources/updated";
+    constexpr const char* RESOURCES_LIST_CHANGED = "notifications/resources/list_changed";
     constexpr const char* TOOLS_LIST = "tools/list";
     constexpr const char* TOOLS_CALL = "tools/call";
-    constexpr const char* TOOLS_LIST_CHANGED = "tools/list_changed";
+    constexpr const char* TOOLS_LIST_CHANGED = "notifications/tools/list_changed";
     constexpr const char* PROMPTS_LIST = "prompts/list";
     constexpr const char* PROMPTS_GET = "prompts/get";
-    constexpr const char* PROMPTS_LIST_CHANGED = "prompts/list_changed";
+    constexpr const char* PROMPTS_LIST_CHANGED = "notifications/prompts/list_changed";
     constexpr const char* SAMPLING_CREATE_MESSAGE = "sampling/createMessage";
     constexpr const char* LOGGING_SET_LEVEL = "logging/setLevel";
     constexpr const char* ROOTS_LIST = "roots/list";
     constexpr const char* ROOTS_LIST_CHANGED = "roots/list_changed";
+    constexpr const char* PROGRESS = "notifications/progress";
+    constexpr const char* CANCELLED = "notifications/cancelled";
 }
\ No newline at end of file
@@ -2,7 +2,14 @@
 #include <string>
 #include <vector>
 #include <optional>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <unordered_map>
+#include <unordered_set>
 #include <nlohmann/json.hpp>
+#include "MCPCancelHandle.hpp"
+#include "FileStamp.hpp"
 
 class MCPClient;
 
@@ -14,21 +21,65 @@ public:
     // List resources (optionally paginated)
     std::vector<nlohmann::json> list_resources(std::optional<std::string> cursor = std::nullopt);
 
-    // Read a resource by URI
-    std::optional<nlohmann::json> read_resource(const std::string& uri);
+    // Read a resource by URI. Served from the content cache while the cached
+    // copy is still valid; force_refresh always goes to the server.
+    std::optional<nlohmann::json> read_resource(const std::string& uri, bool force_refresh = false,
+                                                const MCPCancelHandle& cancel = {});
 
-    // Resolve a resource URI (if needed)
+    // Resolve a resource URI (scheme-less names and local paths)
     std::optional<std::string> resolve_uri(const std::string& uri);
 
+    // Subscription management (resources/subscribe, resources/unsubscribe)
+    bool subscribe(const std::string& uri);
+    bool unsubscribe(const std::string& uri);
+    bool is_subscribed(const std::string& uri) const;
+
     // Cache management
     void clear_cache();
+    void invalidate(const std::string& uri);
+    bool is_cached(const std::string& uri) const;
+
+    // How long an unsubscribed, non file-backed entry is trusted without a re-read
+    void set_cache_ttl(std::chrono::milliseconds ttl) { cache_ttl_ = ttl; }
 
-    // Notification handler for resource updates
+    // Payloads at least this large are stored out-of-line
+    static constexpr size_t kOutOfLineThreshold = 64 * 1024;
+
+    // Notification handlers for resource updates
     void handle_list_changed_notification();
+    void handle_updated_notification(const nlohmann::json& params);
 
 private:
+    // Large text/blob payload stored outside the metadata JSON
+    struct Payload {
+        std::string field;                 // "text" or "blob"
+        std::shared_ptr<const std::string> data;
+        bool from_file = false;            // Re-read from the entry's local file
+    };
+
+    struct CachedResource {
+        nlohmann::json result;             // resources/read result with large payloads stripped
+        std::vector<std::optional<Payload>> payloads; // One slot per contents[] item
+        std::chrono::steady_clock::time_point fetched_at;
+        std::string local_path;            // Non-empty when file-backed
+        std::optional<FileStamp> stamp;    // The local file as it was when fetched
+    };
+
     MCPClient* client_;
     std::vector<nlohmann::json> resource_cache_;
     std::string last_cursor_;
-    // Add more as needed
-}; 
\ No newline at end of file
+
+    mutable std::mutex cache_mutex_;
+    std::unordered_map<std::string, CachedResource> content_cache_;
+    std::unordered_set<std::string> subscriptions_;
+    std::chrono::milliseconds cache_ttl_{std::chrono::seconds(60)};
+    uint64_t invalidation_epoch_ = 0; // Bumped on every invalidation so in-flight reads don't store stale data
+
+    bool server_supports_subscribe() const;
+    bool is_fresh(const CachedResource& entry, bool subscribed) const;
+    CachedResource make_entry(const std::string& uri, const nlohmann::json& result) const;
+    // nullopt if a file-backed payload no longer matches the file on disk.
+    // Does file I/O, so call it on a copy of the entry without the lock held.
+    static std::optional<nlohmann::json> materialize(CachedResource entry);
+    static std::optional<std::string> local_path_for(const std::string& uri);
+};
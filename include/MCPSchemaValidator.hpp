@@ -0,0 +1,75 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <optional>
+#include <expected>
+#include <regex>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+
+// Validator compiled once from a tool's JSON Schema inputSchema.
+// Supports the subset tool schemas use in practice: type, enum, const,
+// required, properties, additionalProperties, items, anyOf/oneOf,
+// numeric bounds, string length/pattern and array length.
+// Other keywords are ignored, but the ones that change what the rest of a
+// schema accepts ($ref, allOf, patternProperties, ...) are listed by
+// unsupported_keywords(). Checking around them can reject valid input, e.g.
+// additionalProperties: false rejects a property patternProperties allows,
+// so callers should not trust the validator for such a schema.
+class MCPSchemaValidator {
+public:
+    MCPSchemaValidator() = default;
+
+    // Compile a schema; fails only if the schema itself is malformed
+    static std::expected<MCPSchemaValidator, std::string> compile(const nlohmann::json& schema);
+
+    // Validate a value. On failure returns every violation found, one per
+    // line, each prefixed with a JSON path (e.g. "$.query: expected string, got integer").
+    std::expected<void, std::string> validate(const nlohmann::json& value) const;
+
+    bool empty() const { return nodes_.empty(); }
+    // Keywords the schema uses that this validator cannot check, as "<path>: <keyword>"
+    const std::vector<std::string>& unsupported_keywords() const { return unsupported_; }
+
+private:
+    enum TypeBits : uint8_t {
+        kNull = 1 << 0,
+        kBoolean = 1 << 1,
+        kInteger = 1 << 2,
+        kNumber = 1 << 3,   // Also accepts integers
+        kString = 1 << 4,
+        kArray = 1 << 5,
+        kObject = 1 << 6,
+        kAny = 0x7f
+    };
+
+    struct Node {
+        uint8_t types = kAny;
+        std::vector<nlohmann::json> enum_values;
+        std::optional<nlohmann::json> const_value;
+        std::optional<double> minimum, maximum, exclusive_minimum, exclusive_maximum;
+        std::optional<size_t> min_length, max_length, min_items, max_items;
+        std::optional<std::regex> pattern;
+        std::string pattern_source;
+        std::vector<std::string> required;
+        std::vector<std::pair<std::string, int>> properties; // Sorted by name
+        bool additional_allowed = true;
+        int additional_schema = -1;
+        int items = -1;
+        std::vector<int> any_of;
+        std::vector<int> one_of;
+    };
+
+    std::vector<Node> nodes_; // nodes_[0] is the root
+    std::vector<std::string> unsupported_;
+
+    static std::expected<int, std::string> compile_node(const nlohmann::json& schema,
+                                                        std::vector<Node>& nodes,
+                                                        std::vector<std::string>& unsupported,
+                                                        const std::string& path);
+    void validate_node(int index, const nlohmann::json& value, std::string& path,
+                       std::vector<std::string>& errors) const;
+    static bool matches_type(uint8_t types, const nlohmann::json& value);
+    static const char* type_name(const nlohmann::json& value);
+    static std::string type_mask_to_string(uint8_t types);
+};
@@ -41,6 +41,9 @@ public:
     // Set notification interface for tool call events
     void set_notification_interface(MCPNotificationInterface* notifier);
 
+    // Abandon every in-flight request (sends notifications/cancelled)
+    void cancel_pending_requests(const std::string& reason = "Cancelled by user");
+
 private:
     MCPService() = default;
     ~MCPService() = default;
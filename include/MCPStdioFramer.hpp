@@ -0,0 +1,42 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <cstring>
+
+// Newline-delimited JSON framing for MCP over stdio. Bytes arrive from the
+// pipe in arbitrary chunks; feed() hands every complete line to a callback
+// and keeps the unterminated tail for the next read. Consumed lines are
+// dropped once per feed, not once per message, so a read carrying many
+// small messages costs one pass over the bytes.
+class MCPStdioFramer {
+public:
+    // Calls on_message(std::string_view) for each complete line in order.
+    // The view is only valid for the duration of the call.
+    template <typename F>
+    void feed(std::string_view bytes, F&& on_message) {
+        size_t scanned = buffer_.size();
+        buffer_.append(bytes);
+        size_t start = 0;
+        const char* data = buffer_.data();
+        while (const void* hit = std::memchr(data + scanned, '\n', buffer_.size() - scanned)) {
+            size_t newline = static_cast<const char*>(hit) - data;
+            on_message(std::string_view(data + start, newline - start));
+            start = scanned = newline + 1;
+        }
+        buffer_.erase(0, start);
+    }
+
+    // Bytes received after the last newline
+    size_t pending_bytes() const { return buffer_.size(); }
+    void reset() { buffer_.clear(); }
+
+    // Append `message` plus its terminator to `out`, so a message goes out in one write()
+    static void append_frame(std::string& out, std::string_view message) {
+        out.reserve(out.size() + message.size() + 1);
+        out.append(message);
+        out += '\n';
+    }
+
+private:
+    std::string buffer_;
+};
@@ -2,8 +2,16 @@
 #include <string>
 #include <vector>
 #include <optional>
+#include <expected>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <atomic>
+#include <cstdint>
 #include <nlohmann/json.hpp>
+#include "MCPCancelHandle.hpp"
 #include "MCPNotificationInterface.hpp"
+#include "MCPSchemaValidator.hpp"
 
 class MCPClient;
 
@@ -15,13 +23,16 @@ public:
     // List tools (optionally paginated)
     std::vector<nlohmann::json> list_tools(std::optional<std::string> cursor = std::nullopt);
 
-    // Call a tool by name with arguments
-    nlohmann::json call_tool(const std::string& name, std::optional<nlohmann::json> arguments = std::nullopt);
+    // Call a tool by name with arguments. Arguments that fail the tool's
+    // inputSchema are rejected locally with an isError result describing why.
+    nlohmann::json call_tool(const std::string& name, std::optional<nlohmann::json> arguments = std::nullopt,
+                             const MCPCancelHandle& cancel = {});
 
-    // Validate tool parameters
+    // Validate tool parameters against the compiled inputSchema
     bool validate_parameters(const std::string& name, const nlohmann::json& arguments);
+    std::expected<void, std::string> check_parameters(const std::string& name, const nlohmann::json& arguments) const;
 
-    // Progress tracking (stub for now)
+    // Route a notifications/progress to the pending call that owns its token
     void handle_progress_notification(const nlohmann::json& progress);
     
     // Notification handler for tool list updates
@@ -32,9 +43,27 @@ public:
 
 private:
     MCPClient* client_;
+    MCPNotificationInterface* notifier_ = nullptr;
+    // Guards the tool list and its validators: list_changed clears them on
+    // the MCP reader thread while list_tools() fills them on the caller's
+    mutable std::mutex cache_mutex_;
     std::vector<nlohmann::json> tool_cache_;
     std::string last_cursor_;
-    MCPNotificationInterface* notifier_ = nullptr;
-    // Add more as needed
+    uint64_t cache_generation_ = 0; // Bumped by clear_cache(); a page fetched across it is not cached
+    // Validators compiled from each tool's inputSchema when the tool list is loaded
+    std::unordered_map<std::string, MCPSchemaValidator> validators_;
+    // Tools already warned about for schema keywords the validator cannot check
+    std::unordered_set<std::string> unsupported_warned_;
+    // Progress tokens of in-flight calls, mapped to the tool name
+    std::mutex progress_mutex_;
+    std::unordered_map<int64_t, std::string> pending_progress_;
+    std::atomic<int64_t> next_progress_token_{1};
     void clear_cache();
+
+    struct CompiledPage {
+        std::unordered_map<std::string, MCPSchemaValidator> validators;
+        std::vector<std::pair<std::string, std::string>> unsupported; // Tool name, keywords
+    };
+    // Compiles one page's validators; called without the lock held
+    static CompiledPage compile_validators(const std::vector<nlohmann::json>& tools);
 }; 
\ No newline at end of file
@@ -1,9 +1,11 @@
 #pragma once
 #include "MCPServerManager.hpp"
+#include "MCPCancelHandle.hpp"
 #include <string>
 #include <vector>
 #include <map>
 #include <optional>
+#include <mutex>
 #include <nlohmann/json.hpp>
 
 struct MCPTool {
@@ -33,6 +35,11 @@ public:
     
     // Tool calling
     std::optional<nlohmann::json> call_tool(const std::string& tool_name, const nlohmann::json& arguments);
+
+    // Tool calls made during a chat turn share one cancel handle, so ESC
+    // abandons that turn's calls and leaves every other MCP request alone
+    void begin_turn();
+    void cancel_turn(const std::string& reason = "Cancelled by user");
     
     // AI integration helpers
     std::string get_tools_description_for_ai();
@@ -51,6 +58,8 @@ private:
     MCPServerManager* server_manager_ = nullptr;
     std::vector<MCPTool> tool_cache_;
     bool cache_valid_ = false;
+    std::mutex turn_mutex_;
+    MCPCancelHandle turn_cancel_;
     
     // Tool discovery from individual servers
     std::vector<MCPTool> discover_tools_from_server(const std::string& server_name);
@@ -0,0 +1,62 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+
+// Append-only message text stored as a list of shared segments.
+// Copying a MessageContent copies segment pointers, not bytes, so
+// snapshots handed to readers are cheap and stay valid while the
+// original keeps growing: copying seals the tail segment, and appends
+// after that start a new segment rather than touch shared bytes.
+//
+// Not internally synchronized: mutate and copy under the owner's lock.
+class MessageContent {
+public:
+    MessageContent() = default;
+    MessageContent(std::string text) { append(std::move(text)); }
+    MessageContent(const char* text) { append(std::string_view(text)); }
+
+    MessageContent(const MessageContent& other)
+        : segments_(other.segments_), size_(other.size_), tail_shared_(!segments_.empty()) {
+        other.tail_shared_ = tail_shared_;
+    }
+    MessageContent& operator=(const MessageContent& other) {
+        if (this != &other) *this = MessageContent(other);
+        return *this;
+    }
+    MessageContent(MessageContent&&) noexcept = default;
+    MessageContent& operator=(MessageContent&&) noexcept = default;
+
+    void append(std::string_view text);
+    void append(std::string&& text);
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    size_t segment_count() const { return segments_.size(); }
+
+    // Flatten the whole text, or the bytes from offset to the end
+    std::string str() const { return substr(0); }
+    std::string substr(size_t offset) const;
+
+    template <typename F>
+    void for_each_segment(F&& f) const {
+        for (const auto& segment : segments_) {
+            f(std::string_view(*segment));
+        }
+    }
+
+    bool operator==(std::string_view text) const;
+
+private:
+    // Small appends (streamed tokens) are packed into segments of this size
+    static constexpr size_t kSegmentSize = 4096;
+
+    std::vector<std::shared_ptr<std::string>> segments_;
+    size_t size_ = 0;
+    // Set once a copy shares the tail segment. Deliberately never cleared:
+    // use_count() can't prove a reader on another thread is done with it.
+    mutable bool tail_shared_ = false;
+
+    bool can_extend_tail(size_t extra) const;
+};
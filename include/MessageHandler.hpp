@@ -5,11 +5,20 @@
 #include <condition_variable>
 #include <vector>
 #include <coroutine>
+#include <functional>
+#include <cstdint>
+#include "TranscriptWriter.hpp"
+#include "MessageContent.hpp"
+#include "utf8_utils.hpp"
 
+// Copies share content segments, so snapshots are cheap
 struct ChatMessage {
     enum class Sender { User, AI };
     Sender sender;
-    std::string content;
+    MessageContent content;
+    uint64_t id = 0;      // Assigned by MessageHandler, unique per session
+    uint64_t version = 0; // Bumped whenever content changes
+    int64_t created_ms = 0; // Unix epoch milliseconds, set on push if zero
 };
 
 class MessageHandler {
@@ -17,12 +26,43 @@ public:
     void append_to_last_ai_message(const std::string& chunk, bool is_complete = false);
     void log_complete_ai_message();
 
-    MessageHandler();
+    explicit MessageHandler(std::string transcript_path = "chat_history.log");
     void push_message(const ChatMessage& msg);
     std::vector<ChatMessage> get_messages(int offset = 0, int count = 50) const;
+    // Messages from index (oldest = 0) to the end; content is shared, not copied
+    std::vector<ChatMessage> get_messages_from(size_t index) const;
+    std::vector<ChatMessage> get_message_range(size_t begin, size_t end) const;
     int message_count() const;
     void clear();
+
+    // Insert older messages (e.g. resumed history) before the current ones.
+    // Their ids are kept; later pushes get ids above all of them.
+    void prepend_messages(std::vector<ChatMessage> older);
+    // Total messages ever prepended; lets views notice a prepend
+    uint64_t prepended_count() const;
+    // Later pushes get ids of at least `next`, e.g. above a stored session's
+    void set_min_next_id(uint64_t next);
+
+    // Called (outside the lock) after any change; may run on any thread
+    void set_change_callback(std::function<void()> callback);
+    // Called (outside the lock) with each finished message: user messages
+    // when pushed, AI messages when their last chunk arrives
+    void set_persist_callback(std::function<void(const ChatMessage&)> callback);
+
+    // chat_history.log is written asynchronously and only while enabled
+    void set_transcript_enabled(bool enabled);
+    void set_transcript_fsync_policy(TranscriptWriter::FsyncPolicy policy);
 private:
     mutable std::mutex mutex_;
     std::deque<ChatMessage> messages_;
+    uint64_t next_id_ = 1;
+    uint64_t prepended_ = 0;
+    std::function<void()> on_change_;
+    std::function<void(const ChatMessage&)> on_persist_;
+    TranscriptWriter transcript_;
+    // Trailing bytes of a character split across streamed chunks
+    Utf8Decoder stream_decoder_;
+    std::string stream_tail_;
+    void notify_changed();
+    void persist(const ChatMessage& msg);
 };
@@ -0,0 +1,191 @@
+#pragma once
+#include <nlohmann/json.hpp>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// In-process metrics: counters, gauges and latency histograms keyed by name
+// and labels (provider, model, tool, server...). Updates are relaxed atomic
+// operations with no locks; only looking a metric up by name takes the
+// registry mutex, so hot paths look up once and keep the reference.
+// Metrics live as long as the process.
+
+using MetricLabels = std::vector<std::pair<std::string, std::string>>;
+
+class MetricsCounter {
+public:
+    void inc(uint64_t n = 1) { value_.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> value_{0};
+};
+
+class MetricsGauge {
+public:
+    void set(int64_t v) { value_.store(v, std::memory_order_relaxed); }
+    void add(int64_t n) { value_.fetch_add(n, std::memory_order_relaxed); }
+    int64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> value_{0};
+};
+
+// HDR-style log-linear histogram of non-negative integers: exact below 16,
+// then 16 buckets per power of two, so any recorded value is reported
+// within 6.25% over the full uint64 range in fixed memory.
+class MetricsHistogram {
+public:
+    static constexpr int kSubBits = 4;
+    static constexpr size_t kSubBuckets = size_t{1} << kSubBits;
+    static constexpr size_t kBuckets = (64 - kSubBits + 1) * kSubBuckets;
+
+    void observe(uint64_t value) {
+        buckets_[bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(value, std::memory_order_relaxed);
+        uint64_t seen = max_.load(std::memory_order_relaxed);
+        while (value > seen && !max_.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {}
+    }
+
+    // Microseconds, the unit of every *_us histogram
+    template <typename Rep, typename Period>
+    void observe(std::chrono::duration<Rep, Period> elapsed) {
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+        observe(static_cast<uint64_t>(us < 0 ? 0 : us));
+    }
+
+    static constexpr size_t bucket_index(uint64_t value) {
+        if (value < kSubBuckets) return static_cast<size_t>(value);
+        int shift = std::bit_width(value) - 1 - kSubBits;
+        return static_cast<size_t>(shift + 1) * kSubBuckets + ((value >> shift) & (kSubBuckets - 1));
+    }
+    // Smallest value that lands in bucket `index`
+    static constexpr uint64_t bucket_lower(size_t index) {
+        if (index < kSubBuckets) return index;
+        int shift = static_cast<int>(index / kSubBuckets) - 1;
+        return (kSubBuckets + index % kSubBuckets) << shift;
+    }
+
+    // Point-in-time copy; concurrent observations may be partially included
+    struct Snapshot {
+        uint64_t count = 0;
+        uint64_t sum = 0;
+        uint64_t max = 0;
+        std::vector<std::pair<size_t, uint64_t>> buckets; // Non-empty only: index, count
+
+        // Midpoint of the bucket holding the q-quantile, clamped to max
+        double quantile(double q) const;
+        double mean() const { return count ? static_cast<double>(sum) / static_cast<double>(count) : 0; }
+    };
+    Snapshot snapshot() const;
+
+private:
+    std::array<std::atomic<uint64_t>, kBuckets> buckets_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+};
+
+class MetricsRegistry {
+public:
+    static MetricsRegistry& instance();
+
+    // Find or create. `help` is kept from the first registration of a name.
+    // A name already registered as another kind is a bug: it is logged and
+    // the caller gets a detached metric that no export ever shows.
+    MetricsCounter& counter(std::string_view name, MetricLabels labels = {}, std::string_view help = "");
+    MetricsGauge& gauge(std::string_view name, MetricLabels labels = {}, std::string_view help = "");
+    MetricsHistogram& histogram(std::string_view name, MetricLabels labels = {}, std::string_view help = "");
+
+    // {"counters": [...], "gauges": [...], "histograms": [...]} with
+    // count/sum/mean/max/p50/p90/p99/p999 per histogram
+    nlohmann::json to_json() const;
+    // Prometheus text exposition; histograms are exported as summaries
+    std::string to_prometheus() const;
+
+private:
+    MetricsRegistry() = default;
+
+    enum class Kind { Counter, Gauge, Histogram };
+    struct Family {
+        Kind kind;
+        std::string help;
+        // Serialized labels -> metric; map keeps exports in a stable order
+        std::map<std::string, std::pair<MetricLabels, std::unique_ptr<MetricsCounter>>> counters;
+        std::map<std::string, std::pair<MetricLabels, std::unique_ptr<MetricsGauge>>> gauges;
+        std::map<std::string, std::pair<MetricLabels, std::unique_ptr<MetricsHistogram>>> histograms;
+    };
+
+    mutable std::mutex mutex_;
+    std::map<std::string, Family, std::less<>> families_;
+    std::chrono::system_clock::time_point started_ = std::chrono::system_clock::now();
+    // Handed out on a kind mismatch; shared, never exported
+    MetricsCounter detached_counter_;
+    MetricsGauge detached_gauge_;
+    MetricsHistogram detached_histogram_;
+
+    // nullptr when `name` is registered as another kind
+    Family* family(std::string_view name, Kind kind, std::string_view help);
+};
+
+// Serves snapshots: rewrites a JSON file every interval (write, then rename)
+// and/or answers each connection on a Unix socket with the Prometheus text,
+// e.g. `curl --unix-socket chatbot_metrics.sock http://x/metrics` or `nc -U`.
+// Empty paths disable that output.
+class MetricsExporter {
+public:
+    MetricsExporter(std::string json_path, std::string socket_path,
+                    std::chrono::seconds interval = std::chrono::seconds(10));
+    ~MetricsExporter(); // Writes a final JSON snapshot
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    void write_json_now();
+
+private:
+    std::string json_path_;
+    std::string socket_path_;
+    std::chrono::seconds interval_;
+    int listen_fd_ = -1;
+    int wake_pipe_[2] = {-1, -1};
+    std::thread thread_;
+    // Budget for one whole socket exchange; the same thread writes the JSON
+    static constexpr std::chrono::milliseconds kClientTimeout{1000};
+
+    void run();
+    void serve_client(int fd);
+};
+
+// Metric names shared by the instrumented call sites
+namespace metric_names {
+    inline constexpr std::string_view kProviderRequests = "chatcurses_provider_requests_total";
+    inline constexpr std::string_view kProviderTtft = "chatcurses_provider_ttft_us";
+    inline constexpr std::string_view kProviderLatency = "chatcurses_provider_latency_us";
+    inline constexpr std::string_view kProviderTokensIn = "chatcurses_provider_tokens_in_total";
+    inline constexpr std::string_view kProviderTokensOut = "chatcurses_provider_tokens_out_total";
+    inline constexpr std::string_view kMcpToolLatency = "chatcurses_mcp_tool_latency_us";
+    inline constexpr std::string_view kMcpToolCalls = "chatcurses_mcp_tool_calls_total";
+    inline constexpr std::string_view kMcpTimeouts = "chatcurses_mcp_timeouts_total";
+    inline constexpr std::string_view kMcpLateReplies = "chatcurses_mcp_late_replies_total";
+    inline constexpr std::string_view kMcpPending = "chatcurses_mcp_pending_requests";
+    inline constexpr std::string_view kTranscriptQueue = "chatcurses_transcript_queue_depth";
+    inline constexpr std::string_view kFrameTime = "chatcurses_render_frame_us";
+}
+
+// One provider HTTP exchange: status is the HTTP code, or 0 when the
+// request never got a response. ttft is the time to the first response byte.
+void record_provider_request(std::string_view provider, std::string_view model, long status,
+                             std::chrono::microseconds ttft, std::chrono::microseconds total);
+// Token usage as reported by the provider; zero counts are skipped
+void record_provider_tokens(std::string_view provider, std::string_view model, int64_t tokens_in, int64_t tokens_out);
@@ -2,6 +2,7 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <mutex>
 #include <curses.h>
 #include <stdexcept> // For std::runtime_error
 
@@ -42,19 +43,55 @@ public:
     }
 };
 
+// Byte range [begin, end) of a chat row to draw highlighted
+struct ChatHighlight {
+    size_t row;
+    size_t begin;
+    size_t end;
+};
+
 class NCursesUI {
 public:
+    // getch() codes for the bracketed-paste start/end markers
+    static constexpr int kKeyPasteBegin = KEY_MAX + 1;
+    static constexpr int kKeyPasteEnd = KEY_MAX + 2;
+
     NCursesUI() noexcept;
+    // Drive a terminal on the given streams instead of stdin/stdout, e.g. a
+    // headless one on /dev/null for benchmarks; TERM must name a terminfo entry
+    NCursesUI(FILE* out, FILE* in);
     ~NCursesUI() noexcept;
-    [[nodiscard]] int draw_chat_window(const std::vector<std::string_view>& messages, int scroll_offset, bool waiting_for_ai = false);
-    void draw_input_window(std::string_view input, int cursor_pos);
+    // Draw already-wrapped lines (top to bottom); empty views are blank rows.
+    // Only rows that differ from the previous frame are rewritten.
+    // Highlights must be sorted by row, then begin, and not overlap.
+    void draw_chat_window(const std::vector<std::string_view>& lines,
+                          const std::vector<ChatHighlight>& highlights = {});
+    // Waiting indicator and MCP activity, drawn into the chat window's bottom border
+    void draw_status_line(bool waiting_for_ai);
+    int chat_text_width() const;  // Columns available for text inside the border
+    int chat_text_rows() const;   // Rows available for text inside the border
+    // Soft-wrapped input rows; only rows that changed are rewritten.
+    // The cursor goes to (cursor_row, cursor_column) within `rows`.
+    void draw_input_window(const std::vector<std::string>& rows, int cursor_row, int cursor_column);
+    int input_text_width() const; // Columns inside the input border
+    int max_input_rows() const;   // The input may take up to half the screen
+    // Resize the input window to hold `rows` text rows (clamped); the chat
+    // window gives up or takes back the space. Returns true if the layout
+    // changed, in which case every region must be redrawn.
+    bool set_input_rows(int rows);
     void draw_settings_panel(bool visible);
+    // Push every staged window to the terminal in a single doupdate()
     void refresh_all();
+    // Forget what is on screen so the next frame repaints everything
+    void invalidate();
     void toggle_settings_panel();
     void set_theme(int theme_id);
     void handle_resize();
     void show_error(std::string_view message);
     void show_mcp_activity(std::string_view activity_message);
+    // After kKeyPasteBegin: read the pasted bytes up to the end marker.
+    // Leaves getch() non-blocking.
+    std::string read_paste();
     WINDOW* get_settings_win() const { return settings_win_.get(); }
 private:
     NcursesWindow chat_win_;
@@ -62,7 +99,17 @@ private:
     NcursesWindow settings_win_; 
     bool settings_visible_ = false;
     int theme_id_ = 0;
+    std::vector<std::string> chat_rows_; // Text currently shown on each chat row
+    std::vector<std::vector<std::pair<size_t, size_t>>> chat_marks_; // And its highlighted ranges
+    std::vector<std::string> input_rows_; // Text currently shown on each input row
+    int input_text_rows_ = 1;
+    std::string status_text_;
     std::string current_mcp_activity_;
+    mutable std::mutex activity_mutex_; // show_mcp_activity is called from MCP threads
+    SCREEN* screen_ = nullptr; // Only set when constructed on explicit streams
+    FILE* out_ = stdout;
+    void setup_terminal();
+    void paint_status();
     void init_windows();
     void destroy_windows();
 };
@@ -3,9 +3,13 @@
 
 class OpenAIClient : public BaseAIClient {
 public:
-    OpenAIClient() { model_ = "gpt-4o"; }
+    OpenAIClient() {
+        model_ = "gpt-4o";
+        base_url_ = ProviderRegistry::instance().base_url("openai");
+    }
     
     nlohmann::json build_message_history(const std::string& latest_user_msg = "") const override {
+        TraceSpan span("build_history", "client");
         std::lock_guard lock(mutex_);
         nlohmann::json messages = nlohmann::json::array();
         
@@ -30,4 +34,7 @@ public:
     std::future<std::expected<std::string, ApiErrorInfo>> send_message(
         const nlohmann::json& messages, 
         const std::string& model = "") override;
+    
+    // The chat/completions body for `messages`; no network access or locking
+    nlohmann::json build_request_body(const nlohmann::json& messages, const std::string& model) const;
 };
\ No newline at end of file
@@ -9,14 +9,16 @@
 // ProviderConfig encapsulates configuration for a single AI provider
 class ProviderConfig {
 public:
-    ProviderConfig(std::string id, std::string display_name, std::string default_model, std::vector<std::string> models, std::string api_key_field)
-        : id_(std::move(id)), display_name_(std::move(display_name)), default_model_(std::move(default_model)), models_(std::move(models)), api_key_field_(std::move(api_key_field)) {}
+    ProviderConfig(std::string id, std::string display_name, std::string default_model, std::vector<std::string> models, std::string api_key_field, std::string base_url = "")
+        : id_(std::move(id)), display_name_(std::move(display_name)), default_model_(std::move(default_model)), models_(std::move(models)), api_key_field_(std::move(api_key_field)), base_url_(std::move(base_url)) {}
 
     const std::string& id() const { return id_; }
     const std::string& display_name() const { return display_name_; }
     const std::string& default_model() const { return default_model_; }
     const std::vector<std::string>& models() const { return models_; }
     const std::string& api_key_field() const { return api_key_field_; }
+    // Scheme and host of the public API, without a trailing slash
+    const std::string& base_url() const { return base_url_; }
 
 private:
     std::string id_;
@@ -24,6 +26,7 @@ private:
     std::string default_model_;
     std::vector<std::string> models_;
     std::string api_key_field_;
+    std::string base_url_;
 };
 
 // Singleton registry for all providers
@@ -61,6 +64,11 @@ public:
         return get(id).default_model();
     }
 
+    // Returns the public API base URL for a provider
+    std::string base_url(const std::string& id) const {
+        return get(id).base_url();
+    }
+
     // Returns the available models for a provider
     const std::vector<std::string>& models(const std::string& id) const {
         return get(id).models();
@@ -70,13 +78,13 @@ private:
     ProviderRegistry() {
         // Register all supported providers here
         providers_["xai"] = std::make_unique<ProviderConfig>(
-            "xai", "xAI", "grok-3-beta", std::vector<std::string>{"grok-3-beta", "grok-1", "grok-1.5"}, "xai_api_key");
+            "xai", "xAI", "grok-3-beta", std::vector<std::string>{"grok-3-beta", "grok-1", "grok-1.5"}, "xai_api_key", "https://api.x.ai");
         providers_["claude"] = std::make_unique<ProviderConfig>(
-            "claude", "Claude", "claude", std::vector<std::string>{"claude", "claude-3-opus-20240229", "claude-3-sonnet-20240229"}, "claude_api_key");
+            "claude", "Claude", "claude", std::vector<std::string>{"claude", "claude-3-opus-20240229", "claude-3-sonnet-20240229"}, "claude_api_key", "https://api.anthropic.com");
         providers_["openai"] = std::make_unique<ProviderConfig>(
-            "openai", "OpenAI", "gpt-4o", std::vector<std::string>{"gpt-4o", "gpt-4", "gpt-3.5-turbo"}, "openai_api_key");
+            "openai", "OpenAI", "gpt-4o", std::vector<std::string>{"gpt-4o", "gpt-4", "gpt-3.5-turbo"}, "openai_api_key", "https://api.openai.com");
         providers_["gemini"] = std::make_unique<ProviderConfig>(
-            "gemini", "Gemini", "gemini-1.5-pro", std::vector<std::string>{"gemini-1.5-pro", "gemini-1.5-flash", "gemini-2.0-flash-thinking-exp", "gemini-2.0-flash-exp"}, "gemini_api_key");
+            "gemini", "Gemini", "gemini-1.5-pro", std::vector<std::string>{"gemini-1.5-pro", "gemini-1.5-flash", "gemini-2.0-flash-thinking-exp", "gemini-2.0-flash-exp"}, "gemini_api_key", "https://generativelanguage.googleapis.com");
         providers_["mcp"] = std::make_unique<ProviderConfig>(
             "mcp", "MCP Servers", "mcp", std::vector<std::string>{"mcp"}, "");
     }
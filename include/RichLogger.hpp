@@ -1,61 +1,384 @@
 #pragma once
 #include <format>
 #include <string>
+#include <string_view>
 #include <iostream>
 #include <fstream>
 #include <memory>
 #include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <thread>
+#include <array>
+#include <tuple>
+#include <vector>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
 #include <source_location>
 #include <chrono>
 #include <ctime>
+#include <map>
 #include <nlohmann/json.hpp>
+#include "BinaryLog.hpp"
 
 enum class LogLevel { Debug, Info, Warning, Error, Critical };
 
+// Text lines, one JSON object per line, or the binary format of
+// BinaryLog.hpp (read with chatbot_log_decode)
+enum class LogFormat { Text, Json, Binary };
+
+// Asynchronous logger. A logging thread only copies the message, or for
+// logf() the raw format arguments, into a lock-free ring buffer of its own;
+// a background writer thread drains the rings, formats, timestamps and
+// writes. Prefer the LOG_* macros in GlobalLogger.hpp, which skip argument
+// evaluation entirely when the level is disabled, and compile away below
+// CHATBOT_MIN_LOG_LEVEL.
 class RichLogger {
 public:
     RichLogger(const std::string& filename = "", bool json_mode = false)
-        : file_(filename.empty() ? nullptr : new std::ofstream(filename, std::ios::app)),
-          json_mode_(json_mode) {}
+        : RichLogger(filename, json_mode ? LogFormat::Json : LogFormat::Text) {}
+
+    // Binary output needs a file; without one it falls back to text
+    RichLogger(const std::string& filename, LogFormat format)
+        : file_(filename.empty() ? nullptr : new std::ofstream(filename, std::ios::app | std::ios::binary)),
+          format_(format == LogFormat::Binary && filename.empty() ? LogFormat::Text : format),
+          writer_([this](std::stop_token stop) { run(stop); }) {}
+
+    // Writes everything already logged before returning
+    ~RichLogger() {
+        writer_.request_stop();
+        wake();
+        writer_.join();
+    }
+
+    RichLogger(const RichLogger&) = delete;
+    RichLogger& operator=(const RichLogger&) = delete;
 
-    void set_level(LogLevel level) { level_ = level; }
-    void set_json_mode(bool json_mode) { json_mode_ = json_mode; }
+    void set_level(LogLevel level) { level_.store(level, std::memory_order_relaxed); }
+    bool enabled(LogLevel level) const { return level >= level_.load(std::memory_order_relaxed); }
+    // Switches between text and JSON lines; a binary log stays binary
+    void set_json_mode(bool json_mode) {
+        if (format_ == LogFormat::Binary) return;
+        format_.store(json_mode ? LogFormat::Json : LogFormat::Text, std::memory_order_relaxed);
+    }
 
-    void log(LogLevel level, const std::string& msg,
+    void log(LogLevel level, std::string msg,
              const std::source_location& loc = std::source_location::current()) {
-        if (level < level_) return;
-        std::lock_guard lock(mutex_);
-        auto now = std::chrono::system_clock::now();
-        std::time_t now_c = std::chrono::system_clock::to_time_t(now);
-        char timebuf[32];
-        std::strftime(timebuf, sizeof(timebuf), "%Y-%m-%d %H:%M:%S", std::localtime(&now_c));
-        if (json_mode_) {
+        if (!enabled(level)) return;
+        Ring& ring = thread_ring();
+        Record& record = begin_record(ring, level, loc);
+        record.message = std::move(msg);
+        commit_record(ring, level);
+    }
+
+    // Deferred formatting: the arguments are copied (strings and C strings
+    // by value) and std::format runs on the writer thread
+    template <typename... Args>
+    void logf(LogLevel level, const std::source_location& loc, std::format_string<Args...> fmt, Args&&... args) {
+        if (!enabled(level)) return;
+        using Captured = std::tuple<captured_t<Args>...>;
+        Ring& ring = thread_ring();
+        Record& record = begin_record(ring, level, loc);
+        if constexpr (sizeof(Captured) <= kInlineArgBytes && alignof(Captured) <= alignof(std::max_align_t)) {
+            ::new (static_cast<void*>(record.args)) Captured(std::forward<Args>(args)...);
+            record.format_string = fmt.get();
+            record.format = [](const Record& r, std::string& out) {
+                const auto& values = *std::launder(reinterpret_cast<const Captured*>(r.args));
+                std::apply([&](const auto&... v) { out = std::vformat(r.format_string, std::make_format_args(v...)); },
+                           values);
+            };
+            record.encode = [](const Record& r, std::string& out) {
+                const auto& values = *std::launder(reinterpret_cast<const Captured*>(r.args));
+                binlog::put(out, static_cast<uint8_t>(sizeof...(Args)));
+                std::apply([&](const auto&... v) { (binlog::put_arg(out, v), ...); }, values);
+            };
+            record.destroy = [](Record& r) { std::launder(reinterpret_cast<Captured*>(r.args))->~Captured(); };
+        } else {
+            record.message = std::format(fmt, std::forward<Args>(args)...);
+        }
+        commit_record(ring, level);
+    }
+
+    // Block until everything logged so far has been written out
+    void flush() {
+        std::unique_lock lock(wake_mutex_);
+        uint64_t generation = ++flush_requested_;
+        wake_requested_ = true;
+        wake_cv_.notify_all();
+        flushed_cv_.wait(lock, [&] { return flushed_ >= generation; });
+    }
+
+private:
+    static constexpr size_t kRingSize = 256;
+    static constexpr size_t kInlineArgBytes = 160;
+    static constexpr auto kIdleFlush = std::chrono::milliseconds(20);
+
+    // Arguments outlive the call, so anything that points into the
+    // caller's memory is captured as an owned string
+    template <typename T>
+    using captured_t = std::conditional_t<
+        std::is_convertible_v<std::decay_t<T>, std::string_view> && !std::is_same_v<std::decay_t<T>, std::nullptr_t>,
+        std::string, std::decay_t<T>>;
+
+    struct Record {
+        LogLevel level = LogLevel::Info;
+        std::source_location loc;
+        std::chrono::system_clock::time_point time;
+        std::string message;
+        std::string_view format_string;
+        void (*format)(const Record&, std::string&) = nullptr;
+        void (*encode)(const Record&, std::string&) = nullptr; // Binary: argc and args
+        void (*destroy)(Record&) = nullptr;
+        alignas(std::max_align_t) unsigned char args[kInlineArgBytes];
+
+        ~Record() {
+            if (destroy) destroy(*this);
+        }
+    };
+
+    // Single-producer (the owning thread), single-consumer (the writer)
+    struct Ring {
+        std::array<Record, kRingSize> slots;
+        alignas(64) std::atomic<size_t> head{0}; // Next slot to fill
+        alignas(64) std::atomic<size_t> tail{0}; // Next slot to write out
+        std::atomic<bool> retired{false};        // Owning thread has exited
+    };
+
+    std::unique_ptr<std::ofstream> file_;
+    std::atomic<LogLevel> level_{LogLevel::Debug};
+    std::atomic<LogFormat> format_{LogFormat::Text};
+    const uint64_t id_ = next_logger_id();
+
+    std::mutex rings_mutex_;
+    std::vector<std::shared_ptr<Ring>> rings_;
+
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
+    std::condition_variable flushed_cv_;
+    bool wake_requested_ = false;
+    std::atomic<bool> pending_{false}; // Records committed since the writer last drained
+    uint64_t flush_requested_ = 0;
+    uint64_t flushed_ = 0;
+
+    // Writer-thread state: the formatted second is reused until it changes
+    std::time_t cached_second_ = -1;
+    char timebuf_[32] = {};
+    std::string line_;
+    // Binary: call site (format string, file, line) -> format id
+    std::map<std::tuple<const char*, const char*, uint32_t>, uint32_t> format_ids_;
+
+    std::jthread writer_; // Last: starts after everything above exists
+
+    static uint64_t next_logger_id() {
+        static std::atomic<uint64_t> next{1};
+        return next.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Ring& thread_ring() {
+        struct Owned {
+            std::vector<std::pair<uint64_t, std::shared_ptr<Ring>>> rings;
+            ~Owned() {
+                for (auto& entry : rings) entry.second->retired.store(true, std::memory_order_release);
+            }
+        };
+        thread_local Owned owned;
+        for (auto& [logger, ring] : owned.rings) {
+            if (logger == id_) return *ring;
+        }
+        auto ring = std::make_shared<Ring>();
+        {
+            std::lock_guard lock(rings_mutex_);
+            rings_.push_back(ring);
+        }
+        owned.rings.emplace_back(id_, ring);
+        return *ring;
+    }
+
+    Record& begin_record(Ring& ring, LogLevel level, const std::source_location& loc) {
+        size_t head = ring.head.load(std::memory_order_relaxed);
+        // Full: let the writer catch up rather than drop the line
+        while (head - ring.tail.load(std::memory_order_acquire) >= kRingSize) {
+            wake();
+            std::this_thread::yield();
+        }
+        Record& record = ring.slots[head % kRingSize];
+        record.level = level;
+        record.loc = loc;
+        record.time = std::chrono::system_clock::now();
+        return record;
+    }
+
+    void commit_record(Ring& ring, LogLevel level) {
+        ring.head.store(ring.head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        // Errors are written promptly; everything else within kIdleFlush.
+        // Only the first record after a drain arms the writer's deadline.
+        if (level >= LogLevel::Error) {
+            wake();
+        } else if (!pending_.exchange(true, std::memory_order_acq_rel)) {
+            arm();
+        }
+    }
+
+    // Starts an idle writer's kIdleFlush countdown
+    void arm() {
+        // Taking the lock orders this notify after the writer's check of pending_
+        { std::lock_guard lock(wake_mutex_); }
+        wake_cv_.notify_one();
+    }
+
+    void wake() {
+        {
+            std::lock_guard lock(wake_mutex_);
+            wake_requested_ = true;
+        }
+        wake_cv_.notify_one();
+    }
+
+    void run(std::stop_token stop) {
+        if (format_ == LogFormat::Binary) start_binary_session();
+        while (true) {
+            uint64_t generation;
+            {
+                std::unique_lock lock(wake_mutex_);
+                auto woken = [&] { return wake_requested_ || stop.stop_requested(); };
+                // Idle: sleep until a record is committed, then give it kIdleFlush to batch up
+                wake_cv_.wait(lock, [&] { return woken() || pending_.load(std::memory_order_acquire); });
+                if (!woken()) wake_cv_.wait_for(lock, kIdleFlush, woken);
+                wake_requested_ = false;
+                generation = flush_requested_;
+            }
+            // Cleared before draining, so a record committed during the drain re-arms the deadline
+            pending_.store(false, std::memory_order_release);
+            bool stopping = stop.stop_requested();
+            drain();
+            if (file_) file_->flush();
+            else std::cout.flush();
+            {
+                std::lock_guard lock(wake_mutex_);
+                flushed_ = generation;
+            }
+            flushed_cv_.notify_all();
+            if (stopping) return;
+        }
+    }
+
+    void drain() {
+        std::vector<std::shared_ptr<Ring>> rings;
+        {
+            std::lock_guard lock(rings_mutex_);
+            rings = rings_;
+        }
+        for (auto& ring : rings) {
+            // Read `retired` first: once set, the owner will publish nothing more
+            bool retired = ring->retired.load(std::memory_order_acquire);
+            size_t tail = ring->tail.load(std::memory_order_relaxed);
+            size_t head = ring->head.load(std::memory_order_acquire);
+            for (; tail != head; ++tail) {
+                Record& record = ring->slots[tail % kRingSize];
+                write(record);
+                if (record.destroy) record.destroy(record);
+                record.format = nullptr;
+                record.encode = nullptr;
+                record.destroy = nullptr;
+                record.message.clear();
+                ring->tail.store(tail + 1, std::memory_order_release);
+            }
+            if (retired) {
+                std::lock_guard lock(rings_mutex_);
+                std::erase(rings_, ring);
+            }
+        }
+    }
+
+    void start_binary_session() {
+        if (!file_) return;
+        file_->seekp(0, std::ios::end);
+        if (file_->tellp() == 0) *file_ << binlog::kMagic;
+        *file_ << binlog::kSessionMarker;
+    }
+
+    void write_binary(const Record& record) {
+        const auto& loc = record.loc;
+        int64_t time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(record.time.time_since_epoch()).count();
+        line_.clear();
+        if (record.encode) {
+            auto key = std::make_tuple(record.format_string.data(), loc.file_name(), loc.line());
+            auto [it, added] = format_ids_.try_emplace(key, static_cast<uint32_t>(format_ids_.size()));
+            if (added) {
+                line_ += static_cast<char>(binlog::Record::Format);
+                binlog::put(line_, it->second);
+                binlog::put(line_, static_cast<uint8_t>(record.level));
+                binlog::put(line_, static_cast<uint32_t>(loc.line()));
+                binlog::put_str(line_, loc.file_name());
+                binlog::put_str(line_, loc.function_name());
+                binlog::put_str(line_, record.format_string);
+            }
+            line_ += static_cast<char>(binlog::Record::Entry);
+            binlog::put(line_, it->second);
+            binlog::put(line_, time_ns);
+            record.encode(record, line_);
+        } else {
+            line_ += static_cast<char>(binlog::Record::Message);
+            binlog::put(line_, static_cast<uint8_t>(record.level));
+            binlog::put(line_, time_ns);
+            binlog::put(line_, static_cast<uint32_t>(loc.line()));
+            binlog::put_str(line_, loc.file_name());
+            binlog::put_str(line_, loc.function_name());
+            binlog::put_str(line_, record.message);
+        }
+        file_->write(line_.data(), static_cast<std::streamsize>(line_.size()));
+    }
+
+    void write(const Record& record) {
+        LogFormat format = format_.load(std::memory_order_relaxed);
+        if (format == LogFormat::Binary) {
+            write_binary(record);
+            return;
+        }
+        std::time_t second = std::chrono::system_clock::to_time_t(record.time);
+        if (second != cached_second_) {
+            std::tm local{};
+            localtime_r(&second, &local);
+            std::strftime(timebuf_, sizeof(timebuf_), "%Y-%m-%d %H:%M:%S", &local);
+            cached_second_ = second;
+        }
+        const std::string* msg = &record.message;
+        std::string formatted;
+        if (record.format) {
+            try {
+                record.format(record, formatted);
+            } catch (const std::exception& e) {
+                formatted = std::format("<log format error: {}>", e.what());
+            }
+            msg = &formatted;
+        }
+        const auto& loc = record.loc;
+        if (format == LogFormat::Json) {
             nlohmann::json j = {
-                {"timestamp", timebuf},
-                {"level", level_to_string(level)},
+                {"timestamp", timebuf_},
+                {"level", level_to_string(record.level)},
                 {"file", loc.file_name()},
                 {"line", loc.line()},
                 {"function", loc.function_name()},
-                {"message", msg}
+                {"message", *msg}
             };
-            std::string output = j.dump();
-            if (!file_) std::cout << output << std::endl;
-            else *file_ << output << std::endl;
+            std::string output = j.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+            if (!file_) std::cout << output << '\n';
+            else *file_ << output << '\n';
         } else {
-            std::string output = std::format("[{}] {} {}:{} {}() | {}\n",
-                timebuf, level_to_string(level), loc.file_name(), loc.line(), loc.function_name(), msg);
+            line_.clear();
+            std::format_to(std::back_inserter(line_), "[{}] {} {}:{} {}() | {}\n",
+                timebuf_, level_to_string(record.level), loc.file_name(), loc.line(), loc.function_name(), *msg);
             if (!file_) {
-                std::cout << color_for(level) << output << "\033[0m";
+                std::cout << color_for(record.level) << line_ << "\033[0m";
             } else {
-                *file_ << output;
+                *file_ << line_;
             }
         }
     }
-private:
-    std::unique_ptr<std::ofstream> file_;
-    std::mutex mutex_;
-    LogLevel level_ = LogLevel::Debug;
-    bool json_mode_ = false;
+
+public:
     static std::string level_to_string(LogLevel level) {
         switch (level) {
             case LogLevel::Debug: return "DEBUG";
@@ -66,6 +389,7 @@ private:
         }
         return "UNK";
     }
+private:
     static const char* color_for(LogLevel level) {
         switch (level) {
             case LogLevel::Debug: return "\033[36m";      // Cyan
@@ -0,0 +1,91 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <shared_mutex>
+#include <cstdint>
+#include "utf8_utils.hpp"
+
+// In-memory inverted index over chat messages.
+// Text is split into UTF-8 word tokens (ASCII, Latin-1, Greek and Cyrillic
+// letters are case-folded; each CJK ideograph or kana is a token of its own)
+// and every token occurrence is recorded with its position, so multi-word
+// queries match as phrases. Messages are only ever added, which keeps each
+// posting list sorted by (document, position) without any re-sorting.
+//
+// add() and search() are thread-safe; searches run concurrently.
+class SearchIndex {
+public:
+    struct Hit {
+        uint64_t message_id;
+        uint32_t position;   // Token index of the first query term in the message
+        uint32_t occurrence; // Earlier occurrences of the first term in the same message
+    };
+
+    void add(uint64_t message_id, std::string_view text);
+
+    // Phrase search; hits are grouped by message in the order messages were added
+    std::vector<Hit> search(std::string_view query) const;
+
+    // Case-folded terms of a query, in order
+    static std::vector<std::string> terms(std::string_view text);
+
+    // Calls f(term, byte_offset, byte_length) for each token; `term` is
+    // case-folded and only valid during the call
+    template <typename F>
+    static void tokenize(std::string_view text, F&& f);
+
+    size_t document_count() const;
+    size_t term_count() const;
+
+private:
+    struct Posting {
+        uint32_t doc;
+        uint32_t position;
+        bool operator<(const Posting& other) const {
+            return doc != other.doc ? doc < other.doc : position < other.position;
+        }
+    };
+
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<std::string, std::vector<Posting>> postings_;
+    std::vector<uint64_t> docs_; // Document number -> message id
+
+    enum class CharClass { Separator, Word, Ideograph };
+    static CharClass classify(uint32_t cp);
+    static uint32_t fold(uint32_t cp);
+    static void append_utf8(std::string& out, uint32_t cp);
+};
+
+template <typename F>
+void SearchIndex::tokenize(std::string_view text, F&& f) {
+    std::string term;
+    size_t start = 0;
+    auto flush = [&](size_t end) {
+        if (!term.empty()) {
+            f(static_cast<const std::string&>(term), start, end - start);
+            term.clear();
+        }
+    };
+    for (size_t i = 0; i < text.size();) {
+        size_t at = i;
+        uint32_t cp = utf8_next_codepoint(text, i);
+        switch (classify(cp)) {
+            case CharClass::Separator:
+                flush(at);
+                break;
+            case CharClass::Ideograph:
+                flush(at);
+                start = at;
+                append_utf8(term, cp);
+                flush(i);
+                break;
+            case CharClass::Word:
+                if (term.empty()) start = at;
+                append_utf8(term, fold(cp));
+                break;
+        }
+    }
+    flush(text.size());
+}
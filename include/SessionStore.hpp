@@ -0,0 +1,88 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <optional>
+#include <mutex>
+#include <atomic>
+#include <expected>
+#include <cstdint>
+#include <utility>
+#include "MappedFile.hpp"
+#include "MessageHandler.hpp"
+
+// Binary append-only log of finished chat messages, used to resume the
+// previous session. One framed record per message (role, provider,
+// timestamps, text), with a sidecar file of record offsets so the last
+// N messages can be located without scanning the log.
+//
+// Layout (host byte order):
+//   log:   FileHeader, then RecordHeader + provider bytes + content bytes, ...
+//   index: one uint64_t log offset per record
+//
+// The log is memory-mapped read-only when opened; records appended later
+// are only written, never read back, since they are still in memory.
+// A torn record at the end of the log (crash mid-write) is cut off on open,
+// and a missing or short index is rebuilt from the log. The log is locked
+// while open; a second instance gets it read-only and repairs nothing.
+class SessionStore {
+public:
+    struct Record {
+        uint64_t id;
+        ChatMessage::Sender sender;
+        std::string_view provider;
+        int64_t created_ms;   // Unix epoch milliseconds
+        int64_t completed_ms;
+        std::string_view content; // Points into the mapping
+    };
+
+    explicit SessionStore(std::string path = "chat_session.bin");
+    ~SessionStore();
+    SessionStore(const SessionStore&) = delete;
+    SessionStore& operator=(const SessionStore&) = delete;
+
+    // Create the log if missing, map it and load the index
+    std::expected<void, std::string> open();
+    bool is_open() const { return fd_ >= 0; }
+    // Another instance holds the log: records can be read but not appended
+    bool is_read_only() const { return read_only_; }
+
+    // Records present when the log was opened
+    size_t record_count() const { return offsets_.size(); }
+    Record record(size_t index) const;
+    // Index of the record holding message `id`; nullopt if it is not stored.
+    // Records are in completion order, not id order, so the first call
+    // builds a sorted id index over every record.
+    std::optional<size_t> find_record(uint64_t id) const;
+    // Messages [begin, end) ready for MessageHandler::prepend_messages
+    std::vector<ChatMessage> load(size_t begin, size_t end) const;
+    uint64_t max_message_id() const { return max_id_; }
+
+    // Appends are dropped while disabled; the provider is stamped on each record
+    void set_enabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+    void set_provider(const std::string& provider);
+
+    // Thread-safe; one write() per record
+    bool append(const ChatMessage& msg);
+
+    static int64_t now_ms();
+
+private:
+    std::string path_;
+    std::string index_path_;
+    int fd_ = -1;
+    int index_fd_ = -1;
+    bool read_only_ = false;
+    MappedFile map_;
+    std::vector<uint64_t> offsets_;
+    mutable std::once_flag id_index_once_;
+    mutable std::vector<std::pair<uint64_t, size_t>> id_index_; // (message id, record index), sorted
+    uint64_t end_offset_ = 0; // Where the next record goes
+    uint64_t max_id_ = 0;
+    std::atomic<bool> enabled_{true};
+    std::mutex mutex_;        // Guards appends and provider_
+    std::string provider_;
+
+    bool load_index(uint64_t log_size);
+    bool valid_record_at(uint64_t offset, uint64_t& next) const;
+};
@@ -15,9 +15,19 @@ struct Settings {
     std::string provider = "xai";
     std::string model = "grok-3-beta";
     bool store_chat_history = true;
+    std::string chat_history_fsync = "never"; // "never", "message" or "batch"
+    int resume_context_messages = 0; // Stored messages fed back to the provider on startup; 0 = display only
     int theme_id = 0;
+    int max_fps = 30; // Redraw rate cap while output streams in; 0 = uncapped
     std::string mcp_server_url;
     std::string scrapex_server_url;
+    // Provider id -> base URL replacing the public endpoint, e.g. a local mock server
+    std::map<std::string, std::string> base_urls;
+    // Metrics export; empty paths turn it off (see Metrics.hpp)
+    std::string metrics_json_path;
+    std::string metrics_socket_path;
+    int metrics_interval_s = 10; // How often metrics_json_path is rewritten
+    std::string trace_path; // Chrome trace JSON written on exit; empty = tracing off (see Trace.hpp)
 
     // Returns the display name for the current provider
     std::string get_display_provider() const {
@@ -34,6 +44,13 @@ struct Settings {
         return {};
     }
 
+    // Returns the configured base URL for a provider, or its public endpoint
+    std::string get_base_url(const std::string& provider_id) const {
+        auto it = base_urls.find(provider_id);
+        if (it != base_urls.end() && !it->second.empty()) return it->second;
+        return ProviderRegistry::instance().base_url(provider_id);
+    }
+
     // Sets model to the provider's default if the provider changes
     void initialize_defaults() {
         model = ProviderRegistry::instance().default_model(provider);
@@ -0,0 +1,109 @@
+#pragma once
+#include <nlohmann/json.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Set to 0 (CMake option CHATBOT_TRACING=OFF) to compile every span away
+#ifndef CHATBOT_TRACING
+#define CHATBOT_TRACING 1
+#endif
+
+// Timeline tracing in the Chrome trace event format: open the file in
+// chrome://tracing or https://ui.perfetto.dev. Each thread records finished
+// spans into a buffer of its own, so recording never contends with other
+// threads; the buffers are only merged when the trace is written. While
+// tracing is off a span costs one relaxed atomic load.
+class Tracer {
+public:
+    static Tracer& instance();
+    static bool enabled() { return CHATBOT_TRACING && enabled_.load(std::memory_order_relaxed); }
+    // Steady clock, the time base of every event
+    static int64_t now_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Starts recording; stop() writes everything recorded to `path`, if not empty
+    void start(std::string path);
+    void stop();
+    // Writes the events so far without stopping; false if the file cannot be
+    // written. Buffers of threads that have exited are released once written.
+    bool write(const std::string& path);
+    // Discards everything recorded so far
+    void clear();
+
+    // A finished span; `name` and `category` must be string literals
+    void complete(const char* name, const char* category, int64_t start_ns, int64_t duration_ns,
+                  nlohmann::json args = {});
+    // Label for the calling thread's track, e.g. "ui"
+    void set_thread_name(std::string name);
+
+private:
+    Tracer() = default;
+
+    struct Event {
+        const char* name;
+        const char* category;
+        int64_t start_ns;
+        int64_t duration_ns;
+        nlohmann::json args;
+    };
+    // One per thread; the mutex is only ever contended by write()
+    struct Buffer {
+        std::mutex mutex;
+        std::vector<Event> events;
+        std::string thread_name;
+        uint32_t tid = 0;
+        uint64_t dropped = 0;
+        std::atomic<bool> retired{false}; // Owning thread has exited
+    };
+    static constexpr size_t kMaxEventsPerThread = 1 << 18;
+
+    static inline std::atomic<bool> enabled_{false};
+    mutable std::mutex buffers_mutex_;
+    std::vector<std::shared_ptr<Buffer>> buffers_; // Outlive their threads until written or cleared
+    std::string path_;
+
+    Buffer& thread_buffer();
+};
+
+// Records the time from construction to destruction (or end()) as one
+// span on the calling thread's track. Spans nest by time, so a span opened
+// inside another shows up beneath it.
+class TraceSpan {
+public:
+    explicit TraceSpan(const char* name, const char* category = "app") : name_(name), category_(category) {
+        if (Tracer::enabled()) start_ns_ = Tracer::now_ns();
+    }
+    ~TraceSpan() { end(); }
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+    bool active() const { return start_ns_ >= 0; }
+    int64_t start_ns() const { return start_ns_; }
+
+    // Shown with the span in the viewer; ignored while not tracing
+    template <typename T>
+    void arg(const char* key, T&& value) {
+        if (active()) args_[key] = std::forward<T>(value);
+    }
+
+    // Finishes the span early; later calls do nothing
+    void end() {
+        if (!active()) return;
+        Tracer::instance().complete(name_, category_, start_ns_, Tracer::now_ns() - start_ns_, std::move(args_));
+        start_ns_ = -1;
+    }
+
+private:
+    const char* name_;
+    const char* category_;
+    int64_t start_ns_ = -1;
+    nlohmann::json args_;
+};
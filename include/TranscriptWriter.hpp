@@ -0,0 +1,70 @@
+#pragma once
+#include <string>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <ctime>
+#include <cstdint>
+
+class MetricsGauge;
+
+// Appends chat events to the transcript file from a dedicated thread.
+// Producers push onto a lock-free stack and never touch the file; the
+// writer takes everything queued at once, formats it and issues a single
+// write() on a descriptor that stays open for the writer's lifetime.
+class TranscriptWriter {
+public:
+    enum class Kind { User, AI, Chunk, Complete };
+
+    // When to fsync the transcript
+    enum class FsyncPolicy {
+        Never,    // Leave it to the OS
+        Message,  // After a batch that contains a complete message
+        Batch     // After every batch
+    };
+
+    explicit TranscriptWriter(std::string path = "chat_history.log");
+    ~TranscriptWriter();
+    TranscriptWriter(const TranscriptWriter&) = delete;
+    TranscriptWriter& operator=(const TranscriptWriter&) = delete;
+
+    // Disabled writers drop records without queuing them. The writer
+    // thread is started the first time the writer is enabled.
+    void set_enabled(bool enabled);
+    bool is_enabled() const { return enabled_.load(std::memory_order_relaxed); }
+    void set_fsync_policy(FsyncPolicy policy) { fsync_policy_.store(policy, std::memory_order_relaxed); }
+
+    // "never", "message" or "batch"; anything else maps to Never
+    static FsyncPolicy parse_fsync_policy(const std::string& name);
+
+    // Thread-safe, lock-free, never blocks on I/O
+    void append(Kind kind, std::string text);
+
+private:
+    struct Record {
+        Record* next = nullptr;
+        Kind kind;
+        std::chrono::system_clock::time_point time;
+        std::string text;
+    };
+
+    std::string path_;
+    std::atomic<Record*> head_{nullptr};
+    std::atomic<uint32_t> pending_{0}; // Bumped on every push; the writer waits on it
+    std::atomic<bool> enabled_{false};
+    std::atomic<bool> stopping_{false};
+    std::atomic<FsyncPolicy> fsync_policy_{FsyncPolicy::Never};
+    std::thread thread_;
+    std::atomic<bool> started_{false};
+    MetricsGauge& queue_depth_; // Records pushed but not yet written
+
+    // Writer-thread state
+    int fd_ = -1;
+    bool open_failed_ = false;
+    std::time_t stamp_second_ = -1;
+    std::string stamp_;
+
+    void run();
+    void write_batch(Record* newest_first);
+    void format_record(const Record& record, std::string& out);
+};
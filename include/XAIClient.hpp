@@ -14,9 +14,10 @@ concept AIProvider = requires(T a, const std::string& prompt, const std::string&
 
 class XAIClient : public BaseAIClient {
 public:
-    XAIClient() = default;
+    XAIClient() { base_url_ = ProviderRegistry::instance().base_url("xai"); }
     
     nlohmann::json build_message_history(const std::string& latest_user_msg = "") const override {
+        TraceSpan span("build_history", "client");
         std::lock_guard lock(mutex_);
         nlohmann::json messages = nlohmann::json::array();
         
@@ -57,6 +58,10 @@ public:
         std::function<void(const ApiErrorInfo& error)> on_error_cb) override;
     
     std::vector<std::string> available_models() const;
+    
+    // The chat/completions body for `messages`; no network access or locking
+    nlohmann::json build_request_body(const nlohmann::json& messages, const std::string& model,
+                                      const std::string& system_prompt, const std::string& tool_results = "") const;
 
 private:
     std::string enhance_system_prompt_with_tools(const std::string& original_prompt);
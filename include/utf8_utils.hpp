@@ -1,16 +1,146 @@
 #pragma once
 #include <string>
+#include <string_view>
 #include <vector>
+#include <cstdint>
+
+// Incremental UTF-8 decoder over explicitly bounded chunks. Input may be
+// split anywhere (an SSE read can end inside a character): a sequence left
+// incomplete at the end of a chunk is held and finished by the next one.
+// Malformed input yields U+FFFD once per maximal invalid subsequence
+// (Unicode 3.9 / WHATWG), and the byte that broke a sequence starts the
+// next one, so decoding resynchronizes immediately.
+class Utf8Decoder {
+public:
+    static constexpr uint32_t kReplacement = 0xFFFD;
+
+    // Decode the next code point from chunk[index...]; advances index.
+    // Returns false when the chunk ends inside a sequence (index is then
+    // chunk.size() and the bytes are held for the next chunk).
+    bool next(std::string_view chunk, size_t& index, uint32_t& codepoint) {
+        while (index < chunk.size()) {
+            unsigned char byte = static_cast<unsigned char>(chunk[index]);
+            if (needed_ == 0) {
+                ++index;
+                if (byte < 0x80) {
+                    codepoint = byte;
+                    return true;
+                }
+                if (!start(byte)) {
+                    codepoint = kReplacement;
+                    return true;
+                }
+                continue;
+            }
+            if (byte < lower_ || byte > upper_) {
+                // Not consumed: it begins whatever follows the bad sequence
+                reset();
+                codepoint = kReplacement;
+                return true;
+            }
+            ++index;
+            lower_ = 0x80;
+            upper_ = 0xBF;
+            codepoint_ = (codepoint_ << 6) | (byte & 0x3F);
+            if (++seen_ == needed_) {
+                codepoint = codepoint_;
+                reset();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Decode a whole chunk, calling f(codepoint) for each code point
+    template <typename F>
+    void feed(std::string_view chunk, F&& f) {
+        size_t index = 0;
+        uint32_t codepoint = 0;
+        while (next(chunk, index, codepoint)) f(codepoint);
+    }
+
+    // End of input: a held partial sequence becomes U+FFFD
+    bool finish(uint32_t& codepoint) {
+        if (needed_ == 0) return false;
+        reset();
+        codepoint = kReplacement;
+        return true;
+    }
+
+    // Bytes of an incomplete sequence held from earlier input
+    size_t pending_bytes() const { return needed_ == 0 ? 0 : seen_ + 1u; }
+
+    void reset() {
+        codepoint_ = 0;
+        needed_ = seen_ = 0;
+        lower_ = 0x80;
+        upper_ = 0xBF;
+    }
+
+private:
+    uint32_t codepoint_ = 0;
+    uint8_t needed_ = 0; // Continuation bytes in the current sequence
+    uint8_t seen_ = 0;   // ... and how many have arrived
+    uint8_t lower_ = 0x80; // Valid range of the next continuation byte; narrower
+    uint8_t upper_ = 0xBF; // after E0/ED/F0/F4 to reject overlongs and surrogates
+
+    bool start(unsigned char lead) {
+        if (lead >= 0xC2 && lead <= 0xDF) {
+            needed_ = 1;
+            codepoint_ = lead & 0x1F;
+        } else if (lead >= 0xE0 && lead <= 0xEF) {
+            if (lead == 0xE0) lower_ = 0xA0;
+            if (lead == 0xED) upper_ = 0x9F;
+            needed_ = 2;
+            codepoint_ = lead & 0x0F;
+        } else if (lead >= 0xF0 && lead <= 0xF4) {
+            if (lead == 0xF0) lower_ = 0x90;
+            if (lead == 0xF4) upper_ = 0x8F;
+            needed_ = 3;
+            codepoint_ = lead & 0x07;
+        } else {
+            return false;
+        }
+        return true;
+    }
+};
+
+// One wrapped line as a byte range of the source text
+struct WrapSpan {
+    size_t offset;
+    size_t length;
+    bool indented;   // A continuation line: draw `indent` spaces before it
+    bool hyphenated; // A word was split here: draw '-' after it
+};
+
+// Word-wrap UTF-8 text into spans of at most max_width columns; lines that
+// continue a wrapped paragraph reserve `indent` of those columns. Spaces
+// between words on a line are kept as in the source, whitespace at a break
+// is dropped, '\n' ends a line and words longer than a line are split with
+// a hyphen. Replaces the contents of `out`; no per-line allocation.
+void utf8_wrap_spans(std::string_view text, int max_width, int indent, std::vector<WrapSpan>& out);
 
 // Split a UTF-8 string into lines of at most max_width columns (not bytes).
 // Returns a vector of lines, each of which fits in max_width display columns.
+// Built on utf8_wrap_spans; continuation lines start with `indent` spaces.
 std::vector<std::string> utf8_word_wrap(const std::string& text, int max_width, int indent = 0);
 
-// Returns the display width (columns) of a UTF-8 string.
-int utf8_display_width(const std::string& s);
+// Returns the display width (columns) of a UTF-8 string, counted per
+// grapheme cluster (see utf8_next_grapheme).
+int utf8_display_width(std::string_view s);
+
+// Advance `index` past one extended grapheme cluster (UAX #29: a base with
+// its combining marks, a Hangul syllable, a flag, an emoji ZWJ sequence)
+// and return the columns the cluster occupies. Each malformed sequence is
+// one column (as U+FFFD); control characters take none.
+int utf8_next_grapheme(std::string_view text, size_t& index);
 
-// Get the next UTF-8 codepoint from a string
-uint32_t utf8_next_codepoint(const char* str, size_t& index);
+// Decode the code point at text[index] and advance past it. Never reads
+// outside `text`; malformed or truncated input yields U+FFFD and advances
+// past the invalid bytes only.
+uint32_t utf8_next_codepoint(std::string_view text, size_t& index);
 
-// Get the display width of a single codepoint
-int codepoint_width(uint32_t codepoint);
\ No newline at end of file
+// Get the display width of a single codepoint: 0 for combining, format and
+// control characters, 2 for East Asian Wide/Fullwidth (CJK, emoji), else 1.
+// Looked up in the generated unicode_width_table.hpp; independent of locale.
+int codepoint_width(uint32_t codepoint);
@@ -0,0 +1,179 @@
+#include "ChatWrapCache.hpp"
+#include "utf8_utils.hpp"
+#include <algorithm>
+
+void ChatWrapCache::set_width(int width) {
+    if (width == width_) return;
+    width_ = width;
+    invalidate();
+}
+
+void ChatWrapCache::set_user_prefix(const std::string& prefix) {
+    if (prefix == user_prefix_) return;
+    user_prefix_ = prefix;
+    invalidate();
+}
+
+void ChatWrapCache::invalidate() {
+    entries_.clear();
+    line_index_.clear();
+    index_of_.clear();
+}
+
+void ChatWrapCache::sync(const MessageHandler& messages) {
+    uint64_t prepended = messages.prepended_count();
+    if (prepended != prepended_seen_) {
+        size_t added = static_cast<size_t>(prepended - prepended_seen_);
+        prepended_seen_ = prepended;
+        if (!entries_.empty()) sync_prepended(messages, added);
+    }
+
+    // Messages are only appended or cleared, and only the newest one grows,
+    // so everything before the last cached entry is still valid
+    size_t resume = entries_.empty() ? 0 : entries_.size() - 1;
+    auto changed = messages.get_messages_from(resume);
+    if (resume > 0 && (changed.empty() || changed.front().id != entries_[resume].id)) {
+        // The store was cleared or replaced under us
+        invalidate();
+        resume = 0;
+        changed = messages.get_messages_from(0);
+    }
+
+    for (size_t i = 0; i < changed.size(); ++i) {
+        const auto& msg = changed[i];
+        size_t index = resume + i;
+        if (index < entries_.size()) {
+            auto& entry = entries_[index];
+            if (entry.id == msg.id && entry.version == msg.version) continue;
+            if (entry.id != msg.id) index_of_.erase(entry.id);
+            wrap(entry, msg);
+            line_index_.set(index, line_count(entry));
+        } else {
+            Entry entry;
+            wrap(entry, msg);
+            line_index_.push_back(line_count(entry));
+            entries_.push_back(std::move(entry));
+        }
+        index_of_[msg.id] = index;
+    }
+}
+
+void ChatWrapCache::sync_prepended(const MessageHandler& messages, size_t added) {
+    // The new messages plus the one we already have first, to confirm they line up
+    auto older = messages.get_message_range(0, added + 1);
+    if (older.size() != added + 1 || older.back().id != entries_.front().id) {
+        invalidate();
+        return;
+    }
+    std::vector<Entry> fresh(added);
+    for (size_t i = 0; i < added; ++i) {
+        wrap(fresh[i], older[i]);
+    }
+    entries_.insert(entries_.begin(), std::make_move_iterator(fresh.begin()), std::make_move_iterator(fresh.end()));
+    // Positions shifted; rebuilding the index only touches line counts
+    line_index_.clear();
+    index_of_.clear();
+    for (size_t i = 0; i < entries_.size(); ++i) {
+        line_index_.push_back(line_count(entries_[i]));
+        index_of_[entries_[i].id] = i;
+    }
+}
+
+std::optional<size_t> ChatWrapCache::find_line(uint64_t id, const std::function<bool(std::string_view)>& match) const {
+    auto it = index_of_.find(id);
+    if (it == index_of_.end()) return std::nullopt;
+    const Entry& entry = entries_[it->second];
+    size_t first = line_index_.prefix(it->second);
+    for (size_t line = 0; line < entry.lines.size(); ++line) {
+        std::string_view text = entry.lines[line];
+        if (line == 0) text.remove_prefix(std::min(entry.prefix_size, text.size()));
+        if (match(text)) return first + line;
+    }
+    return first;
+}
+
+void ChatWrapCache::wrap(Entry& entry, const ChatMessage& msg) const {
+    // Content is append-only, so while a message streams in only its last
+    // paragraph can change; earlier paragraphs keep their wrapped lines
+    bool incremental = entry.id == msg.id && entry.size > 0 && msg.content.size() >= entry.size;
+    if (incremental) {
+        entry.lines.resize(entry.tail_line);
+    } else {
+        entry.lines.clear();
+        entry.tail_offset = 0;
+        entry.tail_line = 0;
+    }
+    entry.id = msg.id;
+    entry.version = msg.version;
+    entry.size = msg.content.size();
+
+    const std::string& prefix = msg.sender == ChatMessage::Sender::User ? user_prefix_ : std::string(kAIPrefix);
+    entry.prefix_size = prefix.size();
+    int prefix_width = utf8_display_width(prefix);
+    std::string indent(prefix_width, ' ');
+    int available_width = width_ - prefix_width;
+
+    // Wrap each source line separately so continuation lines keep the hanging indent
+    std::string text = msg.content.substr(entry.tail_offset);
+    std::string_view rest = text;
+    std::vector<WrapSpan> spans;
+    size_t offset = entry.tail_offset;
+    while (!rest.empty()) {
+        entry.tail_offset = offset;
+        entry.tail_line = entry.lines.size();
+        size_t newline = rest.find('\n');
+        std::string_view source = rest.substr(0, newline);
+        if (newline == std::string_view::npos) {
+            rest = std::string_view();
+        } else {
+            rest.remove_prefix(newline + 1);
+            offset += newline + 1;
+        }
+
+        const std::string& lead = entry.tail_offset == 0 ? prefix : indent;
+        utf8_wrap_spans(source, available_width, prefix_width, spans);
+        if (spans.empty()) {
+            entry.lines.push_back(lead); // Keep paragraph breaks
+        }
+        for (size_t i = 0; i < spans.size(); ++i) {
+            const auto& span = spans[i];
+            std::string line;
+            line.reserve(lead.size() + span.length + 1);
+            if (i == 0) {
+                line = lead;
+            } else if (span.indented) {
+                line = indent;
+            }
+            line.append(source.substr(span.offset, span.length));
+            if (span.hyphenated) line += '-';
+            entry.lines.push_back(std::move(line));
+        }
+        if (newline != std::string_view::npos && rest.empty()) {
+            // Trailing newline: the next append starts a fresh paragraph
+            entry.tail_offset = offset;
+            entry.tail_line = entry.lines.size();
+        }
+    }
+}
+
+std::vector<std::string_view> ChatWrapCache::visible_lines(int scroll_offset, int rows) const {
+    std::vector<std::string_view> lines;
+    size_t total = line_index_.total();
+    if (rows <= 0 || total == 0) return lines;
+
+    // Window [first, last) in global line numbers, anchored to the bottom
+    size_t offset = std::min(static_cast<size_t>(std::max(0, scroll_offset)), total);
+    size_t last = total - offset;
+    size_t first = last > static_cast<size_t>(rows) ? last - rows : 0;
+    lines.reserve(last - first);
+
+    auto [index, line] = line_index_.find(first);
+    for (size_t remaining = last - first; remaining > 0 && index < entries_.size(); ++index, line = 0) {
+        const auto& entry = entries_[index];
+        for (; line < line_count(entry) && remaining > 0; ++line, --remaining) {
+            // The last line of every entry is the blank separator
+            lines.push_back(line < entry.lines.size() ? std::string_view(entry.lines[line]) : std::string_view());
+        }
+    }
+    return lines;
+}
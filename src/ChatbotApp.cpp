@@ -7,34 +7,55 @@
 #include "OpenAIClient.hpp"
 #include "GeminiAIClient.hpp"
 #include "MessageHandler.hpp"
+#include "ChatWrapCache.hpp"
+#include "SessionStore.hpp"
+#include "SearchIndex.hpp"
 #include "CommandLineEditor.hpp"
 #include "GlobalLogger.hpp"
 #include "ConfigManager.hpp"
 #include "SignalHandler.hpp"
+#include "EventLoop.hpp"
 #include "utf8_utils.hpp"
 #include "MCPClient.hpp"
 #include "MCPService.hpp"
 #include "MCPNotificationInterface.hpp"
 #include "MCPServerManager.hpp"
 #include "MCPToolService.hpp"
+#include "Metrics.hpp"
+#include "Trace.hpp"
 
 #include <atomic>
 #include <vector>
 #include <string>
 #include <chrono>
+#include <thread>
+#include <algorithm>
+#include <utility>
 
 namespace {
-    constexpr int kInputWinHeight = 3;
+    // Messages restored at startup, and paged in each time the view reaches the top
+    constexpr size_t kHistoryPageSize = 200;
+    constexpr const char* kSearchLabel = "Search: ";
+
+    // Screen regions redrawn independently
+    enum DirtyRegion : unsigned {
+        kDirtyChat = 1 << 0,   // Transcript rows
+        kDirtyStatus = 1 << 1, // Waiting indicator / MCP activity
+        kDirtyInput = 1 << 2,  // Input line and cursor
+        kDirtyAll = kDirtyChat | kDirtyStatus | kDirtyInput
+    };
 }
 
 class ChatbotAppImpl {
 private:
+    // First member: blocks SIGWINCH before any other thread is started
+    EventLoop event_loop_;
     ClaudeAIClient claude_client_;
     OpenAIClient openai_client_;
     GeminiAIClient gemini_client_;
 
 public:
-    std::atomic<bool> needs_redraw_{false};
+    std::atomic<unsigned> dirty_regions_{kDirtyAll};
     std::atomic<bool> waiting_for_ai_{false};
 public:
     ChatbotAppImpl()
@@ -46,164 +67,259 @@ public:
         auto load_result = config_manager_.load();
         if (load_result) {
             settings_ = *load_result;
-            get_logger().log(LogLevel::Info, std::format("Settings loaded successfully from {}", config_manager_.config_path()));
+            LOG_INFO("Settings loaded successfully from {}", config_manager_.config_path());
         } else {
-            get_logger().log(LogLevel::Error, std::format("Failed to load settings from {}: Error {}", config_manager_.config_path(), static_cast<int>(load_result.error())));
+            LOG_ERROR("Failed to load settings from {}: Error {}", config_manager_.config_path(), static_cast<int>(load_result.error()));
         }
         // Set up all AI clients using the registry and settings helpers
         xai_client_.set_api_key(settings_.xai_api_key);
         xai_client_.set_system_prompt(settings_.system_prompt);
         xai_client_.set_model(ProviderRegistry::instance().default_model("xai"));
+        xai_client_.set_base_url(settings_.get_base_url("xai"));
         xai_client_.clear_history();
 
         claude_client_.set_api_key(settings_.claude_api_key);
         claude_client_.set_system_prompt(settings_.system_prompt);
         claude_client_.set_model(ProviderRegistry::instance().default_model("claude"));
+        claude_client_.set_base_url(settings_.get_base_url("claude"));
         claude_client_.clear_history();
 
         openai_client_.set_api_key(settings_.openai_api_key);
         openai_client_.set_system_prompt(settings_.system_prompt);
         openai_client_.set_model(ProviderRegistry::instance().default_model("openai"));
+        openai_client_.set_base_url(settings_.get_base_url("openai"));
         openai_client_.clear_history();
 
         gemini_client_.set_api_key(settings_.gemini_api_key);
         gemini_client_.set_system_prompt(settings_.system_prompt);
         gemini_client_.set_model(ProviderRegistry::instance().default_model("gemini"));
+        gemini_client_.set_base_url(settings_.get_base_url("gemini"));
         gemini_client_.clear_history();
 
+        if (!settings_.trace_path.empty()) {
+            Tracer::instance().start(settings_.trace_path);
+        }
+        if (!settings_.metrics_json_path.empty() || !settings_.metrics_socket_path.empty()) {
+            metrics_exporter_ = std::make_unique<MetricsExporter>(
+                settings_.metrics_json_path, settings_.metrics_socket_path,
+                std::chrono::seconds(settings_.metrics_interval_s));
+        }
+
         // Initialize MCP server manager
         auto mcp_init_result = mcp_server_manager_.initialize("mcp_config.json");
         if (mcp_init_result.has_value()) {
-            get_logger().log(LogLevel::Info, "MCP server manager initialized successfully");
+            LOG_INFO("MCP server manager initialized successfully");
             
             // Connect to all enabled MCP servers
             auto connect_result = mcp_server_manager_.connect_all();
             if (connect_result.has_value()) {
                 auto connected_servers = mcp_server_manager_.get_connected_servers();
-                get_logger().log(LogLevel::Info, std::format("Connected to {} MCP servers", connected_servers.size()));
+                LOG_INFO("Connected to {} MCP servers", connected_servers.size());
                 for (const auto& server : connected_servers) {
-                    get_logger().log(LogLevel::Info, std::format("  - {}", server));
+                    LOG_INFO("  - {}", server);
                 }
                 
                 // Initialize MCP tool service with the server manager
                 MCPToolService::instance().initialize(&mcp_server_manager_);
-                get_logger().log(LogLevel::Info, "MCP tool service initialized");
+                LOG_INFO("MCP tool service initialized");
                 
             } else {
-                get_logger().log(LogLevel::Warning, "Some MCP servers failed to connect");
+                LOG_WARN("Some MCP servers failed to connect");
             }
         } else {
-            get_logger().log(LogLevel::Warning, "Failed to initialize MCP server manager");
+            LOG_WARN("Failed to initialize MCP server manager");
         }
 
         // Initialize legacy MCP service if configured
         if (!settings_.mcp_server_url.empty()) {
             MCPService::instance().configure(settings_.mcp_server_url);
-            get_logger().log(LogLevel::Info, std::format("Legacy MCP service configured for: {}", settings_.mcp_server_url));
+            LOG_INFO("Legacy MCP service configured for: {}", settings_.mcp_server_url);
         }
 
         // Initialize Scrapex service if configured
         if (!settings_.scrapex_server_url.empty()) {
             MCPService::instance().configure(settings_.scrapex_server_url);
-            get_logger().log(LogLevel::Info, std::format("Scrapex service configured for: {}", settings_.scrapex_server_url));
+            LOG_INFO("Scrapex service configured for: {}", settings_.scrapex_server_url);
         }
 
         SignalHandler::setup([this]() { on_exit(); });
         ui_ = std::make_unique<NCursesUI>();
         settings_panel_.set_visible(false);
+        message_handler_.set_transcript_fsync_policy(TranscriptWriter::parse_fsync_policy(settings_.chat_history_fsync));
+        message_handler_.set_transcript_enabled(settings_.store_chat_history);
+        message_handler_.set_change_callback([this]() { request_redraw(kDirtyChat); });
+        session_store_.set_provider(settings_.provider);
+        session_store_.set_enabled(settings_.store_chat_history);
+        if (settings_.store_chat_history) {
+            resume_session();
+        }
+        message_handler_.set_persist_callback([this](const ChatMessage& msg) {
+            session_store_.append(msg);
+            search_index_.add(msg.id, msg.content.str());
+        });
         
         // Setup MCP notifications
         setup_mcp_notifications();
     }
 
+    // Safe from any thread: marks regions dirty and wakes the event loop
+    void request_redraw(unsigned regions = kDirtyAll) {
+        dirty_regions_.fetch_or(regions);
+        event_loop_.wake();
+    }
+
     void setup_mcp_notifications() {
         // Set up callbacks for MCP activity notifications
         mcp_notifier_.set_activity_callback([this](const std::string& activity) {
             if (ui_) {
                 ui_->show_mcp_activity(activity);
-                needs_redraw_ = true;
+                request_redraw(kDirtyStatus);
             }
         });
         
         mcp_notifier_.set_tool_call_start_callback([this](const std::string& tool_name, const nlohmann::json& args) {
             if (ui_) {
                 ui_->show_mcp_activity(std::format("Calling tool: {}", tool_name));
-                needs_redraw_ = true;
+                request_redraw(kDirtyStatus);
             }
         });
         
         mcp_notifier_.set_tool_call_success_callback([this](const std::string& tool_name, const nlohmann::json& result) {
             if (ui_) {
                 ui_->show_mcp_activity(std::format("Tool {} completed", tool_name));
-                needs_redraw_ = true;
+                request_redraw(kDirtyStatus);
             }
         });
         
         mcp_notifier_.set_tool_call_error_callback([this](const std::string& tool_name, const std::string& error) {
             if (ui_) {
                 ui_->show_mcp_activity(std::format("Tool {} failed: {}", tool_name, error));
-                needs_redraw_ = true;
+                request_redraw(kDirtyStatus);
+            }
+        });
+        
+        mcp_notifier_.set_tool_call_progress_callback([this](const std::string& tool_name, double progress,
+                                                             std::optional<double> total, const std::string& message) {
+            if (!ui_) return;
+            std::string status = total && *total > 0
+                ? std::format("{} {:.0f}%", tool_name, 100.0 * progress / *total)
+                : std::format("{} {:g}", tool_name, progress);
+            if (!message.empty()) {
+                status += " - " + message;
             }
+            ui_->show_mcp_activity(status);
+            // The event loop coalesces redraws into max_fps frames, so the last update always shows
+            request_redraw(kDirtyStatus);
         });
         
-        // Register the notifier with MCP service
+        // Register the notifier with MCP service and every configured MCP server
         MCPService::instance().set_notification_interface(&mcp_notifier_);
+        for (const auto& server : mcp_server_manager_.get_connected_servers()) {
+            auto client = mcp_server_manager_.get_client(server);
+            if (client && client->tool_manager()) {
+                client->tool_manager()->set_notification_interface(&mcp_notifier_);
+            }
+        }
     }
 
     void run() {
-        constexpr int kGetchTimeoutMs = 100;
-        timeout(kGetchTimeoutMs); // Make getch() non-blocking
-        int last_message_count = message_handler_.message_count();
-        draw();
+        timeout(0); // getch() never blocks; the event loop says when input is ready
+        using Clock = std::chrono::steady_clock;
+        // Streamed output is coalesced into at most max_fps frames per second
+        const auto frame_interval = settings_.max_fps > 0
+            ? std::chrono::duration_cast<Clock::duration>(std::chrono::seconds(1)) / settings_.max_fps
+            : Clock::duration::zero();
+        auto next_frame = Clock::now();
+        Tracer::instance().set_thread_name("ui");
         while (running_) {
-            if (SignalHandler::check_and_clear_resize()) {
-                ui_->handle_resize();
-                needs_redraw_ = true;
+            // Sleep until input arrives, or until the next frame slot if something is already dirty
+            int wait_ms = -1;
+            if (dirty_regions_.load() != 0) {
+                auto until = std::chrono::ceil<std::chrono::milliseconds>(next_frame - Clock::now());
+                wait_ms = static_cast<int>(std::max<std::chrono::milliseconds::rep>(0, until.count()));
             }
-            int ch = getch();
-            int current_message_count = message_handler_.message_count();
-            bool need_redraw = false;
-            if (current_message_count != last_message_count) {
-                need_redraw = true;
-                last_message_count = current_message_count;
+            auto events = event_loop_.wait(wait_ms);
+            TraceSpan input_span("input", "ui");
+            unsigned dirty = 0; // Regions touched on this thread
+            if (events.resize) {
+                ui_->handle_resize();
+                dirty |= kDirtyAll;
             }
-            if (ch != ERR) {
-                // Log all keypresses for debugging
-                get_logger().log(LogLevel::Debug, std::format("Key pressed: {}", ch));
+            // Drain every pending key before redrawing once
+            for (int ch = getch(); running_ && ch != ERR; ch = getch()) {
+                if (ch == NCursesUI::kKeyPasteBegin) {
+                    // The whole paste lands in one insert and one redraw
+                    std::string pasted = ui_->read_paste();
+                    if (settings_panel_.is_visible()) continue;
+                    if (search_mode_) {
+                        search_editor_.insert(pasted);
+                        run_search();
+                        dirty |= kDirtyChat;
+                    } else {
+                        input_editor_.insert(pasted);
+                    }
+                    dirty |= kDirtyInput;
+                    continue;
+                }
+                if (ch > 0xFF) {
+                    // Text keys are not logged: a typed or pasted prompt would flood the log
+                    LOG_DEBUG("Key pressed: {}", ch);
+                }
                 if (settings_panel_.is_visible()) {
                     if (ch == 27) { // ESC
                         settings_panel_.set_visible(false);
-                        need_redraw = true;
+                        dirty |= kDirtyAll;
                         continue;
                     }
                     settings_panel_.handle_input(ch);
-                    need_redraw = true;
-                    needs_redraw_ = true;
+                    message_handler_.set_transcript_enabled(settings_.store_chat_history);
+                    session_store_.set_enabled(settings_.store_chat_history);
+                    if (settings_.store_chat_history && !session_store_.is_open()) {
+                        open_session_store();
+                    }
+                    dirty |= kDirtyAll;
+                    continue;
+                }
+                if (search_mode_ && handle_search_key(ch)) {
+                    dirty |= kDirtyChat | kDirtyInput;
                     continue;
                 }
                 switch (ch) {
                 case KEY_F(2):
-                    get_logger().log(LogLevel::Info, "F2 pressed, toggling settings panel");
+                    LOG_INFO("F2 pressed, toggling settings panel");
                     settings_panel_.set_visible(!settings_panel_.is_visible());
-                    get_logger().log(LogLevel::Debug, std::string("After toggle, settings_panel_.is_visible() = ") + (settings_panel_.is_visible() ? "true" : "false"));
-                    needs_redraw_ = true;
+                    LOG_DEBUG("After toggle, settings_panel_.is_visible() = {}", settings_panel_.is_visible());
+                    dirty |= kDirtyAll;
                     break;
                 case KEY_UP:
+                    // Moves between prompt lines first, then scrolls the chat
+                    if (input_editor_.move_line(-1)) {
+                        dirty |= kDirtyInput;
+                        break;
+                    }
                     scroll_offset_++; // We'll clamp it later in draw()
+                    dirty |= kDirtyChat;
                     break;
                 case KEY_DOWN:
+                    if (input_editor_.move_line(1)) {
+                        dirty |= kDirtyInput;
+                        break;
+                    }
                     scroll_offset_--; // Clamp later
+                    dirty |= kDirtyChat;
                     break;
                 case 10: // Enter
                 case KEY_ENTER:
                 {
                     std::string input = input_editor_.current_line();
                     if (!input.empty()) {
+                        session_store_.set_provider(settings_.provider);
                         message_handler_.push_message({ChatMessage::Sender::User, input});
                         input_editor_.add_history(input);
                         input_editor_.clear();
                         waiting_for_ai_ = true;
-                        needs_redraw_ = true; // Show waiting indicator immediately
+                        MCPToolService::instance().begin_turn();
+                        dirty |= kDirtyInput | kDirtyStatus; // Show waiting indicator immediately
                         message_handler_.push_message({ChatMessage::Sender::AI, ""}); // Add placeholder for AI response
                         std::string prompt = input;
                         std::string model_to_use = settings_.model;
@@ -225,7 +341,7 @@ public:
                                     message_handler_.append_to_last_ai_message(error_msg, true);
                                 }
                                 waiting_for_ai_ = false;
-                                needs_redraw_ = true;
+                                request_redraw(kDirtyStatus);
                             }).detach();
                         } else if (settings_.provider == "openai") {
                             openai_client_.set_api_key(settings_.openai_api_key);
@@ -245,7 +361,7 @@ public:
                                     message_handler_.append_to_last_ai_message(error_msg, true);
                                 }
                                 waiting_for_ai_ = false;
-                                needs_redraw_ = true;
+                                request_redraw(kDirtyStatus);
                             }).detach();
                         } else if (settings_.provider == "xai") {
                             xai_client_.set_api_key(settings_.xai_api_key);
@@ -258,18 +374,18 @@ public:
                                     if (is_last_chunk) {
                                         xai_client_.push_assistant_message(chunk);
                                     }
-                                    needs_redraw_ = true;
+                                    request_redraw(kDirtyChat);
                                 },
                                 [this]() {
                                     waiting_for_ai_ = false;
-                                    needs_redraw_ = true;
+                                    request_redraw(kDirtyStatus);
                                 },
                                 [this](const ApiErrorInfo& error) {
                                     std::string error_msg = std::format("[Error {}: {}]", static_cast<int>(error.code), error.message);
                                     message_handler_.append_to_last_ai_message(error_msg, true);
-                                    get_logger().log(LogLevel::Error, std::format("API Error: {} - {}", static_cast<int>(error.code), error.message));
+                                    LOG_ERROR("API Error: {} - {}", static_cast<int>(error.code), error.message);
                                     waiting_for_ai_ = false;
-                                    needs_redraw_ = true;
+                                    request_redraw(kDirtyStatus);
                                 }
                             );
                         } else if (settings_.provider == "gemini") {
@@ -290,13 +406,13 @@ public:
                                     message_handler_.append_to_last_ai_message(error_msg, true);
                                 }
                                 waiting_for_ai_ = false;
-                                needs_redraw_ = true;
+                                request_redraw(kDirtyStatus);
                             }).detach();
                         } else if (settings_.provider == "mcp") {
                             // Handle MCP server communication
                             message_handler_.append_to_last_ai_message("MCP server communication not yet implemented", true);
                             waiting_for_ai_ = false;
-                            needs_redraw_ = true;
+                            request_redraw(kDirtyStatus);
                         }
                     }
                     break;
@@ -306,67 +422,118 @@ public:
                     break;
                 case KEY_RESIZE:
                     ui_->handle_resize();
+                    dirty |= kDirtyAll;
                     break;
                 case KEY_PPAGE: // PageUp
                     scroll_offset_ += 5; // Scroll up by 5 lines
                     if (scroll_offset_ < 0) scroll_offset_ = 0;
-                    need_redraw = true;
+                    dirty |= kDirtyChat;
                     break;
                 case KEY_NPAGE: // PageDown
                     scroll_offset_ -= 5; // Scroll down by 5 lines
                     if (scroll_offset_ < 0) scroll_offset_ = 0;
-                    need_redraw = true;
+                    dirty |= kDirtyChat;
+                    break;
+                case 6: // Ctrl+F searches the scrollback
+                    search_mode_ = true;
+                    search_editor_.clear();
+                    search_terms_.clear();
+                    search_hits_.clear();
+                    dirty |= kDirtyChat | kDirtyInput;
                     break;
                 case 24: // Ctrl+X quit
                     running_ = false;
                     break;
+                case 27: // ESC aborts in-flight MCP requests while waiting
+                    // Alt+Enter arrives as ESC followed by Enter and starts a new prompt line
+                    if (int next = getch(); next == 10 || next == KEY_ENTER) {
+                        input_editor_.insert_newline();
+                        dirty |= kDirtyInput;
+                        break;
+                    } else if (next != ERR) {
+                        ungetch(next);
+                    }
+                    if (waiting_for_ai_) {
+                        cancel_mcp_requests();
+                        break;
+                    }
+                    [[fallthrough]];
                 default:
                     input_editor_.handle_input(ch);
-                    need_redraw = true;
+                    dirty |= kDirtyInput;
                     break;
             }
             }
-            if (need_redraw || needs_redraw_) {
-                draw();
-                needs_redraw_ = false;
+            input_span.end();
+            dirty_regions_.fetch_or(dirty);
+            auto now = Clock::now();
+            if (dirty_regions_.load() != 0 && now >= next_frame) {
+                draw(dirty_regions_.exchange(0));
+                next_frame = now + frame_interval;
+            }
+            if (std::exchange(older_history_wanted_, false)) {
+                load_older_history(); // The prepend triggers a redraw
             }
         }
         on_exit();
     }
 
-    void draw() {
+    void draw(unsigned regions = kDirtyAll) {
+        TraceSpan span("render", "ui");
+        auto frame_start = std::chrono::steady_clock::now();
         if (settings_panel_.is_visible()) {
             settings_panel_.draw(ui_->get_settings_win());
+            settings_shown_ = true;
             return;
         }
-        std::vector<std::string> raw_lines;
-        auto messages = message_handler_.get_messages(0, message_handler_.message_count());
-        int maxy, maxx;
-        getmaxyx(stdscr, maxy, maxx);
-        int chat_win_width = maxx - 2; // Adjust for borders if any
-        int wrap_indent = 2; // Indent for wrapped lines
-        for (const auto& msg : messages) {
-            std::string prefix = (msg.sender == ChatMessage::Sender::User) ? settings_.user_display_name + ": " : "AI: ";
-            std::istringstream iss(msg.content);
-            std::string line;
-            bool first = true;
-            while (std::getline(iss, line)) {
-                raw_lines.push_back((first ? prefix : std::string(prefix.size(), ' ')) + line);
-                first = false;
+        if (settings_shown_) {
+            // The panel covered everything; repaint the whole screen once
+            settings_shown_ = false;
+            ui_->invalidate();
+            regions = kDirtyAll;
+        }
+        if ((regions & kDirtyInput) && layout_input()) {
+            regions = kDirtyAll; // The chat window changed height
+        }
+        if (regions & kDirtyChat) {
+            // Only new or changed messages are re-wrapped; a resize changes the width and rewraps all
+            wrap_cache_.set_width(ui_->chat_text_width());
+            wrap_cache_.set_user_prefix(settings_.user_display_name + ": ");
+            wrap_cache_.sync(message_handler_);
+
+            int display_lines = ui_->chat_text_rows();
+            if (search_jump_pending_) {
+                search_jump_pending_ = !jump_to_search_hit(display_lines);
+            }
+
+            // Clamp scroll_offset_ so we never scroll past start or end
+            int max_scroll = std::max(0, static_cast<int>(wrap_cache_.total_lines()) - display_lines);
+            if (scroll_offset_ > max_scroll) scroll_offset_ = max_scroll;
+            if (scroll_offset_ < 0) scroll_offset_ = 0;
+            auto visible = wrap_cache_.visible_lines(scroll_offset_, display_lines);
+            ui_->draw_chat_window(visible, search_highlights(visible));
+            // Reached the oldest loaded message; the event loop loads the next page
+            if (scroll_offset_ == max_scroll && history_begin_ > 0) older_history_wanted_ = true;
+        }
+        if (regions & kDirtyStatus) {
+            ui_->draw_status_line(waiting_for_ai_);
+        }
+        if (regions & kDirtyInput) {
+            if (search_mode_) {
+                std::string line = kSearchLabel + search_editor_.current_line();
+                if (!search_hits_.empty()) {
+                    line += std::format("  [{}/{}]", search_hit_ + 1, search_hits_.size());
+                } else if (!search_terms_.empty()) {
+                    line += "  [no matches]";
+                }
+                ui_->draw_input_window({line}, 0, static_cast<int>(std::string_view(kSearchLabel).size()) + search_editor_.cursor_column());
+            } else {
+                int cursor_row = static_cast<int>(input_editor_.cursor_row() - input_scroll_);
+                ui_->draw_input_window(input_editor_.rows(input_scroll_, input_rows_shown_), cursor_row, input_editor_.cursor_column());
             }
         }
-        std::vector<std::string_view> lines;
-        lines.reserve(raw_lines.size());
-        for (const auto& s : raw_lines) lines.push_back(s);
-        int total_lines = ui_->draw_chat_window(lines, scroll_offset_, waiting_for_ai_);
-        // Clamp scroll_offset_ so we never scroll past start or end
-
-        int display_lines = maxy - 2;
-        int max_scroll = std::max(0, total_lines - display_lines);
-        if (scroll_offset_ > max_scroll) scroll_offset_ = max_scroll;
-        if (scroll_offset_ < 0) scroll_offset_ = 0;
-        ui_->draw_input_window(input_editor_.current_line(), input_editor_.cursor_pos());
         ui_->refresh_all();
+        frame_time_.observe(std::chrono::steady_clock::now() - frame_start);
     }
 
     void on_exit() {
@@ -375,23 +542,249 @@ public:
         if (exited) return;
         exited = true;
         config_manager_.save(settings_);
+        Tracer::instance().stop(); // Writes the trace, if one is being recorded
         running_ = false;
         // Let NCursesUI destructor handle endwin() via RAII pattern
     }
 
 private:
+    // Show the tail of the previous session; older pages load on demand.
+    // The provider only gets context back if resume_context_messages asks for it.
+    void resume_session() {
+        if (!open_session_store()) return;
+        size_t count = session_store_.record_count();
+        history_begin_ = count - std::min(count, kHistoryPageSize);
+        message_handler_.prepend_messages(session_store_.load(history_begin_, count));
+        if (settings_.resume_context_messages > 0) {
+            restore_provider_context(count);
+        }
+
+        // Make the whole stored history searchable without delaying startup
+        history_indexer_ = std::jthread([this, count](std::stop_token stop) {
+            for (size_t i = 0; i < count && !stop.stop_requested(); ++i) {
+                auto record = session_store_.record(i);
+                search_index_.add(record.id, record.content);
+            }
+        });
+        LOG_INFO("Resumed {} of {} messages from the previous session", count - history_begin_, count);
+    }
+
+    // Ids stay unique across sessions: new messages are numbered above
+    // everything stored, whether or not the stored messages are loaded
+    bool open_session_store() {
+        if (auto opened = session_store_.open(); !opened) {
+            LOG_WARN("Session history disabled: {}", opened.error());
+            return false;
+        }
+        message_handler_.set_min_next_id(session_store_.max_message_id() + 1);
+        return true;
+    }
+
+    // Feed the current provider its newest stored exchanges, at most
+    // resume_context_messages of them. Other providers' turns are left out,
+    // and so are failed turns: the error reply and the prompt behind it.
+    void restore_provider_context(size_t count) {
+        AIClientInterface* client = client_for(settings_.provider);
+        if (!client) return;
+        size_t limit = std::min(static_cast<size_t>(settings_.resume_context_messages), kHistoryPageSize);
+        std::vector<SessionStore::Record> context; // Newest first
+        bool drop_prompt = false;
+        for (size_t i = count; i > 0 && context.size() < limit; --i) {
+            auto record = session_store_.record(i - 1);
+            if (record.provider != settings_.provider) continue;
+            bool user = record.sender == ChatMessage::Sender::User;
+            if (!user && is_error_reply(record.content)) {
+                drop_prompt = true;
+                continue;
+            }
+            if (std::exchange(drop_prompt, false) && user) continue;
+            context.push_back(record);
+        }
+        // Providers expect the history to open with a user turn
+        while (!context.empty() && context.back().sender != ChatMessage::Sender::User) {
+            context.pop_back();
+        }
+        for (auto it = context.rbegin(); it != context.rend(); ++it) {
+            if (it->sender == ChatMessage::Sender::User) {
+                client->push_user_message(std::string(it->content));
+            } else {
+                client->push_assistant_message(std::string(it->content));
+            }
+        }
+        LOG_INFO("Restored {} messages of {} context", context.size(), settings_.provider);
+    }
+
+    // Failed turns are stored as "[Error 7: ...]", "[OpenAI Error 7: ...]", ...
+    static bool is_error_reply(std::string_view content) {
+        if (!content.starts_with('[') || !content.ends_with(']')) return false;
+        size_t error = content.find("Error ");
+        return error != std::string_view::npos && error < content.find(':');
+    }
+
+    void load_older_history() {
+        size_t end = history_begin_;
+        history_begin_ = end - std::min(end, kHistoryPageSize);
+        message_handler_.prepend_messages(session_store_.load(history_begin_, end));
+    }
+
+    // Size the input window to the wrapped prompt and keep the cursor row
+    // in view; true if the window changed height
+    bool layout_input() {
+        // One column stays free so the cursor fits after a full row
+        input_editor_.set_wrap_width(ui_->input_text_width() - 1);
+        size_t rows = search_mode_ ? 1 : input_editor_.row_count();
+        bool resized = ui_->set_input_rows(static_cast<int>(rows));
+        input_rows_shown_ = static_cast<size_t>(std::min<int>(static_cast<int>(rows), ui_->max_input_rows()));
+        size_t cursor_row = search_mode_ ? 0 : input_editor_.cursor_row();
+        if (cursor_row < input_scroll_) input_scroll_ = cursor_row;
+        if (cursor_row >= input_scroll_ + input_rows_shown_) input_scroll_ = cursor_row + 1 - input_rows_shown_;
+        if (input_scroll_ + input_rows_shown_ > rows) input_scroll_ = rows - input_rows_shown_;
+        return resized;
+    }
+
+    // Keys while the search prompt is open; false lets the normal handler run
+    bool handle_search_key(int ch) {
+        switch (ch) {
+            case 27: // ESC leaves search and drops the highlights
+                search_mode_ = false;
+                search_terms_.clear();
+                search_hits_.clear();
+                return true;
+            case 10:
+            case KEY_ENTER:
+            case KEY_UP:
+            case 6: // Ctrl+F
+                step_search_hit(1);
+                return true;
+            case KEY_DOWN:
+                step_search_hit(-1);
+                return true;
+            case KEY_RESIZE:
+            case KEY_PPAGE:
+            case KEY_NPAGE:
+            case 24:
+                return false;
+            default:
+                search_editor_.handle_input(ch);
+                run_search();
+                return true;
+        }
+    }
+
+    // Search as the query is typed; hits are ordered newest first
+    void run_search() {
+        std::string query = search_editor_.current_line();
+        auto start = std::chrono::steady_clock::now();
+        search_terms_ = SearchIndex::terms(query);
+        search_hits_ = search_index_.search(query);
+        std::sort(search_hits_.begin(), search_hits_.end(), [](const auto& a, const auto& b) {
+            return a.message_id != b.message_id ? a.message_id > b.message_id : a.position > b.position;
+        });
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+        LOG_DEBUG("Search '{}': {} hits in {} messages, {}us",
+                                                      query, search_hits_.size(), search_index_.document_count(), elapsed.count());
+        search_hit_ = 0;
+        search_jump_pending_ = !search_hits_.empty();
+    }
+
+    // +1 moves to the next older hit, -1 to the next newer one
+    void step_search_hit(int direction) {
+        if (search_hits_.empty()) return;
+        size_t count = search_hits_.size();
+        search_hit_ = direction > 0 ? (search_hit_ + 1) % count : (search_hit_ + count - 1) % count;
+        search_jump_pending_ = true;
+    }
+
+    // Scroll so the current hit sits mid-screen. False while the hit is in
+    // history not loaded yet: the event loop pages in one page per frame
+    // and the jump is retried on the next draw.
+    bool jump_to_search_hit(int display_lines) {
+        if (search_hit_ >= search_hits_.size() || search_terms_.empty()) return true;
+        const auto& hit = search_hits_[search_hit_];
+        if (!wrap_cache_.contains(hit.message_id)) {
+            auto stored = session_store_.is_open() ? session_store_.find_record(hit.message_id) : std::nullopt;
+            if (stored && *stored < history_begin_) {
+                older_history_wanted_ = true;
+                return false;
+            }
+            return true; // Not in the transcript at all
+        }
+        // The hit's line is the one holding the matching occurrence of the first term
+        uint32_t seen = 0;
+        auto line = wrap_cache_.find_line(hit.message_id, [&](std::string_view text) {
+            bool found = false;
+            SearchIndex::tokenize(text, [&](const std::string& term, size_t, size_t) {
+                if (!found && term == search_terms_.front() && seen++ == hit.occurrence) found = true;
+            });
+            return found;
+        });
+        if (line) {
+            int total = static_cast<int>(wrap_cache_.total_lines());
+            scroll_offset_ = std::max(0, total - (static_cast<int>(*line) + display_lines / 2 + 1));
+        }
+        return true;
+    }
+
+    std::vector<ChatHighlight> search_highlights(const std::vector<std::string_view>& rows) const {
+        std::vector<ChatHighlight> highlights;
+        if (!search_mode_ || search_terms_.empty()) return highlights;
+        for (size_t row = 0; row < rows.size(); ++row) {
+            SearchIndex::tokenize(rows[row], [&](const std::string& term, size_t offset, size_t length) {
+                if (std::find(search_terms_.begin(), search_terms_.end(), term) != search_terms_.end()) {
+                    highlights.push_back({row, offset, offset + length});
+                }
+            });
+        }
+        return highlights;
+    }
+
+    AIClientInterface* client_for(std::string_view provider) {
+        if (provider == "xai") return &xai_client_;
+        if (provider == "claude") return &claude_client_;
+        if (provider == "openai") return &openai_client_;
+        if (provider == "gemini") return &gemini_client_;
+        return nullptr;
+    }
+
+    // Abandon the current turn's MCP tool calls; the blocked call returns
+    // an error and the provider thread finishes its turn with it
+    void cancel_mcp_requests() {
+        LOG_INFO("ESC pressed, cancelling this turn's MCP tool calls");
+        MCPToolService::instance().cancel_turn();
+        ui_->show_mcp_activity("Cancelled");
+        request_redraw(kDirtyStatus);
+    }
 
     ConfigManager config_manager_;
     Settings settings_;
     SettingsPanel settings_panel_;
     XAIClient xai_client_;
     MessageHandler message_handler_;
+    SessionStore session_store_;
+    size_t history_begin_ = 0; // Oldest stored message currently loaded
+    bool older_history_wanted_ = false; // Set by draw() when scrolled to the top or a search hit is older
+    ChatWrapCache wrap_cache_;
     CommandLineEditor input_editor_;
+    size_t input_scroll_ = 0;     // First prompt row shown
+    size_t input_rows_shown_ = 1; // Prompt rows that fit in the input window
     std::unique_ptr<NCursesUI> ui_;
     std::atomic<bool> running_;
     int scroll_offset_;
     MCPCallbackNotifier mcp_notifier_;
     MCPServerManager mcp_server_manager_;
+    std::unique_ptr<MetricsExporter> metrics_exporter_;
+    MetricsHistogram& frame_time_ = MetricsRegistry::instance().histogram(
+        metric_names::kFrameTime, {}, "Time to draw and refresh one frame");
+    bool settings_shown_ = false;
+    SearchIndex search_index_;
+    CommandLineEditor search_editor_;
+    bool search_mode_ = false;
+    std::vector<std::string> search_terms_;
+    std::vector<SearchIndex::Hit> search_hits_;
+    size_t search_hit_ = 0;
+    bool search_jump_pending_ = false;
+    // Last member: stopped and joined before the store and index go away
+    std::jthread history_indexer_;
 };
 
 ChatbotApp::ChatbotApp() : impl_(std::make_unique<ChatbotAppImpl>()) {}
@@ -11,12 +11,41 @@ size_t ClaudeWriteCallback(void* contents, size_t size, size_t nmemb, void* user
     return totalSize;
 }
 
+nlohmann::json ClaudeAIClient::build_request_body(const nlohmann::json& messages, const std::string& model,
+                                                  const std::string& system_prompt, const std::string& tool_results) const {
+    nlohmann::json request_body;
+    request_body["model"] = model;
+    request_body["max_tokens"] = 4000;
+    
+    // Modified messages with tool results if available
+    nlohmann::json modified_messages = messages;
+    if (!tool_results.empty() && !messages.empty()) {
+        // Modify the last user message to include tool results
+        auto& last_msg = modified_messages.back();
+        if (last_msg.contains("content")) {
+            std::string original_content = last_msg["content"];
+            last_msg["content"] = "Here are the results from available tools:\n\n" + tool_results + "\n\nNow please respond to: " + original_content;
+        }
+    }
+    
+    request_body["messages"] = std::move(modified_messages);
+    
+    // Add system prompt if present
+    if (!system_prompt.empty()) {
+        request_body["system"] = system_prompt;
+    }
+    return request_body;
+}
+
 std::future<std::expected<std::string, ApiErrorInfo>> ClaudeAIClient::send_message(
     const nlohmann::json& messages, 
     const std::string& model) {
     
     return std::async(std::launch::async, [this, messages, model]() -> std::expected<std::string, ApiErrorInfo> {
+        TraceSpan span("send_message", "client");
+        span.arg("provider", "claude");
         std::lock_guard lock(mutex_);
+        const std::string base_url = base_url_;
         
         if (api_key_.empty()) {
             return std::unexpected(ApiErrorInfo{ApiError::ApiKeyNotSet, "API key not set"});
@@ -36,28 +65,8 @@ std::future<std::expected<std::string, ApiErrorInfo>> ClaudeAIClient::send_messa
             // Enhanced system prompt with tools
             std::string enhanced_prompt = enhance_system_prompt_with_tools(system_prompt_);
             
-            // Build request body
-            nlohmann::json request_body;
-            request_body["model"] = model.empty() ? model_ : model;
-            request_body["max_tokens"] = 4000;
-            
-            // Modified messages with tool results if available
-            nlohmann::json modified_messages = messages;
-            if (!tool_results.empty() && !messages.empty()) {
-                // Modify the last user message to include tool results
-                auto& last_msg = modified_messages.back();
-                if (last_msg.contains("content")) {
-                    std::string original_content = last_msg["content"];
-                    last_msg["content"] = "Here are the results from available tools:\n\n" + tool_results + "\n\nNow please respond to: " + original_content;
-                }
-            }
-            
-            request_body["messages"] = modified_messages;
-            
-            // Add system prompt if present
-            if (!enhanced_prompt.empty()) {
-                request_body["system"] = enhanced_prompt;
-            }
+            std::string model_to_use = model.empty() ? model_ : model;
+            nlohmann::json request_body = build_request_body(messages, model_to_use, enhanced_prompt, tool_results);
             
             // Prepare HTTP request
             CURL* curl = curl_easy_init();
@@ -76,7 +85,8 @@ std::future<std::expected<std::string, ApiErrorInfo>> ClaudeAIClient::send_messa
             
             // Set curl options
             std::string json_data = request_body.dump();
-            curl_easy_setopt(curl, CURLOPT_URL, "https://api.anthropic.com/v1/messages");
+            std::string url = base_url + "/v1/messages";
+            curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
             curl_easy_setopt(curl, CURLOPT_POSTFIELDS, json_data.c_str());
             curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, json_data.length());
             curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
@@ -85,7 +95,11 @@ std::future<std::expected<std::string, ApiErrorInfo>> ClaudeAIClient::send_messa
             curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L);
             
             // Perform request
+            TraceSpan http("http", "client");
             CURLcode res = curl_easy_perform(curl);
+            trace_curl_phases(http, curl);
+            http.end();
+            record_request_metrics("claude", model_to_use, curl, res);
             
             // Check for curl errors
             if (res != CURLE_OK) {
@@ -106,7 +120,10 @@ std::future<std::expected<std::string, ApiErrorInfo>> ClaudeAIClient::send_messa
             }
             
             // Parse response
+            TraceSpan parse("parse", "client");
             auto response_json = nlohmann::json::parse(response_string);
+            record_usage_metrics("claude", model_to_use, response_json.value("usage", nlohmann::json{}),
+                                 "input_tokens", "output_tokens");
             
             if (!response_json.contains("content") || response_json["content"].empty()) {
                 return std::unexpected(ApiErrorInfo{ApiError::MalformedResponse, "Invalid response format"});
@@ -122,12 +139,12 @@ std::future<std::expected<std::string, ApiErrorInfo>> ClaudeAIClient::send_messa
             }
             
             // Log successful interaction
-            get_logger().log(LogLevel::Info, std::format("Claude API request successful. Response length: {}", content.length()));
+            LOG_INFO("Claude API request successful. Response length: {}", content.length());
             
             return content;
             
         } catch (const std::exception& e) {
-            get_logger().log(LogLevel::Error, std::format("Claude API error: {}", e.what()));
+            LOG_ERROR("Claude API error: {}", e.what());
             return std::unexpected(ApiErrorInfo{ApiError::Unknown, std::format("Error: {}", e.what())});
         }
     });
@@ -1,51 +1,292 @@
 #include "CommandLineEditor.hpp"
+#include "utf8_utils.hpp"
 #include <curses.h>
+#include <algorithm>
 
-CommandLineEditor::CommandLineEditor() {}
+namespace {
+    // Keep line breaks and printable text; tabs become spaces
+    std::string sanitize(std::string_view text) {
+        std::string clean;
+        clean.reserve(text.size());
+        for (size_t i = 0; i < text.size(); ++i) {
+            unsigned char c = static_cast<unsigned char>(text[i]);
+            if (c == '\r') {
+                if (i + 1 < text.size() && text[i + 1] == '\n') continue;
+                clean += '\n';
+            } else if (c == '\t') {
+                clean += ' ';
+            } else if (c == '\n' || (c >= 32 && c != 127)) {
+                clean += static_cast<char>(c);
+            }
+        }
+        return clean;
+    }
+}
+
+CommandLineEditor::CommandLineEditor() {
+    row_index_.push_back(1);
+}
+
+// Clusters never span a line break, so both scans stay within the cursor line
+size_t CommandLineEditor::previous_grapheme_start() const {
+    size_t pos = buffer_.cursor();
+    if (pos == cursor_line_start_) return pos == 0 ? 0 : pos - 1;
+    std::string head = buffer_.substr(cursor_line_start_, pos - cursor_line_start_);
+    size_t start = 0;
+    for (size_t i = 0; i < head.size();) {
+        start = i;
+        utf8_next_grapheme(head, i);
+    }
+    return cursor_line_start_ + start;
+}
+
+size_t CommandLineEditor::next_grapheme_end() const {
+    size_t pos = buffer_.cursor();
+    size_t line_end = cursor_line_start_ + lines_[cursor_line_].length;
+    if (pos == line_end) return std::min(pos + 1, buffer_.size());
+    std::string tail = buffer_.substr(pos, line_end - pos);
+    size_t end = 0;
+    utf8_next_grapheme(tail, end);
+    return pos + end;
+}
 
 void CommandLineEditor::handle_input(int ch) {
     // Left/Right navigation, Home/End, Delete, Backspace, Insert, Printable
     switch (ch) {
         case KEY_LEFT:
-            if (cursor_pos_ > 0) --cursor_pos_;
+            move_to(previous_grapheme_start());
             break;
         case KEY_RIGHT:
-            if (cursor_pos_ < (int)buffer_.size()) ++cursor_pos_;
+            move_to(next_grapheme_end());
             break;
         case KEY_HOME:
-            cursor_pos_ = 0;
+            move_to(cursor_line_start_);
             break;
         case KEY_END:
-            cursor_pos_ = buffer_.size();
+            move_to(cursor_line_start_ + lines_[cursor_line_].length);
             break;
         case KEY_DC: // Delete key
-            if (cursor_pos_ < (int)buffer_.size()) buffer_.erase(cursor_pos_, 1);
+            erase_after(next_grapheme_end() - buffer_.cursor());
             break;
         case 127: case KEY_BACKSPACE: case 8: // Backspace
-            if (cursor_pos_ > 0 && !buffer_.empty()) {
-                buffer_.erase(cursor_pos_-1, 1);
-                --cursor_pos_;
-            }
+            erase_before(buffer_.cursor() - previous_grapheme_start());
             break;
         default:
-            if (ch >= 32 && ch <= 126) { // Printable ASCII
-                buffer_.insert(cursor_pos_, 1, static_cast<char>(ch));
-                ++cursor_pos_;
+            // Printable ASCII, or one byte of a UTF-8 sequence
+            if ((ch >= 32 && ch <= 126) || (ch >= 0x80 && ch <= 0xFF)) {
+                buffer_.insert(static_cast<char>(ch));
+                ++lines_[cursor_line_].length;
+                rewrap(cursor_line_, cursor_line_start_);
             }
             break;
     }
-    // Clamp cursor position
-    if (cursor_pos_ > (int)buffer_.size()) cursor_pos_ = buffer_.size();
-    if (cursor_pos_ < 0) cursor_pos_ = 0;
+}
+
+void CommandLineEditor::insert_newline() {
+    insert("\n");
+}
+
+void CommandLineEditor::insert(std::string_view text) {
+    std::string clean = sanitize(text);
+    if (clean.empty()) return;
+    size_t offset = buffer_.cursor() - cursor_line_start_;
+    size_t tail = lines_[cursor_line_].length - offset;
+    buffer_.insert(clean);
+
+    size_t newline = clean.find('\n');
+    Line& line = lines_[cursor_line_];
+    if (newline == std::string::npos) {
+        line.length += clean.size();
+        rewrap(cursor_line_, cursor_line_start_);
+        return;
+    }
+    // Split the cursor line: its head keeps the text up to the first break,
+    // the text after the cursor moves to the last inserted line
+    line.length = offset + newline;
+    std::vector<Line> added;
+    size_t start = newline + 1;
+    for (size_t next = clean.find('\n', start); next != std::string::npos; next = clean.find('\n', start)) {
+        added.push_back(Line{next - start});
+        start = next + 1;
+    }
+    added.push_back(Line{clean.size() - start + tail});
+    lines_.insert(lines_.begin() + static_cast<std::ptrdiff_t>(cursor_line_ + 1), added.begin(), added.end());
+    row_index_.insert(cursor_line_ + 1, std::vector<size_t>(added.size(), 1));
+    // Wrap the head and every new line; the lines around them keep their rows
+    size_t start_of_line = cursor_line_start_;
+    for (size_t i = cursor_line_; i <= cursor_line_ + added.size(); ++i) {
+        rewrap(i, start_of_line);
+        start_of_line += lines_[i].length + 1;
+    }
+    cursor_line_ += added.size();
+    cursor_line_start_ = buffer_.cursor() - (clean.size() - start);
+}
+
+void CommandLineEditor::erase_before(size_t n) {
+    if (n == 0) return;
+    if (buffer_.cursor() == cursor_line_start_) {
+        if (cursor_line_ == 0) return;
+        // Deleting the line break joins this line onto the previous one
+        Line& previous = lines_[cursor_line_ - 1];
+        cursor_line_start_ -= previous.length + 1;
+        previous.length += lines_[cursor_line_].length;
+        lines_.erase(lines_.begin() + static_cast<std::ptrdiff_t>(cursor_line_));
+        row_index_.erase(cursor_line_);
+        --cursor_line_;
+        buffer_.erase_before(1);
+        rewrap(cursor_line_, cursor_line_start_);
+        return;
+    }
+    lines_[cursor_line_].length -= n;
+    buffer_.erase_before(n);
+    rewrap(cursor_line_, cursor_line_start_);
+}
+
+void CommandLineEditor::erase_after(size_t n) {
+    if (n == 0) return;
+    Line& line = lines_[cursor_line_];
+    if (buffer_.cursor() == cursor_line_start_ + line.length) {
+        if (cursor_line_ + 1 >= lines_.size()) return;
+        line.length += lines_[cursor_line_ + 1].length;
+        lines_.erase(lines_.begin() + static_cast<std::ptrdiff_t>(cursor_line_ + 1));
+        row_index_.erase(cursor_line_ + 1);
+        buffer_.erase_after(1);
+        rewrap(cursor_line_, cursor_line_start_);
+        return;
+    }
+    line.length -= n;
+    buffer_.erase_after(n);
+    rewrap(cursor_line_, cursor_line_start_);
+}
+
+void CommandLineEditor::move_to(size_t pos) {
+    pos = std::min(pos, buffer_.size());
+    buffer_.move_to(pos);
+    while (pos < cursor_line_start_) {
+        --cursor_line_;
+        cursor_line_start_ -= lines_[cursor_line_].length + 1;
+    }
+    while (pos > cursor_line_start_ + lines_[cursor_line_].length) {
+        cursor_line_start_ += lines_[cursor_line_].length + 1;
+        ++cursor_line_;
+    }
+}
+
+bool CommandLineEditor::move_line(int direction) {
+    if (direction < 0 ? cursor_line_ == 0 : cursor_line_ + 1 >= lines_.size()) return false;
+    // Keep the display column where the target line is long enough
+    std::string head = buffer_.substr(cursor_line_start_, buffer_.cursor() - cursor_line_start_);
+    int column = utf8_display_width(head);
+    size_t target = direction < 0 ? cursor_line_ - 1 : cursor_line_ + 1;
+    size_t target_start = direction < 0 ? cursor_line_start_ - lines_[target].length - 1
+                                        : cursor_line_start_ + lines_[cursor_line_].length + 1;
+    std::string text = line_text(target);
+    size_t offset = 0;
+    for (int width = 0; offset < text.size();) {
+        size_t next = offset;
+        width += utf8_next_grapheme(text, next);
+        if (width > column) break;
+        offset = next;
+    }
+    move_to(target_start + offset);
+    return true;
+}
+
+int CommandLineEditor::cursor_column() const {
+    auto [row, row_start] = cursor_row_in_line();
+    std::string head = buffer_.substr(cursor_line_start_ + row_start, buffer_.cursor() - cursor_line_start_ - row_start);
+    return utf8_display_width(head);
+}
+
+// Walks from the cursor line, so lines near the cursor are cheap to find
+size_t CommandLineEditor::line_start(size_t line) const {
+    size_t start = cursor_line_start_;
+    for (size_t i = cursor_line_; i > line; --i) start -= lines_[i - 1].length + 1;
+    for (size_t i = cursor_line_; i < line; ++i) start += lines_[i].length + 1;
+    return start;
+}
+
+std::string CommandLineEditor::line_text(size_t line) const {
+    return buffer_.substr(line_start(line), lines_[line].length);
+}
+
+void CommandLineEditor::set_wrap_width(int columns) {
+    columns = std::max(1, columns);
+    if (columns == wrap_width_) return;
+    wrap_width_ = columns;
+    size_t start = 0;
+    for (size_t i = 0; i < lines_.size(); ++i) {
+        rewrap(i, start);
+        start += lines_[i].length + 1;
+    }
+}
+
+void CommandLineEditor::rewrap(size_t line, size_t start) {
+    auto& row_starts = lines_[line].row_starts;
+    row_starts.clear();
+    // Break on display width alone; a word is split rather than moved
+    std::string text = buffer_.substr(start, lines_[line].length);
+    row_starts.push_back(0);
+    int width = 0;
+    for (size_t i = 0; i < text.size();) {
+        size_t at = i;
+        int w = utf8_next_grapheme(text, i);
+        if (width > 0 && width + w > wrap_width_) {
+            row_starts.push_back(static_cast<uint32_t>(at));
+            width = 0;
+        }
+        width += w;
+    }
+    row_index_.set(line, row_starts.size());
+}
+
+std::pair<size_t, size_t> CommandLineEditor::cursor_row_in_line() const {
+    const auto& row_starts = lines_[cursor_line_].row_starts;
+    size_t offset = buffer_.cursor() - cursor_line_start_;
+    auto it = std::upper_bound(row_starts.begin(), row_starts.end(), static_cast<uint32_t>(offset));
+    size_t row = static_cast<size_t>(it - row_starts.begin()) - 1;
+    return {row, row_starts[row]};
+}
+
+size_t CommandLineEditor::row_count() const {
+    return row_index_.total();
+}
+
+size_t CommandLineEditor::cursor_row() const {
+    return row_index_.prefix(cursor_line_) + cursor_row_in_line().first;
+}
+
+std::vector<std::string> CommandLineEditor::rows(size_t first, size_t count) const {
+    std::vector<std::string> out;
+    auto [line, row] = row_index_.find(first);
+    if (line >= lines_.size()) return out;
+    size_t start = line_start(line);
+    for (size_t i = line, k = row; i < lines_.size() && out.size() < count; start += lines_[i].length + 1, ++i, k = 0) {
+        const auto& row_starts = lines_[i].row_starts;
+        for (; k < row_starts.size() && out.size() < count; ++k) {
+            size_t end = k + 1 < row_starts.size() ? row_starts[k + 1] : lines_[i].length;
+            out.push_back(buffer_.substr(start + row_starts[k], end - row_starts[k]));
+        }
+    }
+    return out;
+}
+
+void CommandLineEditor::assign(std::string_view text) {
+    clear();
+    insert(text);
 }
 
 std::string CommandLineEditor::current_line() const {
-    return buffer_;
+    return buffer_.str();
 }
 
 void CommandLineEditor::clear() {
     buffer_.clear();
-    cursor_pos_ = 0;
+    lines_.assign(1, Line{});
+    row_index_.clear();
+    row_index_.push_back(1);
+    cursor_line_ = 0;
+    cursor_line_start_ = 0;
     history_index_ = -1;
 }
 
@@ -57,17 +298,21 @@ void CommandLineEditor::add_history(const std::string& line) {
 }
 
 std::string CommandLineEditor::history_up() {
-    if (history_.empty() || history_index_ <= 0) return buffer_;
+    if (history_.empty() || history_index_ <= 0) return buffer_.str();
     --history_index_;
-    buffer_ = history_[history_index_];
-    return buffer_;
+    int index = history_index_;
+    assign(history_[index]);
+    history_index_ = index;
+    return history_[index];
 }
 
 std::string CommandLineEditor::history_down() {
-    if (history_.empty() || history_index_ >= (int)history_.size() - 1) return buffer_;
+    if (history_.empty() || history_index_ >= (int)history_.size() - 1) return buffer_.str();
     ++history_index_;
-    buffer_ = history_[history_index_];
-    return buffer_;
+    int index = history_index_;
+    assign(history_[index]);
+    history_index_ = index;
+    return history_[index];
 }
 
 const std::vector<std::string>& CommandLineEditor::history() const {
@@ -23,9 +23,17 @@ std::expected<Settings, ConfigError> ConfigManager::load() {
         settings.provider = j.value("provider", "xai");
         settings.model = j.value("model", settings.provider == "xai" ? "grok-3-beta" : "claude");
         settings.store_chat_history = j.value("store_chat_history", true);
+        settings.chat_history_fsync = j.value("chat_history_fsync", "never");
+        settings.resume_context_messages = j.value("resume_context_messages", 0);
         settings.theme_id = j.value("theme_id", 0);
+        settings.max_fps = j.value("max_fps", 30);
         settings.mcp_server_url = j.value("mcp_server_url", "ws://localhost:9092");
         settings.scrapex_server_url = j.value("scrapex_server_url", "ws://localhost:9093");
+        settings.base_urls = j.value("base_urls", std::map<std::string, std::string>{});
+        settings.metrics_json_path = j.value("metrics_json_path", "");
+        settings.metrics_socket_path = j.value("metrics_socket_path", "");
+        settings.metrics_interval_s = j.value("metrics_interval_s", 10);
+        settings.trace_path = j.value("trace_path", "");
         return settings;
     } catch (const nlohmann::json::parse_error& e) {
         return std::unexpected(ConfigError::JsonParseError);
@@ -49,9 +57,17 @@ std::expected<void, ConfigError> ConfigManager::save(const Settings& settings) {
         {"provider", settings.provider},
         {"model", settings.model},
         {"store_chat_history", settings.store_chat_history},
+        {"chat_history_fsync", settings.chat_history_fsync},
+        {"resume_context_messages", settings.resume_context_messages},
         {"theme_id", settings.theme_id},
+        {"max_fps", settings.max_fps},
         {"mcp_server_url", settings.mcp_server_url},
-        {"scrapex_server_url", settings.scrapex_server_url}
+        {"scrapex_server_url", settings.scrapex_server_url},
+        {"base_urls", settings.base_urls},
+        {"metrics_json_path", settings.metrics_json_path},
+        {"metrics_socket_path", settings.metrics_socket_path},
+        {"metrics_interval_s", settings.metrics_interval_s},
+        {"trace_path", settings.trace_path}
     };
     try {
         ofs << j.dump(2);
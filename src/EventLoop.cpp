@@ -0,0 +1,83 @@
+#include "EventLoop.hpp"
+#include <stdexcept>
+#include <format>
+#include <cerrno>
+#include <cstring>
+#include <cstdint>
+#include <csignal>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+
+namespace {
+    constexpr int kMaxEvents = 4;
+
+    [[noreturn]] void throw_errno(const char* what) {
+        throw std::runtime_error(std::format("EventLoop: {} failed: {}", what, std::strerror(errno)));
+    }
+}
+
+EventLoop::EventLoop() {
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGWINCH);
+    if (int rc = pthread_sigmask(SIG_BLOCK, &mask, nullptr); rc != 0) {
+        errno = rc;
+        throw_errno("pthread_sigmask");
+    }
+
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0) throw_errno("epoll_create1");
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd_ < 0) throw_errno("eventfd");
+    signal_fd_ = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (signal_fd_ < 0) throw_errno("signalfd");
+
+    for (int fd : {STDIN_FILENO, wake_fd_, signal_fd_}) {
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) != 0) {
+            if (fd == STDIN_FILENO && errno == EPERM) {
+                stdin_always_ready_ = true; // Regular file or /dev/null: reads never block
+                continue;
+            }
+            throw_errno("epoll_ctl");
+        }
+    }
+}
+
+EventLoop::~EventLoop() {
+    for (int fd : {signal_fd_, wake_fd_, epoll_fd_}) {
+        if (fd >= 0) close(fd);
+    }
+}
+
+EventLoop::Events EventLoop::wait(int timeout_ms) {
+    Events events;
+    epoll_event ready[kMaxEvents];
+    int n = epoll_wait(epoll_fd_, ready, kMaxEvents, stdin_always_ready_ ? 0 : timeout_ms);
+    events.input = stdin_always_ready_;
+    for (int i = 0; i < n; ++i) {
+        int fd = ready[i].data.fd;
+        if (fd == STDIN_FILENO) {
+            events.input = true; // Left for getch() to drain
+        } else if (fd == wake_fd_) {
+            uint64_t count;
+            while (read(wake_fd_, &count, sizeof(count)) > 0) {}
+            events.wakeup = true;
+        } else if (fd == signal_fd_) {
+            signalfd_siginfo info;
+            while (read(signal_fd_, &info, sizeof(info)) > 0) {}
+            events.resize = true;
+        }
+    }
+    return events;
+}
+
+void EventLoop::wake() {
+    uint64_t one = 1;
+    // EAGAIN only means the counter is saturated, i.e. a wakeup is already pending
+    [[maybe_unused]] auto written = write(wake_fd_, &one, sizeof(one));
+}
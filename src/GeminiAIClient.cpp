@@ -5,7 +5,6 @@
 #include <nlohmann/json.hpp>
 #include <regex>
 
-const std::string GeminiAIClient::BASE_URL = "https://generativelanguage.googleapis.com";
 const std::string GeminiAIClient::API_VERSION = "v1beta";
 
 size_t GeminiWriteCallback(void* contents, size_t size, size_t nmemb, void* userp) {
@@ -16,9 +15,11 @@ size_t GeminiWriteCallback(void* contents, size_t size, size_t nmemb, void* user
 
 GeminiAIClient::GeminiAIClient() {
     model_ = "gemini-1.5-pro";
+    base_url_ = ProviderRegistry::instance().base_url("gemini");
 }
 
 nlohmann::json GeminiAIClient::build_message_history(const std::string& latest_user_msg) const {
+    TraceSpan span("build_history", "client");
     std::lock_guard lock(mutex_);
     auto history = conversation_history_;
     if (!latest_user_msg.empty()) {
@@ -32,7 +33,10 @@ std::future<std::expected<std::string, ApiErrorInfo>> GeminiAIClient::send_messa
     const std::string& model) {
     
     return std::async(std::launch::async, [this, messages, model]() -> std::expected<std::string, ApiErrorInfo> {
+        TraceSpan span("send_message", "client");
+        span.arg("provider", "gemini");
         std::lock_guard lock(mutex_);
+        const std::string base_url = base_url_;
         
         if (api_key_.empty()) {
             return std::unexpected(ApiErrorInfo{ApiError::ApiKeyNotSet, "API key not set"});
@@ -79,17 +83,18 @@ std::future<std::expected<std::string, ApiErrorInfo>> GeminiAIClient::send_messa
             }
             
             // Make API request
-            std::string url = build_request_url(model.empty() ? model_ : model);
-            auto response = make_api_request(url, request_body);
+            std::string model_to_use = model.empty() ? model_ : model;
+            std::string url = build_request_url(base_url, model_to_use);
+            auto response = make_api_request(url, request_body, model_to_use);
             
             if (!response) {
                 return std::unexpected(response.error());
             }
             
-            return parse_response(response.value());
+            return parse_response(response.value(), model_to_use);
             
         } catch (const std::exception& e) {
-            get_logger().log(LogLevel::Error, std::format("GeminiAIClient::send_message exception: {}", e.what()));
+            LOG_ERROR("GeminiAIClient::send_message exception: {}", e.what());
             return std::unexpected(ApiErrorInfo{ApiError::CurlRequestFailed, std::string("Request failed: ") + e.what()});
         }
     });
@@ -120,9 +125,9 @@ void GeminiAIClient::send_message_stream(
     }).detach();
 }
 
-std::string GeminiAIClient::build_request_url(const std::string& model) const {
+std::string GeminiAIClient::build_request_url(const std::string& base_url, const std::string& model) const {
     return std::format("{}/{}/models/{}:generateContent?key={}", 
-                      BASE_URL, API_VERSION, model, api_key_);
+                      base_url, API_VERSION, model, api_key_);
 }
 
 nlohmann::json GeminiAIClient::build_request_body(const nlohmann::json& messages) const {
@@ -162,9 +167,12 @@ nlohmann::json GeminiAIClient::build_request_body(const nlohmann::json& messages
     return request_body;
 }
 
-std::expected<std::string, ApiErrorInfo> GeminiAIClient::parse_response(const std::string& response) const {
+std::expected<std::string, ApiErrorInfo> GeminiAIClient::parse_response(const std::string& response, const std::string& model) const {
+    TraceSpan span("parse", "client");
     try {
         auto json_response = nlohmann::json::parse(response);
+        record_usage_metrics("gemini", model, json_response.value("usageMetadata", nlohmann::json{}),
+                             "promptTokenCount", "candidatesTokenCount");
         
         if (json_response.contains("error")) {
             auto error = json_response["error"];
@@ -185,12 +193,13 @@ std::expected<std::string, ApiErrorInfo> GeminiAIClient::parse_response(const st
         return std::unexpected(ApiErrorInfo{ApiError::InvalidResponse, "No valid response content found"});
         
     } catch (const std::exception& e) {
-        get_logger().log(LogLevel::Error, std::format("GeminiAIClient::parse_response exception: {}", e.what()));
+        LOG_ERROR("GeminiAIClient::parse_response exception: {}", e.what());
         return std::unexpected(ApiErrorInfo{ApiError::InvalidResponse, std::string("Failed to parse response: ") + e.what()});
     }
 }
 
-std::expected<std::string, ApiErrorInfo> GeminiAIClient::make_api_request(const std::string& url, const nlohmann::json& request_body) const {
+std::expected<std::string, ApiErrorInfo> GeminiAIClient::make_api_request(const std::string& url, const nlohmann::json& request_body,
+                                                                          const std::string& model) const {
     CURL* curl = curl_easy_init();
     if (!curl) {
         return std::unexpected(ApiErrorInfo{ApiError::CurlInitFailed, "Failed to initialize curl"});
@@ -210,10 +219,14 @@ std::expected<std::string, ApiErrorInfo> GeminiAIClient::make_api_request(const
     curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L);
     curl_easy_setopt(curl, CURLOPT_USERAGENT, "ChatCurses/1.0");
     
-    get_logger().log(LogLevel::Debug, std::format("GeminiAIClient::make_api_request - URL: {}", url));
-    get_logger().log(LogLevel::Debug, std::format("GeminiAIClient::make_api_request - Request: {}", request_body_str));
+    LOG_DEBUG("GeminiAIClient::make_api_request - URL: {}", url);
+    LOG_DEBUG("GeminiAIClient::make_api_request - Request: {}", request_body_str);
     
+    TraceSpan http("http", "client");
     CURLcode res = curl_easy_perform(curl);
+    trace_curl_phases(http, curl);
+    http.end();
+    record_request_metrics("gemini", model, curl, res);
     
     long response_code;
     curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
@@ -223,12 +236,12 @@ std::expected<std::string, ApiErrorInfo> GeminiAIClient::make_api_request(const
     
     if (res != CURLE_OK) {
         std::string error_msg = std::format("curl_easy_perform() failed: {}", curl_easy_strerror(res));
-        get_logger().log(LogLevel::Error, std::format("GeminiAIClient::make_api_request - {}", error_msg));
+        LOG_ERROR("GeminiAIClient::make_api_request - {}", error_msg);
         return std::unexpected(ApiErrorInfo{ApiError::CurlRequestFailed, error_msg});
     }
     
-    get_logger().log(LogLevel::Debug, std::format("GeminiAIClient::make_api_request - Response code: {}", response_code));
-    get_logger().log(LogLevel::Debug, std::format("GeminiAIClient::make_api_request - Response: {}", response_data));
+    LOG_DEBUG("GeminiAIClient::make_api_request - Response code: {}", response_code);
+    LOG_DEBUG("GeminiAIClient::make_api_request - Response: {}", response_data);
     
     if (response_code != 200) {
         std::string error_msg = std::format("HTTP error: {}", response_code);
@@ -9,9 +9,76 @@
 #include <cerrno>
 #include <cstring>
 #include <cstdlib>
+#include <charconv>
+#include <optional>
+#include <string_view>
+#include <algorithm>
 #include "MCPResourceManager.hpp"
 #include "MCPToolManager.hpp"
 #include "MCPPromptManager.hpp"
+#include "MCPStdioFramer.hpp"
+#include "Metrics.hpp"
+
+namespace {
+    // Requests awaiting a response, across every MCP server
+    MetricsGauge& pending_gauge() {
+        static MetricsGauge& gauge = MetricsRegistry::instance().gauge(
+            metric_names::kMcpPending, {}, "MCP requests awaiting a response");
+        return gauge;
+    }
+
+    size_t skip_space(std::string_view text, size_t pos) {
+        while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\r' || text[pos] == '\n')) ++pos;
+        return pos;
+    }
+
+    // The top-level "id" of a response, found by scanning the raw text so a
+    // late reply to an abandoned request (possibly megabytes of result) is
+    // dropped without being parsed. nullopt for requests and notifications,
+    // non-integer or escaped ids, and anything malformed; those take the
+    // normal path.
+    std::optional<std::string> peek_response_id(std::string_view text) {
+        std::optional<std::string> id;
+        int depth = 0;
+        for (size_t i = 0; i < text.size(); ++i) {
+            char c = text[i];
+            if (c == '{' || c == '[') {
+                ++depth;
+            } else if (c == '}' || c == ']') {
+                --depth;
+            } else if (c == '"') {
+                size_t end = i + 1;
+                while (end < text.size() && text[end] != '"') end += text[end] == '\\' ? 2 : 1;
+                if (end >= text.size()) return std::nullopt;
+                size_t colon = skip_space(text, end + 1);
+                if (depth == 1 && colon < text.size() && text[colon] == ':') {
+                    std::string_view key = text.substr(i + 1, end - i - 1);
+                    if (key == "method") return std::nullopt;
+                    if (key == "id") {
+                        size_t value = skip_space(text, colon + 1);
+                        if (value < text.size() && text[value] == '"') {
+                            size_t close = text.find('"', value + 1);
+                            if (close == std::string_view::npos) return std::nullopt;
+                            std::string_view raw = text.substr(value + 1, close - value - 1);
+                            if (raw.find('\\') != std::string_view::npos) return std::nullopt;
+                            id = std::string(raw);
+                        } else {
+                            int64_t number = 0;
+                            auto [ptr, ec] = std::from_chars(text.data() + value, text.data() + text.size(), number);
+                            if (ec != std::errc() || (ptr < text.data() + text.size() &&
+                                                      (*ptr == '.' || *ptr == 'e' || *ptr == 'E'))) {
+                                return std::nullopt;
+                            }
+                            id = std::to_string(number);
+                        }
+                    }
+                }
+                i = end;
+            }
+        }
+        return id;
+    }
+}
 
 MCPClient::MCPClient(const std::string& server_url)
     : server_url_(server_url), is_stdio_connection_(false) {
@@ -41,6 +108,8 @@ MCPClient::~MCPClient() {
     resource_manager_.reset();
     tool_manager_.reset();
     prompt_manager_.reset();
+    std::lock_guard lock(pending_requests_mutex_);
+    pending_gauge().add(-static_cast<int64_t>(pending_requests_.size()));
 }
 
 // AIClientInterface implementation
@@ -59,6 +128,17 @@ void MCPClient::set_model(const std::string& model) {
     model_ = model;
 }
 
+void MCPClient::set_base_url(const std::string& url) {
+    std::lock_guard lock(mutex_);
+    server_url_ = url;
+}
+
+std::string MCPClient::server_label() const {
+    std::lock_guard lock(mutex_);
+    if (server_info_ && !server_info_->name.empty()) return server_info_->name;
+    return is_stdio_connection_ ? "stdio" : server_url_;
+}
+
 void MCPClient::clear_history() {
     std::lock_guard lock(mutex_);
     conversation_history_.clear();
@@ -180,24 +260,20 @@ void MCPClient::send_message_stream(
 void MCPClient::setup_stdio_connection() {
     stdio_read_thread_running_ = true;
     stdio_read_thread_ = std::thread([this]() {
-        char buffer[4096];
-        std::string current_message_buffer;
+        char buffer[65536];
+        MCPStdioFramer framer;
+        std::string message;
         while (stdio_read_thread_running_) {
-            ssize_t bytes_read = read(stdout_fd_, buffer, sizeof(buffer) - 1);
+            ssize_t bytes_read = read(stdout_fd_, buffer, sizeof(buffer));
             if (bytes_read > 0) {
-                buffer[bytes_read] = '\0';
-                current_message_buffer += buffer;
-                
                 // MCP messages are newline-delimited JSON
-                size_t newline_pos;
-                while ((newline_pos = current_message_buffer.find('\n')) != std::string::npos) {
-                    std::string message = current_message_buffer.substr(0, newline_pos);
-                    current_message_buffer.erase(0, newline_pos + 1);
+                framer.feed(std::string_view(buffer, static_cast<size_t>(bytes_read)), [&](std::string_view line) {
+                    message.assign(line);
                     handle_message(message);
-                }
+                });
             } else if (bytes_read == 0) {
                 // EOF, pipe closed
-                get_logger().log(LogLevel::Info, "STDIO connection closed by server.");
+                LOG_INFO("STDIO connection closed by server.");
                 stdio_read_thread_running_ = false;
                 connection_state_ = MCPConnectionState::Disconnected;
             } else if (bytes_read == -1) {
@@ -205,7 +281,7 @@ void MCPClient::setup_stdio_connection() {
                     // No data available, try again later
                     std::this_thread::sleep_for(std::chrono::milliseconds(10));
                 } else {
-                    get_logger().log(LogLevel::Error, std::format("Error reading from stdout pipe: {}", strerror(errno)));
+                    LOG_ERROR("Error reading from stdout pipe: {}", strerror(errno));
                     stdio_read_thread_running_ = false;
                     connection_state_ = MCPConnectionState::Error;
                 }
@@ -214,6 +290,23 @@ void MCPClient::setup_stdio_connection() {
     });
 }
 
+void MCPClient::send_stdio(std::string_view message) {
+    std::string frame;
+    MCPStdioFramer::append_frame(frame, message);
+    // One message per locked write loop so concurrent senders never interleave
+    std::lock_guard lock(stdio_write_mutex_);
+    size_t written = 0;
+    while (written < frame.size()) {
+        ssize_t n = write(stdin_fd_, frame.data() + written, frame.size() - written);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            LOG_ERROR("Error writing to stdin pipe: {}", strerror(errno));
+            return;
+        }
+        written += static_cast<size_t>(n);
+    }
+}
+
 // Connection management
 std::future<std::expected<void, ApiErrorInfo>> MCPClient::connect() {
     return std::async(std::launch::async, [this]() -> std::expected<void, ApiErrorInfo> {
@@ -229,7 +322,7 @@ std::future<std::expected<void, ApiErrorInfo>> MCPClient::connect() {
         if (is_stdio_connection_) {
             // For stdio, connection is established when process is spawned
             // Just need to initialize MCP protocol
-            get_logger().log(LogLevel::Info, "STDIO MCP client connecting...");
+            LOG_INFO("STDIO MCP client connecting...");
         } else {
             // Connect WebSocket
             ws_->setUrl(server_url_);
@@ -255,7 +348,7 @@ std::future<std::expected<void, ApiErrorInfo>> MCPClient::connect() {
         }
         
         connection_state_ = MCPConnectionState::Connected;
-        get_logger().log(LogLevel::Info, "MCP connection established");
+        LOG_INFO("MCP connection established");
         
         return {};
     });
@@ -281,7 +374,7 @@ std::future<std::expected<void, ApiErrorInfo>> MCPClient::disconnect() {
         cleanup_connection();
         connection_state_ = MCPConnectionState::Disconnected;
         
-        get_logger().log(LogLevel::Info, "MCP connection closed");
+        LOG_INFO("MCP connection closed");
         return {};
     });
 }
@@ -345,18 +438,22 @@ std::future<std::expected<void, ApiErrorInfo>> MCPClient::initialize_connection(
         auto initialized_notification = MCPProtocolMessages::create_initialized_notification();
         send_notification(initialized_notification);
         
-        get_logger().log(LogLevel::Info, std::format("MCP initialized with server: {} v{}", 
+        LOG_INFO("MCP initialized with server: {} v{}", 
                                                     init_result->server_info.name, 
-                                                    init_result->server_info.version));
+                                                    init_result->server_info.version);
         
         return {};
     });
 }
 
 std::future<std::expected<MCPResponse, ApiErrorInfo>> MCPClient::send_request(const MCPRequest& request, 
-                                                                                   std::chrono::milliseconds timeout) {
-    return std::async(std::launch::async, [this, request, timeout]() -> std::expected<MCPResponse, ApiErrorInfo> {
-        if (connection_state_ != MCPConnectionState::Connected) {
+                                                                                   std::chrono::milliseconds timeout,
+                                                                                   MCPCancelHandle cancel) {
+    return std::async(std::launch::async, [this, request, timeout, cancel]() -> std::expected<MCPResponse, ApiErrorInfo> {
+        // initialize and shutdown are sent while the state is Initializing and Shutting_Down
+        auto state = connection_state_.load();
+        if (state != MCPConnectionState::Connected && state != MCPConnectionState::Initializing &&
+            state != MCPConnectionState::Shutting_Down) {
             return std::unexpected(ApiErrorInfo{
                 ApiError::InvalidState,
                 "Not connected to MCP server"
@@ -373,6 +470,18 @@ std::future<std::expected<MCPResponse, ApiErrorInfo>> MCPClient::send_request(co
         {
             std::lock_guard lock(pending_requests_mutex_);
             pending_requests_[request_id] = std::move(response_promise);
+            pending_gauge().add(1);
+        }
+        
+        // Let the cancel handle abandon this request from another thread
+        if (!cancel.bind([this, id = request.id](const std::string& reason) { cancel_request(id, reason); })) {
+            std::lock_guard lock(pending_requests_mutex_);
+            pending_requests_.erase(request_id);
+            pending_gauge().add(-1);
+            return std::unexpected(ApiErrorInfo{
+                ApiError::Cancelled,
+                "Request cancelled"
+            });
         }
         
         // Send the request
@@ -380,45 +489,118 @@ std::future<std::expected<MCPResponse, ApiErrorInfo>> MCPClient::send_request(co
         std::string request_str = request_json.dump();
         
         if (is_stdio_connection_) {
-            write(stdin_fd_, request_str.c_str(), request_str.length());
-            write(stdin_fd_, "\n", 1);
+            send_stdio(request_str);
         } else {
             ws_->send(request_str);
         }
         
         // Wait for response with timeout
         auto status = response_future.wait_for(timeout);
+        cancel.unbind();
         
         if (status == std::future_status::timeout) {
-            // Clean up the pending request
-            {
-                std::lock_guard lock(pending_requests_mutex_);
-                pending_requests_.erase(request_id);
+            // Tell the server to stop working on it; if the response raced in
+            // meanwhile, the future is ready and we fall through to it
+            if (cancel_request(request.id, "Request timed out")) {
+                MetricsRegistry::instance().counter(metric_names::kMcpTimeouts,
+                    {{"server", server_label()}, {"method", request.method}},
+                    "MCP requests abandoned after their timeout").inc();
+                return std::unexpected(ApiErrorInfo{
+                    ApiError::Timeout,
+                    "Request timeout"
+                });
             }
+        }
+        
+        auto response = response_future.get();
+        if (response.is_error() && response.error->code == MCPErrorCode::RequestCancelled) {
             return std::unexpected(ApiErrorInfo{
-                ApiError::Timeout,
-                "Request timeout"
+                ApiError::Cancelled,
+                response.error->message
             });
         }
-        
-        return response_future.get();
+        return response;
     });
 }
 
+bool MCPClient::cancel_request(const MCPMessageId& id, const std::string& reason) {
+    std::string request_id = message_id_to_string(id);
+    {
+        std::lock_guard lock(pending_requests_mutex_);
+        auto it = pending_requests_.find(request_id);
+        if (it == pending_requests_.end()) {
+            return false; // Already answered
+        }
+        it->second.set_value(MCPResponse(id, MCPError(MCPErrorCode::RequestCancelled,
+                                                      std::format("Request cancelled: {}", reason))));
+        pending_requests_.erase(it);
+        pending_gauge().add(-1);
+        mark_abandoned(request_id);
+    }
+    
+    LOG_DEBUG("Cancelling MCP request {}: {}", request_id, reason);
+    if (connection_state_ == MCPConnectionState::Connected) {
+        send_notification(MCPProtocolMessages::create_cancelled_notification(id, reason));
+    }
+    return true;
+}
+
+void MCPClient::cancel_all_requests(const std::string& reason) {
+    std::vector<std::string> ids;
+    {
+        std::lock_guard lock(pending_requests_mutex_);
+        ids.reserve(pending_requests_.size());
+        for (const auto& [id, _] : pending_requests_) {
+            ids.push_back(id);
+        }
+    }
+    for (const auto& id : ids) {
+        // Ids we generate are integers; keep that type on the wire
+        int64_t numeric = 0;
+        auto [end, ec] = std::from_chars(id.data(), id.data() + id.size(), numeric);
+        if (ec == std::errc() && end == id.data() + id.size()) {
+            cancel_request(MCPMessageId(numeric), reason);
+        } else {
+            cancel_request(MCPMessageId(id), reason);
+        }
+    }
+}
+
+void MCPClient::mark_abandoned(const std::string& request_id) {
+    if (!abandoned_requests_.insert(request_id).second) return;
+    abandoned_order_.push_back(request_id);
+    if (abandoned_order_.size() > kMaxAbandonedRequests) {
+        abandoned_requests_.erase(abandoned_order_.front());
+        abandoned_order_.pop_front();
+    }
+}
+
+bool MCPClient::has_abandoned() {
+    std::lock_guard lock(pending_requests_mutex_);
+    return !abandoned_requests_.empty();
+}
+
+bool MCPClient::take_abandoned(const std::string& request_id) {
+    std::lock_guard lock(pending_requests_mutex_);
+    if (abandoned_requests_.erase(request_id) == 0) return false;
+    std::erase(abandoned_order_, request_id);
+    return true;
+}
+
 void MCPClient::launch_websocketd_bridge(const std::string& mcp_cmd, int ws_port) {
     if (bridge_running_) {
-        get_logger().log(LogLevel::Warning, "Bridge is already running");
+        LOG_WARN("Bridge is already running");
         return;
     }
     
     bridge_running_ = true;
     bridge_thread_ = std::thread([this, mcp_cmd, ws_port]() {
         std::string command = std::format("websocketd --port={} -- {}", ws_port, mcp_cmd);
-        get_logger().log(LogLevel::Info, std::format("Starting websocketd bridge: {}", command));
+        LOG_INFO("Starting websocketd bridge: {}", command);
         
         int result = system(command.c_str());
         if (result != 0) {
-            get_logger().log(LogLevel::Error, std::format("websocketd bridge failed with exit code: {}", result));
+            LOG_ERROR("websocketd bridge failed with exit code: {}", result);
         }
         
         bridge_running_ = false;
@@ -429,8 +611,7 @@ void MCPClient::send_notification(const MCPNotification& notification) {
     auto message_json = notification.to_json();
     std::string message_str = message_json.dump();
     if (is_stdio_connection_) {
-        write(stdin_fd_, message_str.c_str(), message_str.length());
-        write(stdin_fd_, "\n", 1);
+        send_stdio(message_str);
     } else {
         ws_->send(message_str);
     }
@@ -438,11 +619,23 @@ void MCPClient::send_notification(const MCPNotification& notification) {
 
 void MCPClient::handle_message(const std::string& message) {
     try {
+        // Late reply to a request we already gave up on: drop it unparsed.
+        // Nothing is abandoned most of the time, so skip the id scan then.
+        if (has_abandoned()) {
+            if (auto id = peek_response_id(message); id && take_abandoned(*id)) {
+                LOG_DEBUG("Discarding response to cancelled MCP request {}", *id);
+                MetricsRegistry::instance().counter(metric_names::kMcpLateReplies, {{"server", server_label()}},
+                    "Replies to MCP requests already cancelled or timed out").inc();
+                return;
+            }
+        }
+        
         auto json = nlohmann::json::parse(message);
+        
         auto parsed_message = parse_mcp_message(json);
         
         if (!parsed_message) {
-            get_logger().log(LogLevel::Error, std::format("Failed to parse MCP message: {}", parsed_message.error()));
+            LOG_ERROR("Failed to parse MCP message: {}", parsed_message.error());
             return;
         }
         
@@ -465,7 +658,7 @@ void MCPClient::handle_message(const std::string& message) {
             }
         }
     } catch (const std::exception& e) {
-        get_logger().log(LogLevel::Error, std::format("Error handling MCP message: {}", e.what()));
+        LOG_ERROR("Error handling MCP message: {}", e.what());
     }
 }
 
@@ -477,24 +670,29 @@ void MCPClient::handle_response(const MCPResponse& response) {
     if (it != pending_requests_.end()) {
         it->second.set_value(response);
         pending_requests_.erase(it);
+        pending_gauge().add(-1);
     }
 }
 
 void MCPClient::handle_notification(const MCPNotification& notification) {
-    get_logger().log(LogLevel::Debug, std::format("Received MCP notification: {}", notification.method));
+    LOG_DEBUG("Received MCP notification: {}", notification.method);
     
     // Handle specific notifications
     if (notification.method == MCPMethods::RESOURCES_LIST_CHANGED) {
         if (resource_manager_) resource_manager_->handle_list_changed_notification();
+    } else if (notification.method == MCPMethods::RESOURCES_UPDATED) {
+        if (resource_manager_) resource_manager_->handle_updated_notification(notification.params.value_or(nlohmann::json::object()));
     } else if (notification.method == MCPMethods::TOOLS_LIST_CHANGED) {
         if (tool_manager_) tool_manager_->handle_list_changed_notification();
     } else if (notification.method == MCPMethods::PROMPTS_LIST_CHANGED) {
         if (prompt_manager_) prompt_manager_->handle_list_changed_notification();
+    } else if (notification.method == MCPMethods::PROGRESS) {
+        if (tool_manager_) tool_manager_->handle_progress_notification(notification.params.value_or(nlohmann::json::object()));
     }
 }
 
 void MCPClient::handle_request(const MCPRequest& request) {
-    get_logger().log(LogLevel::Debug, std::format("Received MCP request: {}", request.method));
+    LOG_DEBUG("Received MCP request: {}", request.method);
     
     // Handle ping requests
     if (request.method == MCPMethods::PING) {
@@ -510,10 +708,10 @@ void MCPClient::setup_websocket() {
         if (msg->type == ix::WebSocketMessageType::Message) {
             handle_message(msg->str);
         } else if (msg->type == ix::WebSocketMessageType::Error) {
-            get_logger().log(LogLevel::Error, std::format("WebSocket error: {}", msg->errorInfo.reason));
+            LOG_ERROR("WebSocket error: {}", msg->errorInfo.reason);
             connection_state_ = MCPConnectionState::Error;
         } else if (msg->type == ix::WebSocketMessageType::Close) {
-            get_logger().log(LogLevel::Info, "WebSocket connection closed");
+            LOG_INFO("WebSocket connection closed");
             connection_state_ = MCPConnectionState::Disconnected;
         }
     });
@@ -561,6 +759,9 @@ ApiErrorInfo MCPClient::mcp_error_to_api_error(const MCPError& error) const {
         case MCPErrorCode::InternalError:
             api_error = ApiError::InternalError;
             break;
+        case MCPErrorCode::RequestCancelled:
+            api_error = ApiError::Cancelled;
+            break;
         default:
             api_error = ApiError::Unknown;
             break;
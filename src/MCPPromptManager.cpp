@@ -1,16 +1,157 @@
 #include "MCPPromptManager.hpp"
 #include "MCPClient.hpp"
 #include "MCPProtocol.hpp"
+#include "GlobalLogger.hpp"
 #include <future>
+#include <format>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
 
+namespace {
+    constexpr std::string_view kSlotOpen = "{{";
+    constexpr std::string_view kSlotClose = "}}";
+
+    std::string_view trim(std::string_view s) {
+        while (!s.empty() && std::isspace(static_cast<unsigned char>(s.front()))) s.remove_prefix(1);
+        while (!s.empty() && std::isspace(static_cast<unsigned char>(s.back()))) s.remove_suffix(1);
+        return s;
+    }
+
+    bool is_identifier(std::string_view s) {
+        return !s.empty() && std::all_of(s.begin(), s.end(), [](char c) {
+            return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '-' || c == '.';
+        });
+    }
+
+    // Stands in for an argument while probing; nothing a prompt would contain
+    std::string marker_for(const std::string& name, uint64_t probe) {
+        return std::format("\x1e{}#{}\x1e", name, probe);
+    }
+}
+
+// PromptTemplate implementation
+void PromptTemplate::add_literal(size_t offset, size_t length) {
+    if (length == 0) return;
+    // Merge adjacent literals so rendering does one append per run
+    if (!ops_.empty() && ops_.back().kind == Op::Kind::Literal && ops_.back().offset + ops_.back().length == offset) {
+        ops_.back().length += length;
+    } else {
+        ops_.push_back({Op::Kind::Literal, offset, length, 0});
+    }
+    literal_bytes_ += length;
+}
+
+void PromptTemplate::add_slot(std::string_view name) {
+    auto it = std::find(slots_.begin(), slots_.end(), name);
+    size_t slot = static_cast<size_t>(it - slots_.begin());
+    if (it == slots_.end()) {
+        slots_.emplace_back(name);
+    }
+    ops_.push_back({Op::Kind::Slot, 0, 0, slot});
+}
+
+PromptTemplate PromptTemplate::compile(std::string source) {
+    PromptTemplate tmpl;
+    tmpl.source_ = std::move(source);
+    std::string_view src = tmpl.source_;
+
+    size_t pos = 0;
+    while (pos < src.size()) {
+        size_t open = src.find(kSlotOpen, pos);
+        if (open == std::string_view::npos) break;
+        size_t close = src.find(kSlotClose, open + kSlotOpen.size());
+        if (close == std::string_view::npos) break;
+
+        auto name = trim(src.substr(open + kSlotOpen.size(), close - open - kSlotOpen.size()));
+        if (!is_identifier(name)) {
+            // Not a placeholder: keep the opening braces literal and move on
+            tmpl.add_literal(pos, open + kSlotOpen.size() - pos);
+            pos = open + kSlotOpen.size();
+            continue;
+        }
+        tmpl.add_literal(pos, open - pos);
+        tmpl.add_slot(name);
+        pos = close + kSlotClose.size();
+    }
+    tmpl.add_literal(pos, src.size() - pos);
+    return tmpl;
+}
+
+PromptTemplate PromptTemplate::from_rendered(std::string text,
+                                             const std::vector<std::pair<std::string, std::string>>& markers) {
+    PromptTemplate tmpl;
+    tmpl.source_ = std::move(text);
+    std::string_view src = tmpl.source_;
+    size_t pos = 0;
+    while (true) {
+        // The earliest marker from here on
+        size_t found = std::string_view::npos;
+        const std::pair<std::string, std::string>* marker = nullptr;
+        for (const auto& candidate : markers) {
+            size_t at = src.find(candidate.second, pos);
+            if (at < found) {
+                found = at;
+                marker = &candidate;
+            }
+        }
+        if (!marker) break;
+        tmpl.add_literal(pos, found - pos);
+        tmpl.add_slot(marker->first);
+        pos = found + marker->second.size();
+    }
+    tmpl.add_literal(pos, src.size() - pos);
+    return tmpl;
+}
+
+std::string PromptTemplate::render(const nlohmann::json& arguments) const {
+    // Resolve every slot once; non-string arguments are serialized
+    std::vector<std::string_view> values(slots_.size());
+    std::vector<std::string> owned(slots_.size());
+    size_t total = literal_bytes_;
+    for (size_t i = 0; i < slots_.size(); ++i) {
+        if (!arguments.is_object()) break;
+        auto it = arguments.find(slots_[i]);
+        if (it == arguments.end() || it->is_null()) continue;
+        if (it->is_string()) {
+            values[i] = it->get_ref<const std::string&>();
+        } else {
+            owned[i] = it->dump();
+            values[i] = owned[i];
+        }
+    }
+    for (const auto& op : ops_) {
+        if (op.kind == Op::Kind::Slot) total += values[op.slot].size();
+    }
+
+    std::string out;
+    out.reserve(total);
+    for (const auto& op : ops_) {
+        if (op.kind == Op::Kind::Literal) {
+            out.append(source_, op.offset, op.length);
+        } else {
+            out.append(values[op.slot]);
+        }
+    }
+    return out;
+}
+
+bool PromptTemplate::has_slot(const std::string& name) const {
+    return std::find(slots_.begin(), slots_.end(), name) != slots_.end();
+}
+
+// MCPPromptManager implementation
 MCPPromptManager::MCPPromptManager(MCPClient* client)
     : client_(client) {}
 
 MCPPromptManager::~MCPPromptManager() = default;
 
 std::vector<nlohmann::json> MCPPromptManager::list_prompts(std::optional<std::string> cursor) {
-    if (!cursor.has_value() && !prompt_cache_.empty()) {
-        return prompt_cache_;
+    {
+        std::lock_guard lock(cache_mutex_);
+        if (!cursor.has_value() && !prompt_cache_.empty()) {
+            return prompt_cache_;
+        }
     }
     auto request = MCPProtocolMessages::create_prompts_list_request(cursor);
     auto fut = client_->send_request_for_manager(request);
@@ -20,6 +161,7 @@ std::vector<nlohmann::json> MCPPromptManager::list_prompts(std::optional<std::st
     }
     const auto& res = result->result.value();
     if (res.contains("prompts") && res["prompts"].is_array()) {
+        std::lock_guard lock(cache_mutex_);
         prompt_cache_ = res["prompts"].get<std::vector<nlohmann::json>>();
         if (res.contains("cursor") && res["cursor"].is_string()) {
             last_cursor_ = res["cursor"].get<std::string>();
@@ -29,9 +171,130 @@ std::vector<nlohmann::json> MCPPromptManager::list_prompts(std::optional<std::st
     return {};
 }
 
-std::optional<std::string> MCPPromptManager::get_prompt(const std::string& name, std::optional<nlohmann::json> arguments) {
+std::optional<std::string> MCPPromptManager::get_prompt(const std::string& name, std::optional<nlohmann::json> arguments,
+                                                        const MCPCancelHandle& cancel) {
+    std::optional<CompiledPrompt> compiled;
+    {
+        std::lock_guard lock(cache_mutex_);
+        if (auto it = compiled_prompts_.find(name); it != compiled_prompts_.end()) {
+            compiled = it->second;
+        }
+    }
+    if (!compiled) {
+        compiled = compile_prompt(name, cancel);
+        if (cancel.is_cancelled()) {
+            return std::nullopt;
+        }
+    }
+    const auto& args = arguments.value_or(nlohmann::json::object());
+    // Missing or extra arguments are the server's to judge (and reject)
+    if (!compiled->tmpl || !renders_locally(*compiled->tmpl, args)) {
+        return fetch_prompt_text(name, arguments, cancel);
+    }
+    if (compiled->trusted) {
+        return compiled->tmpl->render(args);
+    }
+
+    // Not proven yet: the server renders it, and the template is kept only if it agrees.
+    // A conditional or a default can agree for one argument set and not another, so
+    // trust needs a second match with every argument changed.
+    auto text = fetch_prompt_text(name, arguments, cancel);
+    if (text) {
+        CompiledPrompt next = *compiled;
+        if (*text != compiled->tmpl->render(args)) {
+            LOG_DEBUG("MCPPromptManager - Prompt '{}' is not cacheable (not a plain substitution)", name);
+            next = {};
+        } else if (next.verified_args.is_null()) {
+            next.verified_args = args;
+        } else if (differs_everywhere(next.verified_args, args)) {
+            next.trusted = true;
+            next.verified_args = nullptr;
+        }
+        store_compiled(name, compiled->tmpl, std::move(next));
+    }
+    return text;
+}
+
+bool MCPPromptManager::renders_locally(const PromptTemplate& tmpl, const nlohmann::json& arguments) {
+    if (!arguments.is_object() || arguments.size() != tmpl.slot_names().size()) {
+        return false;
+    }
+    return std::all_of(tmpl.slot_names().begin(), tmpl.slot_names().end(), [&](const std::string& slot) {
+        auto it = arguments.find(slot);
+        // An empty value may stand for "use the default" on the server
+        return it != arguments.end() && it->is_string() && !it->get_ref<const std::string&>().empty();
+    });
+}
+
+bool MCPPromptManager::differs_everywhere(const nlohmann::json& a, const nlohmann::json& b) {
+    return std::all_of(a.items().begin(), a.items().end(), [&](const auto& item) {
+        auto it = b.find(item.key());
+        return it != b.end() && *it != item.value();
+    });
+}
+
+void MCPPromptManager::store_compiled(const std::string& name, const std::shared_ptr<const PromptTemplate>& expected,
+                                      CompiledPrompt compiled) {
+    std::lock_guard lock(cache_mutex_);
+    auto it = compiled_prompts_.find(name);
+    // A list_changed notification may have dropped the entry meanwhile
+    if (it != compiled_prompts_.end() && it->second.tmpl == expected) {
+        it->second = std::move(compiled);
+    }
+}
+
+void MCPPromptManager::remember_compiled(const std::string& name, CompiledPrompt compiled) {
+    std::lock_guard lock(cache_mutex_);
+    auto [it, inserted] = compiled_prompts_.insert_or_assign(name, std::move(compiled));
+    if (!inserted) return;
+    compiled_prompt_order_.push_back(name);
+    if (compiled_prompt_order_.size() > kMaxCompiled) {
+        compiled_prompts_.erase(compiled_prompt_order_.front());
+        compiled_prompt_order_.pop_front();
+    }
+}
+
+std::string MCPPromptManager::render_template(const std::string& template_str, const nlohmann::json& arguments) {
+    std::shared_ptr<const PromptTemplate> tmpl;
+    {
+        std::lock_guard lock(cache_mutex_);
+        if (auto it = compiled_templates_.find(template_str); it != compiled_templates_.end()) {
+            tmpl = it->second;
+        }
+    }
+    if (!tmpl) {
+        // Compiled outside the lock; a racing caller may compile the same source twice
+        tmpl = std::make_shared<const PromptTemplate>(PromptTemplate::compile(template_str));
+        std::lock_guard lock(cache_mutex_);
+        if (compiled_templates_.emplace(template_str, tmpl).second) {
+            compiled_template_order_.push_back(template_str);
+            if (compiled_template_order_.size() > kMaxCompiled) {
+                compiled_templates_.erase(compiled_template_order_.front());
+                compiled_template_order_.pop_front();
+            }
+        }
+    }
+    return tmpl->render(arguments);
+}
+
+void MCPPromptManager::handle_list_changed_notification() {
+    clear_cache();
+}
+
+void MCPPromptManager::clear_cache() {
+    std::lock_guard lock(cache_mutex_);
+    prompt_cache_.clear();
+    last_cursor_.clear();
+    compiled_prompts_.clear();
+    compiled_prompt_order_.clear();
+    compiled_templates_.clear();
+    compiled_template_order_.clear();
+}
+
+std::optional<std::string> MCPPromptManager::fetch_prompt_text(const std::string& name, std::optional<nlohmann::json> arguments,
+                                                               const MCPCancelHandle& cancel) {
     auto request = MCPProtocolMessages::create_prompts_get_request(name, arguments);
-    auto fut = client_->send_request_for_manager(request);
+    auto fut = client_->send_request_for_manager(request, std::chrono::milliseconds(30000), cancel);
     auto result = fut.get();
     if (!result || result->is_error() || !result->result.has_value()) {
         return std::nullopt;
@@ -40,19 +303,74 @@ std::optional<std::string> MCPPromptManager::get_prompt(const std::string& name,
     if (res.contains("prompt") && res["prompt"].is_string()) {
         return res["prompt"].get<std::string>();
     }
+    // Standard prompts/get result: join the text of each message
+    if (res.contains("messages") && res["messages"].is_array()) {
+        std::string text;
+        for (const auto& message : res["messages"]) {
+            if (!message.contains("content")) continue;
+            const auto& content = message["content"];
+            if (content.is_object() && content.contains("text") && content["text"].is_string()) {
+                if (!text.empty()) text += "\n\n";
+                text += content["text"].get<std::string>();
+            }
+        }
+        return text;
+    }
     return std::nullopt;
 }
 
-std::string MCPPromptManager::render_template(const std::string& template_str, const nlohmann::json& arguments) {
-    // TODO: Implement template rendering (simple stub)
-    return template_str;
+std::optional<std::vector<std::string>> MCPPromptManager::prompt_argument_names(const std::string& name) {
+    for (const auto& prompt : list_prompts()) {
+        if (prompt.value("name", "") != name) continue;
+        std::vector<std::string> names;
+        if (prompt.contains("arguments") && prompt["arguments"].is_array()) {
+            for (const auto& arg : prompt["arguments"]) {
+                if (arg.contains("name") && arg["name"].is_string()) {
+                    names.push_back(arg["name"].get<std::string>());
+                }
+            }
+        }
+        return names;
+    }
+    return std::nullopt;
 }
 
-void MCPPromptManager::handle_list_changed_notification() {
-    clear_cache();
-}
+MCPPromptManager::CompiledPrompt MCPPromptManager::compile_prompt(const std::string& name, const MCPCancelHandle& cancel) {
+    // Remembered before returning, so a prompt that can't be compiled costs
+    // one round trip per call from now on, not two
+    auto remember = [&](CompiledPrompt compiled) {
+        if (cancel.is_cancelled()) return compiled; // Try again next time
+        remember_compiled(name, compiled);
+        return compiled;
+    };
 
-void MCPPromptManager::clear_cache() {
-    prompt_cache_.clear();
-    last_cursor_.clear();
-} 
\ No newline at end of file
+    // Only prompts the server advertises have a known argument list
+    auto arg_names = prompt_argument_names(name);
+    if (!arg_names) {
+        return remember({});
+    }
+
+    // Ask the server to render the prompt with each argument set to a unique marker
+    static std::atomic<uint64_t> next_probe{1};
+    uint64_t probe = next_probe.fetch_add(1, std::memory_order_relaxed);
+    nlohmann::json markers_json = nlohmann::json::object();
+    std::vector<std::pair<std::string, std::string>> markers;
+    for (const auto& arg : *arg_names) {
+        markers.emplace_back(arg, marker_for(arg, probe));
+        markers_json[arg] = markers.back().second;
+    }
+    auto text = fetch_prompt_text(name, markers_json, cancel);
+    if (!text) {
+        return remember({});
+    }
+
+    auto tmpl = std::make_shared<const PromptTemplate>(PromptTemplate::from_rendered(std::move(*text), markers));
+    // If the server transformed or dropped an argument, the template can't be reproduced locally
+    for (const auto& arg : *arg_names) {
+        if (!tmpl->has_slot(arg)) {
+            LOG_DEBUG("MCPPromptManager - Prompt '{}' is not cacheable (argument '{}' not echoed)", name, arg);
+            return remember({});
+        }
+    }
+    return remember({tmpl});
+}
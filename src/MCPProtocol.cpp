@@ -290,13 +290,29 @@ MCPRequest MCPProtocolMessages::create_resources_read_request(const std::string&
     return MCPRequest(MCPMethods::RESOURCES_READ, std::optional<nlohmann::json>(params));
 }
 
+MCPRequest MCPProtocolMessages::create_resources_subscribe_request(const std::string& uri) {
+    nlohmann::json params;
+    params["uri"] = uri;
+    return MCPRequest(MCPMethods::RESOURCES_SUBSCRIBE, std::optional<nlohmann::json>(params));
+}
+
+MCPRequest MCPProtocolMessages::create_resources_unsubscribe_request(const std::string& uri) {
+    nlohmann::json params;
+    params["uri"] = uri;
+    return MCPRequest(MCPMethods::RESOURCES_UNSUBSCRIBE, std::optional<nlohmann::json>(params));
+}
+
 MCPRequest MCPProtocolMessages::create_tools_call_request(const std::string& name, 
-                                                         std::optional<nlohmann::json> arguments) {
+                                                         std::optional<nlohmann::json> arguments,
+                                                         std::optional<nlohmann::json> progress_token) {
     nlohmann::json params;
     params["name"] = name;
     if (arguments.has_value()) {
         params["arguments"] = arguments.value();
     }
+    if (progress_token.has_value()) {
+        params["_meta"]["progressToken"] = progress_token.value();
+    }
     return MCPRequest(MCPMethods::TOOLS_CALL, std::optional<nlohmann::json>(params));
 }
 
@@ -310,6 +326,16 @@ MCPRequest MCPProtocolMessages::create_prompts_get_request(const std::string& na
     return MCPRequest(MCPMethods::PROMPTS_GET, std::optional<nlohmann::json>(params));
 }
 
+MCPNotification MCPProtocolMessages::create_cancelled_notification(const MCPMessageId& request_id,
+                                                                   const std::string& reason) {
+    nlohmann::json params;
+    params["requestId"] = message_id_to_json(request_id);
+    if (!reason.empty()) {
+        params["reason"] = reason;
+    }
+    return MCPNotification(MCPMethods::CANCELLED, std::optional<nlohmann::json>(params));
+}
+
 MCPRequest MCPProtocolMessages::create_sampling_create_message_request(const nlohmann::json& messages,
                                                                       std::optional<nlohmann::json> model_preferences,
                                                                       std::optional<nlohmann::json> system_prompt,
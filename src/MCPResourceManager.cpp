@@ -1,7 +1,9 @@
 #include "MCPResourceManager.hpp"
 #include "MCPClient.hpp"
 #include "MCPProtocol.hpp"
+#include "GlobalLogger.hpp"
 #include <future>
+#include <format>
 
 MCPResourceManager::MCPResourceManager(MCPClient* client)
     : client_(client) {}
@@ -10,8 +12,11 @@ MCPResourceManager::~MCPResourceManager() = default;
 
 std::vector<nlohmann::json> MCPResourceManager::list_resources(std::optional<std::string> cursor) {
     // If cache is valid and no cursor, return cached
-    if (!cursor.has_value() && !resource_cache_.empty()) {
-        return resource_cache_;
+    {
+        std::lock_guard lock(cache_mutex_);
+        if (!cursor.has_value() && !resource_cache_.empty()) {
+            return resource_cache_;
+        }
     }
     auto request = MCPProtocolMessages::create_resources_list_request(cursor);
     auto fut = client_->send_request_for_manager(request);
@@ -21,6 +26,7 @@ std::vector<nlohmann::json> MCPResourceManager::list_resources(std::optional<std
     }
     const auto& res = result->result.value();
     if (res.contains("resources") && res["resources"].is_array()) {
+        std::lock_guard lock(cache_mutex_);
         resource_cache_ = res["resources"].get<std::vector<nlohmann::json>>();
         if (res.contains("cursor") && res["cursor"].is_string()) {
             last_cursor_ = res["cursor"].get<std::string>();
@@ -30,26 +36,251 @@ std::vector<nlohmann::json> MCPResourceManager::list_resources(std::optional<std
     return {};
 }
 
-std::optional<nlohmann::json> MCPResourceManager::read_resource(const std::string& uri) {
+std::optional<nlohmann::json> MCPResourceManager::read_resource(const std::string& uri, bool force_refresh,
+                                                               const MCPCancelHandle& cancel) {
+    if (!force_refresh) {
+        // Copy the entry out so the stat and file reads below run unlocked
+        std::optional<CachedResource> cached;
+        bool subscribed = false;
+        {
+            std::lock_guard lock(cache_mutex_);
+            auto it = content_cache_.find(uri);
+            if (it != content_cache_.end()) {
+                cached = it->second;
+                subscribed = subscriptions_.contains(uri);
+            }
+        }
+        if (cached && is_fresh(*cached, subscribed)) {
+            if (auto result = materialize(std::move(*cached))) {
+                return result;
+            }
+            // The local file changed after the freshness check: fetch it again
+        }
+    }
+    // Subscribe before reading: an update sent between the read reply and a
+    // later subscribe would be missed, and a subscribed entry never expires
+    if (server_supports_subscribe()) {
+        subscribe(uri);
+    }
+    uint64_t epoch = 0;
+    {
+        std::lock_guard lock(cache_mutex_);
+        epoch = invalidation_epoch_;
+    }
+
     auto request = MCPProtocolMessages::create_resources_read_request(uri);
-    auto fut = client_->send_request_for_manager(request);
+    auto fut = client_->send_request_for_manager(request, std::chrono::milliseconds(30000), cancel);
     auto result = fut.get();
     if (!result || result->is_error() || !result->result.has_value()) {
         return std::nullopt;
     }
+
+    // Build the entry (and read any local file) outside the lock
+    auto entry = make_entry(uri, result->result.value());
+    {
+        std::lock_guard lock(cache_mutex_);
+        // An updated notification raced with this read; don't cache what may be stale
+        if (epoch == invalidation_epoch_) {
+            content_cache_[uri] = std::move(entry);
+        }
+    }
     return result->result.value();
 }
 
 std::optional<std::string> MCPResourceManager::resolve_uri(const std::string& uri) {
-    // For now, just return the URI (stub)
-    return uri;
+    if (uri.empty()) {
+        return std::nullopt;
+    }
+    // Already a URI
+    if (uri.find("://") != std::string::npos) {
+        return uri;
+    }
+    // Match a listed resource by name
+    {
+        std::lock_guard lock(cache_mutex_);
+        for (const auto& resource : resource_cache_) {
+            if (resource.value("name", "") == uri && resource.contains("uri") && resource["uri"].is_string()) {
+                return resource["uri"].get<std::string>();
+            }
+        }
+    }
+    // Absolute local path
+    if (uri.front() == '/') {
+        return "file://" + uri;
+    }
+    return std::nullopt;
+}
+
+bool MCPResourceManager::subscribe(const std::string& uri) {
+    if (!server_supports_subscribe()) {
+        return false;
+    }
+    {
+        std::lock_guard lock(cache_mutex_);
+        if (subscriptions_.contains(uri)) {
+            return true;
+        }
+    }
+    auto request = MCPProtocolMessages::create_resources_subscribe_request(uri);
+    auto fut = client_->send_request_for_manager(request);
+    auto result = fut.get();
+    if (!result || result->is_error()) {
+        LOG_WARN("MCPResourceManager::subscribe - Failed to subscribe to {}", uri);
+        return false;
+    }
+    std::lock_guard lock(cache_mutex_);
+    subscriptions_.insert(uri);
+    return true;
+}
+
+bool MCPResourceManager::unsubscribe(const std::string& uri) {
+    {
+        std::lock_guard lock(cache_mutex_);
+        if (subscriptions_.erase(uri) == 0) {
+            return false;
+        }
+    }
+    auto request = MCPProtocolMessages::create_resources_unsubscribe_request(uri);
+    auto fut = client_->send_request_for_manager(request);
+    auto result = fut.get();
+    return result && !result->is_error();
+}
+
+bool MCPResourceManager::is_subscribed(const std::string& uri) const {
+    std::lock_guard lock(cache_mutex_);
+    return subscriptions_.contains(uri);
 }
 
 void MCPResourceManager::clear_cache() {
+    std::lock_guard lock(cache_mutex_);
     resource_cache_.clear();
     last_cursor_.clear();
+    content_cache_.clear();
+    ++invalidation_epoch_;
+}
+
+void MCPResourceManager::invalidate(const std::string& uri) {
+    std::lock_guard lock(cache_mutex_);
+    content_cache_.erase(uri);
+    ++invalidation_epoch_;
+}
+
+bool MCPResourceManager::is_cached(const std::string& uri) const {
+    std::lock_guard lock(cache_mutex_);
+    return content_cache_.contains(uri);
 }
 
 void MCPResourceManager::handle_list_changed_notification() {
     clear_cache();
-} 
\ No newline at end of file
+}
+
+void MCPResourceManager::handle_updated_notification(const nlohmann::json& params) {
+    if (!params.contains("uri") || !params["uri"].is_string()) {
+        return;
+    }
+    auto uri = params["uri"].get<std::string>();
+    LOG_DEBUG("MCPResourceManager - Resource updated: {}", uri);
+    invalidate(uri);
+}
+
+bool MCPResourceManager::server_supports_subscribe() const {
+    auto caps = client_->get_server_capabilities();
+    return caps && caps->resources && caps->resources->subscribe;
+}
+
+bool MCPResourceManager::is_fresh(const CachedResource& entry, bool subscribed) const {
+    // File-backed: a stat() against the stamp is the conditional re-read
+    if (entry.stamp) {
+        return !entry.stamp->is_stale(entry.local_path);
+    }
+    // Subscribed: the server tells us when it changes
+    if (subscribed) {
+        return true;
+    }
+    return std::chrono::steady_clock::now() - entry.fetched_at < cache_ttl_;
+}
+
+MCPResourceManager::CachedResource MCPResourceManager::make_entry(const std::string& uri, const nlohmann::json& result) const {
+    CachedResource entry;
+    entry.result = result;
+    entry.fetched_at = std::chrono::steady_clock::now();
+
+    if (auto path = local_path_for(uri)) {
+        entry.stamp = FileStamp::take(*path);
+        if (entry.stamp) entry.local_path = *path;
+    }
+
+    if (!entry.result.contains("contents") || !entry.result["contents"].is_array()) {
+        entry.stamp.reset();
+        entry.local_path.clear();
+        return entry;
+    }
+    auto& contents = entry.result["contents"];
+    entry.payloads.resize(contents.size());
+    // Only trust the local file if the server actually returned its contents
+    std::optional<std::string> file_text;
+    if (entry.stamp) {
+        file_text = entry.stamp->read_if_current(entry.local_path);
+    }
+    bool file_backed = false;
+    for (size_t i = 0; i < contents.size(); ++i) {
+        auto& item = contents[i];
+        for (const char* field : {"text", "blob"}) {
+            if (!item.contains(field) || !item[field].is_string()) continue;
+            auto& value = item[field].get_ref<std::string&>();
+            bool matches_file = file_text && std::string_view(field) == "text" && *file_text == value;
+            file_backed = file_backed || matches_file;
+            if (value.size() < kOutOfLineThreshold) continue;
+
+            Payload payload;
+            payload.field = field;
+            if (matches_file) {
+                // Identical to the local file: re-read it instead of keeping a copy
+                payload.from_file = true;
+            } else {
+                payload.data = std::make_shared<const std::string>(std::move(value));
+            }
+            item.erase(field);
+            entry.payloads[i] = std::move(payload);
+            break;
+        }
+    }
+    if (!file_backed) {
+        entry.stamp.reset();
+        entry.local_path.clear();
+    }
+    return entry;
+}
+
+std::optional<nlohmann::json> MCPResourceManager::materialize(CachedResource entry) {
+    nlohmann::json result = std::move(entry.result);
+    for (size_t i = 0; i < entry.payloads.size(); ++i) {
+        const auto& payload = entry.payloads[i];
+        if (!payload) continue;
+        if (payload->from_file) {
+            auto text = entry.stamp->read_if_current(entry.local_path);
+            if (!text) {
+                return std::nullopt;
+            }
+            result["contents"][i][payload->field] = std::move(*text);
+        } else {
+            result["contents"][i][payload->field] = *payload->data;
+        }
+    }
+    return result;
+}
+
+std::optional<std::string> MCPResourceManager::local_path_for(const std::string& uri) {
+    constexpr std::string_view kFileScheme = "file://";
+    if (!uri.starts_with(kFileScheme)) {
+        return std::nullopt;
+    }
+    std::string path = uri.substr(kFileScheme.size());
+    if (path.starts_with("localhost/")) {
+        path.erase(0, std::string_view("localhost").size());
+    }
+    if (path.empty() || path.front() != '/') {
+        return std::nullopt;
+    }
+    return path;
+}
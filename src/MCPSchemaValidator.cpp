@@ -0,0 +1,350 @@
+#include "MCPSchemaValidator.hpp"
+#include <algorithm>
+#include <cmath>
+#include <format>
+
+namespace {
+    // Number of code points in a UTF-8 string (JSON Schema lengths are in characters)
+    size_t utf8_length(const std::string& s) {
+        return std::count_if(s.begin(), s.end(), [](char c) {
+            return (static_cast<unsigned char>(c) & 0xC0) != 0x80;
+        });
+    }
+
+    std::optional<double> number_field(const nlohmann::json& schema, const char* key) {
+        if (schema.contains(key) && schema[key].is_number()) {
+            return schema[key].get<double>();
+        }
+        return std::nullopt;
+    }
+
+    std::optional<size_t> size_field(const nlohmann::json& schema, const char* key) {
+        if (schema.contains(key) && schema[key].is_number_integer() && schema[key].get<int64_t>() >= 0) {
+            return schema[key].get<size_t>();
+        }
+        return std::nullopt;
+    }
+
+    // Keywords that change what the rest of a schema accepts; ignoring them is not safe
+    constexpr const char* kUnsupportedKeywords[] = {
+        "$ref", "allOf", "not", "if", "patternProperties", "dependentRequired",
+        "dependentSchemas", "dependencies", "unevaluatedProperties"
+    };
+}
+
+std::expected<MCPSchemaValidator, std::string> MCPSchemaValidator::compile(const nlohmann::json& schema) {
+    MCPSchemaValidator validator;
+    if (schema.is_null()) {
+        return validator; // No schema: accept anything
+    }
+    auto root = compile_node(schema, validator.nodes_, validator.unsupported_, "$");
+    if (!root) {
+        return std::unexpected(root.error());
+    }
+    return validator;
+}
+
+std::expected<int, std::string> MCPSchemaValidator::compile_node(const nlohmann::json& schema,
+                                                                 std::vector<Node>& nodes,
+                                                                 std::vector<std::string>& unsupported,
+                                                                 const std::string& path) {
+    int index = static_cast<int>(nodes.size());
+    nodes.emplace_back();
+
+    // Boolean schemas: true accepts everything, false rejects everything
+    if (schema.is_boolean()) {
+        if (!schema.get<bool>()) nodes[index].types = 0;
+        return index;
+    }
+    if (!schema.is_object()) {
+        return std::unexpected(std::format("{}: schema must be an object", path));
+    }
+
+    for (const char* keyword : kUnsupportedKeywords) {
+        if (schema.contains(keyword)) unsupported.push_back(std::format("{}: {}", path, keyword));
+    }
+
+    Node node;
+    if (schema.contains("type")) {
+        auto bit_for = [](const std::string& name) -> uint8_t {
+            if (name == "null") return kNull;
+            if (name == "boolean") return kBoolean;
+            if (name == "integer") return kInteger;
+            if (name == "number") return kNumber;
+            if (name == "string") return kString;
+            if (name == "array") return kArray;
+            if (name == "object") return kObject;
+            return 0;
+        };
+        const auto& type = schema["type"];
+        node.types = 0;
+        if (type.is_string()) {
+            node.types = bit_for(type.get<std::string>());
+        } else if (type.is_array()) {
+            for (const auto& t : type) {
+                if (t.is_string()) node.types |= bit_for(t.get<std::string>());
+            }
+        }
+        if (node.types == 0) {
+            return std::unexpected(std::format("{}: invalid 'type' {}", path, type.dump()));
+        }
+    }
+
+    if (schema.contains("enum") && schema["enum"].is_array()) {
+        node.enum_values = schema["enum"].get<std::vector<nlohmann::json>>();
+    }
+    if (schema.contains("const")) {
+        node.const_value = schema["const"];
+    }
+
+    node.minimum = number_field(schema, "minimum");
+    node.maximum = number_field(schema, "maximum");
+    node.exclusive_minimum = number_field(schema, "exclusiveMinimum");
+    node.exclusive_maximum = number_field(schema, "exclusiveMaximum");
+    // Draft 4 spelling: boolean exclusiveMinimum/Maximum modifying minimum/maximum
+    if (schema.value("exclusiveMinimum", nlohmann::json()).is_boolean() && schema["exclusiveMinimum"].get<bool>()) {
+        node.exclusive_minimum = node.minimum;
+        node.minimum.reset();
+    }
+    if (schema.value("exclusiveMaximum", nlohmann::json()).is_boolean() && schema["exclusiveMaximum"].get<bool>()) {
+        node.exclusive_maximum = node.maximum;
+        node.maximum.reset();
+    }
+    node.min_length = size_field(schema, "minLength");
+    node.max_length = size_field(schema, "maxLength");
+    node.min_items = size_field(schema, "minItems");
+    node.max_items = size_field(schema, "maxItems");
+
+    if (schema.contains("pattern") && schema["pattern"].is_string()) {
+        node.pattern_source = schema["pattern"].get<std::string>();
+        try {
+            node.pattern.emplace(node.pattern_source, std::regex::ECMAScript | std::regex::optimize);
+        } catch (const std::regex_error&) {
+            return std::unexpected(std::format("{}: invalid pattern '{}'", path, node.pattern_source));
+        }
+    }
+
+    if (schema.contains("required") && schema["required"].is_array()) {
+        for (const auto& name : schema["required"]) {
+            if (name.is_string()) node.required.push_back(name.get<std::string>());
+        }
+    }
+
+    // Children are compiled after this node is stored, so hold them by index
+    nodes[index] = std::move(node);
+
+    if (schema.contains("properties") && schema["properties"].is_object()) {
+        std::vector<std::pair<std::string, int>> properties;
+        for (const auto& [name, sub] : schema["properties"].items()) {
+            auto child = compile_node(sub, nodes, unsupported, std::format("{}.{}", path, name));
+            if (!child) return std::unexpected(child.error());
+            properties.emplace_back(name, *child);
+        }
+        std::sort(properties.begin(), properties.end());
+        nodes[index].properties = std::move(properties);
+    }
+
+    if (schema.contains("additionalProperties")) {
+        const auto& additional = schema["additionalProperties"];
+        if (additional.is_boolean()) {
+            nodes[index].additional_allowed = additional.get<bool>();
+        } else {
+            auto child = compile_node(additional, nodes, unsupported, path + ".*");
+            if (!child) return std::unexpected(child.error());
+            nodes[index].additional_schema = *child;
+        }
+    }
+
+    if (schema.contains("items") && (schema["items"].is_object() || schema["items"].is_boolean())) {
+        auto child = compile_node(schema["items"], nodes, unsupported, path + "[]");
+        if (!child) return std::unexpected(child.error());
+        nodes[index].items = *child;
+    }
+
+    for (const char* key : {"anyOf", "oneOf"}) {
+        if (!schema.contains(key) || !schema[key].is_array()) continue;
+        std::vector<int> alternatives;
+        for (const auto& sub : schema[key]) {
+            auto child = compile_node(sub, nodes, unsupported, path);
+            if (!child) return std::unexpected(child.error());
+            alternatives.push_back(*child);
+        }
+        (std::string_view(key) == "anyOf" ? nodes[index].any_of : nodes[index].one_of) = std::move(alternatives);
+    }
+
+    return index;
+}
+
+std::expected<void, std::string> MCPSchemaValidator::validate(const nlohmann::json& value) const {
+    if (nodes_.empty()) {
+        return {};
+    }
+    std::vector<std::string> errors;
+    std::string path = "$";
+    validate_node(0, value, path, errors);
+    if (errors.empty()) {
+        return {};
+    }
+    std::string message;
+    for (const auto& error : errors) {
+        if (!message.empty()) message += '\n';
+        message += error;
+    }
+    return std::unexpected(message);
+}
+
+void MCPSchemaValidator::validate_node(int index, const nlohmann::json& value, std::string& path,
+                                       std::vector<std::string>& errors) const {
+    const Node& node = nodes_[index];
+
+    if (!matches_type(node.types, value)) {
+        if (node.types == 0) {
+            errors.push_back(std::format("{}: no value is allowed here", path));
+        } else {
+            errors.push_back(std::format("{}: expected {}, got {}", path, type_mask_to_string(node.types), type_name(value)));
+        }
+        return; // Further checks would only repeat the type error
+    }
+
+    if (!node.enum_values.empty() &&
+        std::find(node.enum_values.begin(), node.enum_values.end(), value) == node.enum_values.end()) {
+        std::string allowed;
+        for (const auto& v : node.enum_values) {
+            if (!allowed.empty()) allowed += ", ";
+            allowed += v.dump();
+        }
+        errors.push_back(std::format("{}: {} is not one of [{}]", path, value.dump(), allowed));
+    }
+    if (node.const_value && value != *node.const_value) {
+        errors.push_back(std::format("{}: must be {}", path, node.const_value->dump()));
+    }
+
+    if (value.is_number()) {
+        double v = value.get<double>();
+        if (node.minimum && v < *node.minimum) {
+            errors.push_back(std::format("{}: {} is less than minimum {}", path, value.dump(), *node.minimum));
+        }
+        if (node.maximum && v > *node.maximum) {
+            errors.push_back(std::format("{}: {} is greater than maximum {}", path, value.dump(), *node.maximum));
+        }
+        if (node.exclusive_minimum && v <= *node.exclusive_minimum) {
+            errors.push_back(std::format("{}: {} must be greater than {}", path, value.dump(), *node.exclusive_minimum));
+        }
+        if (node.exclusive_maximum && v >= *node.exclusive_maximum) {
+            errors.push_back(std::format("{}: {} must be less than {}", path, value.dump(), *node.exclusive_maximum));
+        }
+    } else if (value.is_string()) {
+        const auto& s = value.get_ref<const std::string&>();
+        if (node.min_length || node.max_length) {
+            size_t length = utf8_length(s);
+            if (node.min_length && length < *node.min_length) {
+                errors.push_back(std::format("{}: string is shorter than {} characters", path, *node.min_length));
+            }
+            if (node.max_length && length > *node.max_length) {
+                errors.push_back(std::format("{}: string is longer than {} characters", path, *node.max_length));
+            }
+        }
+        if (node.pattern && !std::regex_search(s, *node.pattern)) {
+            errors.push_back(std::format("{}: does not match pattern '{}'", path, node.pattern_source));
+        }
+    } else if (value.is_array()) {
+        if (node.min_items && value.size() < *node.min_items) {
+            errors.push_back(std::format("{}: expected at least {} items, got {}", path, *node.min_items, value.size()));
+        }
+        if (node.max_items && value.size() > *node.max_items) {
+            errors.push_back(std::format("{}: expected at most {} items, got {}", path, *node.max_items, value.size()));
+        }
+        if (node.items >= 0) {
+            size_t base = path.size();
+            for (size_t i = 0; i < value.size(); ++i) {
+                path += std::format("[{}]", i);
+                validate_node(node.items, value[i], path, errors);
+                path.resize(base);
+            }
+        }
+    } else if (value.is_object()) {
+        for (const auto& name : node.required) {
+            if (!value.contains(name)) {
+                errors.push_back(std::format("{}: missing required property '{}'", path, name));
+            }
+        }
+        size_t base = path.size();
+        for (const auto& [name, child] : value.items()) {
+            auto it = std::lower_bound(node.properties.begin(), node.properties.end(), name,
+                                       [](const auto& entry, const std::string& key) { return entry.first < key; });
+            int schema = -1;
+            if (it != node.properties.end() && it->first == name) {
+                schema = it->second;
+            } else if (node.additional_schema >= 0) {
+                schema = node.additional_schema;
+            } else if (!node.additional_allowed) {
+                errors.push_back(std::format("{}: unexpected property '{}'", path, name));
+                continue;
+            }
+            if (schema >= 0) {
+                path += '.';
+                path += name;
+                validate_node(schema, child, path, errors);
+                path.resize(base);
+            }
+        }
+    }
+
+    if (!node.any_of.empty() || !node.one_of.empty()) {
+        auto passes = [&](int alternative) {
+            std::vector<std::string> scratch;
+            std::string scratch_path = path;
+            validate_node(alternative, value, scratch_path, scratch);
+            return scratch.empty();
+        };
+        if (!node.any_of.empty() && std::none_of(node.any_of.begin(), node.any_of.end(), passes)) {
+            errors.push_back(std::format("{}: does not match any of the allowed schemas", path));
+        }
+        if (!node.one_of.empty()) {
+            auto matched = std::count_if(node.one_of.begin(), node.one_of.end(), passes);
+            if (matched != 1) {
+                errors.push_back(std::format("{}: must match exactly one schema, matched {}", path, matched));
+            }
+        }
+    }
+}
+
+bool MCPSchemaValidator::matches_type(uint8_t types, const nlohmann::json& value) {
+    if (types == kAny) return true;
+    switch (value.type()) {
+        case nlohmann::json::value_t::null: return types & kNull;
+        case nlohmann::json::value_t::boolean: return types & kBoolean;
+        case nlohmann::json::value_t::number_integer:
+        case nlohmann::json::value_t::number_unsigned: return types & (kInteger | kNumber);
+        case nlohmann::json::value_t::number_float: {
+            if (types & kNumber) return true;
+            double v = value.get<double>();
+            return (types & kInteger) && std::isfinite(v) && std::floor(v) == v;
+        }
+        case nlohmann::json::value_t::string: return types & kString;
+        case nlohmann::json::value_t::array: return types & kArray;
+        case nlohmann::json::value_t::object: return types & kObject;
+        default: return false;
+    }
+}
+
+const char* MCPSchemaValidator::type_name(const nlohmann::json& value) {
+    if (value.is_number_integer()) return "integer";
+    if (value.is_number()) return "number";
+    return value.type_name();
+}
+
+std::string MCPSchemaValidator::type_mask_to_string(uint8_t types) {
+    static constexpr std::pair<uint8_t, const char*> kNames[] = {
+        {kNull, "null"}, {kBoolean, "boolean"}, {kInteger, "integer"}, {kNumber, "number"},
+        {kString, "string"}, {kArray, "array"}, {kObject, "object"}
+    };
+    std::string out;
+    for (const auto& [bit, name] : kNames) {
+        if (!(types & bit)) continue;
+        if (bit == kInteger && (types & kNumber)) continue; // "number" already covers it
+        if (!out.empty()) out += " or ";
+        out += name;
+    }
+    return out;
+}
@@ -32,26 +32,26 @@ std::expected<MCPServerConfiguration, MCPServerError> MCPServerConfiguration::fr
         
         return info;
     } catch (const std::exception& e) {
-        get_logger().log(LogLevel::Error, std::format("Failed to parse MCP server info from JSON: {}", e.what()));
+        LOG_ERROR("Failed to parse MCP server info from JSON: {}", e.what());
         return std::unexpected(MCPServerError::ConfigParseError);
     }
 }
 
 MCPServerConfig::MCPServerConfig(const std::string& config_path) : config_path_(config_path) {
-    get_logger().log(LogLevel::Info, std::format("MCPServerConfig initialized with path: {}", config_path_));
+    LOG_INFO("MCPServerConfig initialized with path: {}", config_path_);
 }
 
 std::expected<void, MCPServerError> MCPServerConfig::load() {
     try {
         if (!std::filesystem::exists(config_path_)) {
-            get_logger().log(LogLevel::Info, std::format("MCP config file not found, creating default: {}", config_path_));
+            LOG_INFO("MCP config file not found, creating default: {}", config_path_);
             create_default_config();
             return save();
         }
         
         std::ifstream file(config_path_);
         if (!file.is_open()) {
-            get_logger().log(LogLevel::Error, std::format("Failed to open MCP config file: {}", config_path_));
+            LOG_ERROR("Failed to open MCP config file: {}", config_path_);
             return std::unexpected(MCPServerError::ConfigNotFound);
         }
         
@@ -67,18 +67,18 @@ std::expected<void, MCPServerError> MCPServerConfig::load() {
                     auto server = server_result.value();
                     server.name = name; // Ensure name matches key
                     servers_[name] = server;
-                    get_logger().log(LogLevel::Debug, std::format("Loaded MCP server: {} ({})", name, server.description));
+                    LOG_DEBUG("Loaded MCP server: {} ({})", name, server.description);
                 } else {
-                    get_logger().log(LogLevel::Warning, std::format("Failed to load MCP server config for: {}", name));
+                    LOG_WARN("Failed to load MCP server config for: {}", name);
                 }
             }
         }
         
-        get_logger().log(LogLevel::Info, std::format("Loaded {} MCP servers from config", servers_.size()));
+        LOG_INFO("Loaded {} MCP servers from config", servers_.size());
         return {};
         
     } catch (const std::exception& e) {
-        get_logger().log(LogLevel::Error, std::format("Failed to load MCP config: {}", e.what()));
+        LOG_ERROR("Failed to load MCP config: {}", e.what());
         return std::unexpected(MCPServerError::ConfigParseError);
     }
 }
@@ -96,16 +96,16 @@ std::expected<void, MCPServerError> MCPServerConfig::save() const {
         
         std::ofstream file(config_path_);
         if (!file.is_open()) {
-            get_logger().log(LogLevel::Error, std::format("Failed to open MCP config file for writing: {}", config_path_));
+            LOG_ERROR("Failed to open MCP config file for writing: {}", config_path_);
             return std::unexpected(MCPServerError::ConfigNotFound);
         }
         
         file << j.dump(2);
-        get_logger().log(LogLevel::Info, std::format("Saved MCP config with {} servers", servers_.size()));
+        LOG_INFO("Saved MCP config with {} servers", servers_.size());
         return {};
         
     } catch (const std::exception& e) {
-        get_logger().log(LogLevel::Error, std::format("Failed to save MCP config: {}", e.what()));
+        LOG_ERROR("Failed to save MCP config: {}", e.what());
         return std::unexpected(MCPServerError::ConfigParseError);
     }
 }
@@ -120,14 +120,14 @@ std::expected<MCPServerConfiguration, MCPServerError> MCPServerConfig::get_serve
 
 void MCPServerConfig::add_server(const std::string& name, const MCPServerConfiguration& server) {
     servers_[name] = server;
-    get_logger().log(LogLevel::Info, std::format("Added MCP server: {} ({})", name, server.description));
+    LOG_INFO("Added MCP server: {} ({})", name, server.description);
 }
 
 bool MCPServerConfig::remove_server(const std::string& name) {
     auto it = servers_.find(name);
     if (it != servers_.end()) {
         servers_.erase(it);
-        get_logger().log(LogLevel::Info, std::format("Removed MCP server: {}", name));
+        LOG_INFO("Removed MCP server: {}", name);
         return true;
     }
     return false;
@@ -191,7 +191,7 @@ void MCPServerConfig::create_default_config() {
     playwright.enabled = false; // Optional, requires additional setup
     add_server("playwright", playwright);
     
-    get_logger().log(LogLevel::Info, std::format("Created default MCP configuration with {} servers", servers_.size()));
+    LOG_INFO("Created default MCP configuration with {} servers", servers_.size());
 }
 
 std::string MCPServerConfig::error_to_string(MCPServerError error) const {
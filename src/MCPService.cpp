@@ -10,7 +10,7 @@ void MCPService::configure(const std::string& server_url) {
         return; // Already configured
     }
 
-    get_logger().log(LogLevel::Info, std::format("Configuring MCP service for: {}", server_url));
+    LOG_INFO("Configuring MCP service for: {}", server_url);
     
     current_server_url_ = server_url;
     mcp_client_ = std::make_unique<MCPClient>(server_url);
@@ -25,9 +25,9 @@ void MCPService::configure(const std::string& server_url) {
 bool MCPService::is_connected() const {
     bool connected = mcp_client_ && mcp_client_->get_connection_state() == MCPConnectionState::Connected;
     if (!connected) {
-        get_logger().log(LogLevel::Debug, std::format("MCP not connected - client exists: {}, state: {}", 
+        LOG_DEBUG("MCP not connected - client exists: {}, state: {}", 
             mcp_client_ ? "yes" : "no", 
-            mcp_client_ ? static_cast<int>(mcp_client_->get_connection_state()) : -1));
+            mcp_client_ ? static_cast<int>(mcp_client_->get_connection_state()) : -1);
     }
     return connected;
 }
@@ -36,7 +36,7 @@ void MCPService::launch_bridge_if_needed() {
     // Launch bridge for known local servers
     if (current_server_url_ == "ws://localhost:9092") {
         // Check if bridge is already running by trying to connect
-        get_logger().log(LogLevel::Info, "Checking if Brave search bridge is already running on port 9092");
+        LOG_INFO("Checking if Brave search bridge is already running on port 9092");
         
         // Try to connect first - if it fails, then launch bridge
         // Note: This is a simplified check - in production you'd want more robust detection
@@ -44,25 +44,25 @@ void MCPService::launch_bridge_if_needed() {
         auto connect_result = temp_client->connect().get();
         
         if (!connect_result) {
-            get_logger().log(LogLevel::Info, "Bridge not running, launching Brave search bridge on port 9092");
+            LOG_INFO("Bridge not running, launching Brave search bridge on port 9092");
             mcp_client_->launch_websocketd_bridge("/home/kfarrell/mcp-servers/venv/bin/python /home/kfarrell/mcp-servers/brave-search-rate-limited.py", 9092);
         } else {
-            get_logger().log(LogLevel::Info, "Bridge already running on port 9092");
+            LOG_INFO("Bridge already running on port 9092");
             temp_client->disconnect().wait();
         }
     }
     // ScrapeX MCP Bridge
     if (current_server_url_ == "ws://localhost:9093") {
-        get_logger().log(LogLevel::Info, "Checking if ScrapeX bridge is already running on port 9093");
+        LOG_INFO("Checking if ScrapeX bridge is already running on port 9093");
         
         auto temp_client = std::make_unique<MCPClient>(current_server_url_);
         auto connect_result = temp_client->connect().get();
         
         if (!connect_result) {
-            get_logger().log(LogLevel::Info, "Bridge not running, launching ScrapeX bridge on port 9093");
+            LOG_INFO("Bridge not running, launching ScrapeX bridge on port 9093");
             mcp_client_->launch_websocketd_bridge("/home/kfarrell/mcp-servers/venv/bin/python /home/kfarrell/.config/Claude/mcp_scrapex_bridge_fastmcp.py", 9093);
         } else {
-            get_logger().log(LogLevel::Info, "Bridge already running on port 9093");
+            LOG_INFO("Bridge already running on port 9093");
             temp_client->disconnect().wait();
         }
     }
@@ -86,7 +86,7 @@ std::optional<nlohmann::json> MCPService::call_tool(const std::string& name, con
         auto result = mcp_client_->tool_manager()->call_tool(name, arguments);
         return result;
     } catch (const std::exception& e) {
-        get_logger().log(LogLevel::Error, std::format("Error calling tool {}: {}", name, e.what()));
+        LOG_ERROR("Error calling tool {}: {}", name, e.what());
         return std::nullopt;
     }
 }
@@ -105,9 +105,10 @@ std::optional<nlohmann::json> MCPService::read_resource(const std::string& uri)
     if (!mcp_client_ || !mcp_client_->resource_manager()) return std::nullopt;
     
     try {
-        return mcp_client_->resource_manager()->read_resource(uri);
+        auto* resources = mcp_client_->resource_manager();
+        return resources->read_resource(resources->resolve_uri(uri).value_or(uri));
     } catch (const std::exception& e) {
-        get_logger().log(LogLevel::Error, std::format("Error reading resource {}: {}", uri, e.what()));
+        LOG_ERROR("Error reading resource {}: {}", uri, e.what());
         return std::nullopt;
     }
 }
@@ -128,7 +129,7 @@ std::optional<std::string> MCPService::get_prompt(const std::string& name, const
     try {
         return mcp_client_->prompt_manager()->get_prompt(name, arguments);
     } catch (const std::exception& e) {
-        get_logger().log(LogLevel::Error, std::format("Error getting prompt {}: {}", name, e.what()));
+        LOG_ERROR("Error getting prompt {}: {}", name, e.what());
         return std::nullopt;
     }
 }
@@ -198,7 +199,7 @@ void MCPService::refresh_cache() {
         if (mcp_client_->get_connection_state() != MCPConnectionState::Connected) {
             auto connect_result = mcp_client_->connect().get();
             if (!connect_result) {
-                get_logger().log(LogLevel::Error, std::format("Failed to connect to MCP server: {}", connect_result.error().message));
+                LOG_ERROR("Failed to connect to MCP server: {}", connect_result.error().message);
                 return;
             }
         }
@@ -217,10 +218,16 @@ void MCPService::refresh_cache() {
         }
         
         cache_valid_ = true;
-        get_logger().log(LogLevel::Info, std::format("MCP cache refreshed: {} tools, {} resources, {} prompts", 
-                                                    tools_cache_.size(), resources_cache_.size(), prompts_cache_.size()));
+        LOG_INFO("MCP cache refreshed: {} tools, {} resources, {} prompts", 
+                                                    tools_cache_.size(), resources_cache_.size(), prompts_cache_.size());
         
     } catch (const std::exception& e) {
-        get_logger().log(LogLevel::Error, std::format("Error refreshing MCP cache: {}", e.what()));
+        LOG_ERROR("Error refreshing MCP cache: {}", e.what());
     }
-}
\ No newline at end of file
+}
+
+void MCPService::cancel_pending_requests(const std::string& reason) {
+    if (mcp_client_) {
+        mcp_client_->cancel_all_requests(reason);
+    }
+}
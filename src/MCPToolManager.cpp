@@ -2,6 +2,8 @@
 #include "MCPClient.hpp"
 #include "MCPProtocol.hpp"
 #include "GlobalLogger.hpp"
+#include "Metrics.hpp"
+#include "Trace.hpp"
 #include <future>
 #include <format>
 
@@ -11,8 +13,13 @@ MCPToolManager::MCPToolManager(MCPClient* client)
 MCPToolManager::~MCPToolManager() = default;
 
 std::vector<nlohmann::json> MCPToolManager::list_tools(std::optional<std::string> cursor) {
-    if (!cursor.has_value() && !tool_cache_.empty()) {
-        return tool_cache_;
+    uint64_t generation = 0;
+    {
+        std::lock_guard lock(cache_mutex_);
+        if (!cursor.has_value() && !tool_cache_.empty()) {
+            return tool_cache_;
+        }
+        generation = cache_generation_;
     }
     auto request = MCPProtocolMessages::create_tools_list_request(cursor);
     auto fut = client_->send_request_for_manager(request);
@@ -20,46 +27,119 @@ std::vector<nlohmann::json> MCPToolManager::list_tools(std::optional<std::string
     if (!result || result->is_error() || !result->result.has_value()) {
         // Log the specific error for debugging
         if (!result) {
-            get_logger().log(LogLevel::Error, "MCPToolManager::list_tools - No result from request");
+            LOG_ERROR("MCPToolManager::list_tools - No result from request");
         } else if (result->is_error()) {
-            get_logger().log(LogLevel::Error, std::format("MCPToolManager::list_tools - Error response: {}", result->error->message));
+            LOG_ERROR("MCPToolManager::list_tools - Error response: {}", result->error->message);
         } else {
-            get_logger().log(LogLevel::Error, "MCPToolManager::list_tools - No result field in response");
+            LOG_ERROR("MCPToolManager::list_tools - No result field in response");
         }
         return {};
     }
     const auto& res = result->result.value();
-    get_logger().log(LogLevel::Debug, std::format("MCPToolManager::list_tools - Response: {}", res.dump()));
+    LOG_DEBUG("MCPToolManager::list_tools - Response: {}", res.dump());
     
     if (res.contains("tools") && res["tools"].is_array()) {
-        tool_cache_ = res["tools"].get<std::vector<nlohmann::json>>();
-        if (res.contains("cursor") && res["cursor"].is_string()) {
-            last_cursor_ = res["cursor"].get<std::string>();
+        auto page = res["tools"].get<std::vector<nlohmann::json>>();
+        std::string next_cursor;
+        for (const char* key : {"nextCursor", "cursor"}) {
+            if (res.contains(key) && res[key].is_string()) {
+                next_cursor = res[key].get<std::string>();
+                break;
+            }
+        }
+        auto compiled = compile_validators(page);
+
+        std::lock_guard lock(cache_mutex_);
+        if (generation != cache_generation_) {
+            // The list changed while this page was in flight; don't mix it into the new one
+            LOG_DEBUG("MCPToolManager::list_tools - Tool list changed during the request; not caching the page");
+            return page;
+        }
+        // The first page starts a fresh list; pages fetched with a cursor extend it
+        if (!cursor.has_value()) {
+            tool_cache_ = page;
+            validators_ = std::move(compiled.validators);
+        } else {
+            tool_cache_.insert(tool_cache_.end(), page.begin(), page.end());
+            for (auto& [name, validator] : compiled.validators) {
+                validators_.insert_or_assign(name, std::move(validator));
+            }
         }
-        get_logger().log(LogLevel::Info, std::format("MCPToolManager::list_tools - Successfully loaded {} tools", tool_cache_.size()));
-        return tool_cache_;
+        last_cursor_ = std::move(next_cursor);
+        for (const auto& [name, keywords] : compiled.unsupported) {
+            validators_.erase(name);
+            if (unsupported_warned_.insert(name).second) {
+                LOG_WARN("MCPToolManager - inputSchema for '{}' uses unsupported keywords ({}); leaving validation to the server",
+                         name, keywords);
+            }
+        }
+        LOG_INFO("MCPToolManager::list_tools - Successfully loaded {} tools", page.size());
+        return page;
     } else {
-        get_logger().log(LogLevel::Error, std::format("MCPToolManager::list_tools - Response does not contain tools array: {}", res.dump()));
+        LOG_ERROR("MCPToolManager::list_tools - Response does not contain tools array: {}", res.dump());
     }
     return {};
 }
 
-nlohmann::json MCPToolManager::call_tool(const std::string& name, std::optional<nlohmann::json> arguments) {
+nlohmann::json MCPToolManager::call_tool(const std::string& name, std::optional<nlohmann::json> arguments,
+                                         const MCPCancelHandle& cancel) {
+    TraceSpan span("tools/call", "mcp");
+    span.arg("tool", name);
     // Notify start of tool call
     if (notifier_) {
         notifier_->on_tool_call_start(name, arguments.value_or(nlohmann::json::object()));
         notifier_->on_mcp_activity(std::format("Calling tool: {}", name));
     }
     
-    auto request = MCPProtocolMessages::create_tools_call_request(name, arguments);
-    auto fut = client_->send_request_for_manager(request);
+    // Reject malformed arguments before they cost a round-trip
+    auto valid = check_parameters(name, arguments.value_or(nlohmann::json::object()));
+    if (!valid) {
+        std::string error_msg = std::format("Invalid arguments for tool '{}':\n{}", name, valid.error());
+        LOG_WARN("MCPToolManager::call_tool - {}", error_msg);
+        if (notifier_) {
+            notifier_->on_tool_call_error(name, error_msg);
+            notifier_->on_mcp_activity(std::format("Tool call rejected: {}", name));
+        }
+        return nlohmann::json{
+            {"isError", true},
+            {"content", nlohmann::json::array({{{"type", "text"}, {"text", error_msg}}})}
+        };
+    }
+    
+    int64_t progress_token = next_progress_token_++;
+    {
+        std::lock_guard lock(progress_mutex_);
+        pending_progress_[progress_token] = name;
+    }
+    auto request = MCPProtocolMessages::create_tools_call_request(name, arguments, progress_token);
+    auto started = std::chrono::steady_clock::now();
+    auto fut = client_->send_request_for_manager(request, std::chrono::milliseconds(30000), cancel);
     auto result = fut.get();
+    {
+        auto& registry = MetricsRegistry::instance();
+        MetricLabels labels = {{"server", client_->server_label()}, {"tool", name}};
+        registry.histogram(metric_names::kMcpToolLatency, labels, "MCP tools/call round trip")
+            .observe(std::chrono::steady_clock::now() - started);
+        std::string outcome = !result ? (result.error().code == ApiError::Timeout ? "timeout"
+                                         : result.error().code == ApiError::Cancelled ? "cancelled" : "error")
+                            : result->is_error() ? "error" : "ok";
+        span.arg("server", labels.front().second);
+        span.arg("outcome", outcome);
+        labels.emplace_back("outcome", std::move(outcome));
+        registry.counter(metric_names::kMcpToolCalls, std::move(labels), "MCP tool calls by outcome").inc();
+    }
+    {
+        std::lock_guard lock(progress_mutex_);
+        pending_progress_.erase(progress_token);
+    }
     
     if (!result || result->is_error() || !result->result.has_value()) {
         // Notify error
         if (notifier_) {
             std::string error_msg = "Tool call failed";
-            if (result && result->is_error()) {
+            if (!result) {
+                error_msg = result.error().message;
+            } else if (result->is_error()) {
                 error_msg = result->error->message;
             }
             notifier_->on_tool_call_error(name, error_msg);
@@ -78,12 +158,82 @@ nlohmann::json MCPToolManager::call_tool(const std::string& name, std::optional<
 }
 
 bool MCPToolManager::validate_parameters(const std::string& name, const nlohmann::json& arguments) {
-    // TODO: Implement parameter validation if tool schemas are available
-    return true;
+    return check_parameters(name, arguments).has_value();
+}
+
+std::expected<void, std::string> MCPToolManager::check_parameters(const std::string& name, const nlohmann::json& arguments) const {
+    std::lock_guard lock(cache_mutex_);
+    auto it = validators_.find(name);
+    if (it == validators_.end()) {
+        return {}; // No schema known for this tool; let the server decide
+    }
+    return it->second.validate(arguments);
+}
+
+MCPToolManager::CompiledPage MCPToolManager::compile_validators(const std::vector<nlohmann::json>& tools) {
+    CompiledPage compiled;
+    for (const auto& tool : tools) {
+        if (!tool.contains("name") || !tool["name"].is_string() || !tool.contains("inputSchema")) {
+            continue;
+        }
+        auto name = tool["name"].get<std::string>();
+        auto validator = MCPSchemaValidator::compile(tool["inputSchema"]);
+        if (!validator) {
+            LOG_WARN("MCPToolManager - Ignoring invalid inputSchema for '{}': {}", name, validator.error());
+            continue;
+        }
+        if (!validator->unsupported_keywords().empty()) {
+            // A partial check could reject valid arguments, so the server validates this tool alone
+            std::string keywords;
+            for (const auto& keyword : validator->unsupported_keywords()) {
+                if (!keywords.empty()) keywords += ", ";
+                keywords += keyword;
+            }
+            compiled.unsupported.emplace_back(std::move(name), std::move(keywords));
+            continue;
+        }
+        compiled.validators.emplace(std::move(name), std::move(*validator));
+    }
+    return compiled;
 }
 
 void MCPToolManager::handle_progress_notification(const nlohmann::json& progress) {
-    // TODO: Implement progress tracking
+    if (!progress.contains("progressToken") || !progress.contains("progress") || !progress["progress"].is_number()) {
+        return;
+    }
+    // We only hand out integer tokens; servers may echo them back as strings
+    const auto& token_json = progress["progressToken"];
+    int64_t token = 0;
+    if (token_json.is_number_integer()) {
+        token = token_json.get<int64_t>();
+    } else if (token_json.is_string()) {
+        try {
+            token = std::stoll(token_json.get<std::string>());
+        } catch (const std::exception&) {
+            return;
+        }
+    } else {
+        return;
+    }
+
+    std::string tool_name;
+    {
+        std::lock_guard lock(progress_mutex_);
+        auto it = pending_progress_.find(token);
+        if (it == pending_progress_.end()) {
+            return; // Late notification for a call that already finished
+        }
+        tool_name = it->second;
+    }
+
+    std::optional<double> total;
+    if (progress.contains("total") && progress["total"].is_number()) {
+        total = progress["total"].get<double>();
+    }
+    std::string message = progress.value("message", "");
+    if (notifier_) {
+        notifier_->on_tool_call_progress(tool_name, progress["progress"].get<double>(), total, message);
+    }
 }
 
 void MCPToolManager::handle_list_changed_notification() {
@@ -96,6 +246,9 @@ void MCPToolManager::set_notification_interface(MCPNotificationInterface* notifi
 }
 
 void MCPToolManager::clear_cache() {
+    std::lock_guard lock(cache_mutex_);
+    ++cache_generation_;
     tool_cache_.clear();
     last_cursor_.clear();
+    validators_.clear();
 } 
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "MCPToolService.hpp"
 #include "GlobalLogger.hpp"
+#include "Trace.hpp"
 #include <algorithm>
 #include <regex>
 
@@ -15,7 +16,7 @@ nlohmann::json MCPTool::to_json() const {
 void MCPToolService::initialize(MCPServerManager* server_manager) {
     server_manager_ = server_manager;
     cache_valid_ = false;
-    get_logger().log(LogLevel::Info, "MCPToolService initialized");
+    LOG_INFO("MCPToolService initialized");
 }
 
 std::vector<MCPTool> MCPToolService::get_all_available_tools() {
@@ -40,17 +41,17 @@ void MCPToolService::refresh_tool_cache() {
     // Get all connected servers
     auto connected_servers = server_manager_->get_connected_servers();
     
-    get_logger().log(LogLevel::Info, std::format("Discovering tools from {} connected MCP servers", connected_servers.size()));
+    LOG_INFO("Discovering tools from {} connected MCP servers", connected_servers.size());
     
     for (const auto& server_name : connected_servers) {
         auto tools = discover_tools_from_server(server_name);
         tool_cache_.insert(tool_cache_.end(), tools.begin(), tools.end());
         
-        get_logger().log(LogLevel::Info, std::format("Found {} tools from server '{}'", tools.size(), server_name));
+        LOG_INFO("Found {} tools from server '{}'", tools.size(), server_name);
     }
     
     cache_valid_ = true;
-    get_logger().log(LogLevel::Info, std::format("Total tools discovered: {}", tool_cache_.size()));
+    LOG_INFO("Total tools discovered: {}", tool_cache_.size());
 }
 
 std::vector<MCPTool> MCPToolService::discover_tools_from_server(const std::string& server_name) {
@@ -62,7 +63,7 @@ std::vector<MCPTool> MCPToolService::discover_tools_from_server(const std::strin
     
     auto client = server_manager_->get_client(server_name);
     if (!client || !client->tool_manager()) {
-        get_logger().log(LogLevel::Warning, std::format("No tool manager available for server '{}'", server_name));
+        LOG_WARN("No tool manager available for server '{}'", server_name);
         return tools;
     }
     
@@ -82,7 +83,7 @@ std::vector<MCPTool> MCPToolService::discover_tools_from_server(const std::strin
         }
         
     } catch (const std::exception& e) {
-        get_logger().log(LogLevel::Error, std::format("Error discovering tools from server '{}': {}", server_name, e.what()));
+        LOG_ERROR("Error discovering tools from server '{}': {}", server_name, e.what());
     }
     
     return tools;
@@ -109,32 +110,53 @@ std::optional<nlohmann::json> MCPToolService::call_tool(const std::string& tool_
     }
     
     // Find which server has this tool
+    TraceSpan lookup("find_tool", "mcp");
     auto tool = find_tool(tool_name);
+    lookup.end();
     if (!tool.has_value()) {
-        get_logger().log(LogLevel::Warning, std::format("Tool '{}' not found", tool_name));
+        LOG_WARN("Tool '{}' not found", tool_name);
         return std::nullopt;
     }
     
     auto client = server_manager_->get_client(tool->server_name);
     if (!client || !client->tool_manager()) {
-        get_logger().log(LogLevel::Error, std::format("No client available for server '{}'", tool->server_name));
+        LOG_ERROR("No client available for server '{}'", tool->server_name);
         return std::nullopt;
     }
     
     try {
-        get_logger().log(LogLevel::Info, std::format("Calling tool '{}' on server '{}'", tool_name, tool->server_name));
+        LOG_INFO("Calling tool '{}' on server '{}'", tool_name, tool->server_name);
         
-        auto result = client->tool_manager()->call_tool(tool_name, arguments);
+        MCPCancelHandle cancel;
+        {
+            std::lock_guard lock(turn_mutex_);
+            cancel = turn_cancel_;
+        }
+        auto result = client->tool_manager()->call_tool(tool_name, arguments, cancel);
         
-        get_logger().log(LogLevel::Info, std::format("Tool '{}' executed successfully", tool_name));
+        LOG_INFO("Tool '{}' executed successfully", tool_name);
         return result;
         
     } catch (const std::exception& e) {
-        get_logger().log(LogLevel::Error, std::format("Error calling tool '{}': {}", tool_name, e.what()));
+        LOG_ERROR("Error calling tool '{}': {}", tool_name, e.what());
         return std::nullopt;
     }
 }
 
+void MCPToolService::begin_turn() {
+    std::lock_guard lock(turn_mutex_);
+    turn_cancel_ = MCPCancelHandle();
+}
+
+void MCPToolService::cancel_turn(const std::string& reason) {
+    MCPCancelHandle cancel;
+    {
+        std::lock_guard lock(turn_mutex_);
+        cancel = turn_cancel_;
+    }
+    cancel.cancel(reason);
+}
+
 std::string MCPToolService::get_tools_description_for_ai() {
     auto tools = get_all_available_tools();
     
@@ -234,7 +256,7 @@ std::optional<nlohmann::json> MCPToolService::auto_call_tools(const std::string&
                     args["path"] = "."; // Current directory
                 }
                 
-                get_logger().log(LogLevel::Info, std::format("Auto-calling tool '{}' for file operation", tool.name));
+                LOG_INFO("Auto-calling tool '{}' for file operation", tool.name);
                 return call_tool(tool.name, args);
             }
         }
@@ -253,7 +275,7 @@ std::optional<nlohmann::json> MCPToolService::auto_call_tools(const std::string&
                 nlohmann::json args;
                 args["query"] = user_message;
                 
-                get_logger().log(LogLevel::Info, std::format("Auto-calling tool '{}' for web search", tool.name));
+                LOG_INFO("Auto-calling tool '{}' for web search", tool.name);
                 return call_tool(tool.name, args);
             }
         }
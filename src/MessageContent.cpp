@@ -0,0 +1,53 @@
+#include "MessageContent.hpp"
+
+bool MessageContent::can_extend_tail(size_t extra) const {
+    return !segments_.empty() && !tail_shared_ && segments_.back()->size() + extra <= kSegmentSize;
+}
+
+void MessageContent::append(std::string_view text) {
+    if (text.empty()) return;
+    if (can_extend_tail(text.size())) {
+        segments_.back()->append(text);
+    } else {
+        segments_.push_back(std::make_shared<std::string>(text));
+        tail_shared_ = false;
+    }
+    size_ += text.size();
+}
+
+void MessageContent::append(std::string&& text) {
+    if (text.size() < kSegmentSize) {
+        append(std::string_view(text));
+        return;
+    }
+    // Large payloads (tool output) become a segment of their own without a copy
+    size_ += text.size();
+    segments_.push_back(std::make_shared<std::string>(std::move(text)));
+    tail_shared_ = false;
+}
+
+std::string MessageContent::substr(size_t offset) const {
+    std::string out;
+    if (offset >= size_) return out;
+    out.reserve(size_ - offset);
+    size_t position = 0;
+    for (const auto& segment : segments_) {
+        size_t end = position + segment->size();
+        if (end > offset) {
+            size_t skip = offset > position ? offset - position : 0;
+            out.append(*segment, skip);
+        }
+        position = end;
+    }
+    return out;
+}
+
+bool MessageContent::operator==(std::string_view text) const {
+    if (text.size() != size_) return false;
+    size_t position = 0;
+    for (const auto& segment : segments_) {
+        if (text.compare(position, segment->size(), *segment) != 0) return false;
+        position += segment->size();
+    }
+    return true;
+}
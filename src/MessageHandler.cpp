@@ -1,21 +1,73 @@
 #include "MessageHandler.hpp"
-#include <fstream>
+#include <chrono>
+#include <algorithm>
 
-MessageHandler::MessageHandler() {}
+MessageHandler::MessageHandler(std::string transcript_path) : transcript_(std::move(transcript_path)) {}
 
-void MessageHandler::push_message(const ChatMessage& msg) {
+void MessageHandler::set_change_callback(std::function<void()> callback) {
     std::lock_guard lock(mutex_);
-    messages_.push_back(msg);
-    // Log to chat_history.log
-    std::ofstream log("chat_history.log", std::ios::app);
-    if (log) {
-        auto now = std::chrono::system_clock::now();
-        std::time_t now_c = std::chrono::system_clock::to_time_t(now);
-        char timebuf[32];
-        std::strftime(timebuf, sizeof(timebuf), "%Y-%m-%d %H:%M:%S", std::localtime(&now_c));
-        const char* sender = (msg.sender == ChatMessage::Sender::User) ? "USER" : "AI";
-        log << "[" << timebuf << "] [" << sender << "] " << msg.content << std::endl;
+    on_change_ = std::move(callback);
+}
+
+void MessageHandler::notify_changed() {
+    std::function<void()> callback;
+    {
+        std::lock_guard lock(mutex_);
+        callback = on_change_;
     }
+    if (callback) callback();
+}
+
+void MessageHandler::set_persist_callback(std::function<void(const ChatMessage&)> callback) {
+    std::lock_guard lock(mutex_);
+    on_persist_ = std::move(callback);
+}
+
+void MessageHandler::persist(const ChatMessage& msg) {
+    std::function<void(const ChatMessage&)> callback;
+    {
+        std::lock_guard lock(mutex_);
+        callback = on_persist_;
+    }
+    if (callback) callback(msg);
+}
+
+void MessageHandler::set_transcript_enabled(bool enabled) {
+    transcript_.set_enabled(enabled);
+}
+
+void MessageHandler::set_transcript_fsync_policy(TranscriptWriter::FsyncPolicy policy) {
+    transcript_.set_fsync_policy(policy);
+}
+
+void MessageHandler::push_message(const ChatMessage& msg) {
+    ChatMessage stored;
+    {
+        std::lock_guard lock(mutex_);
+        // A new message ends any reply still streaming into the previous one
+        stream_decoder_.reset();
+        stream_tail_.clear();
+        messages_.push_back(msg);
+        messages_.back().id = next_id_++;
+        messages_.back().version = 0;
+        if (messages_.back().created_ms == 0) {
+            messages_.back().created_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+        }
+        stored = messages_.back();
+        // Queued under the lock so the transcript keeps the order of messages_;
+        // append() only pushes onto the writer's queue and never does I/O
+        if (transcript_.is_enabled()) {
+            transcript_.append(msg.sender == ChatMessage::Sender::User ? TranscriptWriter::Kind::User
+                                                                       : TranscriptWriter::Kind::AI,
+                               msg.content.str());
+        }
+    }
+    // An empty AI message is a placeholder for a reply still to stream in
+    if (stored.sender == ChatMessage::Sender::User || !stored.content.empty()) {
+        persist(stored);
+    }
+    notify_changed();
 }
 
 std::vector<ChatMessage> MessageHandler::get_messages(int offset, int count) const {
@@ -29,46 +81,99 @@ std::vector<ChatMessage> MessageHandler::get_messages(int offset, int count) con
     return result;
 }
 
+std::vector<ChatMessage> MessageHandler::get_messages_from(size_t index) const {
+    std::lock_guard lock(mutex_);
+    if (index >= messages_.size()) {
+        return {};
+    }
+    return std::vector<ChatMessage>(messages_.begin() + index, messages_.end());
+}
+
+std::vector<ChatMessage> MessageHandler::get_message_range(size_t begin, size_t end) const {
+    std::lock_guard lock(mutex_);
+    end = std::min(end, messages_.size());
+    if (begin >= end) {
+        return {};
+    }
+    return std::vector<ChatMessage>(messages_.begin() + begin, messages_.begin() + end);
+}
+
 int MessageHandler::message_count() const {
     std::lock_guard lock(mutex_);
     return messages_.size();
 }
 
-void MessageHandler::append_to_last_ai_message(const std::string& text, bool is_complete) {
-    std::lock_guard lock(mutex_);
-    if (!messages_.empty() && messages_.back().sender == ChatMessage::Sender::AI) {
-        messages_.back().content += text;
-        // Log every chunk append
-        std::ofstream log("chat_history.log", std::ios::app);
-        if (log) {
-            auto now = std::chrono::system_clock::now();
-            std::time_t now_c = std::chrono::system_clock::to_time_t(now);
-            char timebuf[32];
-            std::strftime(timebuf, sizeof(timebuf), "%Y-%m-%d %H:%M:%S", std::localtime(&now_c));
-            log << "[" << timebuf << "] [AI] (chunk append) " << text << std::endl;
-            
-            // If this is the last chunk, log the complete message
+void MessageHandler::append_to_last_ai_message(const std::string& chunk, bool is_complete) {
+    bool appended = false;
+    ChatMessage finished;
+    {
+        std::lock_guard lock(mutex_);
+        if (!messages_.empty() && messages_.back().sender == ChatMessage::Sender::AI) {
+            // Chunks can end inside a multibyte character; hold its first
+            // bytes back until the rest arrives so views never see half of it
+            std::string text = std::move(stream_tail_) + chunk;
+            stream_tail_.clear();
+            stream_decoder_.feed(chunk, [](uint32_t) {});
+            size_t held = is_complete ? 0 : stream_decoder_.pending_bytes();
+            if (held > 0) {
+                stream_tail_.assign(text, text.size() - held, held);
+                text.resize(text.size() - held);
+            }
+            if (is_complete) stream_decoder_.reset();
+            messages_.back().content.append(text);
+            ++messages_.back().version;
+            appended = true;
+            transcript_.append(TranscriptWriter::Kind::Chunk, std::move(text));
             if (is_complete) {
-                log_complete_ai_message();
+                finished = messages_.back();
+                // The last chunk also logs the complete message
+                if (transcript_.is_enabled()) {
+                    transcript_.append(TranscriptWriter::Kind::Complete, messages_.back().content.str());
+                }
             }
         }
     }
+    if (appended && is_complete) {
+        persist(finished);
+    }
+    notify_changed();
 }
 
 void MessageHandler::log_complete_ai_message() {
-    if (!messages_.empty() && messages_.back().sender == ChatMessage::Sender::AI) {
-        std::ofstream log("chat_history.log", std::ios::app);
-        if (log) {
-            auto now = std::chrono::system_clock::now();
-            std::time_t now_c = std::chrono::system_clock::to_time_t(now);
-            char timebuf[32];
-            std::strftime(timebuf, sizeof(timebuf), "%Y-%m-%d %H:%M:%S", std::localtime(&now_c));
-            log << "[" << timebuf << "] [AI] (complete message) " << messages_.back().content << std::endl;
+    std::lock_guard lock(mutex_);
+    if (messages_.empty() || messages_.back().sender != ChatMessage::Sender::AI || !transcript_.is_enabled()) return;
+    transcript_.append(TranscriptWriter::Kind::Complete, messages_.back().content.str());
+}
+
+void MessageHandler::prepend_messages(std::vector<ChatMessage> older) {
+    if (older.empty()) return;
+    {
+        std::lock_guard lock(mutex_);
+        for (const auto& msg : older) {
+            next_id_ = std::max(next_id_, msg.id + 1);
         }
+        prepended_ += older.size();
+        messages_.insert(messages_.begin(), std::make_move_iterator(older.begin()), std::make_move_iterator(older.end()));
     }
+    notify_changed();
 }
 
-void MessageHandler::clear() {
+uint64_t MessageHandler::prepended_count() const {
+    std::lock_guard lock(mutex_);
+    return prepended_;
+}
+
+void MessageHandler::set_min_next_id(uint64_t next) {
     std::lock_guard lock(mutex_);
-    messages_.clear();
+    next_id_ = std::max(next_id_, next);
+}
+
+void MessageHandler::clear() {
+    {
+        std::lock_guard lock(mutex_);
+        messages_.clear();
+        stream_decoder_.reset();
+        stream_tail_.clear();
+    }
+    notify_changed();
 }
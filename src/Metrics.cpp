@@ -0,0 +1,386 @@
+#include "Metrics.hpp"
+#include "GlobalLogger.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+    std::string label_key(const MetricLabels& labels) {
+        std::string key;
+        for (const auto& [name, value] : labels) {
+            key += name;
+            key += '=';
+            key += value;
+            key += '\x1f';
+        }
+        return key;
+    }
+
+    nlohmann::json labels_json(const MetricLabels& labels) {
+        nlohmann::json out = nlohmann::json::object();
+        for (const auto& [name, value] : labels) out[name] = value;
+        return out;
+    }
+
+    // {a="x",b="y"} with Prometheus escaping; `extra` is appended verbatim
+    std::string prometheus_labels(const MetricLabels& labels, std::string_view extra = "") {
+        if (labels.empty() && extra.empty()) return {};
+        std::string out = "{";
+        for (const auto& [name, value] : labels) {
+            if (out.size() > 1) out += ',';
+            out += name;
+            out += "=\"";
+            for (char c : value) {
+                if (c == '\\' || c == '"') out += '\\';
+                if (c == '\n') {
+                    out += "\\n";
+                    continue;
+                }
+                out += c;
+            }
+            out += '"';
+        }
+        if (!extra.empty()) {
+            if (out.size() > 1) out += ',';
+            out += extra;
+        }
+        out += '}';
+        return out;
+    }
+
+    constexpr std::array<std::pair<double, const char*>, 4> kQuantiles = {{
+        {0.5, "0.5"}, {0.9, "0.9"}, {0.99, "0.99"}, {0.999, "0.999"}
+    }};
+
+    // Clears the way for bind(): removes a socket left behind by an earlier
+    // run, but never a regular file or a socket something still listens on
+    bool remove_stale_socket(const std::string& path, const sockaddr_un& addr) {
+        struct stat st{};
+        if (lstat(path.c_str(), &st) != 0) {
+            return errno == ENOENT;
+        }
+        if (!S_ISSOCK(st.st_mode)) {
+            LOG_ERROR("MetricsExporter: {} exists and is not a socket", path);
+            return false;
+        }
+        int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (probe == -1) return false;
+        bool live = connect(probe, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == 0;
+        int error = errno;
+        close(probe);
+        if (live) {
+            LOG_ERROR("MetricsExporter: {} is in use by another process", path);
+            return false;
+        }
+        if (error != ECONNREFUSED) {
+            LOG_ERROR("MetricsExporter: cannot probe {}: {}", path, strerror(error));
+            return false;
+        }
+        return unlink(path.c_str()) == 0 || errno == ENOENT;
+    }
+}
+
+double MetricsHistogram::Snapshot::quantile(double q) const {
+    if (count == 0) return 0;
+    uint64_t rank = static_cast<uint64_t>(std::ceil(q * static_cast<double>(count)));
+    rank = std::clamp<uint64_t>(rank, 1, count);
+    uint64_t seen = 0;
+    for (const auto& [index, n] : buckets) {
+        seen += n;
+        if (seen >= rank) {
+            double lower = static_cast<double>(bucket_lower(index));
+            double upper = index + 1 < kBuckets ? static_cast<double>(bucket_lower(index + 1)) : lower;
+            double mid = index < kSubBuckets ? lower : (lower + upper - 1) / 2;
+            return std::min(mid, static_cast<double>(max));
+        }
+    }
+    return static_cast<double>(max);
+}
+
+MetricsHistogram::Snapshot MetricsHistogram::snapshot() const {
+    Snapshot s;
+    s.count = count_.load(std::memory_order_relaxed);
+    s.sum = sum_.load(std::memory_order_relaxed);
+    s.max = max_.load(std::memory_order_relaxed);
+    uint64_t in_buckets = 0;
+    for (size_t i = 0; i < kBuckets; ++i) {
+        uint64_t n = buckets_[i].load(std::memory_order_relaxed);
+        if (n) {
+            s.buckets.emplace_back(i, n);
+            in_buckets += n;
+        }
+    }
+    s.count = in_buckets; // Keep quantiles consistent with the buckets we read
+    return s;
+}
+
+MetricsRegistry& MetricsRegistry::instance() {
+    static MetricsRegistry registry;
+    return registry;
+}
+
+MetricsRegistry::Family* MetricsRegistry::family(std::string_view name, Kind kind, std::string_view help) {
+    auto it = families_.find(name);
+    if (it == families_.end()) {
+        it = families_.emplace(std::string(name), Family{kind, std::string(help), {}, {}, {}}).first;
+    } else if (it->second.kind != kind) {
+        LOG_ERROR("Metric {} registered with two different types; updates through the second are dropped", name);
+        return nullptr;
+    }
+    return &it->second;
+}
+
+MetricsCounter& MetricsRegistry::counter(std::string_view name, MetricLabels labels, std::string_view help) {
+    std::lock_guard lock(mutex_);
+    Family* f = family(name, Kind::Counter, help);
+    if (!f) return detached_counter_;
+    auto& slot = f->counters[label_key(labels)];
+    if (!slot.second) slot = {std::move(labels), std::make_unique<MetricsCounter>()};
+    return *slot.second;
+}
+
+MetricsGauge& MetricsRegistry::gauge(std::string_view name, MetricLabels labels, std::string_view help) {
+    std::lock_guard lock(mutex_);
+    Family* f = family(name, Kind::Gauge, help);
+    if (!f) return detached_gauge_;
+    auto& slot = f->gauges[label_key(labels)];
+    if (!slot.second) slot = {std::move(labels), std::make_unique<MetricsGauge>()};
+    return *slot.second;
+}
+
+MetricsHistogram& MetricsRegistry::histogram(std::string_view name, MetricLabels labels, std::string_view help) {
+    std::lock_guard lock(mutex_);
+    Family* f = family(name, Kind::Histogram, help);
+    if (!f) return detached_histogram_;
+    auto& slot = f->histograms[label_key(labels)];
+    if (!slot.second) slot = {std::move(labels), std::make_unique<MetricsHistogram>()};
+    return *slot.second;
+}
+
+nlohmann::json MetricsRegistry::to_json() const {
+    nlohmann::json counters = nlohmann::json::array();
+    nlohmann::json gauges = nlohmann::json::array();
+    nlohmann::json histograms = nlohmann::json::array();
+    std::lock_guard lock(mutex_);
+    for (const auto& [name, family] : families_) {
+        for (const auto& [_, entry] : family.counters) {
+            counters.push_back({{"name", name}, {"labels", labels_json(entry.first)}, {"value", entry.second->value()}});
+        }
+        for (const auto& [_, entry] : family.gauges) {
+            gauges.push_back({{"name", name}, {"labels", labels_json(entry.first)}, {"value", entry.second->value()}});
+        }
+        for (const auto& [_, entry] : family.histograms) {
+            auto s = entry.second->snapshot();
+            histograms.push_back({
+                {"name", name}, {"labels", labels_json(entry.first)},
+                {"count", s.count}, {"sum", s.sum}, {"mean", s.mean()}, {"max", s.max},
+                {"p50", s.quantile(0.5)}, {"p90", s.quantile(0.9)}, {"p99", s.quantile(0.99)},
+                {"p999", s.quantile(0.999)}
+            });
+        }
+    }
+    auto now = std::chrono::system_clock::now();
+    return {
+        {"timestamp_ms", std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count()},
+        {"uptime_s", std::chrono::duration_cast<std::chrono::seconds>(now - started_).count()},
+        {"counters", std::move(counters)},
+        {"gauges", std::move(gauges)},
+        {"histograms", std::move(histograms)}
+    };
+}
+
+std::string MetricsRegistry::to_prometheus() const {
+    std::string out;
+    std::lock_guard lock(mutex_);
+    for (const auto& [name, family] : families_) {
+        if (!family.help.empty()) out += std::format("# HELP {} {}\n", name, family.help);
+        switch (family.kind) {
+            case Kind::Counter:
+                out += std::format("# TYPE {} counter\n", name);
+                for (const auto& [_, entry] : family.counters) {
+                    out += std::format("{}{} {}\n", name, prometheus_labels(entry.first), entry.second->value());
+                }
+                break;
+            case Kind::Gauge:
+                out += std::format("# TYPE {} gauge\n", name);
+                for (const auto& [_, entry] : family.gauges) {
+                    out += std::format("{}{} {}\n", name, prometheus_labels(entry.first), entry.second->value());
+                }
+                break;
+            case Kind::Histogram:
+                out += std::format("# TYPE {} summary\n", name);
+                for (const auto& [_, entry] : family.histograms) {
+                    auto s = entry.second->snapshot();
+                    for (const auto& [q, text] : kQuantiles) {
+                        out += std::format("{}{} {}\n", name,
+                                           prometheus_labels(entry.first, std::format("quantile=\"{}\"", text)),
+                                           s.quantile(q));
+                    }
+                    out += std::format("{}_sum{} {}\n", name, prometheus_labels(entry.first), s.sum);
+                    out += std::format("{}_count{} {}\n", name, prometheus_labels(entry.first), s.count);
+                }
+                break;
+        }
+    }
+    return out;
+}
+
+MetricsExporter::MetricsExporter(std::string json_path, std::string socket_path, std::chrono::seconds interval)
+    : json_path_(std::move(json_path)), socket_path_(std::move(socket_path)),
+      interval_(std::max(interval, std::chrono::seconds(1))) {
+    if (json_path_.empty() && socket_path_.empty()) return;
+    if (pipe(wake_pipe_) == -1) {
+        LOG_ERROR("MetricsExporter: pipe failed: {}", strerror(errno));
+        return;
+    }
+    if (!socket_path_.empty()) {
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        if (socket_path_.size() >= sizeof(addr.sun_path)) {
+            LOG_ERROR("MetricsExporter: socket path too long: {}", socket_path_);
+        } else {
+            std::memcpy(addr.sun_path, socket_path_.c_str(), socket_path_.size() + 1);
+            if (remove_stale_socket(socket_path_, addr)) {
+                listen_fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+                if (listen_fd_ == -1 || bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == -1 ||
+                    listen(listen_fd_, 8) == -1) {
+                    LOG_ERROR("MetricsExporter: cannot listen on {}: {}", socket_path_, strerror(errno));
+                    if (listen_fd_ != -1) close(listen_fd_);
+                    listen_fd_ = -1;
+                }
+            }
+        }
+    }
+    thread_ = std::thread([this] { run(); });
+}
+
+MetricsExporter::~MetricsExporter() {
+    if (thread_.joinable()) {
+        char wake = 0;
+        [[maybe_unused]] auto n = write(wake_pipe_[1], &wake, 1);
+        thread_.join();
+    }
+    if (listen_fd_ != -1) {
+        close(listen_fd_);
+        unlink(socket_path_.c_str());
+    }
+    for (int fd : wake_pipe_) {
+        if (fd != -1) close(fd);
+    }
+    write_json_now();
+}
+
+void MetricsExporter::write_json_now() {
+    if (json_path_.empty()) return;
+    std::string tmp = json_path_ + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::trunc);
+        out << MetricsRegistry::instance().to_json().dump(2) << '\n';
+        if (!out) {
+            LOG_WARN("MetricsExporter: cannot write {}", tmp);
+            return;
+        }
+    }
+    // Readers never see a half-written snapshot
+    if (std::rename(tmp.c_str(), json_path_.c_str()) != 0) {
+        LOG_WARN("MetricsExporter: cannot replace {}: {}", json_path_, strerror(errno));
+    }
+}
+
+void MetricsExporter::run() {
+    auto next_write = std::chrono::steady_clock::now() + interval_;
+    while (true) {
+        pollfd fds[2] = {{wake_pipe_[0], POLLIN, 0}, {listen_fd_, POLLIN, 0}};
+        auto wait = std::chrono::ceil<std::chrono::milliseconds>(next_write - std::chrono::steady_clock::now());
+        int ready = poll(fds, listen_fd_ != -1 ? 2 : 1, static_cast<int>(std::max<int64_t>(0, wait.count())));
+        if (ready == -1 && errno != EINTR) {
+            LOG_ERROR("MetricsExporter: poll failed: {}", strerror(errno));
+            return;
+        }
+        if (fds[0].revents) return;
+        if (listen_fd_ != -1 && (fds[1].revents & POLLIN)) {
+            int client = accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+            if (client != -1) serve_client(client);
+        }
+        if (std::chrono::steady_clock::now() >= next_write) {
+            write_json_now();
+            next_write += interval_;
+        }
+    }
+}
+
+void MetricsExporter::serve_client(int fd) {
+    // A client that never reads must not hold up the JSON snapshots: every
+    // wait below comes out of one budget, and the client is dropped after it
+    auto deadline = std::chrono::steady_clock::now() + kClientTimeout;
+    auto remaining_ms = [&] {
+        auto left = std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        return static_cast<int>(std::max<int64_t>(0, left.count()));
+    };
+    // Whatever the client sent (an HTTP request from curl, or nothing from
+    // nc) gets the same answer; drain what is already there so close()
+    // does not reset the connection
+    char discard[1024];
+    pollfd pending{fd, POLLIN, 0};
+    if (poll(&pending, 1, std::min(50, remaining_ms())) > 0) {
+        [[maybe_unused]] auto n = recv(fd, discard, sizeof(discard), MSG_DONTWAIT);
+    }
+    std::string body = MetricsRegistry::instance().to_prometheus();
+    std::string response = std::format("HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\n"
+                                       "Content-Length: {}\r\n\r\n{}", body.size(), body);
+    size_t sent = 0;
+    while (sent < response.size()) {
+        ssize_t n = send(fd, response.data() + sent, response.size() - sent, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n > 0) {
+            sent += static_cast<size_t>(n);
+            continue;
+        }
+        if (n == -1 && errno == EINTR) continue;
+        if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            pollfd writable{fd, POLLOUT, 0};
+            int wait = remaining_ms();
+            if (wait > 0 && poll(&writable, 1, wait) > 0) continue;
+            LOG_WARN("MetricsExporter: client did not read the metrics within {} ms, dropping it",
+                     kClientTimeout.count());
+        }
+        break;
+    }
+    close(fd);
+}
+
+void record_provider_request(std::string_view provider, std::string_view model, long status,
+                             std::chrono::microseconds ttft, std::chrono::microseconds total) {
+    auto& registry = MetricsRegistry::instance();
+    MetricLabels labels = {{"provider", std::string(provider)}, {"model", std::string(model)}};
+    MetricLabels with_status = labels;
+    with_status.emplace_back("status", std::to_string(status));
+    registry.counter(metric_names::kProviderRequests, std::move(with_status),
+                     "Provider HTTP requests by status (0 = no response)").inc();
+    if (status == 0) return;
+    if (status == 200) {
+        registry.histogram(metric_names::kProviderTtft, labels, "Time to the first response byte").observe(ttft);
+    }
+    registry.histogram(metric_names::kProviderLatency, std::move(labels), "Provider request latency").observe(total);
+}
+
+void record_provider_tokens(std::string_view provider, std::string_view model, int64_t tokens_in, int64_t tokens_out) {
+    auto& registry = MetricsRegistry::instance();
+    MetricLabels labels = {{"provider", std::string(provider)}, {"model", std::string(model)}};
+    if (tokens_in > 0) {
+        registry.counter(metric_names::kProviderTokensIn, labels, "Prompt tokens reported by the provider")
+            .inc(static_cast<uint64_t>(tokens_in));
+    }
+    if (tokens_out > 0) {
+        registry.counter(metric_names::kProviderTokensOut, std::move(labels), "Completion tokens reported by the provider")
+            .inc(static_cast<uint64_t>(tokens_out));
+    }
+}
@@ -1,12 +1,38 @@
 #include "NCursesUI.hpp"
 #include <stdexcept>
+#include <algorithm>
 #include "utf8_utils.hpp"
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <cstdio>
+
+namespace {
+    // Gap allowed between bytes of one paste before giving up on the end marker
+    constexpr int kPasteByteTimeoutMs = 100;
+}
 
 NCursesUI::NCursesUI() noexcept {
     initscr();
+    setup_terminal();
+}
+
+NCursesUI::NCursesUI(FILE* out, FILE* in) {
+    screen_ = newterm(nullptr, out, in);
+    if (!screen_) throw std::runtime_error("Failed to open terminal");
+    out_ = out;
+    setup_terminal();
+}
+
+void NCursesUI::setup_terminal() {
     cbreak();
     noecho();
     keypad(stdscr, TRUE);
+    set_escdelay(25); // ESC is a command key; don't stall input waiting for a sequence
+    // Bracketed paste: the terminal wraps pasted text in ESC[200~ ... ESC[201~
+    define_key("\033[200~", kKeyPasteBegin);
+    define_key("\033[201~", kKeyPasteEnd);
+    std::fputs("\033[?2004h", out_);
+    std::fflush(out_);
     curs_set(1);
     start_color();
     init_windows();
@@ -15,13 +41,20 @@ NCursesUI::NCursesUI() noexcept {
 
 NCursesUI::~NCursesUI() noexcept {
     // Windows are automatically deleted by NcursesWindow destructors
+    std::fputs("\033[?2004l", out_);
+    std::fflush(out_);
     endwin();
+    if (screen_) {
+        destroy_windows(); // They belong to the screen
+        delscreen(screen_);
+    }
 }
 
 void NCursesUI::init_windows() {
     int rows, cols;
     getmaxyx(stdscr, rows, cols);
-    int input_height = 3;
+    input_text_rows_ = std::clamp(input_text_rows_, 1, std::max(1, rows / 2 - 2));
+    int input_height = input_text_rows_ + 2;
     auto chat = newwin(rows - input_height, cols, 0, 0);
     auto input = newwin(input_height, cols, rows - input_height, 0);
     auto settings = newwin(rows, cols, 0, 0);
@@ -35,79 +68,126 @@ void NCursesUI::init_windows() {
 }
 
 
-[[nodiscard]] int NCursesUI::draw_chat_window(const std::vector<std::string_view>& messages, int scroll_offset, bool waiting_for_ai) {
-    werase(chat_win_.get());
+void NCursesUI::draw_chat_window(const std::vector<std::string_view>& lines,
+                                 const std::vector<ChatHighlight>& highlights) {
     int maxy, maxx;
     getmaxyx(chat_win_.get(), maxy, maxx);
-    std::vector<std::string> wrapped_lines;
-    std::vector<int> is_first_line;
-    
-    for (const auto& msg : messages) {
-        bool is_user_msg = msg.starts_with("User: ");
-        bool is_ai_msg = msg.starts_with("AI: ");
-        std::string prefix, content;
-        int prefix_width;
-        if (is_user_msg) {
-            prefix = "Kieran: ";
-            content = msg.substr(prefix.length());
-        } else if (is_ai_msg) {
-            prefix = "AI: ";
-            content = msg.substr(prefix.length());
-        } else {
-            prefix = "";
-            content = msg;
+    size_t display_lines = static_cast<size_t>(std::max(0, maxy - 2));
+    if (chat_rows_.size() != display_lines) {
+        werase(chat_win_.get());
+        box(chat_win_, 0, 0);
+        chat_rows_.assign(display_lines, std::string());
+        chat_marks_.assign(display_lines, {});
+        paint_status();
+    }
+    std::vector<std::pair<size_t, size_t>> marks;
+    auto next_highlight = highlights.begin();
+    // While streaming only the tail rows change; leave the rest untouched
+    for (size_t row = 0; row < display_lines; ++row) {
+        std::string_view text = row < lines.size() ? lines[row] : std::string_view();
+        marks.clear();
+        for (; next_highlight != highlights.end() && next_highlight->row == row; ++next_highlight) {
+            size_t end = std::min(next_highlight->end, text.size());
+            if (next_highlight->begin < end) marks.emplace_back(next_highlight->begin, end);
         }
-        prefix_width = utf8_display_width(prefix);
-        int available_width = maxx - 2 - prefix_width;
-        std::string indent(prefix_width, ' ');
-        auto lines = utf8_word_wrap(content, available_width, prefix_width);
-        if (!lines.empty()) {
-            wrapped_lines.push_back(prefix + lines[0]);
-            is_first_line.push_back(1);
-            for (size_t i = 1; i < lines.size(); ++i) {
-                wrapped_lines.push_back(lines[i]);
-                is_first_line.push_back(0);
-            }
+        if (chat_rows_[row] == text && chat_marks_[row] == marks) continue;
+        int y = static_cast<int>(row) + 1;
+        wmove(chat_win_, y, 1);
+        wclrtoeol(chat_win_);
+        size_t written = 0;
+        for (const auto& [begin, end] : marks) {
+            waddnstr(chat_win_, text.data() + written, static_cast<int>(begin - written));
+            wattron(chat_win_, A_REVERSE);
+            waddnstr(chat_win_, text.data() + begin, static_cast<int>(end - begin));
+            wattroff(chat_win_, A_REVERSE);
+            written = end;
         }
-        
-        // Add a blank line after each message
-        wrapped_lines.push_back("");
-        is_first_line.push_back(2); // 2 means blank line
-    }
-    // Scroll_offset now applies to wrapped lines, not messages
-    int total_lines = wrapped_lines.size();
-    int display_lines = maxy - 2;
-    int start_line = std::max(0, total_lines - display_lines - scroll_offset);
-    int end_line = std::min(start_line + display_lines, total_lines);
-    int line = 1;
-    for (int i = start_line; i < end_line; ++i, ++line) {
-        if (is_first_line[i] == 2) { continue; } // skip printing for blank line, just increment line
-        
-        // Ensure text is printed exactly at column 1 for consistent alignment
-        // This ensures the indentation we created actually appears properly
-        mvwprintw(chat_win_, line, 1, "%s", wrapped_lines[i].c_str());
+        if (written < text.size()) {
+            waddnstr(chat_win_, text.data() + written, static_cast<int>(text.size() - written));
+        }
+        mvwaddch(chat_win_, y, maxx - 1, ACS_VLINE); // clrtoeol erased the right border
+        chat_rows_[row].assign(text);
+        chat_marks_[row] = marks;
     }
-    if (waiting_for_ai && line < maxy - 1) {
-        mvwprintw(chat_win_, maxy - 2, 2, "[Waiting for AI response...]");
+    wnoutrefresh(chat_win_);
+}
+
+void NCursesUI::draw_status_line(bool waiting_for_ai) {
+    std::string status;
+    if (waiting_for_ai) {
+        status = "[Waiting for AI response...]";
     }
-    if (!current_mcp_activity_.empty() && line < maxy - 1) {
-        int activity_line = waiting_for_ai ? maxy - 3 : maxy - 2;
-        if (activity_line > 0) {
-            mvwprintw(chat_win_, activity_line, 2, "[MCP: %s]", current_mcp_activity_.c_str());
+    {
+        std::lock_guard lock(activity_mutex_);
+        if (!current_mcp_activity_.empty()) {
+            if (!status.empty()) status += ' ';
+            status += "[MCP: " + current_mcp_activity_ + "]";
         }
     }
-    box(chat_win_, 0, 0);
-    wrefresh(chat_win_);
-    return total_lines;
+    status_text_ = std::move(status);
+    paint_status();
+    wnoutrefresh(chat_win_);
+}
+
+void NCursesUI::paint_status() {
+    int maxy, maxx;
+    getmaxyx(chat_win_.get(), maxy, maxx);
+    if (maxy < 2 || maxx < 4) return;
+    mvwhline(chat_win_, maxy - 1, 1, ACS_HLINE, maxx - 2);
+    if (!status_text_.empty()) {
+        mvwaddnstr(chat_win_, maxy - 1, 2, status_text_.c_str(), maxx - 4);
+    }
+}
+
+int NCursesUI::chat_text_width() const {
+    return std::max(0, getmaxx(chat_win_.get()) - 2);
 }
 
-void NCursesUI::draw_input_window(std::string_view input, int cursor_pos) {
-    werase(input_win_);
-    box(input_win_, 0, 0);
-    mvwprintw(input_win_, 1, 1, "%s", input.data());
+int NCursesUI::chat_text_rows() const {
+    return std::max(0, getmaxy(chat_win_.get()) - 2);
+}
+
+void NCursesUI::draw_input_window(const std::vector<std::string>& rows, int cursor_row, int cursor_column) {
+    if (input_rows_.size() != static_cast<size_t>(input_text_rows_)) {
+        werase(input_win_);
+        box(input_win_, 0, 0);
+        input_rows_.assign(input_text_rows_, std::string());
+    }
+    int maxx = getmaxx(input_win_.get());
+    for (size_t row = 0; row < input_rows_.size(); ++row) {
+        const std::string& text = row < rows.size() ? rows[row] : std::string();
+        if (input_rows_[row] == text) continue;
+        int y = static_cast<int>(row) + 1;
+        wmove(input_win_, y, 1);
+        wclrtoeol(input_win_);
+        waddnstr(input_win_, text.data(), static_cast<int>(text.size()));
+        mvwaddch(input_win_, y, maxx - 1, ACS_VLINE); // clrtoeol erased the right border
+        input_rows_[row] = text;
+    }
     // Move the cursor to the logical position
-    wmove(input_win_, 1, 1 + cursor_pos);
-    wrefresh(input_win_);
+    wmove(input_win_, 1 + cursor_row, 1 + cursor_column);
+    wnoutrefresh(input_win_);
+}
+
+int NCursesUI::input_text_width() const {
+    return std::max(1, getmaxx(input_win_.get()) - 2);
+}
+
+int NCursesUI::max_input_rows() const {
+    return std::max(1, getmaxy(stdscr) / 2 - 2);
+}
+
+bool NCursesUI::set_input_rows(int rows) {
+    rows = std::clamp(rows, 1, max_input_rows());
+    if (rows == input_text_rows_) return false;
+    input_text_rows_ = rows;
+    destroy_windows();
+    init_windows();
+    chat_rows_.clear();
+    chat_marks_.clear();
+    input_rows_.clear();
+    clearok(curscr, TRUE);
+    return true;
 }
 
 void NCursesUI::draw_settings_panel(bool visible) {
@@ -120,9 +200,19 @@ void NCursesUI::draw_settings_panel(bool visible) {
 }
 
 void NCursesUI::refresh_all() {
-    wrefresh(chat_win_);
-    wrefresh(input_win_);
-    if (settings_visible_) { wrefresh(settings_win_); }
+    if (settings_visible_) { wnoutrefresh(settings_win_); }
+    // Refreshed last so the terminal cursor ends up in the input line
+    wnoutrefresh(input_win_);
+    doupdate();
+}
+
+void NCursesUI::invalidate() {
+    chat_rows_.clear();
+    chat_marks_.clear();
+    input_rows_.clear();
+    touchwin(chat_win_.get());
+    touchwin(input_win_.get());
+    clearok(curscr, TRUE);
 }
 
 void NCursesUI::toggle_settings_panel() {
@@ -136,13 +226,17 @@ void NCursesUI::set_theme(int theme_id) {
 }
 
 void NCursesUI::handle_resize() {
+    // SIGWINCH is consumed by the event loop, so tell curses the new size ourselves
+    winsize ws{};
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == 0 && ws.ws_row > 0 && ws.ws_col > 0) {
+        resizeterm(ws.ws_row, ws.ws_col);
+    }
     destroy_windows();
     init_windows();
-    // After resizing, force redraw of all windows
-    refresh_all();
-    // Optionally, you may want to trigger a redraw of the chat window with the latest state.
-    // This requires access to the latest messages, scroll_offset, and waiting_for_ai status.
-    // If those are available as member variables, call draw_chat_window here. Otherwise, ensure the main loop triggers a redraw after resize.
+    // New windows start blank; the caller redraws every region
+    chat_rows_.clear();
+    chat_marks_.clear();
+    input_rows_.clear();
 }
 
 void NCursesUI::show_error(std::string_view message) {
@@ -153,8 +247,20 @@ void NCursesUI::show_error(std::string_view message) {
 }
 
 void NCursesUI::show_mcp_activity(std::string_view activity_message) {
+    std::lock_guard lock(activity_mutex_);
     current_mcp_activity_ = activity_message;
-    // Note: The activity will be displayed in the next draw_chat_window call
+    // Note: The activity will be displayed in the next draw_status_line call
+}
+
+std::string NCursesUI::read_paste() {
+    std::string text;
+    timeout(kPasteByteTimeoutMs);
+    for (int ch = getch(); ch != ERR && ch != kKeyPasteEnd; ch = getch()) {
+        // Key codes above a byte can only come from escape sequences inside the paste
+        if (ch >= 0 && ch <= 0xFF) text += static_cast<char>(ch);
+    }
+    timeout(0);
+    return text;
 }
 
 void NCursesUI::destroy_windows() {
@@ -11,9 +11,27 @@ static size_t WriteCallback(void* contents, size_t size, size_t nmemb, void* use
     return size * nmemb;
 }
 
+nlohmann::json OpenAIClient::build_request_body(const nlohmann::json& messages, const std::string& model) const {
+    return {
+        {"model", model},
+        {"messages", messages},
+        {"max_tokens", 1024}
+    };
+}
+
 std::future<std::expected<std::string, ApiErrorInfo>> OpenAIClient::send_message(const nlohmann::json& messages, const std::string& model) {
     return std::async(std::launch::async, [this, messages, model]() -> std::expected<std::string, ApiErrorInfo> {
-        if (api_key_.empty()) {
+        TraceSpan span("send_message", "client");
+        span.arg("provider", "openai");
+        // set_api_key()/set_model()/set_base_url() may run concurrently; work on copies
+        std::string api_key, default_model, base_url;
+        {
+            std::lock_guard lock(mutex_);
+            api_key = api_key_;
+            default_model = model_;
+            base_url = base_url_;
+        }
+        if (api_key.empty()) {
             return std::unexpected(ApiErrorInfo{.code = ApiError::ApiKeyNotSet, .message = "API key is required but not set."});
         }
         CURL* curl = curl_easy_init();
@@ -26,29 +44,32 @@ std::future<std::expected<std::string, ApiErrorInfo>> OpenAIClient::send_message
         std::unique_ptr<curl_slist, decltype(slist_cleanup)> headers_ptr(nullptr, slist_cleanup);
         std::string readBuffer;
         struct curl_slist* headers = nullptr;
-        headers = curl_slist_append(headers, ("Authorization: Bearer " + api_key_).c_str());
+        headers = curl_slist_append(headers, ("Authorization: Bearer " + api_key).c_str());
         headers = curl_slist_append(headers, "Content-Type: application/json");
         headers_ptr.reset(headers);
         
-        std::string model_to_use = model.empty() ? model_ : model;
+        std::string model_to_use = model.empty() ? default_model : model;
         
-        nlohmann::json req = {
-            {"model", model_to_use},
-            {"messages", messages},
-            {"max_tokens", 1024}
-        };
-        std::string req_str = req.dump();
-        curl_easy_setopt(curl, CURLOPT_URL, "https://api.openai.com/v1/chat/completions");
+        std::string req_str = build_request_body(messages, model_to_use).dump();
+        std::string url = base_url + "/v1/chat/completions";
+        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
         curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
         curl_easy_setopt(curl, CURLOPT_POSTFIELDS, req_str.c_str());
         curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
         curl_easy_setopt(curl, CURLOPT_WRITEDATA, &readBuffer);
+        TraceSpan http("http", "client");
         CURLcode res = curl_easy_perform(curl);
+        trace_curl_phases(http, curl);
+        http.end();
+        record_request_metrics("openai", model_to_use, curl, res);
         if (res != CURLE_OK) {
             return std::unexpected(ApiErrorInfo{.code = ApiError::CurlRequestFailed, .message = curl_easy_strerror(res)});
         }
         try {
+            TraceSpan parse("parse", "client");
             auto resp = nlohmann::json::parse(readBuffer);
+            record_usage_metrics("openai", model_to_use, resp.value("usage", nlohmann::json{}),
+                                 "prompt_tokens", "completion_tokens");
             if (resp.contains("choices") && resp["choices"].is_array() && !resp["choices"].empty()) {
                 auto& msg = resp["choices"][0]["message"];
                 if (msg.contains("content")) {
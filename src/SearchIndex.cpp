@@ -0,0 +1,116 @@
+#include "SearchIndex.hpp"
+#include <algorithm>
+#include <mutex>
+
+void SearchIndex::append_utf8(std::string& out, uint32_t cp) {
+    if (cp < 0x80) {
+        out += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        out += static_cast<char>(0xC0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += static_cast<char>(0xE0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+}
+
+SearchIndex::CharClass SearchIndex::classify(uint32_t cp) {
+    if (cp < 0x80) {
+        bool word = (cp >= 'a' && cp <= 'z') || (cp >= 'A' && cp <= 'Z') || (cp >= '0' && cp <= '9') || cp == '_';
+        return word ? CharClass::Word : CharClass::Separator;
+    }
+    if (cp == 0xFFFD) return CharClass::Separator;
+    // Latin-1 punctuation and symbols (but not the letters after them)
+    if (cp < 0xC0 || cp == 0xD7 || cp == 0xF7) return CharClass::Separator;
+    // General punctuation, CJK punctuation, full-width ASCII punctuation
+    if ((cp >= 0x2000 && cp <= 0x206F) || (cp >= 0x3000 && cp <= 0x303F) ||
+        (cp >= 0xFF00 && cp <= 0xFF0F) || (cp >= 0xFF1A && cp <= 0xFF20)) {
+        return CharClass::Separator;
+    }
+    // Scripts written without spaces: kana and CJK ideographs
+    if ((cp >= 0x3040 && cp <= 0x30FF) || (cp >= 0x3400 && cp <= 0x4DBF) ||
+        (cp >= 0x4E00 && cp <= 0x9FFF) || (cp >= 0xF900 && cp <= 0xFAFF) ||
+        (cp >= 0x20000 && cp <= 0x2FFFF)) {
+        return CharClass::Ideograph;
+    }
+    return CharClass::Word;
+}
+
+uint32_t SearchIndex::fold(uint32_t cp) {
+    if (cp >= 'A' && cp <= 'Z') return cp + 0x20;
+    if (cp < 0x80) return cp;
+    if (cp >= 0xC0 && cp <= 0xDE && cp != 0xD7) return cp + 0x20;        // Latin-1
+    if (cp >= 0x391 && cp <= 0x3A9 && cp != 0x3A2) return cp + 0x20;     // Greek
+    if (cp >= 0x410 && cp <= 0x42F) return cp + 0x20;                    // Cyrillic
+    if (cp >= 0x400 && cp <= 0x40F) return cp + 0x50;
+    return cp;
+}
+
+std::vector<std::string> SearchIndex::terms(std::string_view text) {
+    std::vector<std::string> out;
+    tokenize(text, [&](const std::string& term, size_t, size_t) { out.push_back(term); });
+    return out;
+}
+
+void SearchIndex::add(uint64_t message_id, std::string_view text) {
+    // Tokenize before taking the lock so searches are only blocked for the inserts
+    std::vector<std::string> tokens = terms(text);
+    std::unique_lock lock(mutex_);
+    uint32_t doc = static_cast<uint32_t>(docs_.size());
+    docs_.push_back(message_id);
+    for (uint32_t position = 0; position < tokens.size(); ++position) {
+        postings_[std::move(tokens[position])].push_back({doc, position});
+    }
+}
+
+std::vector<SearchIndex::Hit> SearchIndex::search(std::string_view query) const {
+    std::vector<Hit> hits;
+    std::vector<std::string> query_terms = terms(query);
+    if (query_terms.empty()) return hits;
+
+    std::shared_lock lock(mutex_);
+    std::vector<const std::vector<Posting>*> lists;
+    for (const auto& term : query_terms) {
+        auto it = postings_.find(term);
+        if (it == postings_.end()) return hits;
+        lists.push_back(&it->second);
+    }
+
+    // Drive the match from the rarest term and probe the others by binary search
+    size_t driver = 0;
+    for (size_t i = 1; i < lists.size(); ++i) {
+        if (lists[i]->size() < lists[driver]->size()) driver = i;
+    }
+    const auto& first = *lists[0];
+    for (const Posting& p : *lists[driver]) {
+        if (p.position < driver) continue;
+        uint32_t start = p.position - static_cast<uint32_t>(driver);
+        bool match = true;
+        for (size_t i = 0; i < lists.size() && match; ++i) {
+            if (i == driver) continue;
+            Posting want{p.doc, start + static_cast<uint32_t>(i)};
+            match = std::binary_search(lists[i]->begin(), lists[i]->end(), want);
+        }
+        if (!match) continue;
+        auto at = std::lower_bound(first.begin(), first.end(), Posting{p.doc, start});
+        auto doc_begin = std::lower_bound(first.begin(), at, Posting{p.doc, 0});
+        hits.push_back({docs_[p.doc], start, static_cast<uint32_t>(at - doc_begin)});
+    }
+    return hits;
+}
+
+size_t SearchIndex::document_count() const {
+    std::shared_lock lock(mutex_);
+    return docs_.size();
+}
+
+size_t SearchIndex::term_count() const {
+    std::shared_lock lock(mutex_);
+    return postings_.size();
+}
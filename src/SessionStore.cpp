@@ -0,0 +1,324 @@
+#include "SessionStore.hpp"
+#include "GlobalLogger.hpp"
+#include <format>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+
+namespace {
+    constexpr char kFileMagic[8] = {'C', 'C', 'S', 'E', 'S', 'S', '0', '1'};
+    constexpr uint32_t kRecordMagic = 0x43455243; // "CREC"
+    // Newest messages whose ids are checked for the highest id in use;
+    // completion order can put an id slightly out of sequence
+    constexpr size_t kIdScanRecords = 64;
+
+    struct FileHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t reserved;
+    };
+    static_assert(sizeof(FileHeader) == 16);
+
+    struct RecordHeader {
+        uint32_t magic;
+        uint32_t length;       // Bytes following this header
+        uint32_t crc;          // CRC-32 of those bytes
+        uint8_t sender;        // 0 = user, 1 = AI
+        uint8_t reserved[3];
+        uint64_t message_id;
+        int64_t created_ms;
+        int64_t completed_ms;
+        uint32_t provider_len;
+        uint32_t content_len;
+    };
+    static_assert(sizeof(RecordHeader) == 48);
+
+    constexpr auto kCrcTable = [] {
+        std::array<uint32_t, 256> table{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            table[i] = c;
+        }
+        return table;
+    }();
+
+    uint32_t crc32_update(uint32_t crc, std::string_view data) {
+        for (unsigned char byte : data) {
+            crc = kCrcTable[(crc ^ byte) & 0xFF] ^ (crc >> 8);
+        }
+        return crc;
+    }
+
+    bool write_all(int fd, const char* data, size_t size) {
+        while (size > 0) {
+            ssize_t n = write(fd, data, size);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            data += n;
+            size -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    RecordHeader read_header(const char* data, uint64_t offset) {
+        RecordHeader header;
+        std::memcpy(&header, data + offset, sizeof(header));
+        return header;
+    }
+}
+
+SessionStore::SessionStore(std::string path)
+    : path_(std::move(path)), index_path_(path_ + ".idx") {}
+
+SessionStore::~SessionStore() {
+    if (fd_ >= 0) close(fd_);
+    if (index_fd_ >= 0) close(index_fd_);
+}
+
+int64_t SessionStore::now_ms() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void SessionStore::set_provider(const std::string& provider) {
+    std::lock_guard lock(mutex_);
+    provider_ = provider;
+}
+
+std::expected<void, std::string> SessionStore::open() {
+    std::lock_guard lock(mutex_);
+    if (fd_ >= 0) return {};
+
+    int fd = ::open(path_.c_str(), O_RDWR | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return std::unexpected(std::format("Cannot open {}: {}", path_, std::strerror(errno)));
+    }
+    // One writer per log: a second instance would take the first one's
+    // in-flight record for a torn tail and truncate it under its mapping
+    read_only_ = flock(fd, LOCK_EX | LOCK_NB) != 0;
+    if (read_only_) {
+        LOG_WARN("SessionStore - {} is locked ({}); opening it read-only", path_, std::strerror(errno));
+    }
+    struct stat st{};
+    if (fstat(fd, &st) != 0) {
+        std::string error = std::format("Cannot stat {}: {}", path_, std::strerror(errno));
+        ::close(fd);
+        return std::unexpected(error);
+    }
+    uint64_t size = static_cast<uint64_t>(st.st_size);
+    if (size == 0 && read_only_) {
+        ::close(fd);
+        return std::unexpected(std::format("{} is being created by another instance", path_));
+    }
+    if (size == 0) {
+        FileHeader header{};
+        std::memcpy(header.magic, kFileMagic, sizeof(kFileMagic));
+        header.version = 1;
+        if (!write_all(fd, reinterpret_cast<const char*>(&header), sizeof(header))) {
+            std::string error = std::format("Cannot write {}: {}", path_, std::strerror(errno));
+            ::close(fd);
+            return std::unexpected(error);
+        }
+        size = sizeof(header);
+    }
+
+    if (!map_.open(path_) || map_.size() < sizeof(FileHeader) ||
+        std::memcmp(map_.data(), kFileMagic, sizeof(kFileMagic)) != 0) {
+        // Never append to something we did not write
+        map_.close();
+        ::close(fd);
+        return std::unexpected(std::format("{} is not a session file", path_));
+    }
+
+    index_fd_ = read_only_ ? ::open(index_path_.c_str(), O_RDONLY | O_CLOEXEC)
+                           : ::open(index_path_.c_str(), O_RDWR | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+    if (index_fd_ < 0 && !read_only_) {
+        std::string error = std::format("Cannot open {}: {}", index_path_, std::strerror(errno));
+        map_.close();
+        ::close(fd);
+        return std::unexpected(error);
+    }
+    fd_ = fd;
+
+    if (!load_index(size)) {
+        LOG_WARN("SessionStore - Repaired {} ({} records kept)", path_, offsets_.size());
+    }
+
+    size_t scan_from = offsets_.size() > kIdScanRecords ? offsets_.size() - kIdScanRecords : 0;
+    for (size_t i = scan_from; i < offsets_.size(); ++i) {
+        max_id_ = std::max(max_id_, read_header(map_.data(), offsets_[i]).message_id);
+    }
+    return {};
+}
+
+bool SessionStore::valid_record_at(uint64_t offset, uint64_t& next) const {
+    uint64_t size = end_offset_;
+    if (offset < sizeof(FileHeader) || offset + sizeof(RecordHeader) > size) return false;
+    RecordHeader header = read_header(map_.data(), offset);
+    if (header.magic != kRecordMagic ||
+        static_cast<uint64_t>(header.provider_len) + header.content_len != header.length ||
+        offset + sizeof(RecordHeader) + header.length > size) {
+        return false;
+    }
+    std::string_view payload(map_.data() + offset + sizeof(RecordHeader), header.length);
+    if ((crc32_update(0xFFFFFFFFu, payload) ^ 0xFFFFFFFFu) != header.crc) return false;
+    next = offset + sizeof(RecordHeader) + header.length;
+    return true;
+}
+
+bool SessionStore::load_index(uint64_t log_size) {
+    end_offset_ = log_size;
+    offsets_.clear();
+
+    struct stat st{};
+    bool torn_index = false;
+    if (fstat(index_fd_, &st) == 0 && st.st_size >= static_cast<off_t>(sizeof(uint64_t))) {
+        torn_index = st.st_size % sizeof(uint64_t) != 0;
+        offsets_.resize(static_cast<size_t>(st.st_size) / sizeof(uint64_t));
+        ssize_t n = pread(index_fd_, offsets_.data(), offsets_.size() * sizeof(uint64_t), 0);
+        offsets_.resize(n > 0 ? static_cast<size_t>(n) / sizeof(uint64_t) : 0);
+    }
+    size_t indexed = offsets_.size();
+
+    // Trust the index only while offsets increase and stay inside the log
+    size_t valid = 0;
+    for (uint64_t previous = 0; valid < offsets_.size(); ++valid) {
+        uint64_t offset = offsets_[valid];
+        if (offset <= previous || offset + sizeof(RecordHeader) > log_size) break;
+        previous = offset;
+    }
+    offsets_.resize(valid);
+
+    // Only the newest indexed record is checksummed; older ones were complete
+    // when the next one was appended
+    uint64_t next = sizeof(FileHeader);
+    while (!offsets_.empty() && !valid_record_at(offsets_.back(), next)) {
+        offsets_.pop_back();
+    }
+
+    // Pick up records written after the index fell behind
+    bool index_stale = torn_index || offsets_.size() != indexed;
+    while (next < log_size) {
+        uint64_t after = 0;
+        if (!valid_record_at(next, after)) break;
+        offsets_.push_back(next);
+        next = after;
+        index_stale = true;
+    }
+
+    if (read_only_) {
+        // The tail may be the owner's record in flight; repairs are the owner's job
+        end_offset_ = next;
+        return true;
+    }
+
+    bool clean = true;
+    if (next < log_size) {
+        // Torn write at the end of the log
+        clean = false;
+        if (ftruncate(fd_, static_cast<off_t>(next)) != 0) {
+            LOG_WARN("SessionStore - Cannot truncate {}: {}", path_, std::strerror(errno));
+        }
+        end_offset_ = next;
+    }
+    if (index_stale) {
+        if (ftruncate(index_fd_, 0) != 0 ||
+            !write_all(index_fd_, reinterpret_cast<const char*>(offsets_.data()), offsets_.size() * sizeof(uint64_t))) {
+            LOG_WARN("SessionStore - Cannot rewrite {}: {}", index_path_, std::strerror(errno));
+        }
+    }
+    return clean && !index_stale;
+}
+
+SessionStore::Record SessionStore::record(size_t index) const {
+    uint64_t offset = offsets_[index];
+    RecordHeader header = read_header(map_.data(), offset);
+    const char* payload = map_.data() + offset + sizeof(RecordHeader);
+    return Record{
+        header.message_id,
+        header.sender == 0 ? ChatMessage::Sender::User : ChatMessage::Sender::AI,
+        std::string_view(payload, header.provider_len),
+        header.created_ms,
+        header.completed_ms,
+        std::string_view(payload + header.provider_len, header.content_len)};
+}
+
+std::optional<size_t> SessionStore::find_record(uint64_t id) const {
+    std::call_once(id_index_once_, [this] {
+        id_index_.reserve(offsets_.size());
+        for (size_t i = 0; i < offsets_.size(); ++i) {
+            id_index_.emplace_back(read_header(map_.data(), offsets_[i]).message_id, i);
+        }
+        std::sort(id_index_.begin(), id_index_.end());
+    });
+    auto it = std::lower_bound(id_index_.begin(), id_index_.end(), std::pair<uint64_t, size_t>(id, 0));
+    if (it != id_index_.end() && it->first == id) {
+        return it->second;
+    }
+    return std::nullopt;
+}
+
+std::vector<ChatMessage> SessionStore::load(size_t begin, size_t end) const {
+    std::vector<ChatMessage> messages;
+    end = std::min(end, offsets_.size());
+    if (begin >= end) return messages;
+    messages.reserve(end - begin);
+    for (size_t i = begin; i < end; ++i) {
+        Record r = record(i);
+        ChatMessage msg{r.sender, std::string(r.content)};
+        msg.id = r.id;
+        msg.created_ms = r.created_ms;
+        messages.push_back(std::move(msg));
+    }
+    return messages;
+}
+
+bool SessionStore::append(const ChatMessage& msg) {
+    if (!enabled_.load(std::memory_order_relaxed)) return false;
+
+    std::lock_guard lock(mutex_);
+    if (fd_ < 0 || read_only_) return false;
+
+    RecordHeader header{};
+    header.magic = kRecordMagic;
+    header.sender = msg.sender == ChatMessage::Sender::User ? 0 : 1;
+    header.message_id = msg.id;
+    header.created_ms = msg.created_ms;
+    header.completed_ms = now_ms();
+    header.provider_len = static_cast<uint32_t>(provider_.size());
+    header.content_len = static_cast<uint32_t>(msg.content.size());
+    header.length = header.provider_len + header.content_len;
+
+    std::string frame;
+    frame.reserve(sizeof(header) + header.length);
+    frame.append(sizeof(header), '\0');
+    frame += provider_;
+    msg.content.for_each_segment([&](std::string_view segment) { frame += segment; });
+    header.crc = crc32_update(0xFFFFFFFFu, std::string_view(frame).substr(sizeof(header))) ^ 0xFFFFFFFFu;
+    std::memcpy(frame.data(), &header, sizeof(header));
+
+    // A single write per record keeps the log appendable from any state:
+    // a crash leaves at most one torn record, which open() cuts off
+    if (!write_all(fd_, frame.data(), frame.size())) {
+        LOG_WARN("SessionStore - Write to {} failed: {}", path_, std::strerror(errno));
+        return false;
+    }
+    uint64_t offset = end_offset_;
+    end_offset_ += frame.size();
+    if (!write_all(index_fd_, reinterpret_cast<const char*>(&offset), sizeof(offset))) {
+        // The index is rebuilt from the log on the next open
+        LOG_WARN("SessionStore - Write to {} failed: {}", index_path_, std::strerror(errno));
+    }
+    return true;
+}
@@ -37,12 +37,12 @@ void SettingsPanel::draw() {
         keypad(temp_win.get(), TRUE);
         draw(temp_win.get());
     } else {
-        get_logger().log(LogLevel::Error, "Failed to create settings window");
+        LOG_ERROR("Failed to create settings window");
     }
 }
 
 void SettingsPanel::draw(WINDOW* win) {
-    get_logger().log(LogLevel::Debug, "SettingsPanel::draw(WINDOW*) called");
+    LOG_DEBUG("SettingsPanel::draw(WINDOW*) called");
     int rows, cols;
     getmaxyx(win, rows, cols);
     int win_height = rows;
@@ -197,7 +197,7 @@ void SettingsPanel::handle_input(int ch) {
             if (config_manager_) {
                 auto result = config_manager_->save(settings_);
                 if (!result) {
-                    get_logger().log(LogLevel::Error, "Failed to save settings");
+                    LOG_ERROR("Failed to save settings");
                 }
             }
             in_edit_mode_ = false;
@@ -256,7 +256,7 @@ void SettingsPanel::handle_input(int ch) {
                     if (config_manager_) {
                         auto result = config_manager_->save(settings_);
                         if (!result) {
-                            get_logger().log(LogLevel::Error, "Failed to save settings after model change");
+                            LOG_ERROR("Failed to save settings after model change");
                         }
                     }
                 }
@@ -269,7 +269,7 @@ void SettingsPanel::handle_input(int ch) {
                 if (config_manager_) {
                     auto result = config_manager_->save(settings_);
                     if (!result) {
-                        get_logger().log(LogLevel::Error, "Failed to save settings");
+                        LOG_ERROR("Failed to save settings");
                     }
                 }
             } else if (selected_option_ == (int)FieldType::Theme) {
@@ -277,7 +277,7 @@ void SettingsPanel::handle_input(int ch) {
                 if (config_manager_) {
                     auto result = config_manager_->save(settings_);
                     if (!result) {
-                        get_logger().log(LogLevel::Error, "Failed to save settings");
+                        LOG_ERROR("Failed to save settings");
                     }
                 }
             } else {
@@ -328,7 +328,7 @@ bool SettingsPanel::is_visible() const {
 }
 
 void SettingsPanel::set_visible(bool visible) {
-    get_logger().log(LogLevel::Debug, std::string("SettingsPanel::set_visible called with visible = ") + (visible ? "true" : "false"));
+    LOG_DEBUG("SettingsPanel::set_visible called with visible = {}", visible);
     visible_ = visible;
 }
 
@@ -0,0 +1,127 @@
+#include "Trace.hpp"
+#include "GlobalLogger.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <format>
+#include <fstream>
+#include <unistd.h>
+
+Tracer& Tracer::instance() {
+    static Tracer tracer;
+    return tracer;
+}
+
+void Tracer::start(std::string path) {
+    LOG_INFO("Tracing to {}", path);
+    {
+        std::lock_guard lock(buffers_mutex_);
+        path_ = std::move(path);
+    }
+    enabled_.store(true, std::memory_order_relaxed);
+}
+
+void Tracer::stop() {
+    if (!enabled_.exchange(false, std::memory_order_relaxed)) return;
+    std::string path;
+    {
+        std::lock_guard lock(buffers_mutex_);
+        path = path_;
+    }
+    if (!path.empty() && !write(path)) LOG_WARN("Cannot write trace to {}", path);
+}
+
+Tracer::Buffer& Tracer::thread_buffer() {
+    // Marks the buffer retired when the thread exits, so write() and
+    // clear() can let go of it
+    struct Owned {
+        std::shared_ptr<Buffer> buffer;
+        ~Owned() {
+            if (buffer) buffer->retired.store(true, std::memory_order_release);
+        }
+    };
+    thread_local Owned owned;
+    if (!owned.buffer) {
+        static std::atomic<uint32_t> next_tid{1};
+        owned.buffer = std::make_shared<Buffer>();
+        owned.buffer->tid = next_tid.fetch_add(1, std::memory_order_relaxed);
+        std::lock_guard lock(buffers_mutex_);
+        buffers_.push_back(owned.buffer);
+    }
+    return *owned.buffer;
+}
+
+void Tracer::complete(const char* name, const char* category, int64_t start_ns, int64_t duration_ns,
+                      nlohmann::json args) {
+    Buffer& buffer = thread_buffer();
+    std::lock_guard lock(buffer.mutex);
+    if (buffer.events.size() >= kMaxEventsPerThread) {
+        ++buffer.dropped; // A runaway thread must not eat all memory
+        return;
+    }
+    buffer.events.push_back({name, category, start_ns, duration_ns, std::move(args)});
+}
+
+void Tracer::set_thread_name(std::string name) {
+    Buffer& buffer = thread_buffer();
+    std::lock_guard lock(buffer.mutex);
+    buffer.thread_name = std::move(name);
+}
+
+void Tracer::clear() {
+    std::lock_guard lock(buffers_mutex_);
+    for (const auto& buffer : buffers_) {
+        std::lock_guard buffer_lock(buffer->mutex);
+        buffer->events.clear();
+        buffer->dropped = 0;
+    }
+    std::erase_if(buffers_, [](const auto& buffer) { return buffer->retired.load(std::memory_order_acquire); });
+}
+
+bool Tracer::write(const std::string& path) {
+    std::vector<std::shared_ptr<Buffer>> buffers;
+    {
+        std::lock_guard lock(buffers_mutex_);
+        buffers = buffers_;
+    }
+    std::string tmp = path + ".tmp";
+    std::ofstream out(tmp, std::ios::trunc);
+    if (!out) return false;
+
+    // ts and dur are microseconds; fractions keep sub-microsecond spans visible
+    const int pid = static_cast<int>(getpid());
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    out << nlohmann::json{{"ph", "M"}, {"name", "process_name"}, {"pid", pid}, {"tid", 0},
+                          {"args", {{"name", "chatbot"}}}}.dump();
+    uint64_t dropped = 0;
+    std::vector<std::shared_ptr<Buffer>> retired;
+    for (const auto& buffer : buffers) {
+        // Read `retired` first: once set, the owner will record nothing more
+        if (buffer->retired.load(std::memory_order_acquire)) retired.push_back(buffer);
+        std::lock_guard lock(buffer->mutex);
+        if (buffer->events.empty()) continue;
+        dropped += buffer->dropped;
+        std::string thread_name = buffer->thread_name.empty() ? std::format("thread {}", buffer->tid)
+                                                              : buffer->thread_name;
+        out << ",\n" << nlohmann::json{{"ph", "M"}, {"name", "thread_name"}, {"pid", pid}, {"tid", buffer->tid},
+                                       {"args", {{"name", thread_name}}}}.dump();
+        for (const auto& event : buffer->events) {
+            nlohmann::json line = {
+                {"ph", "X"}, {"name", event.name}, {"cat", event.category}, {"pid", pid}, {"tid", buffer->tid},
+                {"ts", static_cast<double>(event.start_ns) / 1000.0},
+                {"dur", static_cast<double>(event.duration_ns) / 1000.0}
+            };
+            if (!event.args.is_null()) line["args"] = event.args;
+            out << ",\n" << line.dump();
+        }
+    }
+    out << "\n],\"otherData\":" << nlohmann::json{{"dropped_events", dropped}}.dump() << "}\n";
+    out.close();
+    if (!out || std::rename(tmp.c_str(), path.c_str()) != 0) return false;
+
+    // Exited threads' events are in the file now; nothing will add to them
+    std::lock_guard lock(buffers_mutex_);
+    std::erase_if(buffers_, [&](const auto& buffer) {
+        return std::find(retired.begin(), retired.end(), buffer) != retired.end();
+    });
+    return true;
+}
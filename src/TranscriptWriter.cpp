@@ -0,0 +1,144 @@
+#include "TranscriptWriter.hpp"
+#include "GlobalLogger.hpp"
+#include "Metrics.hpp"
+#include <format>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+TranscriptWriter::TranscriptWriter(std::string path)
+    : path_(std::move(path)),
+      queue_depth_(MetricsRegistry::instance().gauge(metric_names::kTranscriptQueue, {},
+                                                     "Transcript records waiting for the writer thread")) {}
+
+TranscriptWriter::~TranscriptWriter() {
+    if (thread_.joinable()) {
+        stopping_.store(true, std::memory_order_release);
+        pending_.fetch_add(1, std::memory_order_release);
+        pending_.notify_one();
+        thread_.join();
+    }
+    // Records queued after the writer stopped (or while it never ran)
+    for (Record* r = head_.exchange(nullptr); r;) {
+        Record* next = r->next;
+        queue_depth_.add(-1);
+        delete r;
+        r = next;
+    }
+    if (fd_ >= 0) close(fd_);
+}
+
+void TranscriptWriter::set_enabled(bool enabled) {
+    enabled_.store(enabled, std::memory_order_relaxed);
+    if (enabled && !started_.exchange(true)) {
+        thread_ = std::thread([this]() { run(); });
+    }
+}
+
+TranscriptWriter::FsyncPolicy TranscriptWriter::parse_fsync_policy(const std::string& name) {
+    if (name == "message") return FsyncPolicy::Message;
+    if (name == "batch") return FsyncPolicy::Batch;
+    return FsyncPolicy::Never;
+}
+
+void TranscriptWriter::append(Kind kind, std::string text) {
+    if (!is_enabled()) return;
+    auto* record = new Record{nullptr, kind, std::chrono::system_clock::now(), std::move(text)};
+    record->next = head_.load(std::memory_order_relaxed);
+    while (!head_.compare_exchange_weak(record->next, record, std::memory_order_release, std::memory_order_relaxed)) {}
+    queue_depth_.add(1);
+    pending_.fetch_add(1, std::memory_order_release);
+    pending_.notify_one();
+}
+
+void TranscriptWriter::run() {
+    for (;;) {
+        uint32_t seen = pending_.load(std::memory_order_acquire);
+        // Take everything queued so far in one go
+        Record* batch = head_.exchange(nullptr, std::memory_order_acquire);
+        if (batch) {
+            write_batch(batch);
+            continue;
+        }
+        if (stopping_.load(std::memory_order_acquire)) break;
+        pending_.wait(seen, std::memory_order_acquire);
+    }
+}
+
+void TranscriptWriter::write_batch(Record* newest_first) {
+    // The stack hands records back newest first; restore arrival order
+    Record* oldest_first = nullptr;
+    while (newest_first) {
+        Record* next = newest_first->next;
+        newest_first->next = oldest_first;
+        oldest_first = newest_first;
+        newest_first = next;
+    }
+
+    std::string buffer;
+    bool has_complete = false;
+    int64_t taken = 0;
+    for (Record* r = oldest_first; r;) {
+        format_record(*r, buffer);
+        has_complete |= r->kind != Kind::Chunk;
+        Record* next = r->next;
+        delete r;
+        r = next;
+        ++taken;
+    }
+    queue_depth_.add(-taken);
+
+    if (fd_ < 0 && !open_failed_) {
+        fd_ = open(path_.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+        if (fd_ < 0) {
+            open_failed_ = true; // Report once, then drop records
+            LOG_WARN("TranscriptWriter - Cannot open {}: {}", path_, std::strerror(errno));
+        }
+    }
+    if (fd_ < 0) return;
+
+    const char* data = buffer.data();
+    size_t remaining = buffer.size();
+    while (remaining > 0) {
+        ssize_t n = write(fd_, data, remaining);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            LOG_WARN("TranscriptWriter - Write to {} failed: {}", path_, std::strerror(errno));
+            return;
+        }
+        data += n;
+        remaining -= static_cast<size_t>(n);
+    }
+
+    auto policy = fsync_policy_.load(std::memory_order_relaxed);
+    if (policy == FsyncPolicy::Batch || (policy == FsyncPolicy::Message && has_complete)) {
+        fdatasync(fd_);
+    }
+}
+
+void TranscriptWriter::format_record(const Record& record, std::string& out) {
+    // Timestamps have one-second resolution, so format each second only once
+    std::time_t now_c = std::chrono::system_clock::to_time_t(record.time);
+    if (now_c != stamp_second_) {
+        std::tm local{};
+        localtime_r(&now_c, &local);
+        char timebuf[32];
+        std::strftime(timebuf, sizeof(timebuf), "%Y-%m-%d %H:%M:%S", &local);
+        stamp_ = timebuf;
+        stamp_second_ = now_c;
+    }
+    const char* tag = "";
+    switch (record.kind) {
+        case Kind::User: tag = "[USER] "; break;
+        case Kind::AI: tag = "[AI] "; break;
+        case Kind::Chunk: tag = "[AI] (chunk append) "; break;
+        case Kind::Complete: tag = "[AI] (complete message) "; break;
+    }
+    out += '[';
+    out += stamp_;
+    out += "] ";
+    out += tag;
+    out += record.text;
+    out += '\n';
+}
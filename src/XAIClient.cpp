@@ -24,7 +24,7 @@ std::string XAIClient::process_with_mcp_tools(const std::string& user_message) {
     // Try auto tool calling based on message content
     auto result = tool_service.auto_call_tools(user_message);
     if (result.has_value()) {
-        get_logger().log(LogLevel::Info, "MCP tool called automatically, returning results");
+        LOG_INFO("MCP tool called automatically, returning results");
         return result->dump(2);
     }
 
@@ -45,7 +45,7 @@ std::string XAIClient::process_tool_calls_in_response(const std::string& ai_resp
     
     // Process each tool call
     for (const auto& tool_call_str : tool_calls) {
-        get_logger().log(LogLevel::Info, std::format("Processing tool call: {}", tool_call_str));
+        LOG_INFO("Processing tool call: {}", tool_call_str);
         
         // Parse the tool call format: **TOOL_CALL: tool_name {...}**
         std::regex tool_call_regex(R"(\*\*TOOL_CALL:\s*(\w+)\s*(\{[^}]*\})\*\*)");
@@ -71,7 +71,7 @@ std::string XAIClient::process_tool_calls_in_response(const std::string& ai_resp
                         std::regex(std::regex_replace(tool_call_str, std::regex(R"([\[\]{}()*+?.^$|\\])"), R"(\$&)")), 
                         formatted_result);
                         
-                    get_logger().log(LogLevel::Info, std::format("Tool '{}' executed successfully", tool_name));
+                    LOG_INFO("Tool '{}' executed successfully", tool_name);
                 } else {
                     // Replace with error message
                     std::string error_result = std::format("\n\n**Tool Error ({})**: Tool execution failed\n\n", tool_name);
@@ -79,11 +79,11 @@ std::string XAIClient::process_tool_calls_in_response(const std::string& ai_resp
                         std::regex(std::regex_replace(tool_call_str, std::regex(R"([\[\]{}()*+?.^$|\\])"), R"(\$&)")), 
                         error_result);
                         
-                    get_logger().log(LogLevel::Warning, std::format("Tool '{}' execution failed", tool_name));
+                    LOG_WARN("Tool '{}' execution failed", tool_name);
                 }
                 
             } catch (const std::exception& e) {
-                get_logger().log(LogLevel::Error, std::format("Error parsing tool call arguments: {}", e.what()));
+                LOG_ERROR("Error parsing tool call arguments: {}", e.what());
                 
                 // Replace with error message
                 std::string error_result = std::format("\n\n**Tool Error ({})**: Invalid arguments\n\n", tool_name);
@@ -97,6 +97,40 @@ std::string XAIClient::process_tool_calls_in_response(const std::string& ai_resp
     return processed_response;
 }
 
+nlohmann::json XAIClient::build_request_body(const nlohmann::json& messages, const std::string& model,
+                                             const std::string& system_prompt, const std::string& tool_results) const {
+    nlohmann::json request_body;
+    request_body["model"] = model;
+    request_body["temperature"] = 0.7;
+    request_body["max_tokens"] = 4000;
+    
+    // Build messages with the (tool-enhanced) system prompt first
+    nlohmann::json modified_messages = nlohmann::json::array();
+    if (!system_prompt.empty()) {
+        modified_messages.push_back({
+            {"role", "system"},
+            {"content", system_prompt}
+        });
+    }
+    
+    // Add original messages (excluding system messages since we handled them above)
+    for (const auto& msg : messages) {
+        if (msg.contains("role") && msg["role"] != "system") {
+            modified_messages.push_back(msg);
+        }
+    }
+    
+    if (!tool_results.empty()) {
+        modified_messages.push_back({
+            {"role", "system"},
+            {"content", "_[TOOL] " + tool_results + "_"}
+        });
+    }
+    
+    request_body["messages"] = std::move(modified_messages);
+    return request_body;
+}
+
 size_t XAIWriteCallback(void* contents, size_t size, size_t nmemb, void* userp) {
     size_t totalSize = size * nmemb;
     static_cast<std::string*>(userp)->append(static_cast<char*>(contents), totalSize);
@@ -108,7 +142,10 @@ std::future<std::expected<std::string, ApiErrorInfo>> XAIClient::send_message(
     const std::string& model) {
     
     return std::async(std::launch::async, [this, messages, model]() -> std::expected<std::string, ApiErrorInfo> {
+        TraceSpan span("send_message", "client");
+        span.arg("provider", "xai");
         std::lock_guard lock(mutex_);
+        const std::string base_url = base_url_;
         
         if (api_key_.empty()) {
             return std::unexpected(ApiErrorInfo{ApiError::ApiKeyNotSet, "API key not set"});
@@ -118,50 +155,24 @@ std::future<std::expected<std::string, ApiErrorInfo>> XAIClient::send_message(
             // Enhance system prompt with tools
             std::string enhanced_prompt = enhance_system_prompt_with_tools(system_prompt_);
             
-            // Build request body
-            nlohmann::json request_body;
-            request_body["model"] = model.empty() ? model_ : model;
-            request_body["temperature"] = 0.7;
-            request_body["max_tokens"] = 4000;
-            
-            // Build messages with enhanced system prompt
-            nlohmann::json modified_messages = nlohmann::json::array();
-            
-            // Add enhanced system message if present
-            if (!enhanced_prompt.empty()) {
-                modified_messages.push_back({
-                    {"role", "system"},
-                    {"content", enhanced_prompt}
-                });
-            }
-            
-            // Add original messages (excluding system messages since we handled them above)
-            for (const auto& msg : messages) {
-                if (msg.contains("role") && msg["role"] != "system") {
-                    modified_messages.push_back(msg);
-                }
-            }
-
             // Process with MCP tools if needed - check the last user message
+            std::string tool_results;
             if (!messages.empty()) {
                 auto last_message = messages.back();
                 if (last_message.contains("content")) {
                     std::string user_message = last_message["content"];
-                    std::string tool_results = process_with_mcp_tools(user_message);
+                    tool_results = process_with_mcp_tools(user_message);
                     if (!tool_results.empty()) {
-                        get_logger().log(LogLevel::Info, std::format("[MCP TOOL] Tool results injected: {}", tool_results));
-                        modified_messages.push_back({
-                            {"role", "system"},
-                            {"content", "_[TOOL] " + tool_results + "_"}
-                        });
+                        LOG_INFO("[MCP TOOL] Tool results injected: {}", tool_results);
                     }
                 }
             }
             
-            request_body["messages"] = modified_messages;
+            std::string model_to_use = model.empty() ? model_ : model;
+            nlohmann::json request_body = build_request_body(messages, model_to_use, enhanced_prompt, tool_results);
             
             // Debug: Log the request being sent
-            get_logger().log(LogLevel::Debug, std::format("XAI Request JSON: {}", request_body.dump()));
+            LOG_DEBUG("XAI Request JSON: {}", request_body.dump());
             
             // Prepare HTTP request
             CURL* curl = curl_easy_init();
@@ -179,7 +190,8 @@ std::future<std::expected<std::string, ApiErrorInfo>> XAIClient::send_message(
             
             // Set curl options
             std::string json_data = request_body.dump();
-            curl_easy_setopt(curl, CURLOPT_URL, "https://api.x.ai/v1/chat/completions");
+            std::string url = base_url + "/v1/chat/completions";
+            curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
             curl_easy_setopt(curl, CURLOPT_POSTFIELDS, json_data.c_str());
             curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, json_data.length());
             curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
@@ -188,7 +200,11 @@ std::future<std::expected<std::string, ApiErrorInfo>> XAIClient::send_message(
             curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L);
             
             // Perform request
+            TraceSpan http("http", "client");
             CURLcode res = curl_easy_perform(curl);
+            trace_curl_phases(http, curl);
+            http.end();
+            record_request_metrics("xai", model_to_use, curl, res);
             
             // Check for curl errors
             if (res != CURLE_OK) {
@@ -209,7 +225,10 @@ std::future<std::expected<std::string, ApiErrorInfo>> XAIClient::send_message(
             }
             
             // Parse response
+            TraceSpan parse("parse", "client");
             auto response_json = nlohmann::json::parse(response_string);
+            record_usage_metrics("xai", model_to_use, response_json.value("usage", nlohmann::json{}),
+                                 "prompt_tokens", "completion_tokens");
             
             if (!response_json.contains("choices") || response_json["choices"].empty()) {
                 return std::unexpected(ApiErrorInfo{ApiError::MalformedResponse, "Invalid response format"});
@@ -221,17 +240,18 @@ std::future<std::expected<std::string, ApiErrorInfo>> XAIClient::send_message(
             }
             
             std::string content = choice["message"]["content"];
+            parse.end();
             
             // Process any tool calls in the AI response
             std::string final_content = process_tool_calls_in_response(content);
             
             // Log successful interaction
-            get_logger().log(LogLevel::Info, std::format("XAI API request successful. Response length: {}", final_content.length()));
+            LOG_INFO("XAI API request successful. Response length: {}", final_content.length());
             
             return final_content;
             
         } catch (const std::exception& e) {
-            get_logger().log(LogLevel::Error, std::format("XAI API error: {}", e.what()));
+            LOG_ERROR("XAI API error: {}", e.what());
             return std::unexpected(ApiErrorInfo{ApiError::Unknown, std::format("Error: {}", e.what())});
         }
     });
@@ -0,0 +1,70 @@
+// chatbot_log_decode: print a binary log (chatbot.blog) as text lines in
+// the same layout as chatbot.log.
+//
+// Usage: chatbot_log_decode [--json] [file]   (default file: chatbot.blog)
+#include "BinaryLog.hpp"
+#include "MappedFile.hpp"
+#include "RichLogger.hpp"
+#include <iostream>
+#include <string>
+#include <ctime>
+
+namespace {
+    std::string timestamp(int64_t time_ns) {
+        std::time_t seconds = static_cast<std::time_t>(time_ns / 1000000000);
+        std::tm local{};
+        localtime_r(&seconds, &local);
+        char buffer[32];
+        std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &local);
+        return buffer;
+    }
+
+    std::string level_name(uint8_t level) {
+        if (level > static_cast<uint8_t>(LogLevel::Critical)) return "UNK";
+        return RichLogger::level_to_string(static_cast<LogLevel>(level));
+    }
+}
+
+int main(int argc, char* argv[]) {
+    bool json = false;
+    std::string path = "chatbot.blog";
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--json") {
+            json = true;
+        } else if (arg == "-h" || arg == "--help") {
+            std::cout << "Usage: " << argv[0] << " [--json] [file]" << std::endl;
+            return 0;
+        } else {
+            path = arg;
+        }
+    }
+
+    MappedFile file;
+    if (!file.open(path)) {
+        std::cerr << "Cannot open " << path << std::endl;
+        return 1;
+    }
+    auto decoded = binlog::decode(file.view(), [&](const binlog::Entry& entry) {
+        if (json) {
+            nlohmann::json j = {
+                {"timestamp", timestamp(entry.time_ns)},
+                {"level", level_name(entry.level)},
+                {"file", entry.file},
+                {"line", entry.line},
+                {"function", entry.function},
+                {"message", entry.message}
+            };
+            std::cout << j.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace) << '\n';
+        } else {
+            std::cout << std::format("[{}] {} {}:{} {}() | {}\n", timestamp(entry.time_ns), level_name(entry.level),
+                                     entry.file, entry.line, entry.function, entry.message);
+        }
+    });
+    std::cout.flush();
+    if (!decoded) {
+        std::cerr << path << ": " << decoded.error() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -1,216 +1,283 @@
 #include "utf8_utils.hpp"
-#include "utf8cpp/utf8.h"
-#include <cwchar>
-#include <limits>
-#include <locale>
+#include "unicode_width_table.hpp"
 #include <vector>
 #include <string>
 #include <sstream>
+#include <algorithm>
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
 
-// Get the next UTF-8 codepoint from a string
-uint32_t utf8_next_codepoint(const char* str, size_t& index) {
-    const char* start = str + index;
-    const char* end = start;
-    while (*end) end++;
-    
-    if (start >= end)
-        return 0;
-    
-    uint32_t codepoint;
-    try {
-        // Get the codepoint
-        codepoint = utf8::next(start, end);
-        // Update index to point after the current character
-        index = start - str;
-    } catch (const utf8::exception& e) {
-        // Handle invalid UTF-8
-        index++;
-        return 0xFFFD; // Replacement character
+uint32_t utf8_next_codepoint(std::string_view text, size_t& index) {
+    if (index >= text.size()) return 0;
+    unsigned char lead = static_cast<unsigned char>(text[index]);
+    if (lead < 0x80) {
+        ++index;
+        return lead;
     }
-    
+    Utf8Decoder decoder;
+    uint32_t codepoint = 0;
+    if (!decoder.next(text, index, codepoint)) decoder.finish(codepoint);
     return codepoint;
 }
 
-// Get the display width of a single codepoint using wcwidth
 int codepoint_width(uint32_t codepoint) {
-    // wcwidth works for values that fit in wchar_t
-    if (codepoint <= static_cast<uint32_t>(std::numeric_limits<wchar_t>::max())) {
-        int width = wcwidth(static_cast<wchar_t>(codepoint));
-        return width >= 0 ? width : 0;
+    return unicode_table::lookup(codepoint) & 3;
+}
+
+namespace {
+    // Grapheme break classes stored in bits 2-4 of the generated table
+    enum class Break : uint8_t { Other, Control, Extend, SpacingMark, Prepend, Pictographic };
+
+    enum class Hangul : uint8_t { None, L, V, T, LV, LVT };
+
+    constexpr uint32_t kZeroWidthJoiner = 0x200D;
+    constexpr uint32_t kEmojiPresentation = 0xFE0F;
+
+    Break break_class(uint8_t props) { return static_cast<Break>(props >> 2); }
+
+    bool is_regional_indicator(uint32_t cp) { return cp >= 0x1F1E6 && cp <= 0x1F1FF; }
+
+    Hangul hangul_type(uint32_t cp) {
+        if ((cp >= 0x1100 && cp <= 0x115F) || (cp >= 0xA960 && cp <= 0xA97C)) return Hangul::L;
+        if ((cp >= 0x1160 && cp <= 0x11A7) || (cp >= 0xD7B0 && cp <= 0xD7C6)) return Hangul::V;
+        if ((cp >= 0x11A8 && cp <= 0x11FF) || (cp >= 0xD7CB && cp <= 0xD7FB)) return Hangul::T;
+        if (cp >= 0xAC00 && cp <= 0xD7A3) return (cp - 0xAC00) % 28 == 0 ? Hangul::LV : Hangul::LVT;
+        return Hangul::None;
+    }
+
+    // Hangul syllable sequences (GB6-GB8)
+    bool hangul_joins(Hangul prev, Hangul next) {
+        switch (prev) {
+            case Hangul::L: return next == Hangul::L || next == Hangul::V || next == Hangul::LV || next == Hangul::LVT;
+            case Hangul::LV:
+            case Hangul::V: return next == Hangul::V || next == Hangul::T;
+            case Hangul::LVT:
+            case Hangul::T: return next == Hangul::T;
+            default: return false;
+        }
     }
-    
-    // For codepoints outside wchar_t range, assume width 1
-    return 1;
 }
 
-int utf8_display_width(const std::string& s) {
-    int width = 0;
-    
-    try {
-        const char* start = s.c_str();
-        const char* end = start + s.length();
-        
-        while (start < end) {
-            uint32_t codepoint = utf8::next(start, end);
-            width += codepoint_width(codepoint);
+int utf8_next_grapheme(std::string_view text, size_t& index) {
+    size_t n = text.size();
+    if (index >= n) return 0;
+    unsigned char lead = static_cast<unsigned char>(text[index]);
+    if (lead < 0x80) {
+        // ASCII followed by ASCII is a cluster on its own
+        ++index;
+        if (lead == '\r' && index < n && text[index] == '\n') {
+            ++index;
+            return 0;
+        }
+        if (lead < 0x20 || lead == 0x7F) return 0;
+        if (index >= n || static_cast<unsigned char>(text[index]) < 0x80) return 1;
+        --index;
+    }
+
+    uint32_t cp = utf8_next_codepoint(text, index);
+    uint8_t props = unicode_table::lookup(cp);
+    Break cls = break_class(props);
+    if (cls == Break::Control) return 0; // GB4
+    int width = props & 3;
+
+    Hangul hangul = hangul_type(cp);
+    bool prepend = cls == Break::Prepend;
+    bool regional_pair_open = is_regional_indicator(cp);
+    // Extended_Pictographic Extend* so far, and whether a ZWJ followed it (GB11)
+    bool pictographic = cls == Break::Pictographic;
+    bool after_zwj = false;
+
+    while (index < n) {
+        size_t next_index = index;
+        uint32_t next = utf8_next_codepoint(text, next_index);
+        uint8_t next_props = unicode_table::lookup(next);
+        Break next_cls = break_class(next_props);
+        Hangul next_hangul = hangul_type(next);
+
+        if (next_cls == Break::Control) break; // GB5
+        if (prepend) {
+            // GB9b: a prepended mark joins whatever follows; the base decides the width
+            width = next_props & 3;
+            pictographic = next_cls == Break::Pictographic;
+            prepend = next_cls == Break::Prepend;
+            regional_pair_open = is_regional_indicator(next);
+            hangul = next_hangul;
+        } else if (hangul_joins(hangul, next_hangul)) {
+            hangul = next_hangul;
+        } else if (next == kZeroWidthJoiner || next_cls == Break::Extend) { // GB9
+            // VS16 asks for emoji presentation, which terminals draw two columns wide
+            if (next == kEmojiPresentation && width == 1) width = 2;
+            after_zwj = next == kZeroWidthJoiner && pictographic;
+            if (next == kZeroWidthJoiner) pictographic = false;
+            hangul = Hangul::None;
+            index = next_index;
+            continue;
+        } else if (next_cls == Break::SpacingMark) { // GB9a
+            width += next_props & 3;
+            hangul = Hangul::None;
+        } else if (after_zwj && next_cls == Break::Pictographic) { // GB11: one emoji glyph
+            pictographic = true;
+        } else if (regional_pair_open && is_regional_indicator(next)) { // GB12/13: a flag
+            regional_pair_open = false;
+            width = 2;
+        } else {
+            break;
         }
-    } catch (const utf8::exception& e) {
-        // On invalid UTF-8, return best-effort width
+        after_zwj = false;
+        index = next_index;
     }
-    
     return width;
 }
 
-// indent: display width (in spaces) for wrapped lines (not for the first line)
-std::vector<std::string> utf8_word_wrap(const std::string& text, int max_width, int indent) {
-    std::vector<std::string> lines;
-    if (text.empty() || max_width <= 0)
-        return lines;
-    
-    std::string line;
-    int line_width = 0;
-    std::string word;
-    int word_width = 0;
-    bool is_first_line = true;
-    
-    auto add_word = [&]() {
-        if (word.empty())
-            return;
-            
-        // Check if adding this word would exceed max_width
-        int needed_width = line_width + (line.empty() ? 0 : 1) + word_width;
-        
-        if (needed_width > max_width && !line.empty()) {
-            // Add current line to lines and start a new one
-            lines.push_back(line);
-            line = std::string(indent, ' ');
-            line_width = indent;
-            is_first_line = false;
+namespace {
+    // Length of the leading run of printable ASCII other than space
+    // (0x21-0x7E): each such byte is one column and never a break point.
+    // Scans 32 or 16 bytes per step where AVX2 / SSE2 is available.
+    size_t ascii_word_run(const char* p, size_t n) {
+        size_t i = 0;
+#if defined(__AVX2__)
+        const __m256i space = _mm256_set1_epi8(0x21);
+        const __m256i del = _mm256_set1_epi8(0x7F);
+        for (; i + 32 <= n; i += 32) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+            // Signed compare: bytes >= 0x80 are negative, so this also flags non-ASCII
+            __m256i stop = _mm256_or_si256(_mm256_cmpgt_epi8(space, v), _mm256_cmpeq_epi8(v, del));
+            unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(stop));
+            if (mask != 0) return i + static_cast<size_t>(__builtin_ctz(mask));
+        }
+#endif
+#if defined(__SSE2__)
+        const __m128i space16 = _mm_set1_epi8(0x21);
+        const __m128i del16 = _mm_set1_epi8(0x7F);
+        for (; i + 16 <= n; i += 16) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+            __m128i stop = _mm_or_si128(_mm_cmplt_epi8(v, space16), _mm_cmpeq_epi8(v, del16));
+            unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(stop));
+            if (mask != 0) return i + static_cast<size_t>(__builtin_ctz(mask));
         }
-        
-        if (!line.empty() && line[line.length() - 1] != ' ') {
-            line += ' ';
-            line_width += 1;
+#endif
+        for (; i < n; ++i) {
+            unsigned char c = static_cast<unsigned char>(p[i]);
+            if (c <= 0x20 || c >= 0x7F) break;
         }
-        
-        // Add the word to the current line
-        line += word;
-        line_width += word_width;
-        
-        // Reset word
-        word.clear();
-        word_width = 0;
+        return i;
+    }
+
+    bool is_break(char c) { return c == ' ' || c == '\t' || c == '\n'; }
+
+}
+
+int utf8_display_width(std::string_view s) {
+    int width = 0;
+    for (size_t i = 0; i < s.size();) width += utf8_next_grapheme(s, i);
+    return width;
+}
+
+void utf8_wrap_spans(std::string_view text, int max_width, int indent, std::vector<WrapSpan>& out) {
+    out.clear();
+    if (text.empty() || max_width <= 0) return;
+
+    bool indented = false;
+    bool open = false;
+    size_t line_start = 0;
+    size_t line_end = 0;
+    int line_width = 0;
+    auto capacity = [&]() { return std::max(1, max_width - (indented ? indent : 0)); };
+    auto emit = [&](bool hyphenated) {
+        out.push_back({line_start, line_end - line_start, indented, hyphenated});
+        open = false;
+        line_width = 0;
     };
-    
-    try {
-        const char* start = text.c_str();
-        const char* end = start + text.length();
-        const char* token_start = start;
-        
-        while (start < end) {
-            // Save the current position
-            const char* char_start = start;
-            
-            // Get the next character and advance the iterator
-            uint32_t codepoint = utf8::next(start, end);
-            
-            // Get the UTF-8 character string representation
-            std::string utf8_char(char_start, start);
-            
-            if (codepoint == ' ' || codepoint == '\n' || codepoint == '\t') {
-                // End of word
-                add_word();
-                
-                if (codepoint == '\n') {
-                    // End of line
-                    lines.push_back(line);
-                    line.clear();
-                    line_width = 0;
-                    is_first_line = true;
-                }
+
+    size_t n = text.size();
+    for (size_t i = 0; i < n;) {
+        char c = text[i];
+        if (c == '\n') {
+            if (!open) line_start = line_end = i;
+            emit(false);
+            indented = false;
+            ++i;
+            continue;
+        }
+        if (c == ' ' || c == '\t') {
+            ++i;
+            continue;
+        }
+
+        // Measure the next word; ASCII runs are skipped in bulk
+        size_t word_start = i;
+        int word_width = 0;
+        while (i < n && !is_break(text[i])) {
+            size_t run = ascii_word_run(text.data() + i, n - i);
+            // A mark or joiner after the run belongs to its last character
+            if (run > 0 && i + run < n && static_cast<unsigned char>(text[i + run]) >= 0x80) --run;
+            if (run > 0) {
+                i += run;
+                word_width += static_cast<int>(run);
             } else {
-                // Part of a word
-                word += utf8_char;
-                word_width += codepoint_width(codepoint);
-                
-                // Handle exceptionally long words
-                if (word_width > max_width - (is_first_line ? 0 : indent)) {
-                    // Add as much of the word as we can fit
-                    if (!line.empty()) {
-                        lines.push_back(line);
-                        line.clear();
-                        line_width = 0;
-                        is_first_line = false;
-                    }
-                    
-                    // If word fits on a line by itself, add it
-                    if (word_width <= max_width) {
-                        line = is_first_line ? "" : std::string(indent, ' ');
-                        line_width = is_first_line ? 0 : indent;
-                        line += word;
-                        line_width += word_width;
-                        
-                        lines.push_back(line);
-                        line.clear();
-                        line_width = 0;
-                        is_first_line = false;
-                    } else {
-                        // The word needs to be broken up - character by character with hyphens
-                        std::string part;
-                        int part_width = 0;
-                        
-                        const char* word_ptr = word.c_str();
-                        const char* word_end = word_ptr + word.length();
-                        
-                        while (word_ptr < word_end) {
-                            const char* char_pos = word_ptr;
-                            uint32_t cp = utf8::next(word_ptr, word_end);
-                            int cp_width = codepoint_width(cp);
-                            
-                            if (part_width + cp_width > max_width - 1) { // -1 for hyphen
-                                part += "-";
-                                if (is_first_line) {
-                                    lines.push_back(part);
-                                } else {
-                                    lines.push_back(std::string(indent, ' ') + part);
-                                }
-                                part.clear();
-                                part_width = 0;
-                                is_first_line = false;
-                            }
-                            
-                            part.append(char_pos, word_ptr);
-                            part_width += cp_width;
-                        }
-                        
-                        if (!part.empty()) {
-                            line = is_first_line ? "" : std::string(indent, ' ');
-                            line_width = is_first_line ? 0 : indent;
-                            line += part;
-                            line_width += part_width;
-                        }
-                    }
-                    
-                    word.clear();
-                    word_width = 0;
-                }
+                word_width += utf8_next_grapheme(text, i);
             }
         }
-        
-        // Add any remaining word
-        add_word();
-        
-        // Add the last line if not empty
-        if (!line.empty()) {
-            lines.push_back(line);
+        size_t word_end = i;
+
+        // Whitespace between words is ASCII space/tab: one column per byte
+        int gap = open ? static_cast<int>(word_start - line_end) : 0;
+        if (open && line_width + gap + word_width > capacity()) {
+            emit(false);
+            indented = true;
+            gap = 0;
+        }
+        if (word_width <= capacity()) {
+            if (!open) {
+                line_start = word_start;
+                open = true;
+            }
+            line_width += gap + word_width;
+            line_end = word_end;
+            continue;
         }
-    } catch (const utf8::exception& e) {
-        // On invalid UTF-8, add what we have so far
-        add_word();
-        if (!line.empty()) {
-            lines.push_back(line);
+
+        // Too long for any line: split at character boundaries, leaving a column for the hyphen
+        if (open) {
+            emit(false);
+            indented = true;
+        }
+        size_t piece = word_start;
+        int piece_width = 0;
+        for (size_t j = word_start; j < word_end;) {
+            size_t char_start = j;
+            int w = utf8_next_grapheme(text, j);
+            if (piece_width > 0 && piece_width + w > capacity() - 1) {
+                line_start = piece;
+                line_end = char_start;
+                emit(true);
+                indented = true;
+                piece = char_start;
+                piece_width = 0;
+            }
+            piece_width += w;
         }
+        line_start = piece;
+        line_end = word_end;
+        line_width = piece_width;
+        open = true;
+    }
+    if (open) emit(false);
+}
+
+std::vector<std::string> utf8_word_wrap(const std::string& text, int max_width, int indent) {
+    std::vector<WrapSpan> spans;
+    utf8_wrap_spans(text, max_width, indent, spans);
+    std::vector<std::string> lines;
+    lines.reserve(spans.size());
+    for (const auto& span : spans) {
+        std::string line;
+        line.reserve((span.indented ? indent : 0) + span.length + 1);
+        if (span.indented) line.append(static_cast<size_t>(std::max(0, indent)), ' ');
+        line.append(text, span.offset, span.length);
+        if (span.hyphenated) line += '-';
+        lines.push_back(std::move(line));
     }
-    
     return lines;
-}
\ No newline at end of file
+}
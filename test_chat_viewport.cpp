@@ -0,0 +1,303 @@
+#include "LineOffsetIndex.hpp"
+#include "ChatWrapCache.hpp"
+#include "MessageHandler.hpp"
+#include "SessionStore.hpp"
+#include "test_harness.hpp"
+#include <iostream>
+#include <filesystem>
+#include <fstream>
+#include <cstdio>
+#include <random>
+#include <clocale>
+#include <algorithm>
+#include <format>
+#include <thread>
+
+int main() {
+    std::setlocale(LC_ALL, "");
+    std::cout << "=== Testing Chat Viewport ===" << std::endl;
+
+    // LineOffsetIndex against a brute-force prefix sum
+    std::mt19937 rng(42);
+    LineOffsetIndex index;
+    std::vector<size_t> counts;
+    for (int i = 0; i < 1000; ++i) {
+        size_t count = 1 + rng() % 7;
+        counts.push_back(count);
+        index.push_back(count);
+    }
+    for (int i = 0; i < 200; ++i) {
+        size_t at = rng() % counts.size();
+        counts[at] = 1 + rng() % 7;
+        index.set(at, counts[at]);
+    }
+    bool prefixes_ok = true;
+    bool finds_ok = true;
+    size_t sum = 0;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        prefixes_ok &= index.prefix(i) == sum;
+        for (size_t line = 0; line < counts[i]; ++line) {
+            auto [found, offset] = index.find(sum + line);
+            finds_ok &= found == i && offset == line;
+        }
+        sum += counts[i];
+    }
+    expect(prefixes_ok && index.total() == sum, "Prefix sums match after appends and updates");
+    expect(finds_ok, "find() maps every line to its message and offset");
+    expect(index.find(sum).first == counts.size(), "find() past the end returns size()");
+
+    // Inserts and erases in the middle rebuild the tree
+    for (int i = 0; i < 50; ++i) {
+        size_t at = rng() % counts.size();
+        if (i % 2 == 0) {
+            std::vector<size_t> added = {1 + rng() % 7, 1 + rng() % 7};
+            counts.insert(counts.begin() + static_cast<std::ptrdiff_t>(at), added.begin(), added.end());
+            index.insert(at, added);
+        } else {
+            counts.erase(counts.begin() + static_cast<std::ptrdiff_t>(at));
+            index.erase(at);
+        }
+    }
+    prefixes_ok = index.size() == counts.size();
+    sum = 0;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        prefixes_ok &= index.prefix(i) == sum && index.count(i) == counts[i];
+        sum += counts[i];
+    }
+    expect(prefixes_ok && index.total() == sum, "Prefix sums match after inserts and erases");
+
+    // ChatWrapCache viewport
+    MessageHandler messages;
+    ChatWrapCache cache;
+    cache.set_width(20);
+    cache.set_user_prefix("Me: ");
+    for (int i = 0; i < 500; ++i) {
+        messages.push_message({ChatMessage::Sender::User, "msg " + std::to_string(i)});
+    }
+    cache.sync(messages);
+    expect(cache.message_count() == 500, "All messages cached");
+    expect(cache.total_lines() == 1000, "Each short message takes one line plus a separator");
+
+    auto bottom = cache.visible_lines(0, 4);
+    expect(bottom.size() == 4 && bottom[2] == "Me: msg 499" && bottom[3].empty(),
+           "Bottom of the transcript is visible at scroll offset 0");
+    auto top = cache.visible_lines(static_cast<int>(cache.total_lines()) - 2, 4);
+    expect(top.size() == 2 && top[0] == "Me: msg 0", "Scrolling to the top shows the first message");
+
+    messages.push_message({ChatMessage::Sender::AI, ""});
+    cache.sync(messages);
+    messages.append_to_last_ai_message("streamed text that wraps across lines");
+    cache.sync(messages);
+    auto streamed = cache.visible_lines(0, 4);
+    expect(cache.total_lines() == 1004 && streamed[0] == "AI: streamed text", "Appended message is rewrapped");
+
+    cache.set_width(40);
+    cache.sync(messages);
+    expect(cache.total_lines() == 1003, "Width change rewraps everything");
+
+    // Streaming in random chunks rewraps incrementally but matches a full wrap
+    std::string text = "First paragraph with enough words to wrap a few times.\n\n"
+                       "Second one, also long enough to need several lines here.\nthird\n";
+    MessageHandler streamed_store;
+    ChatWrapCache incremental;
+    incremental.set_width(24);
+    streamed_store.push_message({ChatMessage::Sender::AI, ""});
+    for (size_t pos = 0; pos < text.size();) {
+        size_t len = std::min<size_t>(1 + rng() % 9, text.size() - pos);
+        streamed_store.append_to_last_ai_message(text.substr(pos, len));
+        incremental.sync(streamed_store);
+        pos += len;
+    }
+    MessageHandler full_store;
+    ChatWrapCache full;
+    full.set_width(24);
+    full_store.push_message({ChatMessage::Sender::AI, text});
+    full.sync(full_store);
+    expect(incremental.total_lines() == full.total_lines() &&
+           incremental.visible_lines(0, 100) == full.visible_lines(0, 100),
+           "Incremental rewrap of a streamed message matches a full wrap");
+
+    // Snapshots share content and don't see later appends
+    auto snapshot = streamed_store.get_messages_from(0);
+    streamed_store.append_to_last_ai_message("more");
+    auto latest = streamed_store.get_messages_from(0);
+    expect(snapshot[0].content == text && latest[0].content == text + "more",
+           "Snapshots are unaffected by later appends");
+
+    // A copy seals the tail segment for good: a dropped snapshot's use_count
+    // says nothing about whether its reader has finished with the bytes
+    MessageContent content("abc");
+    content.append(std::string_view("def"));
+    expect(content.segment_count() == 1, "Small appends extend the tail segment");
+    { MessageContent dropped = content; }
+    content.append(std::string_view("ghi"));
+    expect(content.segment_count() == 2 && content == "abcdefghi", "Appends after a copy start a new segment");
+    content.append(std::string_view("jkl"));
+    expect(content.segment_count() == 2 && content == "abcdefghijkl", "The new, unshared tail is extended again");
+    MessageContent moved = std::move(content);
+    moved.append(std::string_view("mno"));
+    expect(moved.segment_count() == 2 && moved == "abcdefghijklmno", "Moving keeps the tail unshared");
+
+    // A character split across chunks only appears once it is whole
+    MessageHandler split_store;
+    split_store.push_message({ChatMessage::Sender::AI, ""});
+    split_store.append_to_last_ai_message("東\xE4\xBA");
+    auto partial = split_store.get_messages_from(0);
+    split_store.append_to_last_ai_message("\xAC", true);
+    expect(partial[0].content == "東" && split_store.get_messages_from(0)[0].content == "東京",
+           "Streamed chunks never expose half a character");
+
+    messages.clear();
+    messages.push_message({ChatMessage::Sender::User, "fresh"});
+    cache.sync(messages);
+    expect(cache.message_count() == 1 && cache.total_lines() == 2, "Clearing the store resets the cache");
+
+    // Paged-in history is wrapped without disturbing cached entries
+    MessageHandler paged_store;
+    ChatWrapCache paged;
+    paged.set_width(20);
+    paged.set_user_prefix("Me: ");
+    std::vector<ChatMessage> older;
+    for (int i = 0; i < 10; ++i) {
+        ChatMessage msg{ChatMessage::Sender::User, "old " + std::to_string(i)};
+        msg.id = 1000 + i;
+        older.push_back(msg);
+    }
+    paged_store.prepend_messages(std::vector<ChatMessage>(older.begin() + 5, older.end()));
+    paged.sync(paged_store);
+    paged_store.push_message({ChatMessage::Sender::AI, "new"});
+    paged.sync(paged_store);
+    paged_store.prepend_messages(std::vector<ChatMessage>(older.begin(), older.begin() + 5));
+    paged.sync(paged_store);
+    ChatWrapCache paged_full;
+    paged_full.set_width(20);
+    paged_full.set_user_prefix("Me: ");
+    paged_full.sync(paged_store);
+    auto paged_lines = paged.visible_lines(0, 100);
+    expect(paged.message_count() == 11 && paged_lines == paged_full.visible_lines(0, 100) && paged_lines[0] == "Me: old 0",
+           "Prepended history matches a full wrap");
+    expect(paged_store.get_messages_from(10)[0].id == 1010, "Pushes after a prepend get ids above the prepended ones");
+
+    // A store opened without resuming still reserves the ids it holds
+    MessageHandler seeded;
+    seeded.push_message({ChatMessage::Sender::User, "typed before history was enabled"});
+    seeded.set_min_next_id(42);
+    seeded.push_message({ChatMessage::Sender::User, "after"});
+    seeded.set_min_next_id(7);
+    seeded.push_message({ChatMessage::Sender::User, "later"});
+    auto seeded_messages = seeded.get_messages_from(0);
+    expect(seeded_messages[1].id == 42 && seeded_messages[2].id == 43, "Id floor applies to later pushes and never lowers");
+
+    // Session log round trip, torn-tail repair and index rebuild
+    const std::string session_path = "test_chat_viewport_session.bin";
+    std::remove(session_path.c_str());
+    std::remove((session_path + ".idx").c_str());
+    {
+        SessionStore store(session_path);
+        expect(store.open().has_value() && store.record_count() == 0, "New session log opens empty");
+        store.set_provider("claude");
+        ChatMessage user{ChatMessage::Sender::User, "hello"};
+        user.id = 1;
+        ChatMessage reply{ChatMessage::Sender::AI, "hi there"};
+        reply.id = 2;
+        reply.content.append(std::string(5000, 'x'));
+        store.append(user);
+        store.append(reply);
+    }
+    {
+        SessionStore store(session_path);
+        bool opened = store.open().has_value();
+        auto loaded = store.load(0, store.record_count());
+        expect(opened && loaded.size() == 2 && loaded[0].content == "hello" &&
+               loaded[1].sender == ChatMessage::Sender::AI && loaded[1].content.size() == 5008 &&
+               store.record(1).provider == "claude" && store.max_message_id() == 2,
+               "Session log reloads messages with role and provider");
+    }
+    {
+        std::ofstream torn(session_path, std::ios::binary | std::ios::app);
+        torn << "CREC partial record";
+    }
+    {
+        SessionStore store(session_path);
+        bool opened = store.open().has_value();
+        ChatMessage next{ChatMessage::Sender::User, "after crash"};
+        next.id = 3;
+        expect(opened && store.record_count() == 2 && store.append(next), "Torn tail record is cut off on open");
+    }
+    std::remove((session_path + ".idx").c_str());
+    {
+        SessionStore store(session_path);
+        bool opened = store.open().has_value();
+        expect(opened && store.record_count() == 3 && store.record(2).content == "after crash",
+               "Missing index is rebuilt from the log");
+        expect(store.find_record(1) == 0u && store.find_record(3) == 2u && !store.find_record(4) &&
+               !store.find_record(0), "Records are found by message id");
+    }
+    {
+        // A prompt sent while a reply is still streaming is stored before that reply
+        SessionStore store(session_path);
+        store.open();
+        for (uint64_t id : {5, 4}) {
+            ChatMessage msg{ChatMessage::Sender::User, "out of order"};
+            msg.id = id;
+            store.append(msg);
+        }
+    }
+    {
+        SessionStore store(session_path);
+        bool opened = store.open().has_value();
+        expect(opened && store.find_record(5) == 3u && store.find_record(4) == 4u && store.find_record(3) == 2u,
+               "Records stored out of id order are still found");
+    }
+    {
+        // A second instance must not take the owner's half-written record for a torn tail
+        SessionStore owner(session_path);
+        bool owner_opened = owner.open().has_value();
+        {
+            std::ofstream in_flight(session_path, std::ios::binary | std::ios::app);
+            in_flight << "CREC record being written";
+        }
+        auto size_before = std::filesystem::file_size(session_path);
+        SessionStore second(session_path);
+        bool opened = second.open().has_value();
+        ChatMessage msg{ChatMessage::Sender::User, "from the second instance"};
+        msg.id = 9;
+        expect(owner_opened && !owner.is_read_only() && opened && second.is_read_only(),
+               "A locked session log opens read-only");
+        expect(second.record_count() == 5 && std::filesystem::file_size(session_path) == size_before &&
+               !second.append(msg), "The read-only instance neither truncates nor appends");
+    }
+    std::remove(session_path.c_str());
+    std::remove((session_path + ".idx").c_str());
+
+    // Concurrent producers: the transcript lists messages in the order the
+    // handler stored them, and everything queued is on disk once it is gone
+    const std::string transcript_path = "test_chat_viewport.transcript.tmp";
+    std::remove(transcript_path.c_str());
+    std::vector<std::string> stored_order;
+    {
+        MessageHandler handler(transcript_path);
+        handler.set_transcript_enabled(true);
+        std::vector<std::thread> producers;
+        for (int t = 0; t < 4; ++t) {
+            producers.emplace_back([&handler, t]() {
+                for (int k = 0; k < 250; ++k) {
+                    handler.push_message({ChatMessage::Sender::User, std::format("{}-{}", t, k)});
+                }
+            });
+        }
+        for (auto& producer : producers) producer.join();
+        for (const auto& msg : handler.get_messages_from(0)) stored_order.push_back(msg.content.str());
+    }
+    std::vector<std::string> written_order;
+    std::ifstream transcript(transcript_path);
+    for (std::string line; std::getline(transcript, line);) {
+        size_t tag = line.find("[USER] ");
+        if (tag != std::string::npos) written_order.push_back(line.substr(tag + 7));
+    }
+    expect(written_order.size() == 1000, "Every queued record is written before the handler is destroyed");
+    expect(written_order == stored_order, "Transcript order matches message order across threads");
+    std::remove(transcript_path.c_str());
+
+    return test_summary("chat viewport");
+}
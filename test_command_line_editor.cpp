@@ -0,0 +1,205 @@
+#include "CommandLineEditor.hpp"
+#include "test_harness.hpp"
+#include <curses.h>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    // Every soft-wrapped row, in order
+    std::vector<std::string> all_rows(const CommandLineEditor& editor) {
+        return editor.rows(0, editor.row_count());
+    }
+
+    void test_insert() {
+        CommandLineEditor editor;
+        editor.insert("first\nsecond\r\nthird\rfourth");
+        expect(editor.current_line() == "first\nsecond\nthird\nfourth", "CRLF and CR become line breaks");
+        expect(editor.line_count() == 4, "Each break starts a logical line");
+        expect(editor.cursor_pos() == static_cast<int>(editor.current_line().size()), "Cursor ends after the paste");
+
+        // Inserting a break in the middle of a line splits it around the cursor
+        editor.clear();
+        editor.insert("headtail");
+        editor.set_cursor_pos(4);
+        editor.insert("A\nB\nC");
+        expect(editor.current_line() == "headA\nB\nCtail", "Multi-line insert splits the cursor line");
+        expect(editor.line_count() == 3, "Split yields head, middle and tail lines");
+        expect(editor.cursor_pos() == 9 && editor.cursor_column() == 1, "Cursor follows the inserted text");
+
+        editor.insert_newline();
+        expect(editor.current_line() == "headA\nB\nC\ntail" && editor.line_count() == 4 && editor.cursor_column() == 0,
+               "insert_newline breaks the line at the cursor");
+
+        editor.clear();
+        editor.insert("a\tb\x01" "c");
+        expect(editor.current_line() == "a bc", "Tabs become spaces and other controls are dropped");
+    }
+
+    void test_join() {
+        CommandLineEditor editor;
+        editor.insert("one\ntwo\nthree");
+        editor.set_cursor_pos(4); // Start of "two"
+        editor.handle_input(KEY_BACKSPACE);
+        expect(editor.current_line() == "onetwo\nthree" && editor.line_count() == 2,
+               "Backspace at a line start joins it onto the previous line");
+        expect(editor.cursor_pos() == 3 && editor.cursor_column() == 3, "Cursor stays at the join");
+
+        editor.set_cursor_pos(6); // End of "onetwo"
+        editor.handle_input(KEY_DC);
+        expect(editor.current_line() == "onetwothree" && editor.line_count() == 1,
+               "Delete at a line end joins the next line on");
+        expect(editor.cursor_pos() == 6, "Delete leaves the cursor in place");
+
+        editor.set_cursor_pos(0);
+        editor.handle_input(KEY_BACKSPACE);
+        editor.set_cursor_pos(11);
+        editor.handle_input(KEY_DC);
+        expect(editor.current_line() == "onetwothree", "Backspace at the start and Delete at the end do nothing");
+
+        // Joined lines edit like any other
+        editor.set_cursor_pos(3);
+        editor.handle_input(KEY_BACKSPACE);
+        editor.handle_input('E');
+        expect(editor.current_line() == "onEtwothree", "Joined line stays editable");
+    }
+
+    // Left, Right, Backspace and Delete step over whole grapheme clusters
+    void test_graphemes() {
+        const std::string family = "\U0001F468\u200D\U0001F469\u200D\U0001F467"; // One emoji, 18 bytes
+        const std::string accented = "e\u0301";                                      // e + combining acute
+        const std::string flag = "\U0001F1EF\U0001F1F5";                             // Two regional indicators
+        CommandLineEditor editor;
+        editor.insert("a" + family + accented + flag + "\nz");
+        const int family_end = 1 + static_cast<int>(family.size());
+        const int accented_end = family_end + static_cast<int>(accented.size());
+        const int flag_end = accented_end + static_cast<int>(flag.size());
+
+        editor.set_cursor_pos(1);
+        editor.handle_input(KEY_RIGHT);
+        expect(editor.cursor_pos() == family_end, "Right skips a whole ZWJ sequence");
+        editor.handle_input(KEY_RIGHT);
+        expect(editor.cursor_pos() == accented_end, "Right skips a letter with its combining mark");
+        editor.handle_input(KEY_RIGHT);
+        expect(editor.cursor_pos() == flag_end, "Right skips a flag");
+        editor.handle_input(KEY_RIGHT);
+        expect(editor.cursor_pos() == flag_end + 1 && editor.cursor_row() == 1, "Right at a line end crosses the break");
+        editor.handle_input(KEY_LEFT);
+        editor.handle_input(KEY_LEFT);
+        expect(editor.cursor_pos() == accented_end, "Left steps back over the break, then the flag");
+        editor.handle_input(KEY_LEFT);
+        editor.handle_input(KEY_LEFT);
+        expect(editor.cursor_pos() == 1, "Left steps back over whole clusters");
+
+        editor.handle_input(KEY_DC);
+        expect(editor.current_line() == "a" + accented + flag + "\nz", "Delete removes the whole emoji");
+        editor.set_cursor_pos(1 + static_cast<int>(accented.size()));
+        editor.handle_input(KEY_BACKSPACE);
+        expect(editor.current_line() == "a" + flag + "\nz", "Backspace removes the accent with its base");
+        editor.handle_input(KEY_DC);
+        expect(editor.current_line() == "a\nz" && editor.cursor_column() == 1, "Delete removes both halves of a flag");
+    }
+
+    void test_move_line() {
+        CommandLineEditor editor;
+        editor.insert("abcdef\nxy\n中文字\nlast line");
+        expect(!editor.move_line(1), "No line below the last");
+
+        editor.set_cursor_pos(4); // Column 4 of "abcdef"
+        expect(!editor.move_line(-1), "No line above the first");
+        expect(editor.move_line(1) && editor.cursor_column() == 2, "A shorter line clamps to its end");
+        expect(editor.move_line(1) && editor.cursor_column() == 2,
+               "Wide characters: column 2 is after the first ideograph");
+        expect(editor.move_line(1) && editor.cursor_column() == 2, "Column carries over to the next line");
+        expect(editor.move_line(-1) && editor.move_line(-1) && editor.move_line(-1) && editor.cursor_pos() == 2,
+               "Moving back up lands on the same column");
+
+        // Column 3 falls inside 中 (columns 2-3), so the cursor stops before it
+        editor.set_cursor_pos(3);
+        editor.move_line(1);
+        editor.move_line(1);
+        expect(editor.cursor_column() == 2, "A column inside a wide character stops before it");
+    }
+
+    void test_rows() {
+        CommandLineEditor editor;
+        editor.set_wrap_width(4);
+        editor.insert("abcdefghij\nxy");
+        expect(editor.row_count() == 4, "Lines soft-wrap to the wrap width");
+        expect(all_rows(editor) == std::vector<std::string>{"abcd", "efgh", "ij", "xy"}, "Rows split on width");
+        expect(editor.cursor_row() == 3 && editor.cursor_column() == 2, "Cursor is on the last row");
+
+        editor.set_cursor_pos(5); // After "abcde"
+        expect(editor.cursor_row() == 1 && editor.cursor_column() == 1, "Cursor row inside a wrapped line");
+
+        // Editing the line invalidates its rows
+        editor.insert("XYZ");
+        expect(all_rows(editor) == std::vector<std::string>{"abcd", "eXYZ", "fghi", "j", "xy"},
+               "Insert rewraps the edited line");
+        expect(editor.cursor_row() == 2 && editor.cursor_column() == 0, "Cursor moves with the rewrap");
+
+        editor.insert("\n");
+        expect(all_rows(editor) == std::vector<std::string>{"abcd", "eXYZ", "fghi", "j", "xy"},
+               "A break rewraps both halves");
+        expect(editor.cursor_row() == 2 && editor.cursor_column() == 0, "Cursor is at the start of the new line");
+        editor.insert("\n");
+        expect(all_rows(editor) == std::vector<std::string>{"abcd", "eXYZ", "", "fghi", "j", "xy"},
+               "An empty line is one row");
+        editor.handle_input(KEY_BACKSPACE);
+        editor.handle_input(KEY_BACKSPACE);
+        expect(all_rows(editor) == std::vector<std::string>{"abcd", "eXYZ", "fghi", "j", "xy"} &&
+               editor.cursor_row() == 2, "Joining rewraps the merged line");
+
+        // A new width rewraps everything; wide characters never straddle rows
+        editor.set_wrap_width(3);
+        editor.clear();
+        editor.insert("中文字x");
+        expect(all_rows(editor) == std::vector<std::string>{"中", "文", "字x"}, "Wide characters wrap whole");
+        expect(editor.cursor_row() == 2 && editor.cursor_column() == 3, "Cursor column counts display columns");
+        editor.set_wrap_width(10);
+        expect(editor.row_count() == 1 && editor.cursor_row() == 0, "Widening rewraps into one row");
+        expect(editor.rows(1, 5).empty(), "Rows past the end are empty");
+    }
+
+    // Row counts kept up edit by edit match an editor that wrapped the same text in one paste
+    void test_row_index() {
+        std::mt19937 rng(7);
+        CommandLineEditor editor;
+        editor.set_wrap_width(7);
+        for (int i = 0; i < 200; ++i) {
+            editor.insert(std::string(rng() % 20, static_cast<char>('a' + i % 26)) + "\n");
+        }
+        bool consistent = true;
+        for (int step = 0; step < 2000 && consistent; ++step) {
+            switch (rng() % 6) {
+                case 0: editor.set_cursor_pos(static_cast<int>(rng() % (editor.current_line().size() + 1))); break;
+                case 1: editor.insert_newline(); break;
+                case 2: editor.handle_input(KEY_BACKSPACE); break;
+                case 3: editor.handle_input(KEY_DC); break;
+                default: editor.handle_input('x'); break;
+            }
+            if (step % 50 != 0) continue;
+            CommandLineEditor fresh;
+            fresh.set_wrap_width(7);
+            fresh.insert(editor.current_line());
+            fresh.set_cursor_pos(editor.cursor_pos());
+            size_t middle = editor.row_count() / 2;
+            consistent = editor.row_count() == fresh.row_count() && editor.cursor_row() == fresh.cursor_row() &&
+                         editor.rows(middle, 10) == fresh.rows(middle, 10) &&
+                         editor.rows(editor.cursor_row(), 3) == fresh.rows(fresh.cursor_row(), 3);
+        }
+        expect(consistent, "Incremental row counts match a full rewrap");
+    }
+}
+
+int main() {
+    std::cout << "Testing command line editor" << std::endl;
+    test_insert();
+    test_join();
+    test_graphemes();
+    test_move_line();
+    test_rows();
+    test_row_index();
+    return test_summary("Command line editor");
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include "MCPClient.hpp"
+#include <sys/wait.h>
+#include <signal.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+// bench/fake_mcp_server.py on the other end of a pair of pipes, for tests
+// that drive a real MCPClient over stdio. Run the tests from the repository
+// root, or pass the script's path as the program's first argument.
+class FakeMCPServer {
+public:
+    explicit FakeMCPServer(const std::string& script = "bench/fake_mcp_server.py") {
+        int in_pipe[2], out_pipe[2];
+        if (pipe(in_pipe) == -1 || pipe(out_pipe) == -1) {
+            std::perror("pipe");
+            return;
+        }
+        pid_ = fork();
+        if (pid_ == 0) {
+            dup2(in_pipe[0], STDIN_FILENO);
+            dup2(out_pipe[1], STDOUT_FILENO);
+            close(in_pipe[0]);
+            close(in_pipe[1]);
+            close(out_pipe[0]);
+            close(out_pipe[1]);
+            execlp("python3", "python3", script.c_str(), static_cast<char*>(nullptr));
+            std::perror("execlp");
+            _exit(EXIT_FAILURE);
+        }
+        close(in_pipe[0]);
+        close(out_pipe[1]);
+        stdin_fd_ = in_pipe[1];
+        stdout_fd_ = out_pipe[0];
+        client_ = std::make_unique<MCPClient>(stdin_fd_, stdout_fd_);
+    }
+
+    ~FakeMCPServer() {
+        client_.reset();
+        if (stdin_fd_ >= 0) close(stdin_fd_);
+        if (stdout_fd_ >= 0) close(stdout_fd_);
+        if (pid_ > 0) {
+            kill(pid_, SIGTERM);
+            waitpid(pid_, nullptr, 0);
+        }
+    }
+
+    FakeMCPServer(const FakeMCPServer&) = delete;
+    FakeMCPServer& operator=(const FakeMCPServer&) = delete;
+
+    // Connects and runs the initialize handshake
+    bool connect() { return client_ && client_->connect().get().has_value(); }
+    MCPClient& client() { return *client_; }
+
+    // Sends a request outside the managers, e.g. the server's fake/* test hooks
+    std::optional<nlohmann::json> request(const std::string& method, nlohmann::json params = nlohmann::json::object()) {
+        auto response = client_->send_request_for_manager(MCPRequest(method, std::move(params))).get();
+        if (!response || response->is_error() || !response->result) return std::nullopt;
+        return response->result;
+    }
+
+private:
+    pid_t pid_ = -1;
+    int stdin_fd_ = -1;
+    int stdout_fd_ = -1;
+    std::unique_ptr<MCPClient> client_;
+};
@@ -0,0 +1,23 @@
+#pragma once
+#include <iostream>
+#include <string>
+
+// Minimal harness shared by the test_*.cpp programs: every check prints a
+// line, and the program's exit code says whether any of them failed.
+
+inline int test_failures = 0;
+
+inline void expect(bool condition, const std::string& description) {
+    std::cout << (condition ? "✓ " : "✗ ") << description << std::endl;
+    if (!condition) ++test_failures;
+}
+
+// Prints the summary for `suite` and returns the exit code for main()
+inline int test_summary(const std::string& suite) {
+    if (test_failures > 0) {
+        std::cout << test_failures << " " << suite << " test(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "All " << suite << " tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,89 @@
+#include "MCPClient.hpp"
+#include "MCPPromptManager.hpp"
+#include "test_fake_mcp_server.hpp"
+#include "test_harness.hpp"
+
+int main(int argc, char* argv[]) {
+    std::cout << "Testing MCP prompts" << std::endl;
+
+    // Local templates
+    auto tmpl = PromptTemplate::compile("Hi {{ name }}, {{name}}! {{not a slot}} {{");
+    expect(tmpl.slot_names() == std::vector<std::string>{"name"}, "Template has one slot");
+    expect(tmpl.render({{"name", "Ann"}}) == "Hi Ann, Ann! {{not a slot}} {{", "Template renders every occurrence");
+    auto rendered = PromptTemplate::from_rendered("<A> and <B>, then <A>", {{"a", "<A>"}, {"b", "<B>"}});
+    expect(rendered.render({{"a", "1"}, {"b", "2"}}) == "1 and 2, then 1", "Rendered text splits at markers");
+
+    FakeMCPServer server(argc > 1 ? argv[1] : "bench/fake_mcp_server.py");
+    expect(server.connect(), "Connects over stdio");
+    auto& prompts = *server.client().prompt_manager();
+    auto gets = [&]() {
+        auto stats = server.request("fake/stats");
+        return stats ? stats->value("prompts_get", -1) : -1;
+    };
+
+    // A plain substitution: probe, then two verifying calls with every argument changed, then local renders
+    nlohmann::json ann = {{"name", "Ann"}, {"place", "Oslo"}};
+    expect(prompts.get_prompt("greeting", ann) == "Hello, Ann! Welcome to Oslo.", "Renders a prompt");
+    expect(gets() == 2, "First use probes the prompt and asks the server for the real render");
+    nlohmann::json ann_rome = {{"name", "Ann"}, {"place", "Rome"}};
+    expect(prompts.get_prompt("greeting", ann_rome) == "Hello, Ann! Welcome to Rome.", "Renders a changed place");
+    expect(gets() == 3, "A render sharing an argument value does not prove the template");
+    nlohmann::json bob = {{"name", "Bob"}, {"place", "Lima"}};
+    expect(prompts.get_prompt("greeting", bob) == "Hello, Bob! Welcome to Lima.", "Renders other arguments");
+    int after_first = gets();
+    expect(after_first == 4, "A render with every argument changed is checked by the server");
+    nlohmann::json cyd = {{"name", "Cyd"}, {"place", "Kyiv"}};
+    expect(prompts.get_prompt("greeting", cyd) == "Hello, Cyd! Welcome to Kyiv.", "Renders locally");
+    expect(gets() == after_first, "Proven prompt renders locally");
+    expect(prompts.get_prompt("greeting", nlohmann::json{{"name", ""}, {"place", "Kyiv"}}) == "Hello, ! Welcome to Kyiv.",
+           "Renders an empty argument");
+    expect(gets() == after_first + 1, "Empty arguments go to the server");
+    ++after_first;
+
+    // Missing arguments are the server's to reject
+    expect(!prompts.get_prompt("greeting", nlohmann::json{{"name", "Ann"}}), "Missing required argument is an error");
+    expect(gets() == after_first + 1, "Missing argument goes to the server");
+    expect(prompts.get_prompt("review", nlohmann::json{{"code", "x++"}}) == "Review this  code:\nx++",
+           "Missing optional argument is rendered by the server");
+
+    // The probe compiles, but the real render disagrees: never rendered locally
+    int before = gets();
+    expect(prompts.get_prompt("length_aware", nlohmann::json{{"topic", "cats"}}) == "cats (4 characters)",
+           "Non-substitution prompt renders correctly");
+    expect(prompts.get_prompt("length_aware", nlohmann::json{{"topic", "horses"}}) == "horses (6 characters)",
+           "Non-substitution prompt is not rendered from the probe");
+    expect(gets() == before + 3, "Non-substitution prompt goes to the server every call");
+
+    // Matches the server for one value and not another: never trusted
+    before = gets();
+    expect(prompts.get_prompt("access", nlohmann::json{{"name", "Ann"}, {"level", "basic"}}) == "Ann has basic access",
+           "Value-dependent prompt renders");
+    expect(prompts.get_prompt("access", nlohmann::json{{"name", "Bob"}, {"level", "admin"}}) == "Bob has full access",
+           "Value-dependent prompt follows the server's conditional");
+    expect(prompts.get_prompt("access", nlohmann::json{{"name", "Cyd"}, {"level", "guest"}}) == "Cyd has guest access",
+           "Value-dependent prompt renders after a mismatch");
+    expect(gets() == before + 4, "Value-dependent prompt goes to the server every call");
+
+    // The render_template cache stays bounded and keeps rendering
+    bool renders = true;
+    for (int i = 0; i < 200; ++i) {
+        auto n = std::to_string(i);
+        renders = renders && prompts.render_template(n + ": {{x}}", {{"x", "y"}}) == n + ": y";
+    }
+    expect(renders && prompts.render_template("{{x}}!", {{"x", "z"}}) == "z!", "Template cache evicts and recompiles");
+
+    // A failed probe is remembered
+    before = gets();
+    expect(!prompts.get_prompt("broken"), "Failing prompt is an error");
+    int first_cost = gets() - before;
+    expect(!prompts.get_prompt("broken"), "Failing prompt stays an error");
+    expect(first_cost == 2 && gets() - before == 3, "Failed probe is not repeated");
+
+    // list_changed drops compiled templates
+    server.request("fake/set_prompt", {{"name", "greeting"}, {"template", "Hey {name}"},
+                                       {"arguments", {{{"name", "name"}, {"required", true}}}}});
+    expect(prompts.get_prompt("greeting", nlohmann::json{{"name", "Ann"}}) == "Hey Ann",
+           "list_changed notification drops the compiled prompt");
+
+    return test_summary("MCP prompt");
+}
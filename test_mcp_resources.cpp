@@ -0,0 +1,79 @@
+#include "MCPClient.hpp"
+#include "MCPResourceManager.hpp"
+#include "test_fake_mcp_server.hpp"
+#include "test_harness.hpp"
+#include <cstdio>
+#include <fstream>
+
+namespace {
+    std::string text_of(const std::optional<nlohmann::json>& result) {
+        if (!result || !result->contains("contents") || (*result)["contents"].empty()) return "";
+        return (*result)["contents"][0].value("text", "");
+    }
+
+    // Writes `content` and sets the mtime to 1700000000.<nanoseconds>
+    void write_file(const std::string& path, const std::string& content, long nanoseconds) {
+        std::ofstream(path, std::ios::trunc) << content;
+        timespec times[2] = {{1700000000, nanoseconds}, {1700000000, nanoseconds}};
+        utimensat(AT_FDCWD, path.c_str(), times, 0);
+    }
+
+    // The staleness check behind file-backed cache entries
+    void test_file_stamp() {
+        const std::string path = "test_mcp_resources.tmp";
+        write_file(path, "0123456789", 100);
+        auto stamp = FileStamp::take(path);
+        expect(stamp && stamp->size() == 10 && !stamp->is_stale(path), "Stamps a file");
+        expect(stamp && stamp->read_if_current(path) == "0123456789", "Reads a file that still matches its stamp");
+
+        // Same size, inode and second: only the nanoseconds tell them apart
+        write_file(path, "abcdefghij", 200);
+        expect(stamp && stamp->is_stale(path), "Same-size rewrite makes the stamp stale");
+        expect(stamp && !stamp->read_if_current(path), "Rewritten file is not read under a stale stamp");
+
+        auto truncated = FileStamp::take(path);
+        truncate(path.c_str(), 4);
+        expect(truncated && truncated->is_stale(path) && !truncated->read_if_current(path),
+               "Truncated file is stale, not read");
+        std::remove(path.c_str());
+        expect(!FileStamp::take(path), "A missing file has no stamp");
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "Testing MCP resources" << std::endl;
+    test_file_stamp();
+
+    FakeMCPServer server(argc > 1 ? argv[1] : "bench/fake_mcp_server.py");
+    expect(server.connect(), "Connects over stdio");
+    auto& resources = *server.client().resource_manager();
+
+    expect(resources.list_resources().size() == 2, "Lists the server's resources");
+
+    const std::string uri = "fake://notes";
+    expect(text_of(resources.read_resource(uri)) == "first version of the notes", "Reads a resource");
+    expect(resources.is_subscribed(uri), "First read subscribes to the resource");
+    expect(resources.is_cached(uri), "First read caches the resource");
+
+    // The server sends notifications/resources/updated before its reply
+    expect(server.request("fake/update_resource", {{"uri", uri}, {"text", "second version"}}).has_value(),
+           "Server accepts the update");
+    expect(!resources.is_cached(uri), "Updated notification invalidates the cached copy");
+    expect(text_of(resources.read_resource(uri)) == "second version", "Re-read returns the fresh content");
+    expect(text_of(resources.read_resource(uri)) == "second version", "Fresh content is served from the cache");
+
+    // Unsubscribed resources don't get notifications, so the cache stays put
+    expect(resources.unsubscribe(uri), "Unsubscribes");
+    server.request("fake/update_resource", {{"uri", uri}, {"text", "third version"}});
+    expect(resources.is_cached(uri), "No notification after unsubscribing");
+    expect(text_of(resources.read_resource(uri, true)) == "third version", "force_refresh goes to the server");
+
+    // An update right behind the first read's reply must not leave that read cached
+    const std::string status = "fake://status";
+    server.request("fake/update_after_read", {{"uri", status}, {"text", "busy"}});
+    expect(text_of(resources.read_resource(status)) == "idle", "First read returns the old status");
+    server.request("ping"); // The reader handles messages in order: the notification is in once this returns
+    expect(text_of(resources.read_resource(status)) == "busy", "Update after the read reply is not missed");
+
+    return test_summary("MCP resource");
+}
@@ -0,0 +1,81 @@
+#include "MCPSchemaValidator.hpp"
+#include "test_harness.hpp"
+#include <iostream>
+#include <algorithm>
+
+int main() {
+    std::cout << "=== Testing MCP Schema Validator ===" << std::endl;
+
+    // Typical tool inputSchema
+    nlohmann::json schema = {
+        {"type", "object"},
+        {"properties", {
+            {"query", {{"type", "string"}, {"minLength", 1}}},
+            {"count", {{"type", "integer"}, {"minimum", 1}, {"maximum", 20}}},
+            {"safesearch", {{"type", "string"}, {"enum", {"off", "moderate", "strict"}}}},
+            {"tags", {{"type", "array"}, {"items", {{"type", "string"}}}, {"maxItems", 3}}}
+        }},
+        {"required", {"query"}},
+        {"additionalProperties", false}
+    };
+
+    auto compiled = MCPSchemaValidator::compile(schema);
+    expect(compiled.has_value(), "Schema compiles");
+    if (!compiled) return 1;
+    const auto& validator = *compiled;
+
+    expect(validator.validate({{"query", "weather"}}).has_value(), "Minimal valid arguments accepted");
+    expect(validator.validate({{"query", "news"}, {"count", 5}, {"safesearch", "strict"}, {"tags", {"a", "b"}}}).has_value(),
+           "Full valid arguments accepted");
+    expect(validator.validate({{"query", "x"}, {"count", 5.0}}).has_value(), "Integral float accepted as integer");
+
+    auto missing = validator.validate(nlohmann::json::object());
+    expect(!missing && missing.error().find("missing required property 'query'") != std::string::npos,
+           "Missing required property reported");
+
+    auto wrong_type = validator.validate({{"query", 42}});
+    expect(!wrong_type && wrong_type.error().find("$.query: expected string, got integer") != std::string::npos,
+           "Wrong type reported with path");
+
+    auto out_of_range = validator.validate({{"query", "x"}, {"count", 50}});
+    expect(!out_of_range && out_of_range.error().find("greater than maximum") != std::string::npos,
+           "Maximum bound enforced");
+
+    auto bad_enum = validator.validate({{"query", "x"}, {"safesearch", "none"}});
+    expect(!bad_enum && bad_enum.error().find("is not one of") != std::string::npos, "Enum enforced");
+
+    auto extra = validator.validate({{"query", "x"}, {"verbose", true}});
+    expect(!extra && extra.error().find("unexpected property 'verbose'") != std::string::npos,
+           "additionalProperties: false enforced");
+
+    auto bad_item = validator.validate({{"query", "x"}, {"tags", {"a", 1}}});
+    expect(!bad_item && bad_item.error().find("$.tags[1]") != std::string::npos, "Array item path reported");
+
+    auto several = validator.validate({{"count", 0}, {"tags", {"a", "b", "c", "d"}}});
+    expect(!several && std::count(several.error().begin(), several.error().end(), '\n') == 2,
+           "All violations reported together");
+
+    // anyOf / nullable types
+    auto alt = MCPSchemaValidator::compile({{"anyOf", {{{"type", "string"}}, {{"type", "integer"}}}}});
+    expect(alt && alt->validate("abc").has_value() && alt->validate(3).has_value() && !alt->validate(true).has_value(),
+           "anyOf alternatives");
+    auto nullable = MCPSchemaValidator::compile({{"type", {"string", "null"}}});
+    expect(nullable && nullable->validate(nullptr).has_value() && !nullable->validate(1.5).has_value(),
+           "Type arrays");
+
+    // Keywords the validator cannot check are reported instead of skipped
+    expect(validator.unsupported_keywords().empty(), "Plain schema has no unsupported keywords");
+    auto composed = MCPSchemaValidator::compile({
+        {"type", "object"},
+        {"allOf", {{{"$ref", "#/definitions/base"}}}},
+        {"properties", {{"meta", {{"type", "object"}, {"patternProperties", {{"^x-", {{"type", "string"}}}}}}}}}
+    });
+    expect(composed && composed->unsupported_keywords() == std::vector<std::string>{"$: allOf", "$.meta: patternProperties"},
+           "allOf and nested patternProperties reported with their paths");
+
+    // Malformed schemas are reported at compile time
+    expect(!MCPSchemaValidator::compile({{"type", "strnig"}}).has_value(), "Invalid type rejected at compile time");
+    expect(!MCPSchemaValidator::compile({{"type", "string"}, {"pattern", "("}}).has_value(), "Invalid pattern rejected at compile time");
+
+    return test_summary("schema validator");
+}
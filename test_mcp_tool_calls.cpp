@@ -0,0 +1,131 @@
+#include "MCPClient.hpp"
+#include "MCPToolManager.hpp"
+#include "MCPNotificationInterface.hpp"
+#include "test_fake_mcp_server.hpp"
+#include "Metrics.hpp"
+#include "test_harness.hpp"
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+    struct ProgressUpdate {
+        std::string tool;
+        double progress;
+        std::optional<double> total;
+    };
+
+    // Whether the server was sent notifications/cancelled for `id`
+    bool server_saw_cancel(FakeMCPServer& server, int64_t id) {
+        auto stats = server.request("fake/stats");
+        if (!stats || !stats->contains("cancelled")) return false;
+        const auto& cancelled = (*stats)["cancelled"];
+        return std::find(cancelled.begin(), cancelled.end(), id) != cancelled.end();
+    }
+
+    void test_cancellation(FakeMCPServer& server) {
+        auto& client = server.client();
+        using namespace std::chrono_literals;
+
+        // A cancel handle abandons the call it is bound to
+        MCPCancelHandle cancel;
+        auto hang = MCPProtocolMessages::create_tools_call_request("hang", nlohmann::json::object());
+        auto pending = client.send_request_for_manager(hang, 30000ms, cancel);
+        std::this_thread::sleep_for(50ms);
+        cancel.cancel("test");
+        expect(pending.wait_for(2s) == std::future_status::ready, "Cancelled call returns without waiting out its timeout");
+        auto result = pending.get();
+        expect(!result && result.error().code == ApiError::Cancelled, "Cancelled call fails with ApiError::Cancelled");
+        expect(server_saw_cancel(server, std::get<int64_t>(hang.id)), "Server is sent notifications/cancelled");
+        expect(!client.cancel_request(hang.id, "again"), "Cancelling an abandoned request again does nothing");
+
+        auto after = client.send_request_for_manager(MCPProtocolMessages::create_tools_call_request("echo", nlohmann::json::object()),
+                                                     30000ms, cancel).get();
+        expect(!after, "A cancelled handle fails later requests at once");
+
+        // A reply that crosses the cancellation is dropped, not delivered
+        auto& late = MetricsRegistry::instance().counter(metric_names::kMcpLateReplies, {{"server", client.server_label()}});
+        uint64_t late_before = late.value();
+        auto slow = MCPProtocolMessages::create_tools_call_request(
+            "echo", nlohmann::json{{"latency_ms", 200}, {"ignore_cancel", true}});
+        pending = client.send_request_for_manager(slow, 30000ms);
+        std::this_thread::sleep_for(50ms);
+        expect(client.cancel_request(slow.id, "test"), "cancel_request abandons a pending request");
+        result = pending.get();
+        expect(!result && result.error().code == ApiError::Cancelled, "cancel_request fails the waiting call");
+        expect(server_saw_cancel(server, std::get<int64_t>(slow.id)), "cancel_request notifies the server");
+        for (int i = 0; i < 100 && late.value() == late_before; ++i) std::this_thread::sleep_for(10ms);
+        expect(late.value() == late_before + 1, "Late reply to the cancelled request is discarded");
+
+        auto echo = client.send_request_for_manager(
+            MCPProtocolMessages::create_tools_call_request("echo", nlohmann::json{{"text", "still here"}})).get();
+        expect(echo && echo->result && echo->result->dump().find("still here") != std::string::npos,
+               "The connection keeps working after a cancellation");
+    }
+
+    // Validators from every tools/list page are kept; a schema the client
+    // cannot fully check is left to the server
+    void test_paged_validators(FakeMCPServer& server) {
+        auto& tools = *server.client().tool_manager();
+        expect(server.request("fake/set_tools_page_size", {{"size", 3}}).has_value(), "Server pages its tool list");
+        tools.handle_list_changed_notification();
+        size_t listed = tools.list_tools().size();
+        listed += tools.list_tools("3").size();
+        listed += tools.list_tools("6").size();
+        expect(listed == 8 && tools.list_tools().size() == 8, "Pages accumulate into the cached tool list");
+        expect(!tools.check_parameters("echo", {{"text", 5}}).has_value(),
+               "A later page keeps the first page's validators");
+        expect(!tools.check_parameters("progress", {{"text", 5}}).has_value(), "The last page is validated too");
+
+        const nlohmann::json tagged_args = {{"text", "hi"}, {"tag_colour", "red"}};
+        expect(tools.check_parameters("tagged", tagged_args).has_value(),
+               "patternProperties is not half-checked on the client");
+        auto result = tools.call_tool("tagged", tagged_args);
+        expect(result.dump().find("tag_colour") != std::string::npos, "The call reaches the server");
+        server.request("fake/set_tools_page_size", {{"size", 0}});
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "Testing MCP tool calls" << std::endl;
+    FakeMCPServer server(argc > 1 ? argv[1] : "bench/fake_mcp_server.py");
+    expect(server.connect(), "Connects over stdio");
+    auto& tools = *server.client().tool_manager();
+    expect(!tools.list_tools().empty(), "Lists tools");
+
+    // notifications/progress reaches the notifier of the call that owns the token
+    std::mutex updates_mutex;
+    std::vector<ProgressUpdate> updates;
+    MCPCallbackNotifier notifier;
+    notifier.set_tool_call_progress_callback([&](const std::string& tool, double progress, std::optional<double> total,
+                                                 const std::string&) {
+        std::lock_guard lock(updates_mutex);
+        updates.push_back({tool, progress, total});
+    });
+    tools.set_notification_interface(&notifier);
+    auto result = tools.call_tool("progress", nlohmann::json::object());
+    expect(result.contains("content"), "Progress tool call succeeds");
+    {
+        std::lock_guard lock(updates_mutex);
+        bool in_order = updates.size() == 5;
+        for (size_t i = 0; i < updates.size() && in_order; ++i) {
+            in_order = updates[i].tool == "progress" && updates[i].progress == static_cast<double>(i + 1) &&
+                       updates[i].total == 5.0;
+        }
+        expect(in_order, "Every progress notification is routed to on_tool_call_progress, the last one included");
+        updates.clear();
+    }
+    tools.call_tool("echo", nlohmann::json{{"text", "hi"}});
+    {
+        std::lock_guard lock(updates_mutex);
+        expect(updates.empty(), "Calls without progress report none");
+    }
+    tools.set_notification_interface(nullptr);
+
+    test_cancellation(server);
+    test_paged_validators(server);
+
+    return test_summary("MCP tool call");
+}
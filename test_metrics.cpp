@@ -0,0 +1,141 @@
+#include "Metrics.hpp"
+#include "test_harness.hpp"
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+
+namespace {
+    using H = MetricsHistogram;
+
+    void test_buckets() {
+        expect(H::bucket_index(0) == 0 && H::bucket_lower(0) == 0, "0 has a bucket of its own");
+        expect(H::bucket_index(15) == 15 && H::bucket_lower(15) == 15, "Values below 16 are exact");
+        expect(H::bucket_index(16) == 16 && H::bucket_lower(16) == 16, "16 starts the first log-linear bucket");
+        expect(H::bucket_index(17) == 17 && H::bucket_index(32) == 32 && H::bucket_index(33) == 32,
+               "From 32 up a bucket spans two values");
+        const uint64_t top_power = uint64_t{1} << 63;
+        expect(H::bucket_lower(H::bucket_index(top_power)) == top_power, "2^63 is the lower edge of its bucket");
+        expect(H::bucket_index(std::numeric_limits<uint64_t>::max()) == H::kBuckets - 1,
+               "UINT64_MAX lands in the last bucket");
+
+        // Every value sits in [lower, next lower) of its bucket
+        bool bounded = true;
+        for (uint64_t v = 1; v < (uint64_t{1} << 62) && bounded; v = v * 3 + 1) {
+            for (uint64_t probe : {v - 1, v, v + 1}) {
+                size_t index = H::bucket_index(probe);
+                bounded = H::bucket_lower(index) <= probe && probe < H::bucket_lower(index + 1);
+            }
+        }
+        expect(bounded, "Bucket edges bracket their values");
+    }
+
+    void test_quantiles() {
+        MetricsHistogram uniform;
+        for (uint64_t v = 1; v <= 100000; ++v) uniform.observe(v);
+        auto s = uniform.snapshot();
+        bool within = true;
+        for (double q : {0.5, 0.9, 0.99, 0.999}) {
+            double exact = q * 100000;
+            within = within && std::abs(s.quantile(q) - exact) <= exact * 0.0625;
+        }
+        expect(within, "Quantiles of 1..100000 are within 6.25%");
+        expect(s.count == 100000 && s.max == 100000 && s.quantile(1.0) == 100000, "Quantiles never exceed max");
+
+        bool single = true;
+        for (uint64_t v : {uint64_t{7}, uint64_t{1000}, uint64_t{123456789}, uint64_t{1} << 62}) {
+            MetricsHistogram one;
+            one.observe(v);
+            double p50 = one.snapshot().quantile(0.5);
+            single = single && std::abs(p50 - static_cast<double>(v)) <= static_cast<double>(v) * 0.0625;
+        }
+        expect(single, "A single observation is reported within 6.25%");
+        expect(MetricsHistogram().snapshot().quantile(0.5) == 0, "An empty histogram reports 0");
+    }
+
+    void test_kind_mismatch() {
+        auto& registry = MetricsRegistry::instance();
+        registry.counter("test_mismatch_total").inc(2);
+        auto& wrong = registry.gauge("test_mismatch_total");
+        wrong.set(99);
+        expect(registry.counter("test_mismatch_total").value() == 2, "The registered counter is untouched");
+
+        auto text = registry.to_prometheus();
+        expect(text.find("test_mismatch_total 2\n") != std::string::npos && text.find(" 99\n") == std::string::npos,
+               "The detached gauge is never exported");
+        bool in_json = false;
+        for (const auto& gauge : registry.to_json()["gauges"]) {
+            in_json = in_json || gauge["value"] == 99;
+        }
+        expect(!in_json, "Nor does it show up in the JSON");
+    }
+
+    void test_prometheus_escaping() {
+        auto& registry = MetricsRegistry::instance();
+        registry.counter("test_escape_total", {{"path", "a\"b\\c\nd"}, {"tool", "plain"}}, "Escaping test").inc();
+        registry.histogram("test_escape_us", {{"tool", "x\"y"}}).observe(100);
+        auto text = registry.to_prometheus();
+        expect(text.find("# HELP test_escape_total Escaping test\n# TYPE test_escape_total counter\n") != std::string::npos,
+               "HELP and TYPE lines precede the samples");
+        expect(text.find("test_escape_total{path=\"a\\\"b\\\\c\\nd\",tool=\"plain\"} 1\n") != std::string::npos,
+               "Quotes, backslashes and newlines in label values are escaped");
+        expect(text.find("test_escape_us{tool=\"x\\\"y\",quantile=\"0.5\"} 100\n") != std::string::npos &&
+               text.find("test_escape_us_count{tool=\"x\\\"y\"} 1\n") != std::string::npos,
+               "Histograms export as summaries with escaped labels");
+    }
+
+    // Connects to `path`; true if something accepted the connection
+    bool socket_answers(const std::string& path) {
+        int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+        bool ok = connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+        close(fd);
+        return ok;
+    }
+
+    void test_socket_path() {
+        const std::string file = "test_metrics.txt";
+        std::ofstream(file) << "not a socket";
+        { MetricsExporter exporter("", file, std::chrono::seconds(1)); }
+        expect(std::filesystem::is_regular_file(file), "A regular file at the socket path is left alone");
+        std::remove(file.c_str());
+
+        const std::string path = "test_metrics.sock";
+        std::remove(path.c_str());
+        {
+            MetricsExporter first("", path, std::chrono::seconds(1));
+            { MetricsExporter second("", path, std::chrono::seconds(1)); }
+            expect(socket_answers(path), "A second exporter does not take over a live socket");
+        }
+        // A socket whose listener is gone, as after a crash
+        int stale = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+        bind(stale, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        close(stale);
+        {
+            MetricsExporter exporter("", path, std::chrono::seconds(1));
+            expect(socket_answers(path), "A stale socket is replaced");
+        }
+        std::remove(path.c_str());
+    }
+}
+
+int main() {
+    std::cout << "Testing metrics" << std::endl;
+    test_buckets();
+    test_quantiles();
+    test_kind_mismatch();
+    test_prometheus_escaping();
+    test_socket_path();
+    return test_summary("metrics");
+}
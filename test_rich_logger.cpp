@@ -0,0 +1,165 @@
+#include "RichLogger.hpp"
+#include "GlobalLogger.hpp"
+#include "BinaryLog.hpp"
+#include "test_harness.hpp"
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    std::vector<std::string> read_lines(const std::string& path) {
+        std::vector<std::string> lines;
+        std::ifstream in(path);
+        for (std::string line; std::getline(in, line);) lines.push_back(line);
+        return lines;
+    }
+
+    bool ends_with(const std::string& s, const std::string& suffix) {
+        return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+}
+
+int main() {
+    std::cout << "=== Testing Rich Logger ===" << std::endl;
+    const std::string path = "test_rich_logger.log";
+    std::remove(path.c_str());
+
+    {
+        RichLogger logger(path);
+        logger.log(LogLevel::Info, "plain message");
+        {
+            // Deferred formatting must not keep pointers into the caller's memory
+            std::string temporary = "copied argument";
+            logger.logf(LogLevel::Warning, std::source_location::current(), "{} #{}", temporary.c_str(), 7);
+            temporary.assign(temporary.size(), 'x');
+        }
+        logger.set_level(LogLevel::Warning);
+        int evaluated = 0;
+        auto expensive = [&] { ++evaluated; return std::string("never"); };
+        LOG_TO(logger, LogLevel::Debug, "{}", expensive());
+        logger.log(LogLevel::Info, "filtered");
+        logger.flush();
+
+        auto lines = read_lines(path);
+        expect(lines.size() == 2, "Filtered levels are not written");
+        expect(lines.size() == 2 && ends_with(lines[0], "| plain message") && lines[0].find("INFO") != std::string::npos,
+               "Preformatted messages keep the line layout");
+        expect(lines.size() == 2 && ends_with(lines[1], "| copied argument #7"),
+               "Arguments are captured by value and formatted on the writer thread");
+        expect(evaluated == 0, "Disabled levels skip argument evaluation");
+        LOG_TO(logger, LogLevel::Error, "{}", expensive());
+        logger.flush();
+        expect(evaluated == 1 && read_lines(path).size() == 3, "Enabled levels evaluate and write the arguments");
+
+        // Several producers, each with its own ring; more lines than a ring holds
+        logger.set_level(LogLevel::Debug);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&logger, t] {
+                for (int i = 0; i < 2000; ++i) {
+                    logger.logf(LogLevel::Debug, std::source_location::current(), "thread {} line {}", t, i);
+                }
+            });
+        }
+        for (auto& thread : threads) thread.join();
+        logger.flush();
+        lines = read_lines(path);
+        std::vector<int> next(4, 0);
+        bool ordered = lines.size() == 3 + 4 * 2000;
+        for (size_t i = 3; i < lines.size() && ordered; ++i) {
+            auto at = lines[i].find("| thread ");
+            int t = lines[i][at + 9] - '0';
+            ordered = ends_with(lines[i], "line " + std::to_string(next[t]++));
+        }
+        expect(ordered, "Every line from every thread is written, in order per thread");
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < 100000; ++i) {
+            logger.logf(LogLevel::Debug, std::source_location::current(), "latency probe {} {}", i, 3.5);
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        std::cout << "  " << elapsed.count() / 100000 << "ns per deferred log call (including back-pressure)" << std::endl;
+        logger.log(LogLevel::Error, "last line");
+    }
+    // Destruction drains what is still queued
+    auto lines = read_lines(path);
+    expect(!lines.empty() && ends_with(lines.back(), "| last line") && lines.size() == 3 + 8000 + 100000 + 1,
+           "Destroying the logger writes everything still queued");
+    std::remove(path.c_str());
+
+    // The idle writer sleeps until a record arrives, then writes it within kIdleFlush
+    {
+        RichLogger logger(path);
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        logger.log(LogLevel::Info, "after idling");
+        bool written = false;
+        for (int i = 0; i < 100 && !written; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            written = read_lines(path).size() == 1;
+        }
+        expect(written, "A line logged while idle is written without flush()");
+    }
+    std::remove(path.c_str());
+
+    // Binary format: call-site ids plus raw arguments, decoded offline
+    const std::string binary_path = "test_rich_logger.blog";
+    std::remove(binary_path.c_str());
+    for (int session = 0; session < 2; ++session) {
+        RichLogger logger(binary_path, LogFormat::Binary);
+        for (int i = 0; i < 3; ++i) {
+            logger.logf(LogLevel::Info, std::source_location::current(), "request {} took {:.1f}ms ok={} tag={}", i,
+                        2.5 * i, i % 2 == 0, "chunk");
+        }
+        logger.logf(LogLevel::Warning, std::source_location::current(), "{:>5}|{:x}|{}", 42, 255u, 'z');
+        logger.logf(LogLevel::Warning, std::source_location::current(), "{:>{}}|{:.{}f}", 7, 4, 3.14159, 2);
+        logger.log(LogLevel::Error, "plain text");
+    }
+    std::vector<std::string> decoded;
+    std::string data;
+    {
+        std::ifstream in(binary_path, std::ios::binary);
+        data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    auto decode_lines = [](std::string_view bytes, std::vector<std::string>& lines) {
+        lines.clear();
+        return binlog::decode(bytes, [&](const binlog::Entry& entry) {
+            lines.push_back(RichLogger::level_to_string(static_cast<LogLevel>(entry.level)) + " " + entry.message);
+        });
+    };
+    expect(decode_lines(data, decoded).has_value(), "Binary log decodes without errors");
+    std::vector<std::string> session_lines = {"INFO request 0 took 0.0ms ok=true tag=chunk",
+                                              "INFO request 1 took 2.5ms ok=false tag=chunk",
+                                              "INFO request 2 took 5.0ms ok=true tag=chunk",
+                                              "WARN    42|ff|z", "WARN    7|3.14", "ERROR plain text"};
+    std::vector<std::string> expected_lines = session_lines;
+    expected_lines.insert(expected_lines.end(), session_lines.begin(), session_lines.end());
+    expect(decoded == expected_lines, "Binary entries decode to the text the format strings produce, across sessions");
+
+    // A crash cut the first session's last record short; the next session still decodes
+    size_t second_session = data.find(binlog::kSessionMarker, binlog::kMagic.size() + 1);
+    std::string damaged = data.substr(0, second_session - 3) + data.substr(second_session);
+    auto damaged_result = decode_lines(damaged, decoded);
+    expected_lines.erase(expected_lines.begin() + static_cast<std::ptrdiff_t>(session_lines.size() - 1));
+    expect(!damaged_result && damaged_result.error().starts_with("truncated record"), "A truncated record is reported");
+    expect(decoded == expected_lines, "Decoding resumes at the next session after a truncated record");
+    std::vector<std::string> tail_lines;
+    auto cut_result = decode_lines(std::string_view(data).substr(0, data.size() - 1), tail_lines);
+    expect(!cut_result && tail_lines.size() == 2 * session_lines.size() - 1, "A file cut mid-record keeps every whole entry");
+
+    // Nested replacement fields take their width and precision from the arguments
+    using Args = std::vector<binlog::Arg>;
+    expect(binlog::render("[{:>{}}]", Args{int64_t{42}, int64_t{5}}) == "[   42]", "Nested width field");
+    expect(binlog::render("{:.{}f}s", Args{3.14159, uint64_t{2}}) == "3.14s", "Nested precision field");
+    expect(binlog::render("{0:{1}}|{1}", Args{std::string("ab"), int64_t{4}}) == "ab  |4", "Indexed nested field");
+    expect(binlog::render("{:>{}}", Args{int64_t{1}, std::string("x")}) == "{:>{}}",
+           "A nested field that is not an integer leaves the field as written");
+    std::cout << "  binary log: " << data.size() << " bytes for " << 2 * session_lines.size() << " entries" << std::endl;
+    std::remove(binary_path.c_str());
+
+    return test_summary("rich logger");
+}
@@ -0,0 +1,68 @@
+#include "SearchIndex.hpp"
+#include "test_harness.hpp"
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <vector>
+
+int main() {
+    std::cout << "=== Testing Search Index ===" << std::endl;
+
+    auto terms = SearchIndex::terms("Hello, WORLD! Ünïcode naïve_test 東京");
+    expect(terms == std::vector<std::string>{"hello", "world", "ünïcode", "naïve_test", "東", "京"},
+           "Tokenizer folds case, keeps accented words and splits ideographs");
+
+    std::vector<std::pair<size_t, size_t>> spans;
+    SearchIndex::tokenize("ab  cd", [&](const std::string&, size_t offset, size_t length) {
+        spans.emplace_back(offset, length);
+    });
+    expect(spans == std::vector<std::pair<size_t, size_t>>{{0, 2}, {4, 2}}, "Tokens report byte offsets into the source");
+
+    SearchIndex index;
+    index.add(1, "The quick brown fox");
+    index.add(2, "A brown dog and a quick fox, then a quick brown fox again");
+    index.add(3, "Nothing to see here");
+
+    auto fox = index.search("FOX");
+    expect(fox.size() == 3 && fox[0].message_id == 1 && fox[2].occurrence == 1, "Single-term search is case-insensitive");
+
+    auto phrase = index.search("quick brown");
+    expect(phrase.size() == 2 && phrase[0].message_id == 1 && phrase[1].message_id == 2 &&
+           phrase[1].position == 9 && phrase[1].occurrence == 1,
+           "Multi-word queries match only adjacent terms");
+    expect(index.search("brown quick").empty(), "Phrase order matters");
+    expect(index.search("missing").empty() && index.search("  ").empty(), "Unknown and empty queries find nothing");
+
+    index.add(4, "今日は東京へ行く");
+    auto cjk = index.search("東京");
+    expect(cjk.size() == 1 && cjk[0].message_id == 4, "Ideograph sequences match as phrases");
+
+    // 100k messages drawn from a small vocabulary
+    const std::vector<std::string> words = {"alpha", "beta", "gamma", "delta", "epsilon", "zeta", "eta", "theta",
+                                            "iota", "kappa", "lambda", "mu", "nu", "xi", "omicron", "pi"};
+    SearchIndex big;
+    uint64_t seed = 42;
+    for (uint64_t id = 0; id < 100000; ++id) {
+        std::string text;
+        for (int w = 0; w < 20; ++w) {
+            seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+            text += words[(seed >> 33) % words.size()];
+            text += ' ';
+        }
+        if (id % 1000 == 0) text += "needle in the haystack";
+        big.add(id, text);
+    }
+    auto start = std::chrono::steady_clock::now();
+    auto needles = big.search("needle in the haystack");
+    auto rare = std::chrono::steady_clock::now() - start;
+    start = std::chrono::steady_clock::now();
+    auto common = big.search("alpha beta");
+    auto frequent = std::chrono::steady_clock::now() - start;
+    auto ms = [](auto d) { return std::chrono::duration_cast<std::chrono::microseconds>(d).count() / 1000.0; };
+    std::cout << "  100k messages: rare phrase " << ms(rare) << "ms, common phrase " << ms(frequent) << "ms ("
+              << common.size() << " hits)" << std::endl;
+    expect(needles.size() == 100 && big.document_count() == 100000, "Rare phrase found in every tagged message");
+    expect(ms(rare) < 50, "Rare phrase over 100k messages answers in milliseconds");
+
+    return test_summary("search index");
+}
@@ -0,0 +1,88 @@
+#include "Trace.hpp"
+#include "test_harness.hpp"
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <thread>
+
+namespace {
+    std::optional<nlohmann::json> read_trace(const std::string& path) {
+        std::ifstream in(path);
+        auto trace = nlohmann::json::parse(in, nullptr, false);
+        if (trace.is_discarded()) return std::nullopt;
+        return trace;
+    }
+
+    // Names of the complete (ph:X) events in a trace
+    std::multiset<std::string> span_names(const nlohmann::json& trace) {
+        std::multiset<std::string> names;
+        for (const auto& event : trace["traceEvents"]) {
+            if (event["ph"] == "X") names.insert(event["name"].get<std::string>());
+        }
+        return names;
+    }
+}
+
+int main() {
+    std::cout << "Testing trace output" << std::endl;
+    const std::string path = "test_trace.json";
+    auto& tracer = Tracer::instance();
+    tracer.start("");
+    tracer.set_thread_name("main");
+    {
+        TraceSpan outer("outer", "test");
+        outer.arg("turn", 1);
+        TraceSpan inner("inner", "test");
+    }
+    for (int i = 0; i < 3; ++i) {
+        std::thread([] { TraceSpan span("worker", "test"); }).join();
+    }
+
+    expect(tracer.write(path), "Trace file is written");
+    auto trace = read_trace(path);
+    expect(trace && (*trace)["traceEvents"].is_array(), "The file is JSON with a traceEvents array");
+    if (!trace) return test_summary("trace");
+
+    std::map<uint32_t, std::string> thread_names;
+    bool complete_fields = true;
+    bool outer_has_args = false;
+    for (const auto& event : (*trace)["traceEvents"]) {
+        if (event["ph"] == "M" && event["name"] == "thread_name") {
+            thread_names[event["tid"].get<uint32_t>()] = event["args"]["name"].get<std::string>();
+        } else if (event["ph"] == "X") {
+            complete_fields = complete_fields && event["ts"].is_number() && event["dur"].is_number() &&
+                              event["dur"].get<double>() >= 0 && event["cat"] == "test" && event["pid"].is_number();
+            outer_has_args = outer_has_args || (event["name"] == "outer" && event["args"]["turn"] == 1);
+        }
+    }
+    expect(span_names(*trace) == std::multiset<std::string>{"inner", "outer", "worker", "worker", "worker"},
+           "Every span is a ph:X event");
+    expect(complete_fields && outer_has_args, "Complete events carry ts, dur, cat, pid and args");
+    bool named = true;
+    for (const auto& event : (*trace)["traceEvents"]) {
+        if (event["ph"] == "X") named = named && thread_names.contains(event["tid"].get<uint32_t>());
+    }
+    expect(named && thread_names.size() == 4, "Each thread with spans gets thread_name metadata");
+    bool has_main = false;
+    for (const auto& [tid, name] : thread_names) has_main = has_main || name == "main";
+    expect(has_main, "set_thread_name labels the track");
+
+    // The exited workers' buffers were let go once written
+    {
+        TraceSpan later("later", "test");
+    }
+    expect(tracer.write(path), "Trace file is written again");
+    trace = read_trace(path);
+    expect(trace && span_names(*trace) == std::multiset<std::string>{"inner", "later", "outer"},
+           "Exited threads' buffers are released after a write");
+
+    std::thread([] { TraceSpan span("cleared", "test"); }).join();
+    tracer.clear();
+    expect(tracer.write(path) && (trace = read_trace(path)) && span_names(*trace).empty(),
+           "clear() discards every event, exited threads' included");
+    tracer.stop();
+    std::remove(path.c_str());
+    return test_summary("trace");
+}
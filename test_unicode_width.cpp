@@ -0,0 +1,100 @@
+#include "utf8_utils.hpp"
+#include "unicode_width_table.hpp"
+#include "test_harness.hpp"
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace {
+    // The table is usable in constant expressions
+    static_assert((unicode_table::lookup('A') & 3) == 1);
+    static_assert((unicode_table::lookup(0x4E2D) & 3) == 2);
+}
+
+int main() {
+    std::cout << "=== Testing Unicode Width ===" << std::endl;
+
+    expect(codepoint_width('a') == 1 && codepoint_width(0x7F) == 0 && codepoint_width('\t') == 0,
+           "ASCII is one column, controls take none");
+    expect(codepoint_width(0x4E2D) == 2 && codepoint_width(0xFF21) == 2 && codepoint_width(0x20000) == 2,
+           "CJK ideographs and fullwidth forms are two columns");
+    expect(codepoint_width(0x0301) == 0 && codepoint_width(0x200B) == 0 && codepoint_width(0x200D) == 0,
+           "Combining marks and format characters are zero width");
+    expect(codepoint_width(0x1F600) == 2 && codepoint_width(0x00E9) == 1 && codepoint_width(0x110000) == 1,
+           "Emoji are wide; Latin-1 and out-of-range values are narrow");
+
+    expect(utf8_display_width("hello") == 5 && utf8_display_width("中文") == 4, "String widths sum per cluster");
+    expect(utf8_display_width("e\u0301") == 1, "A combining accent joins its base");
+    expect(utf8_display_width("\U0001F468\u200D\U0001F469\u200D\U0001F467") == 2, "A ZWJ family is one emoji");
+    expect(utf8_display_width("\U0001F1EF\U0001F1F5\U0001F1EB") == 3, "Regional indicators pair into flags");
+    expect(utf8_display_width("\u2764\uFE0F") == 2 && utf8_display_width("\u2764") == 1,
+           "VS16 selects the wide emoji presentation");
+    expect(utf8_display_width("\U0001F44D\U0001F3FD") == 2, "A skin-tone modifier joins its emoji");
+    expect(utf8_display_width("\u1112\u1161\u11AB") == 2, "Conjoining Hangul jamo form one syllable");
+    expect(utf8_display_width("a\xFF" "b") == 3 && utf8_display_width("a\r\nb") == 2,
+           "Invalid bytes are one column and CRLF none");
+
+    std::string family = "\U0001F468\u200D\U0001F469\u200D\U0001F467";
+    size_t index = 0;
+    int width = utf8_next_grapheme("x" + family, index);
+    expect(width == 1 && index == 1, "utf8_next_grapheme stops before the next cluster");
+
+    auto lines = utf8_word_wrap(std::string(9, 'a') + family + family + family, 6);
+    bool intact = !lines.empty();
+    for (const auto& line : lines) {
+        intact = intact && utf8_display_width(line) <= 6;
+        if (line.find("\u200D") != std::string::npos && line.back() == '-') {
+            intact = intact && line.find(family) != std::string::npos;
+        }
+    }
+    expect(intact && lines.size() == 4, "Wrapping never splits an emoji sequence");
+
+    // Streaming decoder: split sequences resume in the next chunk
+    std::string japanese = "日本語 \U0001F600";
+    std::vector<uint32_t> whole;
+    Utf8Decoder decoder;
+    decoder.feed(japanese, [&](uint32_t cp) { whole.push_back(cp); });
+    bool splits_ok = whole == std::vector<uint32_t>{0x65E5, 0x672C, 0x8A9E, ' ', 0x1F600};
+    for (size_t cut = 1; cut < japanese.size(); ++cut) {
+        std::vector<uint32_t> pieces;
+        Utf8Decoder chunked;
+        chunked.feed(std::string_view(japanese).substr(0, cut), [&](uint32_t cp) { pieces.push_back(cp); });
+        chunked.feed(std::string_view(japanese).substr(cut), [&](uint32_t cp) { pieces.push_back(cp); });
+        splits_ok = splits_ok && pieces == whole && chunked.pending_bytes() == 0;
+    }
+    expect(splits_ok, "Decoding resumes across every chunk boundary");
+
+    std::vector<uint32_t> recovered;
+    Utf8Decoder strict;
+    strict.feed("a\xE6\x97" "b\xC0\xAF\xED\xA0\x80" "c\xF0\x9F", [&](uint32_t cp) { recovered.push_back(cp); });
+    uint32_t last = 0;
+    bool flushed = strict.pending_bytes() == 2 && strict.finish(last);
+    recovered.push_back(last);
+    expect(flushed && recovered == std::vector<uint32_t>{'a', 0xFFFD, 'b', 0xFFFD, 0xFFFD, 0xFFFD, 0xFFFD, 0xFFFD, 'c', 0xFFFD},
+           "Truncated, overlong and surrogate sequences become U+FFFD and resynchronize");
+
+    std::string_view bounded("\xE6\x97\xA5\xE6\x97", 5);
+    size_t at = 0;
+    uint32_t first = utf8_next_codepoint(bounded, at);
+    uint32_t truncated = utf8_next_codepoint(bounded, at);
+    expect(first == 0x65E5 && truncated == 0xFFFD && at == 5, "utf8_next_codepoint stops at the view's end");
+
+    std::string long_text(1 << 20, 'x');
+    auto scan_start = std::chrono::steady_clock::now();
+    size_t count = 0;
+    for (size_t i = 0; i < long_text.size(); ++count) utf8_next_codepoint(long_text, i);
+    auto scan = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - scan_start);
+    std::cout << "  1MB decoded code point by code point in " << scan.count() / 1000.0 << "ms" << std::endl;
+    expect(count == long_text.size() && scan.count() < 500000, "Iterating with utf8_next_codepoint is linear");
+
+    std::string text;
+    for (int i = 0; i < 20000; ++i) text += "Mixed 中文 text with e\u0301moji \U0001F600 and \U0001F1EF\U0001F1F5 flags. ";
+    auto start = std::chrono::steady_clock::now();
+    int total = utf8_display_width(text);
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    std::cout << "  " << text.size() / 1024 << "KB measured in " << elapsed.count() / 1000.0 << "ms" << std::endl;
+    expect(total == 20000 * 44, "Width of a large mixed buffer is exact");
+
+    return test_summary("unicode width");
+}